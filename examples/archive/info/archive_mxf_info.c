@@ -631,6 +631,8 @@ static int get_info(Reader *reader, int showPSEFailures, int showVTRErrors, int
     uint64_t headerByteCount;
     MXFListIterator setsIter;
     int fileIsComplete;
+    int readFooterMetadata;
+    int64_t filePos;
     mxfRational editRate;
     uint8_t frameLayout;
 
@@ -664,6 +666,19 @@ static int get_info(Reader *reader, int showPSEFailures, int showVTRErrors, int
     }
 
 
+    /* a streamed file has no footer offset in the open header partition pack and the complete header metadata
+       is only available in the footer */
+    readFooterMetadata = 0;
+    if (fileIsComplete && reader->headerPartition->footerPartition == 0)
+    {
+        filePos = mxf_file_tell(reader->mxfFile);
+        CHK_ORET(mxf_find_footer_partition(reader->mxfFile));
+        reader->headerPartition->footerPartition = mxf_file_tell(reader->mxfFile);
+        CHK_ORET(mxf_file_seek(reader->mxfFile, filePos, SEEK_SET));
+        readFooterMetadata = 1;
+    }
+
+
     /* get the content package length */
     get_content_package_len(reader);
 
@@ -685,7 +700,7 @@ static int get_info(Reader *reader, int showPSEFailures, int showVTRErrors, int
 
 
     /* read the header metadata in the footer is showing PSE failures, etc */
-    if (showPSEFailures || showVTRErrors || showDigiBetaDropouts || showTimecodeBreaks)
+    if (readFooterMetadata || showPSEFailures || showVTRErrors || showDigiBetaDropouts || showTimecodeBreaks)
     {
         if (fileIsComplete)
         {
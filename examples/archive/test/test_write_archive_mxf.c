@@ -46,6 +46,7 @@
 #include "write_archive_mxf.h"
 #include <mxf/mxf_utils.h>
 #include <mxf/mxf_page_file.h>
+#include <mxf/mxf_cache_file.h>
 
 
 #define MXF_PAGE_SIZE               (2 * 60 * 25 * 852628LL)
@@ -198,7 +199,7 @@ static void increment_timecode(ArchiveTimecode *timecode, uint16_t roundedTCBase
 
 static void usage(const char *cmd)
 {
-    fprintf(stderr, "Usage: %s [--num-audio <val> --format <format> --10bit --16by9 --no-lto-update --crc32 --regtest] <num frames> <filename>\n", cmd);
+    fprintf(stderr, "Usage: %s [--num-audio <val> --format <format> --10bit --16by9 --no-lto-update --crc32 --direct-io --write-behind <MB> --per-element --regtest] <num frames> <filename>\n", cmd);
     fprintf(stderr, "<format>: 625i25, 525i29, 1080i25, 1080i29, 1080p25, 1080p29, 1080p50, 1080p59, 720p25, 720p29, 720p50, 720p59\n");
 }
 
@@ -244,6 +245,10 @@ int main(int argc, const char *argv[])
     uint32_t audioFrameOffset = 0;
     uint8_t s;
     int regtest = 0;
+    int directIO = 0;
+    unsigned int writeBehindMB = 0;
+    int perElement = 0;
+    const uint8_t *audioData[MAX_ARCHIVE_AUDIO_TRACKS];
     int cmdlnIndex = 1;
 
 
@@ -405,6 +410,33 @@ int main(int argc, const char *argv[])
             includeCRC32 = 1;
             cmdlnIndex++;
         }
+        else if (strcmp(argv[cmdlnIndex], "--direct-io") == 0)
+        {
+            directIO = 1;
+            cmdlnIndex++;
+        }
+        else if (strcmp(argv[cmdlnIndex], "--write-behind") == 0)
+        {
+            if (cmdlnIndex + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing value for argument '%s'\n", argv[cmdlnIndex]);
+                return 1;
+            }
+            if (sscanf(argv[cmdlnIndex + 1], "%u", &writeBehindMB) != 1 ||
+                writeBehindMB == 0 || writeBehindMB > 1024)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Invalid value '%s' for argument '%s'\n", argv[cmdlnIndex + 1], argv[cmdlnIndex]);
+                return 1;
+            }
+            cmdlnIndex += 2;
+        }
+        else if (strcmp(argv[cmdlnIndex], "--per-element") == 0)
+        {
+            perElement = 1;
+            cmdlnIndex++;
+        }
         else if (strcmp(argv[cmdlnIndex], "--regtest") == 0)
         {
             regtest = 1;
@@ -457,14 +489,79 @@ int main(int argc, const char *argv[])
     {
         MXFPageFile *mxfPageFile;
         MXFFile *mxfFile;
-        if (!mxf_page_file_open_new(mxfFilename, MXF_PAGE_SIZE, &mxfPageFile))
+        int result;
+        if (directIO)
+        {
+            result = mxf_page_file_open_new_direct(mxfFilename, MXF_PAGE_SIZE, &mxfPageFile);
+        }
+        else
+        {
+            result = mxf_page_file_open_new(mxfFilename, MXF_PAGE_SIZE, &mxfPageFile);
+        }
+        if (!result)
         {
             fprintf(stderr, "Failed to open page mxf file\n");
             return 1;
         }
         mxfFile = mxf_page_file_get_file(mxfPageFile);
-        if (!prepare_archive_mxf_file_2(&mxfFile, mxfFilename, &frameRate, signalStandard, frameLayout, componentDepth,
-                                        &aspectRatio, numAudioTracks, audioQuantBits, includeCRC32, 0, &output))
+        if (!prepare_archive_mxf_file_3(&mxfFile, mxfFilename, &frameRate, signalStandard, frameLayout, componentDepth,
+                                        &aspectRatio, numAudioTracks, audioQuantBits, includeCRC32, 0, numFrames,
+                                        &output))
+        {
+            fprintf(stderr, "Failed to prepare file\n");
+            if (mxfFile != NULL)
+            {
+                mxf_file_close(&mxfFile);
+            }
+            return 1;
+        }
+    }
+    else if (directIO)
+    {
+        MXFFile *mxfFile;
+        if (!mxf_disk_file_open_new_direct(mxfFilename, 0, &mxfFile))
+        {
+            fprintf(stderr, "Failed to open direct I/O mxf file\n");
+            return 1;
+        }
+        if (!prepare_archive_mxf_file_3(&mxfFile, mxfFilename, &frameRate, signalStandard, frameLayout, componentDepth,
+                                        &aspectRatio, numAudioTracks, audioQuantBits, includeCRC32, 0, numFrames,
+                                        &output))
+        {
+            fprintf(stderr, "Failed to prepare file\n");
+            if (mxfFile != NULL)
+            {
+                mxf_file_close(&mxfFile);
+            }
+            return 1;
+        }
+    }
+    else if (writeBehindMB > 0)
+    {
+        MXFFile *targetFile;
+        MXFCacheFile *mxfCacheFile;
+        MXFFile *mxfFile;
+        if (!mxf_disk_file_open_new(mxfFilename, &targetFile))
+        {
+            fprintf(stderr, "Failed to open mxf file\n");
+            return 1;
+        }
+        if (!mxf_cache_file_open_2(targetFile, 256 * 1024, writeBehindMB * 1024 * 1024, 0, &mxfCacheFile))
+        {
+            fprintf(stderr, "Failed to open cache mxf file\n");
+            mxf_file_close(&targetFile);
+            return 1;
+        }
+        mxfFile = mxf_cache_file_get_file(mxfCacheFile);
+        if (!mxf_cache_file_start_flusher(mxfCacheFile, 0, 0))
+        {
+            fprintf(stderr, "Failed to start cache file flusher\n");
+            mxf_file_close(&mxfFile);
+            return 1;
+        }
+        if (!prepare_archive_mxf_file_3(&mxfFile, mxfFilename, &frameRate, signalStandard, frameLayout, componentDepth,
+                                        &aspectRatio, numAudioTracks, audioQuantBits, includeCRC32, 0, numFrames,
+                                        &output))
         {
             fprintf(stderr, "Failed to prepare file\n");
             if (mxfFile != NULL)
@@ -476,10 +573,22 @@ int main(int argc, const char *argv[])
     }
     else
     {
-        if (!prepare_archive_mxf_file(mxfFilename, &frameRate, signalStandard, frameLayout, componentDepth,
-                                      &aspectRatio, numAudioTracks, audioQuantBits, includeCRC32, 0, &output))
+        /* open the disk file here so that the essence space can be preallocated */
+        MXFFile *mxfFile;
+        if (!mxf_disk_file_open_new(mxfFilename, &mxfFile))
+        {
+            fprintf(stderr, "Failed to open file '%s'\n", mxfFilename);
+            return 1;
+        }
+        if (!prepare_archive_mxf_file_3(&mxfFile, mxfFilename, &frameRate, signalStandard, frameLayout, componentDepth,
+                                        &aspectRatio, numAudioTracks, audioQuantBits, includeCRC32, 0, numFrames,
+                                        &output))
         {
             fprintf(stderr, "Failed to prepare file\n");
+            if (mxfFile != NULL)
+            {
+                mxf_file_close(&mxfFile);
+            }
             return 1;
         }
     }
@@ -543,24 +652,41 @@ int main(int argc, const char *argv[])
             }
         }
 
-        if (!write_system_item(output, vitc, ltc, crc32, numCRC32))
+        if (perElement)
         {
-            passed = 0;
-            fprintf(stderr, "Failed to write system item\n");
-            break;
-        }
-        if (!write_video_frame(output, uncData, videoFrameSize))
-        {
-            passed = 0;
-            fprintf(stderr, "Failed to write video\n");
-            break;
+            if (!write_system_item(output, vitc, ltc, crc32, numCRC32))
+            {
+                passed = 0;
+                fprintf(stderr, "Failed to write system item\n");
+                break;
+            }
+            if (!write_video_frame(output, uncData, videoFrameSize))
+            {
+                passed = 0;
+                fprintf(stderr, "Failed to write video\n");
+                break;
+            }
+            for (j = 0; j < numAudioTracks; j++)
+            {
+                if (!write_audio_frame(output, pcmData + audioFrameOffset, audioFrameSize))
+                {
+                    passed = 0;
+                    fprintf(stderr, "Failed to write audio %d\n", j);
+                    break;
+                }
+            }
         }
-        for (j = 0; j < numAudioTracks; j++)
+        else
         {
-            if (!write_audio_frame(output, pcmData + audioFrameOffset, audioFrameSize))
+            for (j = 0; j < numAudioTracks; j++)
+            {
+                audioData[j] = pcmData + audioFrameOffset;
+            }
+            if (!write_content_package(output, vitc, ltc, crc32, numCRC32, uncData, videoFrameSize, audioData,
+                                       audioFrameSize))
             {
                 passed = 0;
-                fprintf(stderr, "Failed to write audio %d\n", j);
+                fprintf(stderr, "Failed to write content package\n");
                 break;
             }
         }
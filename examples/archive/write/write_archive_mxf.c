@@ -43,6 +43,7 @@
 #include <mxf/mxf.h>
 #include <mxf/mxf_app.h>
 #include <mxf/mxf_uu_metadata.h>
+#include <mxf/mxf_memory_file.h>
 #include <mxf/mxf_macros.h>
 #include "write_archive_mxf.h"
 #include "timecode_index.h"
@@ -72,6 +73,13 @@
 #define MIN_LLEN                        4
 #define ESS_ELEMENT_LLEN                4
 
+/* initial and maximum chunk size of the memory file used to assemble a partition when streaming */
+#define STREAM_PARTITION_CHUNK_SIZE     (256 * 1024)
+#define STREAM_PARTITION_MAX_CHUNK_SIZE (16 * 1024 * 1024)
+
+#define SYSTEM_ITEM_KL_SIZE             (mxfKey_extlen + ESS_ELEMENT_LLEN)
+#define MAX_SYSTEM_ITEM_SIZE            (28 + 12 + (1 + MAX_ARCHIVE_AUDIO_TRACKS) * 4)
+
 
 
 typedef struct
@@ -113,10 +121,21 @@ struct _ArchiveMXFWriter
 
     EssWriteState essWriteState;
 
+    /* set when a content package was partially written; the file can then only be aborted */
+    int writeFailed;
+
+    /* zero bytes used to fill the audio elements in write_content_package */
+    uint8_t *fillZeros;
+
     uint64_t headerMetadataFilePos;
     uint64_t bodyFilePos;
     mxfTimestamp now;
 
+    /* the output is not seekable and partitions are assembled in partitionMemFile before writing to streamFile */
+    int isStreaming;
+    MXFFile *streamFile;
+    MXFMemoryFile *partitionMemFile;
+
     MXFDataModel *dataModel;
     MXFList *partitions;
     MXFHeaderMetadata *headerMetadata;
@@ -442,6 +461,7 @@ static void free_archive_mxf_file(ArchiveMXFWriter **output)
     }
 
     SAFE_FREE((*output)->tempString);
+    SAFE_FREE((*output)->fillZeros);
 
     clear_timecode_index(&(*output)->vitcIndex);
     clear_timecode_index(&(*output)->ltcIndex);
@@ -456,16 +476,62 @@ static void free_archive_mxf_file(ArchiveMXFWriter **output)
     mxf_clear_list(&(*output)->digiBetaDropoutTrackSets);
     mxf_clear_list(&(*output)->timecodeBreakTrackSets);
 
+    if ((*output)->streamFile != NULL)
+    {
+        mxf_file_close(&(*output)->mxfFile);
+        (*output)->mxfFile = (*output)->streamFile;
+    }
     mxf_file_close(&(*output)->mxfFile);
 
     SAFE_FREE(*output);
 }
 
 
+/* the partition packs in a non-seekable output can't be updated. The partition is therefore written to a memory
+   file until the byte counts are known and the partition pack is complete */
+static int start_stream_partition(ArchiveMXFWriter *output)
+{
+    int64_t filePos;
+
+    CHK_ORET((filePos = mxf_file_tell(output->mxfFile)) >= 0);
+    CHK_ORET(mxf_mem_file_open_new(STREAM_PARTITION_CHUNK_SIZE, filePos, &output->partitionMemFile));
+    CHK_ORET(mxf_mem_file_set_chunk_growth(output->partitionMemFile, STREAM_PARTITION_MAX_CHUNK_SIZE));
+
+    output->streamFile = output->mxfFile;
+    output->mxfFile = mxf_mem_file_get_file(output->partitionMemFile);
+    mxf_file_set_min_llen(output->mxfFile, MIN_LLEN);
+
+    return 1;
+}
+
+static int end_stream_partition(ArchiveMXFWriter *output, MXFPartition *partition)
+{
+    MXFFile *memFile = output->mxfFile;
+    int result;
+
+    result = mxf_file_seek(memFile, partition->thisPartition, SEEK_SET) &&
+             mxf_write_partition(memFile, partition) &&
+             mxf_mem_file_flush_to_file(output->partitionMemFile, output->streamFile);
+
+    output->mxfFile = output->streamFile;
+    output->streamFile = NULL;
+    output->partitionMemFile = NULL;
+    mxf_file_close(&memFile);
+
+    return result;
+}
+
+
 static int verify_essence_write_state(ArchiveMXFWriter *output, int writeSystemItem, int writeVideo, int writeAudio)
 {
     assert(writeSystemItem || writeVideo || writeAudio);
 
+    if (output->writeFailed)
+    {
+        mxf_log_error("Essence can't be written after a failed content package write" LOG_LOC_FORMAT, LOG_LOC_PARAMS);
+        return 0;
+    }
+
     if (writeSystemItem)
     {
         if (output->essWriteState.haveSystemItem)
@@ -665,6 +731,17 @@ int prepare_archive_mxf_file_2(MXFFile **mxfFile, const char *filename, const mx
                                uint8_t signalStandard, uint8_t frameLayout, uint32_t componentDepth,
                                const mxfRational *aspectRatio, int numAudioTracks, uint32_t audioQuantBits,
                                int includeCRC32, int64_t startPosition, ArchiveMXFWriter **output)
+{
+    return prepare_archive_mxf_file_3(mxfFile, filename, frameRate, signalStandard, frameLayout, componentDepth,
+                                      aspectRatio, numAudioTracks, audioQuantBits, includeCRC32, startPosition, 0,
+                                      output);
+}
+
+int prepare_archive_mxf_file_3(MXFFile **mxfFile, const char *filename, const mxfRational *frameRate,
+                               uint8_t signalStandard, uint8_t frameLayout, uint32_t componentDepth,
+                               const mxfRational *aspectRatio, int numAudioTracks, uint32_t audioQuantBits,
+                               int includeCRC32, int64_t startPosition, int64_t expectedDuration,
+                               ArchiveMXFWriter **output)
 {
     ArchiveMXFWriter *newOutput;
     int64_t filePos;
@@ -720,6 +797,7 @@ int prepare_archive_mxf_file_2(MXFFile **mxfFile, const char *filename, const mx
     }
     newOutput->videoFrameSize = get_video_frame_size(frameRate, signalStandard, componentDepth);
     newOutput->audioElementSize = get_audio_element_size(frameRate, audioQuantBits);
+    CHK_OFAIL((newOutput->fillZeros = (uint8_t*)calloc(newOutput->audioElementSize, 1)) != NULL);
 
 
     CHK_OFAIL(mxf_create_file_partitions(&newOutput->partitions));
@@ -734,6 +812,12 @@ int prepare_archive_mxf_file_2(MXFFile **mxfFile, const char *filename, const mx
      * Write the Header Partition Pack
      */
 
+    newOutput->isStreaming = !mxf_file_is_seekable(newOutput->mxfFile);
+    if (newOutput->isStreaming)
+    {
+        CHK_OFAIL(start_stream_partition(newOutput));
+    }
+
     CHK_OFAIL(mxf_append_new_partition(newOutput->partitions, &newOutput->headerPartition));
     /* partition is open because the LTO and source videotape Infax data needs to be filled in and is incomplete
        because the durations are not yet known */
@@ -1311,7 +1395,27 @@ int prepare_archive_mxf_file_2(MXFFile **mxfFile, const char *filename, const mx
      * Update the header partition pack
      */
 
-    CHK_ORET(mxf_update_partitions(newOutput->mxfFile, newOutput->partitions));
+    if (newOutput->isStreaming)
+    {
+        CHK_OFAIL(end_stream_partition(newOutput, newOutput->headerPartition));
+    }
+    else
+    {
+        CHK_ORET(mxf_update_partitions(newOutput->mxfFile, newOutput->partitions));
+    }
+
+
+    /*
+     * Reserve the disk space for the essence to avoid fragmentation over a long ingest
+     */
+
+    if (expectedDuration > 0 && !newOutput->isStreaming)
+    {
+        mxf_file_preallocate(newOutput->mxfFile, FIXED_BODY_OFFSET,
+                             expectedDuration * get_archive_mxf_content_package_size(frameRate, signalStandard,
+                                                                                     componentDepth, numAudioTracks,
+                                                                                     audioQuantBits, includeCRC32));
+    }
 
 
     *output = newOutput;
@@ -1323,47 +1427,78 @@ fail:
 }
 
 
-int write_system_item(ArchiveMXFWriter *output, ArchiveTimecode vitc, ArchiveTimecode ltc, const uint32_t *crc32,
-                      int numCRC32)
+static void put_uint16(uint8_t *buffer, uint16_t value)
 {
-    uint8_t t12m[8];
-    int i;
-
-    CHK_ORET(!output->includeCRC32 || numCRC32 == 1 + output->numAudioTracks);
+    buffer[0] = (uint8_t)((value >> 8) & 0xff);
+    buffer[1] = (uint8_t)(value & 0xff);
+}
 
-    CHK_ORET(verify_essence_write_state(output, 1, 0, 0));
+static void put_uint32(uint8_t *buffer, uint32_t value)
+{
+    buffer[0] = (uint8_t)((value >> 24) & 0xff);
+    buffer[1] = (uint8_t)((value >> 16) & 0xff);
+    buffer[2] = (uint8_t)((value >> 8) & 0xff);
+    buffer[3] = (uint8_t)(value & 0xff);
+}
 
-    CHK_ORET(add_timecode_to_index(&output->vitcIndex, &vitc));
-    CHK_ORET(add_timecode_to_index(&output->ltcIndex, &ltc));
+/* encodes the system item KLV into buffer, which must hold SYSTEM_ITEM_KL_SIZE + systemItemSize bytes */
+static int encode_system_item(ArchiveMXFWriter *output, ArchiveTimecode *vitc, ArchiveTimecode *ltc,
+                              const uint32_t *crc32, int numCRC32, uint8_t *buffer)
+{
+    uint8_t *ptr;
+    int i;
 
-    CHK_ORET(mxf_write_fixed_kl(output->mxfFile, &TIMECODE_SYS_ITEM_ELEMENT_KEY, ESS_ELEMENT_LLEN,
-                                output->systemItemSize));
+    CHK_ORET(mxf_encode_fixed_kl(&TIMECODE_SYS_ITEM_ELEMENT_KEY, ESS_ELEMENT_LLEN, output->systemItemSize, buffer));
+    ptr = &buffer[SYSTEM_ITEM_KL_SIZE];
 
     /* timecode */
 
-    CHK_ORET(mxf_write_uint16(output->mxfFile, 0x0102)); /* local tag */
-    CHK_ORET(mxf_write_uint16(output->mxfFile, 24)); /* len */
+    put_uint16(ptr, 0x0102); /* local tag */
+    put_uint16(&ptr[2], 24); /* len */
 
-    CHK_ORET(mxf_write_array_header(output->mxfFile, 2, 8)); /* VITC and LTC SMPTE-12M timecodes */
-    convert_timecode_to_12m(&vitc, t12m);
-    CHK_ORET(mxf_file_write(output->mxfFile, t12m, 8) == 8);
-    convert_timecode_to_12m(&ltc, t12m);
-    CHK_ORET(mxf_file_write(output->mxfFile, t12m, 8) == 8);
+    put_uint32(&ptr[4], 2); /* VITC and LTC SMPTE-12M timecodes */
+    put_uint32(&ptr[8], 8);
+    convert_timecode_to_12m(vitc, &ptr[12]);
+    convert_timecode_to_12m(ltc, &ptr[20]);
+    ptr += 28;
 
     /* CRC-32 */
 
     if (output->includeCRC32)
     {
-        CHK_ORET(mxf_write_uint16(output->mxfFile, 0xffff)); /* local tag */
-        CHK_ORET(mxf_write_uint16(output->mxfFile, 8 + numCRC32 * 4)); /* len */
+        put_uint16(ptr, 0xffff); /* local tag */
+        put_uint16(&ptr[2], (uint16_t)(8 + numCRC32 * 4)); /* len */
 
-        CHK_ORET(mxf_write_array_header(output->mxfFile, numCRC32, 4));
+        put_uint32(&ptr[4], numCRC32);
+        put_uint32(&ptr[8], 4);
+        ptr += 12;
         for (i = 0; i < numCRC32; i++)
         {
-            CHK_ORET(mxf_write_uint32(output->mxfFile, crc32[i]));
+            put_uint32(ptr, crc32[i]);
+            ptr += 4;
         }
     }
 
+    assert(ptr - buffer == (int)(SYSTEM_ITEM_KL_SIZE + output->systemItemSize));
+    return 1;
+}
+
+int write_system_item(ArchiveMXFWriter *output, ArchiveTimecode vitc, ArchiveTimecode ltc, const uint32_t *crc32,
+                      int numCRC32)
+{
+    uint8_t buffer[SYSTEM_ITEM_KL_SIZE + MAX_SYSTEM_ITEM_SIZE];
+
+    CHK_ORET(!output->includeCRC32 || numCRC32 == 1 + output->numAudioTracks);
+
+    CHK_ORET(verify_essence_write_state(output, 1, 0, 0));
+
+    CHK_ORET(add_timecode_to_index(&output->vitcIndex, &vitc));
+    CHK_ORET(add_timecode_to_index(&output->ltcIndex, &ltc));
+
+    CHK_ORET(encode_system_item(output, &vitc, &ltc, crc32, numCRC32, buffer));
+    CHK_ORET(mxf_file_write(output->mxfFile, buffer, SYSTEM_ITEM_KL_SIZE + output->systemItemSize) ==
+                 SYSTEM_ITEM_KL_SIZE + output->systemItemSize);
+
     update_essence_write_state(output, 1, 0, 0);
 
     return 1;
@@ -1415,6 +1550,144 @@ int write_audio_frame(ArchiveMXFWriter *output, const uint8_t *data, uint32_t si
     return 1;
 }
 
+int write_content_package(ArchiveMXFWriter *output, ArchiveTimecode vitc, ArchiveTimecode ltc,
+                          const uint32_t *crc32, int numCRC32, const uint8_t *videoData, uint32_t videoSize,
+                          const uint8_t * const *audioData, uint32_t audioSize)
+{
+    uint8_t headerBuffer[SYSTEM_ITEM_KL_SIZE + MAX_SYSTEM_ITEM_SIZE + mxfKey_extlen + ESS_ELEMENT_LLEN];
+    uint8_t audioKLs[MAX_ARCHIVE_AUDIO_TRACKS][mxfKey_extlen + ESS_ELEMENT_LLEN];
+    uint8_t fillKL[mxfKey_extlen + 9];
+    MXFIOVec iov[2 + 4 * MAX_ARCHIVE_AUDIO_TRACKS];
+    uint32_t savedInputAudioSequence[MAX_AUDIO_SEQUENCE_SIZE];
+    EssWriteState savedEssWriteState;
+    mxfLength savedDuration;
+    uint8_t savedAudioSequenceOffset;
+    uint64_t totalSize;
+    uint32_t headerSize;
+    uint32_t fillSize = 0;
+    uint8_t fillKLSize = 0;
+    mxfKey eeKey;
+    int iovcnt;
+    int i;
+
+    if (videoSize != output->videoFrameSize)
+    {
+        mxf_log_error("Invalid video frame size %ld; expecting %ld" LOG_LOC_FORMAT, videoSize, output->videoFrameSize, LOG_LOC_PARAMS);
+        return 0;
+    }
+    CHK_ORET(!output->includeCRC32 || numCRC32 == 1 + output->numAudioTracks);
+
+
+    /* the write state is updated as each element is added to the write and is restored if nothing was written.
+       The timecodes are added to the index once the content package has been written */
+    savedEssWriteState = output->essWriteState;
+    savedDuration = output->duration;
+    savedAudioSequenceOffset = output->audioSequenceOffset;
+    memcpy(savedInputAudioSequence, output->inputAudioSequence, sizeof(savedInputAudioSequence));
+
+
+    /* system item followed by the video element KL */
+
+    CHK_ORET(verify_essence_write_state(output, 1, 0, 0));
+
+    CHK_ORET(encode_system_item(output, &vitc, &ltc, crc32, numCRC32, headerBuffer));
+    headerSize = SYSTEM_ITEM_KL_SIZE + output->systemItemSize;
+
+    update_essence_write_state(output, 1, 0, 0);
+
+    CHK_OFAIL(verify_essence_write_state(output, 0, 1, 0));
+
+    eeKey = UNC_BASE_ELEMENT_KEY;
+    mxf_complete_essence_element_key(&eeKey, 1, MXF_UNC_FRAME_WRAPPED_EE_TYPE, 1);
+    CHK_OFAIL(mxf_encode_fixed_kl(&eeKey, ESS_ELEMENT_LLEN, videoSize, &headerBuffer[headerSize]));
+    headerSize += mxfKey_extlen + ESS_ELEMENT_LLEN;
+
+    iov[0].data = headerBuffer;
+    iov[0].size = headerSize;
+    iov[1].data = videoData;
+    iov[1].size = videoSize;
+    iovcnt = 2;
+    totalSize = headerSize + videoSize;
+
+    output->duration++;
+    update_essence_write_state(output, 0, 1, 0);
+
+
+    /* audio elements, each filled to audioElementSize */
+
+    if (output->numAudioTracks > 0 &&
+        mxfKey_extlen + ESS_ELEMENT_LLEN + audioSize < output->audioElementSize)
+    {
+        /* same fill as mxf_write_fill */
+        uint32_t size = output->audioElementSize - (mxfKey_extlen + ESS_ELEMENT_LLEN + audioSize);
+        uint8_t llen;
+
+        CHK_OFAIL(size >= (uint32_t)(mxf_get_min_llen(output->mxfFile) + mxfKey_extlen));
+        fillSize = size - mxfKey_extlen;
+        llen = mxf_get_llen(output->mxfFile, fillSize);
+        fillSize -= llen;
+        llen = mxf_get_llen(output->mxfFile, fillSize);
+        CHK_OFAIL(mxf_encode_fixed_kl(&g_KLVFill_key, llen, fillSize, fillKL));
+        fillKLSize = mxfKey_extlen + llen;
+    }
+
+    for (i = 0; i < output->numAudioTracks; i++)
+    {
+        CHK_OFAIL(verify_essence_write_state(output, 0, 0, 1));
+        CHK_OFAIL(check_and_update_audio_sequence(output, audioSize));
+
+        eeKey = WAV_BASE_ELEMENT_KEY;
+        mxf_complete_essence_element_key(&eeKey, output->numAudioTracks, MXF_BWF_FRAME_WRAPPED_EE_TYPE, i + 1);
+        CHK_OFAIL(mxf_encode_fixed_kl(&eeKey, ESS_ELEMENT_LLEN, audioSize, audioKLs[i]));
+
+        iov[iovcnt].data = audioKLs[i];
+        iov[iovcnt].size = mxfKey_extlen + ESS_ELEMENT_LLEN;
+        iovcnt++;
+        iov[iovcnt].data = audioData[i];
+        iov[iovcnt].size = audioSize;
+        iovcnt++;
+        totalSize += mxfKey_extlen + ESS_ELEMENT_LLEN + audioSize;
+        if (fillKLSize > 0)
+        {
+            iov[iovcnt].data = fillKL;
+            iov[iovcnt].size = fillKLSize;
+            iovcnt++;
+            iov[iovcnt].data = output->fillZeros;
+            iov[iovcnt].size = fillSize;
+            iovcnt++;
+            totalSize += fillKLSize + fillSize;
+        }
+
+        update_essence_write_state(output, 0, 0, 1);
+    }
+
+
+    if (mxf_file_writev(output->mxfFile, iov, iovcnt) != totalSize)
+    {
+        /* a short write has moved the file position and so the content package can't be written again */
+        mxf_log_error("Failed to write content package" LOG_LOC_FORMAT, LOG_LOC_PARAMS);
+        output->writeFailed = 1;
+        return 0;
+    }
+
+    if (!add_timecode_to_index(&output->vitcIndex, &vitc) ||
+        !add_timecode_to_index(&output->ltcIndex, &ltc))
+    {
+        mxf_log_error("Failed to add content package timecode to index" LOG_LOC_FORMAT, LOG_LOC_PARAMS);
+        output->writeFailed = 1;
+        return 0;
+    }
+
+    return 1;
+
+fail:
+    output->essWriteState = savedEssWriteState;
+    output->duration = savedDuration;
+    output->audioSequenceOffset = savedAudioSequenceOffset;
+    memcpy(output->inputAudioSequence, savedInputAudioSequence, sizeof(savedInputAudioSequence));
+    return 0;
+}
+
 int abort_archive_mxf_file(ArchiveMXFWriter **output)
 {
     free_archive_mxf_file(output);
@@ -1497,33 +1770,41 @@ int complete_archive_mxf_file(ArchiveMXFWriter **outputRef, const InfaxData *sou
     CHK_ORET(mxf_set_utf16string_item(output->materialPackageSet, &MXF_ITEM_K(GenericPackage, Name), output->tempString));
 
 
-    /* re-write the header metadata */
-
-    CHK_ORET(mxf_file_seek(output->mxfFile, output->headerMetadataFilePos, SEEK_SET));
-    CHK_ORET(mxf_mark_header_start(output->mxfFile, output->headerPartition));
-    CHK_ORET(mxf_write_header_metadata(output->mxfFile, output->headerMetadata));
-    CHK_ORET(mxf_mark_header_end(output->mxfFile, output->headerPartition));
-
+    output->indexSegment->indexDuration = output->duration;
 
-    /* re-write the header index table segment */
+    /* re-write the header metadata and index table segment. The header partition in a streamed file remains
+       open and incomplete and the complete metadata is only found in the footer partition */
 
-    CHK_ORET(mxf_mark_index_start(output->mxfFile, output->headerPartition));
+    if (!output->isStreaming)
+    {
+        CHK_ORET(mxf_file_seek(output->mxfFile, output->headerMetadataFilePos, SEEK_SET));
+        CHK_ORET(mxf_mark_header_start(output->mxfFile, output->headerPartition));
+        CHK_ORET(mxf_write_header_metadata(output->mxfFile, output->headerMetadata));
+        CHK_ORET(mxf_mark_header_end(output->mxfFile, output->headerPartition));
 
-    output->indexSegment->indexDuration = output->duration;
-    CHK_ORET(mxf_write_index_table_segment(output->mxfFile, output->indexSegment));
+        CHK_ORET(mxf_mark_index_start(output->mxfFile, output->headerPartition));
+        CHK_ORET(mxf_write_index_table_segment(output->mxfFile, output->indexSegment));
 
-    /* fill space to body position */
-    CHK_ORET((filePos = mxf_file_tell(output->mxfFile)) >= 0);
-    CHK_ORET((uint64_t)filePos < FIXED_BODY_OFFSET - 17); /* min fill is 17 */
-    CHK_ORET(mxf_fill_to_position(output->mxfFile, FIXED_BODY_OFFSET));
+        /* fill space to body position */
+        CHK_ORET((filePos = mxf_file_tell(output->mxfFile)) >= 0);
+        CHK_ORET((uint64_t)filePos < FIXED_BODY_OFFSET - 17); /* min fill is 17 */
+        CHK_ORET(mxf_fill_to_position(output->mxfFile, FIXED_BODY_OFFSET));
 
-    CHK_ORET(mxf_mark_index_end(output->mxfFile, output->headerPartition));
+        CHK_ORET(mxf_mark_index_end(output->mxfFile, output->headerPartition));
+    }
 
 
 
     /* Write the Footer Partition Pack */
 
-    CHK_ORET(mxf_file_seek(output->mxfFile, 0, SEEK_END));
+    if (output->isStreaming)
+    {
+        CHK_ORET(start_stream_partition(output));
+    }
+    else
+    {
+        CHK_ORET(mxf_file_seek(output->mxfFile, 0, SEEK_END));
+    }
     CHK_ORET(mxf_append_new_from_partition(output->partitions, output->headerPartition, &output->footerPartition));
     /* The preservation system will store the MXF file on an LTO. However, to support usage outside the
     preservation system where the file is not stored on an LTO, the partition is defined to be closed */
@@ -2007,6 +2288,13 @@ int complete_archive_mxf_file(ArchiveMXFWriter **outputRef, const InfaxData *sou
     CHK_ORET(mxf_write_index_table_segment(output->mxfFile, output->indexSegment));
     CHK_ORET(mxf_mark_index_end(output->mxfFile, output->footerPartition));
 
+    if (output->isStreaming)
+    {
+        output->footerPartition->previousPartition = output->headerPartition->thisPartition;
+        output->footerPartition->footerPartition = output->footerPartition->thisPartition;
+        CHK_ORET(end_stream_partition(output, output->footerPartition));
+    }
+
 
     /* write the random index pack */
 
@@ -2016,10 +2304,13 @@ int complete_archive_mxf_file(ArchiveMXFWriter **outputRef, const InfaxData *sou
 
     /* Update the Partition Packs and re-write them */
 
-    /* header partition is open because the LTO Infax data needs to be filled in
-       and it doesn't include the PSE failures and VTR errors */
-    output->headerPartition->key = MXF_PP_K(OpenComplete, Header);
-    CHK_ORET(mxf_update_partitions(output->mxfFile, output->partitions));
+    if (!output->isStreaming)
+    {
+        /* header partition is open because the LTO Infax data needs to be filled in
+           and it doesn't include the PSE failures and VTR errors */
+        output->headerPartition->key = MXF_PP_K(OpenComplete, Header);
+        CHK_ORET(mxf_update_partitions(output->mxfFile, output->partitions));
+    }
 
 
 
@@ -2246,6 +2537,11 @@ fail:
 
 int64_t get_archive_mxf_file_size(ArchiveMXFWriter *writer)
 {
+    if (writer->isStreaming)
+    {
+        return mxf_file_tell(writer->mxfFile);
+    }
+
     return mxf_file_size(writer->mxfFile);
 }
 
@@ -62,6 +62,14 @@ int prepare_archive_mxf_file_2(MXFFile **mxfFile, const char *filename, const mx
                                const mxfRational *aspectRatio, int numAudioTracks, uint32_t audioQuantBits,
                                int includeCRC32, int64_t startPosition, ArchiveMXFWriter **output);
 
+/* as prepare_archive_mxf_file_2, where expectedDuration is the number of frames expected to be written, used to
+   preallocate the disk space, or 0 if unknown */
+int prepare_archive_mxf_file_3(MXFFile **mxfFile, const char *filename, const mxfRational *frameRate,
+                               uint8_t signalStandard, uint8_t frameLayout, uint32_t componentDepth,
+                               const mxfRational *aspectRatio, int numAudioTracks, uint32_t audioQuantBits,
+                               int includeCRC32, int64_t startPosition, int64_t expectedDuration,
+                               ArchiveMXFWriter **output);
+
 
 /* write the essence, in order, starting with the system item, followed by video and then 0 or more audio */
 int write_system_item(ArchiveMXFWriter *output, ArchiveTimecode vitc, ArchiveTimecode ltc, const uint32_t *crc32,
@@ -69,6 +77,13 @@ int write_system_item(ArchiveMXFWriter *output, ArchiveTimecode vitc, ArchiveTim
 int write_video_frame(ArchiveMXFWriter *output, const uint8_t *data, uint32_t size);
 int write_audio_frame(ArchiveMXFWriter *output, const uint8_t *data, uint32_t size);
 
+/* write a complete content package, i.e. the system item, video frame and an audioSize frame for each audio
+   track, with a single gather-write. The writer state is unchanged if the call fails before writing. If the write
+   itself fails the writer is marked as failed, further writes fail and the file can only be aborted */
+int write_content_package(ArchiveMXFWriter *output, ArchiveTimecode vitc, ArchiveTimecode ltc,
+                          const uint32_t *crc32, int numCRC32, const uint8_t *videoData, uint32_t videoSize,
+                          const uint8_t * const *audioData, uint32_t audioSize);
+
 /* close and delete the file and free output */
 int abort_archive_mxf_file(ArchiveMXFWriter **output);
 
@@ -75,6 +75,7 @@ typedef struct
 typedef struct
 {
     mxfPosition currentPosition;
+    mxfPosition partitionStartPosition; /* position of the first frame in the current partition */
 
     mxfKey startContentPackageKey;
     uint64_t contentPackageLen;
@@ -229,6 +230,7 @@ static int ns_position_at_first_frame(MXFReader *reader)
     {
         CHK_ORET(mxf_equals_key(&nsIndex->startContentPackageKey, &key));
     }
+    nsIndex->partitionStartPosition = nsIndex->currentPosition;
     ns_set_next_kl(nsIndex, &key, llen, len);
 
     if (partition != NULL && partition != data->headerPartition)
@@ -862,13 +864,62 @@ static int ns_read_content_package(MXFReader *reader, int skip, MXFReaderListene
     return 1;
 }
 
+/* seek back to an earlier frame in the current partition. This only succeeds if the file supports seeking back
+   within a window, e.g. a ring file, and the content packages have a constant size */
+static int ns_position_back(MXFReader *reader, int64_t frameNumber)
+{
+    MXFFile *mxfFile = reader->mxfFile;
+    EssenceReaderData *data = reader->essenceReader->data;
+    NSFileIndex *nsIndex = &data->nsIndex;
+    int64_t originalPos;
+    int64_t filePos;
+    mxfKey key;
+    uint8_t llen;
+    uint64_t len;
+
+    if (frameNumber < nsIndex->partitionStartPosition ||
+        nsIndex->contentPackageLen == 0 ||
+        !mxf_equals_key(&nsIndex->nextKey, &nsIndex->startContentPackageKey))
+    {
+        return 0;
+    }
+
+    /* the file is positioned after the KL of the current content package */
+    CHK_ORET((originalPos = mxf_file_tell(mxfFile)) >= 0);
+    filePos = originalPos - mxfKey_extlen - nsIndex->nextLLen;
+    filePos -= (nsIndex->currentPosition - frameNumber) * (int64_t)nsIndex->contentPackageLen;
+
+    if (!mxf_file_seek(mxfFile, filePos, SEEK_SET))
+    {
+        return 0;
+    }
+    CHK_OFAIL(mxf_read_kl(mxfFile, &key, &llen, &len));
+    CHK_OFAIL(mxf_equals_key(&key, &nsIndex->startContentPackageKey));
+    ns_set_next_kl(nsIndex, &key, llen, len);
+    nsIndex->currentPosition = frameNumber;
+
+    return 1;
+
+fail:
+    /* restore the position that the non-seekable index state refers to */
+    if (!mxf_file_seek(mxfFile, originalPos, SEEK_SET))
+    {
+        mxf_log_error("Failed to restore file position after failing to seek back" LOG_LOC_FORMAT, LOG_LOC_PARAMS);
+    }
+    return 0;
+}
+
 static int op1a_position_at_frame(MXFReader *reader, int64_t frameNumber)
 {
     MXFFile *mxfFile = reader->mxfFile;
     EssenceReader *essenceReader = reader->essenceReader;
     EssenceReaderData *data = essenceReader->data;
 
-    CHK_ORET(mxf_file_is_seekable(mxfFile));
+    if (!mxf_file_is_seekable(mxfFile))
+    {
+        return ns_position_back(reader, frameNumber);
+    }
+
     CHK_ORET(set_position(mxfFile, data->index, frameNumber));
 
     return 1;
@@ -1119,6 +1170,7 @@ int op1a_initialise_reader(MXFReader *reader, MXFPartition **headerPartition)
     {
         /* get the file partitions */
         CHK_OFAIL(get_file_partitions(mxfFile, data->headerPartition, &data->partitions));
+        open_step_completed(reader, "partitions");
 
 
         /* process the last instance of header metadata */
@@ -1143,6 +1195,7 @@ int op1a_initialise_reader(MXFReader *reader, MXFPartition **headerPartition)
                 CHK_OFAIL(mxf_skip(mxfFile, len));
 
                 CHK_OFAIL(process_metadata(reader, partition));
+                open_step_completed(reader, "header metadata");
                 if (mxf_is_footer_partition_pack(&partition->key))
                 {
                     data->haveFooterMetadata = 1;
@@ -1165,6 +1218,7 @@ int op1a_initialise_reader(MXFReader *reader, MXFPartition **headerPartition)
 
             /* position at start of essence */
             CHK_OFAIL(set_position(mxfFile, data->index, 0));
+            open_step_completed(reader, "index");
         }
     }
     else
@@ -1181,12 +1235,14 @@ int op1a_initialise_reader(MXFReader *reader, MXFPartition **headerPartition)
             mxf_log_warn("Header partition is incomplete" LOG_LOC_FORMAT, LOG_LOC_PARAMS);
         }
         CHK_OFAIL(process_metadata(reader, data->headerPartition));
+        open_step_completed(reader, "header metadata");
 
 
         if (!reader->isMetadataOnly)
         {
             /* position at start of essence */
             CHK_OFAIL(ns_position_at_first_frame(reader));
+            open_step_completed(reader, "first frame");
         }
     }
 
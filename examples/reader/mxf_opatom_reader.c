@@ -910,6 +910,7 @@ int opa_initialise_reader(MXFReader *reader, MXFPartition **headerPartition)
     CHK_OFAIL(process_metadata(reader, data->headerPartition));
     CHK_OFAIL(get_num_essence_tracks(essenceReader) == 1);
     essenceTrack = get_essence_track(essenceReader, 0);
+    open_step_completed(reader, "header metadata");
 
 
     /* read the index table for Avid MJPEG files */
@@ -934,6 +935,7 @@ int opa_initialise_reader(MXFReader *reader, MXFPartition **headerPartition)
         CHK_OFAIL(read_avid_imx_frame_size(reader, &essenceTrack->frameSize));
         CHK_OFAIL(mxf_file_seek(mxfFile, filePos, SEEK_SET));
     }
+    open_step_completed(reader, "index");
 
 
     /* move to start of essence container in the body partition */
@@ -953,6 +955,7 @@ int opa_initialise_reader(MXFReader *reader, MXFPartition **headerPartition)
     CHK_OFAIL((filePos = mxf_file_tell(mxfFile)) >= 0);
     data->essenceStartPos = filePos + essenceTrack->avidFirstFrameOffset;
     data->currentPosition = 0;
+    open_step_completed(reader, "first frame");
 
 
     *headerPartition = NULL; /* take ownership */
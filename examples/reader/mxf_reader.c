@@ -49,6 +49,13 @@
 #include <mxf/mxf_macros.h>
 
 
+/* read-ahead window used for parsing KLVs; essence reads larger than this go directly to the file */
+#define READ_AHEAD_SIZE     (64 * 1024)
+
+/* number of frames read in sequence after a seek before the file is hinted to read ahead again */
+#define SEQUENTIAL_READ_COUNT   8
+
+
 typedef struct
 {
     uint32_t first;
@@ -566,6 +573,12 @@ fail:
 }
 
 int init_mxf_reader_2(MXFFile **mxfFile, MXFDataModel *dataModel, MXFReader **reader)
+{
+    return init_mxf_reader_3(mxfFile, dataModel, NULL, reader);
+}
+
+int init_mxf_reader_3(MXFFile **mxfFile, MXFDataModel *dataModel, MXFReaderOpenListener *openListener,
+                      MXFReader **reader)
 {
     mxfKey key;
     uint8_t llen;
@@ -583,6 +596,10 @@ int init_mxf_reader_2(MXFFile **mxfFile, MXFDataModel *dataModel, MXFReader **re
     newReader->clip.duration = -1;
     newReader->clip.minDuration = -1;
     newReader->dataModel = dataModel;
+    newReader->openListener = openListener;
+
+    CHK_OFAIL(mxf_file_set_read_ahead(newReader->mxfFile, READ_AHEAD_SIZE));
+    mxf_file_advise(newReader->mxfFile, 0, 0, MXF_ADVISE_SEQUENTIAL);
 
 
     /* read header partition pack */
@@ -593,6 +610,7 @@ int init_mxf_reader_2(MXFFile **mxfFile, MXFDataModel *dataModel, MXFReader **re
         goto fail;
     }
     CHK_OFAIL(mxf_read_partition(newReader->mxfFile, &key, &headerPartition));
+    open_step_completed(newReader, "header partition");
 
 
     /* create the essence reader */
@@ -621,6 +639,8 @@ int init_mxf_reader_2(MXFFile **mxfFile, MXFDataModel *dataModel, MXFReader **re
 
     CHK_OFAIL(create_tracks_string(newReader));
 
+    newReader->openListener = NULL;
+
 
     *mxfFile = NULL; /* take ownership */
     *reader = newReader;
@@ -814,8 +834,8 @@ int position_at_frame(MXFReader *reader, int64_t frameNumber)
     {
         if (frameNumber < (get_frame_number(reader) + 1))
         {
-            /* can't skip backwards */
-            return 0;
+            /* skipping backwards is only possible if the file keeps a window of previously read data */
+            return reader->essenceReader->position_at_frame(reader, frameNumber);
         }
 
         /* simulate seeking by skipping individual frames */
@@ -831,6 +851,14 @@ int position_at_frame(MXFReader *reader, int64_t frameNumber)
     }
     else
     {
+        /* seeking by index, e.g. when scrubbing, makes kernel read-ahead a waste of I/O */
+        if (!reader->randomAccess)
+        {
+            mxf_file_advise(reader->mxfFile, 0, 0, MXF_ADVISE_RANDOM);
+            reader->randomAccess = 1;
+        }
+        reader->sequentialReadCount = 0;
+
         if ((result = reader->essenceReader->position_at_frame(reader, frameNumber)))
         {
             /* update minDuration if frame is beyond the last known frame when the duration is unknown */
@@ -928,6 +956,13 @@ int read_next_frame(MXFReader *reader, MXFReaderListener *listener)
     {
         /* flag that at least one frame has been read and therefore that source timecodes are present */
         reader->haveReadAFrame = 1;
+
+        /* back to streaming playback after a seek */
+        if (reader->randomAccess && ++reader->sequentialReadCount >= SEQUENTIAL_READ_COUNT)
+        {
+            mxf_file_advise(reader->mxfFile, 0, 0, MXF_ADVISE_SEQUENTIAL);
+            reader->randomAccess = 0;
+        }
     }
     return result;
 }
@@ -1695,6 +1730,14 @@ fail:
     return 0;
 }
 
+void open_step_completed(MXFReader *reader, const char *step)
+{
+    if (reader->openListener != NULL && reader->openListener->step_completed != NULL)
+    {
+        reader->openListener->step_completed(reader->openListener, step);
+    }
+}
+
 int allocate_archive_crc32(MXFReader *reader, uint32_t num)
 {
     if (reader->numArchiveCRC32Alloc < num)
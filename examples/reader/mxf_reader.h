@@ -76,6 +76,14 @@ typedef struct _MXFReaderListener
     MXFReaderListenerData *data;
 } MXFReaderListener;
 
+/* optional listener that is called after each step of opening a file, e.g. to measure the file I/O per step */
+typedef struct _MXFReaderOpenListener
+{
+    void (*step_completed)(struct _MXFReaderOpenListener *listener, const char *step);
+
+    void *data;
+} MXFReaderOpenListener;
+
 typedef struct
 {
     mxfRational frameRate;
@@ -141,6 +149,8 @@ int open_mxf_reader(const char *filename, MXFReader **reader);
 int open_mxf_reader_2(const char *filename, MXFDataModel *dataModel, MXFReader **reader);
 int init_mxf_reader(MXFFile **mxfFile, MXFReader **reader);
 int init_mxf_reader_2(MXFFile **mxfFile, MXFDataModel *dataModel, MXFReader **reader);
+int init_mxf_reader_3(MXFFile **mxfFile, MXFDataModel *dataModel, MXFReaderOpenListener *openListener,
+                      MXFReader **reader);
 void close_mxf_reader(MXFReader **reader);
 
 int is_metadata_only(MXFReader *reader);
@@ -125,9 +125,15 @@ struct _MXFReader
 
     EssenceReader *essenceReader;
 
+    /* access pattern hinted to the file; reading switches back to sequential after a number of frames */
+    int randomAccess;
+    int sequentialReadCount;
+
     MXFDataModel *dataModel;
     int ownDataModel;  /* the reader will free it when closed */
 
+    MXFReaderOpenListener *openListener; /* only set whilst opening */
+
     /* buffer for internal use */
     uint8_t *buffer;
     uint32_t bufferSize;
@@ -157,6 +163,8 @@ int initialise_source_timecodes(MXFReader *reader, MXFMetadataSet *sourcePackage
 int set_essence_container_timecode(MXFReader *reader, mxfPosition position,
     int type, int count, int isDropFrame, uint8_t hour, uint8_t min, uint8_t sec, uint8_t frame);
 
+void open_step_completed(MXFReader *reader, const char *step);
+
 int allocate_archive_crc32(MXFReader *reader, uint32_t num);
 int set_archive_crc32(MXFReader *reader, uint32_t index, uint32_t crc32);
 
@@ -41,6 +41,9 @@
 #include <assert.h>
 
 #include "mxf_reader.h"
+#include <mxf/mxf_stats_file.h>
+#include <mxf/mxf_ring_file.h>
+#include <mxf/mxf_cache_file.h>
 #include <mxf/mxf_macros.h>
 
 
@@ -164,9 +167,94 @@ static int receive_frame(MXFReaderListener *listener, int trackIndex, uint8_t *b
     return 1;
 }
 
+static void log_open_step_stats(MXFReaderOpenListener *listener, const char *step)
+{
+    MXFStatsFile *statsFile = (MXFStatsFile*)listener->data;
+
+    mxf_stats_file_log(statsFile, step);
+    mxf_stats_file_reset(statsFile);
+}
+
+static int open_stats_reader(const char *mxfFilename, MXFDataModel **dataModel, MXFStatsFile **statsFile,
+                             MXFReader **input)
+{
+    MXFReaderOpenListener openListener;
+    MXFFile *diskFile = NULL;
+    MXFFile *mxfFile = NULL;
+
+    if (!mxf_load_data_model(dataModel) ||
+        !mxf_finalise_data_model(*dataModel))
+    {
+        fprintf(stderr, "Failed to load data model\n");
+        mxf_free_data_model(dataModel);
+        return 0;
+    }
+
+    if (!mxf_disk_file_open_read(mxfFilename, &diskFile))
+    {
+        fprintf(stderr, "Failed to open '%s'\n", mxfFilename);
+        mxf_free_data_model(dataModel);
+        return 0;
+    }
+    if (!mxf_stats_file_open(diskFile, statsFile))
+    {
+        fprintf(stderr, "Failed to open statistics file\n");
+        mxf_file_close(&diskFile);
+        mxf_free_data_model(dataModel);
+        return 0;
+    }
+    mxfFile = mxf_stats_file_get_file(*statsFile);
+
+    openListener.step_completed = log_open_step_stats;
+    openListener.data = *statsFile;
+    if (!init_mxf_reader_3(&mxfFile, *dataModel, &openListener, input))
+    {
+        mxf_file_close(&mxfFile);
+        mxf_free_data_model(dataModel);
+        return 0;
+    }
+
+    return 1;
+}
+
+static int open_prefetch_reader(const char *mxfFilename, uint32_t readAheadSize, MXFReader **input)
+{
+    MXFFile *diskFile = NULL;
+    MXFCacheFile *cacheFile = NULL;
+    MXFFile *mxfFile = NULL;
+
+    if (!mxf_disk_file_open_read(mxfFilename, &diskFile))
+    {
+        fprintf(stderr, "Failed to open '%s'\n", mxfFilename);
+        return 0;
+    }
+    if (!mxf_cache_file_open_2(diskFile, 256 * 1024, 2 * readAheadSize, 0, &cacheFile))
+    {
+        fprintf(stderr, "Failed to open cache file\n");
+        mxf_file_close(&diskFile);
+        return 0;
+    }
+    mxfFile = mxf_cache_file_get_file(cacheFile);
+    if (!mxf_cache_file_start_prefetcher(cacheFile, readAheadSize))
+    {
+        fprintf(stderr, "Failed to start cache file prefetcher\n");
+        mxf_file_close(&mxfFile);
+        return 0;
+    }
+
+    if (!init_mxf_reader(&mxfFile, input))
+    {
+        mxf_file_close(&mxfFile);
+        return 0;
+    }
+
+    return 1;
+}
+
 #if defined(DO_TEST1)
 
-static int test1(const char *mxfFilename, MXFTimecode *startTimecode, int sourceTimecodeCount, const char *outFilename)
+static int test1(const char *mxfFilename, MXFTimecode *startTimecode, int sourceTimecodeCount, int logStats,
+                 uint32_t stdinWindowSize, uint32_t readAheadSize, const char *outFilename)
 {
     MXFReader *input;
     MXFClip *clip;
@@ -182,6 +270,8 @@ static int test1(const char *mxfFilename, MXFTimecode *startTimecode, int source
     int count;
     int result;
     uint32_t archiveCRC32;
+    MXFDataModel *dataModel = NULL;
+    MXFStatsFile *statsFile = NULL;
 
     memset(&data, 0, sizeof(MXFReaderListenerData));
     listener.data = &data;
@@ -190,7 +280,23 @@ static int test1(const char *mxfFilename, MXFTimecode *startTimecode, int source
     listener.deallocate_buffer = deallocate_buffer;
     listener.receive_frame = receive_frame;
 
-    if (strcmp("-", mxfFilename) != 0)
+    if (logStats && strcmp("-", mxfFilename) != 0)
+    {
+        if (!open_stats_reader(mxfFilename, &dataModel, &statsFile, &input))
+        {
+            fprintf(stderr, "Failed to open MXF reader\n");
+            return 0;
+        }
+    }
+    else if (readAheadSize > 0 && strcmp("-", mxfFilename) != 0)
+    {
+        if (!open_prefetch_reader(mxfFilename, readAheadSize, &input))
+        {
+            fprintf(stderr, "Failed to open MXF reader\n");
+            return 0;
+        }
+    }
+    else if (strcmp("-", mxfFilename) != 0)
     {
         if (!open_mxf_reader(mxfFilename, &input))
         {
@@ -200,7 +306,15 @@ static int test1(const char *mxfFilename, MXFTimecode *startTimecode, int source
     }
     else
     {
-        if (!mxf_stdin_wrap_read(&stdinMXFFile))
+        if (stdinWindowSize > 0)
+        {
+            if (!mxf_ring_file_open_stdin(stdinWindowSize, &stdinMXFFile))
+            {
+                fprintf(stderr, "Failed to open standard input ring file\n");
+                return 0;
+            }
+        }
+        else if (!mxf_stdin_wrap_read(&stdinMXFFile))
         {
             fprintf(stderr, "Failed to open standard input MXF file\n");
             return 0;
@@ -288,7 +402,15 @@ static int test1(const char *mxfFilename, MXFTimecode *startTimecode, int source
         return 0;
     }
 
+    if (statsFile != NULL)
+    {
+        mxf_stats_file_log(statsFile, "read frames");
+    }
     close_mxf_reader(&input);
+    if (dataModel != NULL)
+    {
+        mxf_free_data_model(&dataModel);
+    }
     fclose(data.outFile);
     if (data.buffer != NULL)
     {
@@ -595,7 +717,7 @@ static int test3(const char *mxfFilename, const char *outFilename)
 
 static void usage(const char *cmd)
 {
-    fprintf(stderr, "Usage: %s [-sp startTimecode (-sc sourceTimecodeCount)] (<mxf filename> | -) <output filename>\n", cmd);
+    fprintf(stderr, "Usage: %s [-sp startTimecode (-sc sourceTimecodeCount)] [-stats] [-w windowMB] [-r readAheadMB] (<mxf filename> | -) <output filename>\n", cmd);
 }
 
 
@@ -606,6 +728,9 @@ int main(int argc, const char *argv[])
     int cmdlIndex;
     MXFTimecode startTimecode;
     int sourceTimecodeCount = -1;
+    int logStats = 0;
+    uint32_t stdinWindowSize = 0;
+    uint32_t readAheadSize = 0;
 
     startTimecode.hour = INVALID_TIMECODE_HOUR;
 
@@ -650,6 +775,51 @@ int main(int argc, const char *argv[])
             }
             cmdlIndex += 2;
         }
+        else if (!strcmp(argv[cmdlIndex], "-w"))
+        {
+            unsigned int windowMB;
+            if (cmdlIndex >= argc-1)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing -w argument\n");
+                return 1;
+            }
+            if (sscanf(argv[cmdlIndex + 1], "%u", &windowMB) < 1 || windowMB == 0 || windowMB > 2048)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Invalid standard input window size\n");
+                return 1;
+            }
+            stdinWindowSize = windowMB * 1024 * 1024;
+            cmdlIndex += 2;
+        }
+        else if (!strcmp(argv[cmdlIndex], "-r"))
+        {
+            unsigned int readAheadMB;
+            if (cmdlIndex >= argc-1)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing -r argument\n");
+                return 1;
+            }
+            if (sscanf(argv[cmdlIndex + 1], "%u", &readAheadMB) < 1 || readAheadMB == 0 || readAheadMB > 1024)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Invalid read-ahead size\n");
+                return 1;
+            }
+            readAheadSize = readAheadMB * 1024 * 1024;
+            cmdlIndex += 2;
+        }
+        else if (!strcmp(argv[cmdlIndex], "-stats"))
+        {
+            logStats = 1;
+            cmdlIndex++;
+        }
+        else
+        {
+            break;
+        }
     }
 
     if (argc - cmdlIndex != 2)
@@ -663,7 +833,8 @@ int main(int argc, const char *argv[])
 
 #if defined(DO_TEST1)
     printf("TEST 1\n");
-    if (!test1(mxfFilename, &startTimecode, sourceTimecodeCount, outFilename))
+    if (!test1(mxfFilename, &startTimecode, sourceTimecodeCount, logStats, stdinWindowSize, readAheadSize,
+               outFilename))
     {
         return 1;
     }
@@ -88,6 +88,7 @@ static const uint64_t g_p2_fixedBodyPPOffset = 32620;
 
 /* buffer size must be >= max frame size */
 #define ESSENCE_BUFFER_SIZE     288000
+#define ESSENCE_COPY_SIZE       (64 * 1024 * 1024)
 
 
 /* invalid because the registry version, byte8, is 0x01 rather than 0x02, and
@@ -691,6 +692,7 @@ static int transfer_to_p2(AvidMXFToP2Transfer *transfer, int inputFileIndex, int
     int i;
     float percentCompletedStart = transfer->percentCompleted;
     uint64_t totalBytesRead;
+    uint64_t numCopied;
     uint8_t *arrayElement;
 
     AvidMXFFile *input = &transfer->inputs[inputFileIndex];
@@ -991,39 +993,68 @@ static int transfer_to_p2(AvidMXFToP2Transfer *transfer, int inputFileIndex, int
         &output->essenceElement));
     frameCount = 0;
     totalBytesRead = 0;
-    while (1)
+    if (!output->isPicture || transfer->insertTimecode == NULL)
     {
-        CHK_ORET(mxf_read_essence_element_data(input->mxfFile, input->essenceElement, essenceReadSize,
-            buffer, &numRead));
-
-        /* insert timecode into DV essence */
-        if (output->isPicture && transfer->insertTimecode != NULL &&
-            numRead == essenceReadSize)
+        /* the essence is not modified and can be copied file to file without passing through the buffer */
+        while (1)
         {
-            transfer->insertTimecode(buffer, essenceReadSize,
-                frameCount + transfer->timecodeStart, transfer->dropFrameFlag);
-            frameCount++;
-        }
+            CHK_ORET(mxf_copy_essence_element_data(input->mxfFile, input->essenceElement,
+                output->mxfFile, output->essenceElement, ESSENCE_COPY_SIZE, &numCopied));
 
-        if (output->isPicture && numRead > 0 && numRead != essenceReadSize)
-        {
-            mxf_log_warn("Last essence data frame is wrong size %u\n", numRead);
+            /* report progress */
+            totalBytesRead += numCopied;
+            transfer->percentCompleted = percentCompletedStart +
+                output->percentCompletedContribution * (float)((double)totalBytesRead / output->essenceBytesLength);
+            CALL_PROGRESS();
+
+            if (numCopied < ESSENCE_COPY_SIZE)
+            {
+                break;
+            }
         }
 
-        if (numRead > 0)
+        if (output->isPicture && (totalBytesRead % essenceReadSize) != 0)
         {
-            CHK_ORET(mxf_write_essence_element_data(output->mxfFile, output->essenceElement, buffer, numRead));
+            mxf_log_warn("Last essence data frame is wrong size %u\n",
+                (uint32_t)(totalBytesRead % essenceReadSize));
         }
+    }
+    else
+    {
+        while (1)
+        {
+            CHK_ORET(mxf_read_essence_element_data(input->mxfFile, input->essenceElement, essenceReadSize,
+                buffer, &numRead));
 
-        /* report progress */
-        totalBytesRead += numRead;
-        transfer->percentCompleted = percentCompletedStart +
-            output->percentCompletedContribution * (float)((double)totalBytesRead / output->essenceBytesLength);
-        CALL_PROGRESS();
+            /* insert timecode into DV essence */
+            if (output->isPicture && transfer->insertTimecode != NULL &&
+                numRead == essenceReadSize)
+            {
+                transfer->insertTimecode(buffer, essenceReadSize,
+                    frameCount + transfer->timecodeStart, transfer->dropFrameFlag);
+                frameCount++;
+            }
 
-        if (numRead < essenceReadSize)
-        {
-            break;
+            if (output->isPicture && numRead > 0 && numRead != essenceReadSize)
+            {
+                mxf_log_warn("Last essence data frame is wrong size %u\n", numRead);
+            }
+
+            if (numRead > 0)
+            {
+                CHK_ORET(mxf_write_essence_element_data(output->mxfFile, output->essenceElement, buffer, numRead));
+            }
+
+            /* report progress */
+            totalBytesRead += numRead;
+            transfer->percentCompleted = percentCompletedStart +
+                output->percentCompletedContribution * (float)((double)totalBytesRead / output->essenceBytesLength);
+            CALL_PROGRESS();
+
+            if (numRead < essenceReadSize)
+            {
+                break;
+            }
         }
     }
     CHK_ORET(mxf_finalize_essence_element_write(output->mxfFile, output->essenceElement));
@@ -955,6 +955,7 @@ static void usage(const char *cmd)
     fprintf(stderr, "                             Default is the DV file frame rate, 50 for progressive video, otherwise 25\n");
     fprintf(stderr, "  --legacy                   use legacy DataDefs, for DV essence use legacy descriptor properties\n");
     fprintf(stderr, "  --legacy-umid              use the legacy UMID generation method (e.g. for Pro Tools v5.3.1)\n");
+    fprintf(stderr, "  --direct-io                write the files using direct I/O, bypassing the page cache\n");
     fprintf(stderr, "  --aspect <ratio>           video aspect ratio x:y. Default is DV file aspect ratio or 4:3\n");
     fprintf(stderr, "  --comment <string>         add 'Comments' user comment to the MaterialPackage\n");
     fprintf(stderr, "  --desc <string>            add 'Descript' user comment to the MaterialPackage\n");
@@ -1038,6 +1039,7 @@ int main(int argc, const char *argv[])
     int done = 0;
     int useLegacy = 0;
     int useLegacyUMID = 0;
+    int directIO = 0;
     uint32_t numRead;
     uint16_t numAudioChannels;
     int haveImage;
@@ -1164,6 +1166,11 @@ int main(int argc, const char *argv[])
             useLegacyUMID = 1;
             cmdlnIndex++;
         }
+        else if (strcmp(argv[cmdlnIndex], "--direct-io") == 0)
+        {
+            directIO = 1;
+            cmdlnIndex++;
+        }
         else if (strcmp(argv[cmdlnIndex], "--aspect") == 0)
         {
             int result;
@@ -2532,8 +2539,8 @@ int main(int argc, const char *argv[])
 
     /* create the clip writer */
 
-    if (!create_clip_writer(projectName, isPAL ? PAL_25i : NTSC_30i, videoSampleRate, 0, useLegacy, packageDefinitions,
-                            &clipWriter))
+    if (!create_clip_writer_2(projectName, isPAL ? PAL_25i : NTSC_30i, videoSampleRate, 0, useLegacy, directIO,
+                              packageDefinitions, &clipWriter))
     {
         fprintf(stderr, "Failed to create Avid MXF clip writer\n");
         goto fail;
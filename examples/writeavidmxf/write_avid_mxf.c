@@ -204,6 +204,7 @@ struct _AvidClipWriter
     ProjectFormat projectFormat;
     int dropFrameFlag;
     int useLegacy;
+    int directIO;
     mxfRational projectEditRate;
 
     mxfTimestamp now;
@@ -2226,7 +2227,14 @@ static int create_track_writer(AvidClipWriter *clipWriter, PackageDefinitions *p
     /* open the file */
 
     CHK_OFAIL(mxf_create_file_partitions(&newTrackWriter->partitions));
-    CHK_OFAIL(mxf_disk_file_open_new(newTrackWriter->filename, &newTrackWriter->mxfFile));
+    if (clipWriter->directIO)
+    {
+        CHK_OFAIL(mxf_disk_file_open_new_direct(newTrackWriter->filename, 0, &newTrackWriter->mxfFile));
+    }
+    else
+    {
+        CHK_OFAIL(mxf_disk_file_open_new(newTrackWriter->filename, &newTrackWriter->mxfFile));
+    }
 
 
     /* set the minimum llen - Avid uses llen=9 everywhere */
@@ -2309,6 +2317,14 @@ fail:
 int create_clip_writer(const char *projectName, ProjectFormat projectFormat, mxfRational projectEditRate,
                        int dropFrameFlag, int useLegacy, PackageDefinitions *packageDefinitions,
                        AvidClipWriter **clipWriter)
+{
+    return create_clip_writer_2(projectName, projectFormat, projectEditRate, dropFrameFlag, useLegacy, 0,
+                                packageDefinitions, clipWriter);
+}
+
+int create_clip_writer_2(const char *projectName, ProjectFormat projectFormat, mxfRational projectEditRate,
+                         int dropFrameFlag, int useLegacy, int directIO, PackageDefinitions *packageDefinitions,
+                         AvidClipWriter **clipWriter)
 {
     AvidClipWriter *newClipWriter = NULL;
     MXFListIterator iter;
@@ -2328,6 +2344,7 @@ int create_clip_writer(const char *projectName, ProjectFormat projectFormat, mxf
     newClipWriter->projectFormat = projectFormat;
     newClipWriter->dropFrameFlag = dropFrameFlag;
     newClipWriter->useLegacy = useLegacy;
+    newClipWriter->directIO = directIO;
 
     newClipWriter->projectEditRate.numerator = projectEditRate.numerator;
     newClipWriter->projectEditRate.denominator = projectEditRate.denominator;
@@ -58,6 +58,11 @@ int create_clip_writer(const char *projectName, ProjectFormat projectFormat, mxf
                        int dropFrameFlag, int useLegacy, PackageDefinitions *packageDefinitions,
                        AvidClipWriter **clipWriter);
 
+/* as create_clip_writer, with the option to write the files using direct I/O that bypasses the page cache */
+int create_clip_writer_2(const char *projectName, ProjectFormat projectFormat, mxfRational projectEditRate,
+                         int dropFrameFlag, int useLegacy, int directIO, PackageDefinitions *packageDefinitions,
+                         AvidClipWriter **clipWriter);
+
 
 /* write essence samples
     the number of samples is a multiple of the file package track edit rate
@@ -38,19 +38,73 @@
 #include <string.h>
 #include <stdio.h>
 
+#if defined(HAVE_PTHREAD)
+#include <pthread.h>
+#endif
+
 #include <mxf/mxf.h>
 #include <mxf/mxf_cache_file.h>
 #include <mxf/mxf_macros.h>
 
 
 
+/* no page index, used to terminate hash chains and LRU lists */
+#define NO_PAGE     UINT32_MAX
+
+/* maximum size of the batch of pages copied and written by the background flusher */
+#define MAX_FLUSH_BATCH_SIZE    (4 * 1024 * 1024)
+
+/* number of consecutive sequential reads before the prefetcher starts reading ahead */
+#define MIN_SEQUENTIAL_READS    2
+
+
 typedef struct
 {
     int64_t position;
     uint32_t size;
     int isDirty;
+
+    /* associative cache links */
+    uint32_t hashNext;
+    uint32_t lruPrev;
+    uint32_t lruNext;
 } Page;
 
+#if defined(HAVE_PTHREAD)
+/* background thread that flushes dirty pages and/or prefetches pages ahead of sequential reads */
+typedef struct
+{
+    pthread_t thread;
+    /* cacheLock is recursive and protects all cache state. targetLock serializes access to the target and is
+       always taken after cacheLock */
+    pthread_mutex_t cacheLock;
+    pthread_mutex_t targetLock;
+    pthread_cond_t wakeup;
+
+    /* flusher, enabled if highWatermark > 0 */
+    uint32_t highWatermark;
+    uint32_t lowWatermark;
+    int error;
+
+    /* the batch of dirty pages being written, copied out of the cache so that the cache pages can be reused */
+    unsigned char *batchData;
+    int64_t *batchPositions;
+    uint32_t *batchSizes;
+    uint32_t maxBatchPages;
+
+    /* prefetcher, enabled if prefetchPages > 0. Pages in the range [prefetchPosition, prefetchEnd) are read into
+       prefetchData and then copied into the cache if they are still missing */
+    uint32_t prefetchPages;
+    int64_t prefetchPosition;
+    int64_t prefetchEnd;
+    int64_t prefetchFileEnd;
+    uint32_t prefetchWriteCount;
+    unsigned char *prefetchData;
+
+    int stop;
+} Worker;
+#endif
+
 struct MXFCacheFile
 {
     MXFFile *mxfFile;
@@ -71,10 +125,106 @@ struct MXFFileSysData
     uint32_t dirtyCount;
     int eof;
     int writingAtEOF;
+
+    /* associative cache: a page is cached in one of the numWays slots of set (page number % numSets). Pages are
+       found using a hash table and replaced in least recently used order within the set */
+    uint32_t numWays;
+    uint32_t numSets;
+    uint32_t *hashBuckets;
+    uint32_t hashMask;
+    uint32_t *lruHead;
+    uint32_t *lruTail;
+    int64_t writeEnd;
+
+    /* sequential read detection and write count used to discard stale prefetched pages */
+    int64_t lastReadEnd;
+    uint32_t sequentialReads;
+    uint32_t writeCount;
+
+#if defined(HAVE_PTHREAD)
+    Worker *worker;
+#endif
 };
 
 
 
+#if defined(HAVE_PTHREAD)
+static void lock_cache(MXFFileSysData *sysData)
+{
+    if (sysData->worker)
+        pthread_mutex_lock(&sysData->worker->cacheLock);
+}
+
+static void unlock_cache(MXFFileSysData *sysData)
+{
+    if (sysData->worker)
+        pthread_mutex_unlock(&sysData->worker->cacheLock);
+}
+
+static void lock_target(MXFFileSysData *sysData)
+{
+    if (sysData->worker)
+        pthread_mutex_lock(&sysData->worker->targetLock);
+}
+
+static void unlock_target(MXFFileSysData *sysData)
+{
+    if (sysData->worker)
+        pthread_mutex_unlock(&sysData->worker->targetLock);
+}
+#else
+static void lock_cache(MXFFileSysData *sysData)    { (void)sysData; }
+static void unlock_cache(MXFFileSysData *sysData)  { (void)sysData; }
+static void lock_target(MXFFileSysData *sysData)   { (void)sysData; }
+static void unlock_target(MXFFileSysData *sysData) { (void)sysData; }
+#endif
+
+static int seek_target(MXFFileSysData *sysData, int64_t position)
+{
+    int result;
+
+    lock_target(sysData);
+    result = mxf_file_seek(sysData->target, position, SEEK_SET);
+    unlock_target(sysData);
+
+    return result;
+}
+
+static int write_target(MXFFileSysData *sysData, int64_t position, const unsigned char *data, uint32_t size)
+{
+    int result;
+
+    lock_target(sysData);
+    result = mxf_file_seek(sysData->target, position, SEEK_SET) &&
+             mxf_file_write(sysData->target, data, size) == size;
+    unlock_target(sysData);
+
+    return result;
+}
+
+static uint32_t read_target(MXFFileSysData *sysData, int64_t position, unsigned char *data, uint32_t size)
+{
+    uint32_t numRead = 0;
+
+    lock_target(sysData);
+    if (mxf_file_seek(sysData->target, position, SEEK_SET))
+        numRead = mxf_file_read(sysData->target, data, size);
+    unlock_target(sysData);
+
+    return numRead;
+}
+
+static int64_t target_size(MXFFileSysData *sysData)
+{
+    int64_t size;
+
+    lock_target(sysData);
+    size = mxf_file_size(sysData->target);
+    unlock_target(sysData);
+
+    return size;
+}
+
 static void get_current_page_info(MXFFileSysData *sysData, int64_t *pagePosition, uint32_t *pageIndex,
                                   uint32_t *pageOffset)
 {
@@ -132,9 +282,8 @@ static int flush_dirty_pages(MXFFileSysData *sysData, uint32_t pageIndex, uint32
             numWrite = (numCleanPages - 1) * sysData->pageSize +
                         sysData->pages[cleanIndex + numCleanPages - 1].size;
 
-            CHK_ORET(mxf_file_seek(sysData->target, sysData->pages[cleanIndex].position, SEEK_SET));
-            CHK_ORET(mxf_file_write(sysData->target, &sysData->cacheData[cleanIndex * sysData->pageSize], numWrite) ==
-                        numWrite);
+            CHK_ORET(write_target(sysData, sysData->pages[cleanIndex].position,
+                                  &sysData->cacheData[cleanIndex * sysData->pageSize], numWrite));
 
             for (i = 0 ; i < numCleanPages; i++)
                 sysData->pages[cleanIndex + i].isDirty = 0;
@@ -151,18 +300,587 @@ static int flush_dirty_pages(MXFFileSysData *sysData, uint32_t pageIndex, uint32
     return 1;
 }
 
+static uint32_t assoc_hash(MXFFileSysData *sysData, int64_t pageNumber)
+{
+    return (uint32_t)(((uint64_t)pageNumber * 0x9e3779b97f4a7c15ULL) >> 32) & sysData->hashMask;
+}
+
+static uint32_t assoc_find_page(MXFFileSysData *sysData, int64_t pagePosition)
+{
+    uint32_t pageIndex = sysData->hashBuckets[assoc_hash(sysData, pagePosition / sysData->pageSize)];
+
+    while (pageIndex != NO_PAGE && sysData->pages[pageIndex].position != pagePosition)
+        pageIndex = sysData->pages[pageIndex].hashNext;
+
+    return pageIndex;
+}
+
+static void assoc_unhash_page(MXFFileSysData *sysData, uint32_t pageIndex)
+{
+    uint32_t *link = &sysData->hashBuckets[assoc_hash(sysData, sysData->pages[pageIndex].position / sysData->pageSize)];
+
+    while (*link != pageIndex) {
+        assert(*link != NO_PAGE);
+        link = &sysData->pages[*link].hashNext;
+    }
+    *link = sysData->pages[pageIndex].hashNext;
+
+    sysData->pages[pageIndex].hashNext = NO_PAGE;
+    sysData->pages[pageIndex].position = -1;
+    sysData->pages[pageIndex].size     = 0;
+}
+
+static void assoc_hash_page(MXFFileSysData *sysData, uint32_t pageIndex, int64_t pagePosition)
+{
+    uint32_t bucket = assoc_hash(sysData, pagePosition / sysData->pageSize);
+
+    sysData->pages[pageIndex].position = pagePosition;
+    sysData->pages[pageIndex].hashNext = sysData->hashBuckets[bucket];
+    sysData->hashBuckets[bucket] = pageIndex;
+}
+
+static void assoc_touch_page(MXFFileSysData *sysData, uint32_t pageIndex)
+{
+    uint32_t set = pageIndex / sysData->numWays;
+    Page *page = &sysData->pages[pageIndex];
+
+    if (sysData->lruTail[set] == pageIndex)
+        return;
+
+    /* move to the most recently used end of the set's list */
+    if (page->lruPrev != NO_PAGE)
+        sysData->pages[page->lruPrev].lruNext = page->lruNext;
+    else
+        sysData->lruHead[set] = page->lruNext;
+    sysData->pages[page->lruNext].lruPrev = page->lruPrev;
+
+    page->lruPrev = sysData->lruTail[set];
+    page->lruNext = NO_PAGE;
+    sysData->pages[sysData->lruTail[set]].lruNext = pageIndex;
+    sysData->lruTail[set] = pageIndex;
+}
+
+static int assoc_flush_page(MXFFileSysData *sysData, uint32_t pageIndex)
+{
+    Page *page = &sysData->pages[pageIndex];
+
+    if (!page->isDirty)
+        return 1;
+
+    CHK_ORET(write_target(sysData, page->position, &sysData->cacheData[pageIndex * sysData->pageSize], page->size));
+
+    page->isDirty = 0;
+    sysData->dirtyCount--;
+
+    return 1;
+}
+
+static int assoc_flush_all(MXFFileSysData *sysData)
+{
+    uint32_t i;
+
+    for (i = 0; i < sysData->numPages && sysData->dirtyCount > 0; i++)
+        CHK_ORET(assoc_flush_page(sysData, i));
+
+    return 1;
+}
+
+static int assoc_get_page(MXFFileSysData *sysData, int64_t pagePosition, int load, uint32_t *pageIndexOut)
+{
+    uint32_t pageIndex;
+    uint32_t set;
+
+    pageIndex = assoc_find_page(sysData, pagePosition);
+    if (pageIndex == NO_PAGE) {
+        /* replace the least recently used page in the set */
+        set = (uint32_t)((pagePosition / sysData->pageSize) % sysData->numSets);
+        pageIndex = sysData->lruHead[set];
+
+        CHK_ORET(assoc_flush_page(sysData, pageIndex));
+        if (sysData->pages[pageIndex].position >= 0)
+            assoc_unhash_page(sysData, pageIndex);
+
+        if (load) {
+            sysData->pages[pageIndex].size = read_target(sysData, pagePosition,
+                                                         &sysData->cacheData[pageIndex * sysData->pageSize],
+                                                         sysData->pageSize);
+        } else {
+            sysData->pages[pageIndex].size = 0;
+        }
+        assoc_hash_page(sysData, pageIndex, pagePosition);
+    }
+
+    assoc_touch_page(sysData, pageIndex);
+
+    *pageIndexOut = pageIndex;
+    return 1;
+}
+
+static uint32_t assoc_read(MXFFileSysData *sysData, uint8_t *data, uint32_t count)
+{
+    int64_t pagePosition;
+    uint32_t pageIndex;
+    uint32_t pageOffset;
+    uint32_t numRead;
+    uint32_t remCount = count;
+
+    while (remCount > 0) {
+        pagePosition = sysData->position - sysData->position % sysData->pageSize;
+        pageOffset   = (uint32_t)(sysData->position - pagePosition);
+
+        if (!assoc_get_page(sysData, pagePosition, 1, &pageIndex))
+            break;
+        if (pageOffset >= sysData->pages[pageIndex].size)
+            break;
+
+        numRead = sysData->pages[pageIndex].size - pageOffset;
+        if (numRead > remCount)
+            numRead = remCount;
+        if (data)
+            memcpy(&data[count - remCount], &sysData->cacheData[pageIndex * sysData->pageSize + pageOffset], numRead);
+        remCount -= numRead;
+        sysData->position += numRead;
+    }
+
+    sysData->eof = (count > 0 && remCount > 0);
+
+    return count - remCount;
+}
+
+static uint32_t assoc_write(MXFFileSysData *sysData, const uint8_t *data, uint32_t count)
+{
+    int64_t pagePosition;
+    uint32_t pageIndex;
+    uint32_t pageOffset;
+    uint32_t numWrite;
+    uint32_t remCount = count;
+    Page *page;
+
+    while (remCount > 0) {
+        pagePosition = sysData->position - sysData->position % sysData->pageSize;
+        pageOffset   = (uint32_t)(sysData->position - pagePosition);
+
+        /* the existing page data is not needed if the whole page is overwritten */
+        if (!assoc_get_page(sysData, pagePosition, pageOffset > 0 || remCount < sysData->pageSize, &pageIndex))
+            break;
+        page = &sysData->pages[pageIndex];
+
+        if (pageOffset > page->size)
+            memset(&sysData->cacheData[pageIndex * sysData->pageSize + page->size], 0, pageOffset - page->size);
+
+        numWrite = sysData->pageSize - pageOffset;
+        if (numWrite > remCount)
+            numWrite = remCount;
+        memcpy(&sysData->cacheData[pageIndex * sysData->pageSize + pageOffset], &data[count - remCount], numWrite);
+        if (pageOffset + numWrite > page->size)
+            page->size = pageOffset + numWrite;
+        if (!page->isDirty) {
+            page->isDirty = 1;
+            sysData->dirtyCount++;
+        }
+        remCount -= numWrite;
+        sysData->position += numWrite;
+    }
+
+    if (sysData->position > sysData->writeEnd)
+        sysData->writeEnd = sysData->position;
+
+    return count - remCount;
+}
+
+static uint32_t assoc_flush(MXFFileSysData *sysData, uint32_t numPages)
+{
+    uint32_t numFlushed = 0;
+    uint32_t set;
+    uint32_t pageIndex;
+
+    /* flush the least recently used dirty pages first, these being the first candidates for replacement */
+    for (set = 0; set < sysData->numSets && numFlushed < numPages; set++) {
+        pageIndex = sysData->lruHead[set];
+        while (pageIndex != NO_PAGE && numFlushed < numPages) {
+            if (sysData->pages[pageIndex].isDirty) {
+                if (!assoc_flush_page(sysData, pageIndex))
+                    return numFlushed;
+                numFlushed++;
+            }
+            pageIndex = sysData->pages[pageIndex].lruNext;
+        }
+    }
+
+    return numFlushed;
+}
+
+#if defined(HAVE_PTHREAD)
+static uint32_t collect_dirty_pages(MXFFileSysData *sysData)
+{
+    Worker *worker = sysData->worker;
+    uint32_t numPages = 0;
+    uint32_t maxPages;
+    uint32_t pageIndex;
+    uint32_t set;
+
+    if (sysData->numWays > 1) {
+        /* take the least recently used dirty pages */
+        for (set = 0; set < sysData->numSets && numPages < worker->maxBatchPages; set++) {
+            pageIndex = sysData->lruHead[set];
+            while (pageIndex != NO_PAGE && numPages < worker->maxBatchPages) {
+                if (sysData->pages[pageIndex].isDirty) {
+                    memcpy(&worker->batchData[numPages * sysData->pageSize],
+                           &sysData->cacheData[pageIndex * sysData->pageSize], sysData->pages[pageIndex].size);
+                    worker->batchPositions[numPages] = sysData->pages[pageIndex].position;
+                    worker->batchSizes[numPages]     = sysData->pages[pageIndex].size;
+                    sysData->pages[pageIndex].isDirty = 0;
+                    sysData->dirtyCount--;
+                    numPages++;
+                }
+                pageIndex = sysData->pages[pageIndex].lruNext;
+            }
+        }
+    } else {
+        /* take pages from the start of the contiguous dirty sequence. The last dirty page is left because it is
+           usually still being written and the sequence must not be broken */
+        if (sysData->dirtyCount < 2)
+            return 0;
+        maxPages = sysData->dirtyCount - 1;
+        if (maxPages > worker->maxBatchPages)
+            maxPages = worker->maxBatchPages;
+        for (numPages = 0; numPages < maxPages; numPages++) {
+            pageIndex = sysData->firstDirtyPage;
+            memcpy(&worker->batchData[numPages * sysData->pageSize],
+                   &sysData->cacheData[pageIndex * sysData->pageSize], sysData->pages[pageIndex].size);
+            worker->batchPositions[numPages] = sysData->pages[pageIndex].position;
+            worker->batchSizes[numPages]     = sysData->pages[pageIndex].size;
+            sysData->pages[pageIndex].isDirty = 0;
+            sysData->dirtyCount--;
+            sysData->firstDirtyPage = (sysData->firstDirtyPage + 1) % sysData->numPages;
+        }
+    }
+
+    return numPages;
+}
+
+static int write_batch(MXFFileSysData *sysData, uint32_t numPages)
+{
+    Worker *worker = sysData->worker;
+    uint32_t first = 0;
+    uint32_t last;
+    uint32_t size;
+
+    /* write runs of pages that are contiguous in the file with a single call */
+    while (first < numPages) {
+        last = first;
+        size = worker->batchSizes[first];
+        while (last + 1 < numPages &&
+               worker->batchSizes[last] == sysData->pageSize &&
+               worker->batchPositions[last + 1] == worker->batchPositions[last] + sysData->pageSize)
+        {
+            last++;
+            size += worker->batchSizes[last];
+        }
+
+        if (!mxf_file_seek(sysData->target, worker->batchPositions[first], SEEK_SET) ||
+            mxf_file_write(sysData->target, &worker->batchData[first * sysData->pageSize], size) != size)
+        {
+            mxf_log_error("Background flush of cache file pages failed\n");
+            return 0;
+        }
+
+        first = last + 1;
+    }
+
+    return 1;
+}
+
+static void flush_in_background(MXFFileSysData *sysData)
+{
+    Worker *worker = sysData->worker;
+    uint32_t numPages;
+    int result;
+
+    while (!worker->stop && worker->highWatermark > 0 && sysData->dirtyCount > worker->lowWatermark) {
+        numPages = collect_dirty_pages(sysData);
+        if (numPages == 0)
+            break;
+
+        /* the target is locked before the cache is unlocked so that the pages, which are now clean in the
+           cache, can't be read back from the target before they have been written */
+        pthread_mutex_lock(&worker->targetLock);
+        pthread_mutex_unlock(&worker->cacheLock);
+        result = write_batch(sysData, numPages);
+        pthread_mutex_unlock(&worker->targetLock);
+        pthread_mutex_lock(&worker->cacheLock);
+
+        if (!result) {
+            worker->error = 1;
+            break;
+        }
+    }
+}
+
+static int is_page_cached(MXFFileSysData *sysData, int64_t pagePosition)
+{
+    if (sysData->numWays > 1)
+        return assoc_find_page(sysData, pagePosition) != NO_PAGE;
+    else
+        return sysData->pages[(pagePosition / sysData->pageSize) % sysData->numPages].position == pagePosition;
+}
+
+static uint32_t get_prefetch_page(MXFFileSysData *sysData, int64_t pagePosition)
+{
+    uint32_t pageIndex;
+
+    /* the prefetcher only replaces clean pages, leaving dirty pages to the writer and flusher */
+    if (sysData->numWays > 1)
+        pageIndex = sysData->lruHead[(pagePosition / sysData->pageSize) % sysData->numSets];
+    else
+        pageIndex = (uint32_t)((pagePosition / sysData->pageSize) % sysData->numPages);
+    if (sysData->pages[pageIndex].isDirty)
+        return NO_PAGE;
+
+    return pageIndex;
+}
+
+static void prefetch_next_page(MXFFileSysData *sysData)
+{
+    Worker *worker = sysData->worker;
+    int64_t pagePosition = worker->prefetchPosition;
+    uint32_t writeCount = sysData->writeCount;
+    uint32_t pageIndex;
+    uint32_t numRead = 0;
+
+    worker->prefetchPosition += sysData->pageSize;
+    if (is_page_cached(sysData, pagePosition))
+        return;
+    if (get_prefetch_page(sysData, pagePosition) == NO_PAGE) {
+        worker->prefetchEnd = worker->prefetchPosition;
+        return;
+    }
+
+    /* read without holding the cache lock so that the reader can continue using pages already in the cache */
+    pthread_mutex_lock(&worker->targetLock);
+    pthread_mutex_unlock(&worker->cacheLock);
+    if (mxf_file_seek(sysData->target, pagePosition, SEEK_SET))
+        numRead = mxf_file_read(sysData->target, worker->prefetchData, sysData->pageSize);
+    pthread_mutex_unlock(&worker->targetLock);
+    pthread_mutex_lock(&worker->cacheLock);
+
+    if (numRead < sysData->pageSize) {
+        worker->prefetchFileEnd = pagePosition + numRead;
+        worker->prefetchEnd     = worker->prefetchPosition;
+    }
+
+    /* discard the page if the reader has loaded it in the meantime or the file has been written to */
+    if (numRead == 0 || writeCount != sysData->writeCount || is_page_cached(sysData, pagePosition))
+        return;
+    pageIndex = get_prefetch_page(sysData, pagePosition);
+    if (pageIndex == NO_PAGE)
+        return;
+
+    if (sysData->numWays > 1 && sysData->pages[pageIndex].position >= 0)
+        assoc_unhash_page(sysData, pageIndex);
+    memcpy(&sysData->cacheData[pageIndex * sysData->pageSize], worker->prefetchData, numRead);
+    sysData->pages[pageIndex].size     = numRead;
+    sysData->pages[pageIndex].position = pagePosition;
+    if (sysData->numWays > 1) {
+        assoc_hash_page(sysData, pageIndex, pagePosition);
+        assoc_touch_page(sysData, pageIndex);
+    }
+}
+
+static int flush_required(MXFFileSysData *sysData)
+{
+    Worker *worker = sysData->worker;
+
+    return worker->highWatermark > 0 && !worker->error && sysData->dirtyCount >= worker->highWatermark;
+}
+
+static int prefetch_required(MXFFileSysData *sysData)
+{
+    Worker *worker = sysData->worker;
+
+    return worker->prefetchPages > 0 && worker->prefetchPosition < worker->prefetchEnd;
+}
+
+static void* worker_thread(void *arg)
+{
+    MXFFileSysData *sysData = (MXFFileSysData*)arg;
+    Worker *worker = sysData->worker;
+
+    pthread_mutex_lock(&worker->cacheLock);
+    while (!worker->stop) {
+        /* flushing takes priority because writers block when the cache is full of dirty pages */
+        if (flush_required(sysData))
+            flush_in_background(sysData);
+        else if (prefetch_required(sysData))
+            prefetch_next_page(sysData);
+        else
+            pthread_cond_wait(&worker->wakeup, &worker->cacheLock);
+    }
+    pthread_mutex_unlock(&worker->cacheLock);
+
+    return NULL;
+}
+
+static void free_worker(Worker *worker)
+{
+    SAFE_FREE(worker->batchData);
+    SAFE_FREE(worker->batchPositions);
+    SAFE_FREE(worker->batchSizes);
+    SAFE_FREE(worker->prefetchData);
+    free(worker);
+}
+
+static int start_worker(MXFFileSysData *sysData)
+{
+    Worker *newWorker = NULL;
+    pthread_mutexattr_t attr;
+    int result;
+
+    if (sysData->worker)
+        return 1;
+
+    CHK_MALLOC_ORET(newWorker, Worker);
+    memset(newWorker, 0, sizeof(*newWorker));
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    result = pthread_mutex_init(&newWorker->cacheLock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    CHK_OFAIL(result == 0);
+    if (pthread_mutex_init(&newWorker->targetLock, NULL) != 0) {
+        pthread_mutex_destroy(&newWorker->cacheLock);
+        goto fail;
+    }
+    if (pthread_cond_init(&newWorker->wakeup, NULL) != 0) {
+        pthread_mutex_destroy(&newWorker->targetLock);
+        pthread_mutex_destroy(&newWorker->cacheLock);
+        goto fail;
+    }
+
+    sysData->worker = newWorker;
+    if (pthread_create(&newWorker->thread, NULL, worker_thread, sysData) != 0) {
+        mxf_log_error("Failed to create cache file background thread\n");
+        sysData->worker = NULL;
+        pthread_cond_destroy(&newWorker->wakeup);
+        pthread_mutex_destroy(&newWorker->targetLock);
+        pthread_mutex_destroy(&newWorker->cacheLock);
+        goto fail;
+    }
+
+    return 1;
+
+fail:
+    free_worker(newWorker);
+    return 0;
+}
+
+static void stop_worker(MXFFileSysData *sysData)
+{
+    Worker *worker = sysData->worker;
+
+    if (!worker)
+        return;
+
+    pthread_mutex_lock(&worker->cacheLock);
+    worker->stop = 1;
+    pthread_cond_signal(&worker->wakeup);
+    pthread_mutex_unlock(&worker->cacheLock);
+
+    pthread_join(worker->thread, NULL);
+    sysData->worker = NULL;
+
+    pthread_cond_destroy(&worker->wakeup);
+    pthread_mutex_destroy(&worker->targetLock);
+    pthread_mutex_destroy(&worker->cacheLock);
+    free_worker(worker);
+}
+#endif
+
+static int flusher_failed(MXFFileSysData *sysData)
+{
+#if defined(HAVE_PTHREAD)
+    return sysData->worker && sysData->worker->error;
+#else
+    (void)sysData;
+    return 0;
+#endif
+}
+
+static void wakeup_flusher(MXFFileSysData *sysData)
+{
+#if defined(HAVE_PTHREAD)
+    if (sysData->worker && sysData->worker->highWatermark > 0 &&
+        sysData->dirtyCount >= sysData->worker->highWatermark)
+    {
+        pthread_cond_signal(&sysData->worker->wakeup);
+    }
+#else
+    (void)sysData;
+#endif
+}
+
+static void update_prefetch(MXFFileSysData *sysData, int64_t readPosition)
+{
+#if defined(HAVE_PTHREAD)
+    Worker *worker = sysData->worker;
+    int64_t nextPagePosition;
+
+    if (!worker || worker->prefetchPages == 0)
+        return;
+
+    /* the end of file found by the prefetcher is invalid once the file has been written to */
+    if (worker->prefetchWriteCount != sysData->writeCount) {
+        worker->prefetchWriteCount = sysData->writeCount;
+        worker->prefetchFileEnd    = -1;
+    }
+
+    /* a read is sequential if it starts at, or less than a page beyond, the end of the previous read */
+    if (readPosition >= sysData->lastReadEnd && readPosition - sysData->lastReadEnd <= sysData->pageSize) {
+        sysData->sequentialReads++;
+    } else {
+        sysData->sequentialReads = 0;
+        worker->prefetchEnd = worker->prefetchPosition;
+    }
+    sysData->lastReadEnd = sysData->position;
+
+    if (sysData->sequentialReads >= MIN_SEQUENTIAL_READS) {
+        nextPagePosition = (sysData->position / sysData->pageSize + 1) * sysData->pageSize;
+        if (worker->prefetchPosition < nextPagePosition || worker->prefetchPosition > worker->prefetchEnd)
+            worker->prefetchPosition = nextPagePosition;
+        worker->prefetchEnd = nextPagePosition + (int64_t)worker->prefetchPages * sysData->pageSize;
+        if (worker->prefetchFileEnd >= 0 && worker->prefetchEnd > worker->prefetchFileEnd)
+            worker->prefetchEnd = worker->prefetchFileEnd;
+        if (worker->prefetchPosition < worker->prefetchEnd)
+            pthread_cond_signal(&worker->wakeup);
+    }
+#else
+    (void)sysData;
+    (void)readPosition;
+#endif
+}
+
 static void cache_file_close(MXFFileSysData *sysData)
 {
+#if defined(HAVE_PTHREAD)
+    stop_worker(sysData);
+#endif
+
     if (sysData->target) {
-        flush_dirty_pages(sysData, 0, sysData->numPages);
+        if (sysData->numWays > 1)
+            assoc_flush_all(sysData);
+        else
+            flush_dirty_pages(sysData, 0, sysData->numPages);
         mxf_file_close(&sysData->target);
     }
 
     SAFE_FREE(sysData->pages);
     SAFE_FREE(sysData->allocCacheData);
+    SAFE_FREE(sysData->hashBuckets);
+    SAFE_FREE(sysData->lruHead);
+    SAFE_FREE(sysData->lruTail);
 }
 
-static uint32_t cache_file_read(MXFFileSysData *sysData, uint8_t *data, uint32_t count)
+static uint32_t read_pages(MXFFileSysData *sysData, uint8_t *data, uint32_t count)
 {
     int64_t pagePosition;
     uint32_t pageIndex;
@@ -172,6 +890,9 @@ static uint32_t cache_file_read(MXFFileSysData *sysData, uint8_t *data, uint32_t
     uint32_t remCount = count;
     uint32_t i;
 
+    if (sysData->numWays > 1)
+        return assoc_read(sysData, data, count);
+
     while (remCount > 0) {
         get_current_page_info(sysData, &pagePosition, &pageIndex, &pageOffset);
 
@@ -195,9 +916,8 @@ static uint32_t cache_file_read(MXFFileSysData *sysData, uint8_t *data, uint32_t
 
             CHK_ORET(flush_dirty_pages(sysData, pageIndex, numPagesRead));
 
-            CHK_ORET(mxf_file_seek(sysData->target, pagePosition, SEEK_SET));
-            numRead = mxf_file_read(sysData->target, &sysData->cacheData[pageIndex * sysData->pageSize],
-                                    numPagesRead * sysData->pageSize);
+            numRead = read_target(sysData, pagePosition, &sysData->cacheData[pageIndex * sysData->pageSize],
+                                  numPagesRead * sysData->pageSize);
 
             if (numRead == 0)
                 break;
@@ -219,7 +939,7 @@ static uint32_t cache_file_read(MXFFileSysData *sysData, uint8_t *data, uint32_t
     return count - remCount;
 }
 
-static uint32_t cache_file_write(MXFFileSysData *sysData, const uint8_t *data, uint32_t count)
+static uint32_t write_pages(MXFFileSysData *sysData, const uint8_t *data, uint32_t count)
 {
     int64_t pagePosition;
     uint32_t pageIndex;
@@ -232,6 +952,9 @@ static uint32_t cache_file_write(MXFFileSysData *sysData, const uint8_t *data, u
     int originalEOF;
     uint32_t i;
 
+    if (sysData->numWays > 1)
+        return assoc_write(sysData, data, count);
+
     while (remCount > 0) {
         get_current_page_info(sysData, &pagePosition, &pageIndex, &pageOffset);
 
@@ -280,7 +1003,7 @@ static uint32_t cache_file_write(MXFFileSysData *sysData, const uint8_t *data, u
                 originalPosition = sysData->position;
                 originalEOF      = sysData->eof;
 
-                numRead = cache_file_read(sysData, NULL, numPagesWrite * sysData->pageSize);
+                numRead = read_pages(sysData, NULL, numPagesWrite * sysData->pageSize);
                 if (numRead < numPagesWrite * sysData->pageSize) {
                     CHK_ORET(sysData->eof);
                     sysData->writingAtEOF = 1;
@@ -295,6 +1018,37 @@ static uint32_t cache_file_write(MXFFileSysData *sysData, const uint8_t *data, u
     return count - remCount;
 }
 
+static uint32_t cache_file_read(MXFFileSysData *sysData, uint8_t *data, uint32_t count)
+{
+    int64_t readPosition;
+    uint32_t numRead;
+
+    lock_cache(sysData);
+    readPosition = sysData->position;
+    numRead = read_pages(sysData, data, count);
+    update_prefetch(sysData, readPosition);
+    unlock_cache(sysData);
+
+    return numRead;
+}
+
+static uint32_t cache_file_write(MXFFileSysData *sysData, const uint8_t *data, uint32_t count)
+{
+    uint32_t numWrite = 0;
+
+    lock_cache(sysData);
+    if (flusher_failed(sysData)) {
+        mxf_log_error("Failed to write to cache file because an earlier background flush failed\n");
+    } else {
+        numWrite = write_pages(sysData, data, count);
+        sysData->writeCount++;
+        wakeup_flusher(sysData);
+    }
+    unlock_cache(sysData);
+
+    return numWrite;
+}
+
 static int cache_file_getchar(MXFFileSysData *sysData)
 {
     uint8_t data;
@@ -318,6 +1072,33 @@ static int cache_file_eof(MXFFileSysData *sysData)
     return sysData->eof;
 }
 
+static int64_t cache_file_tell(MXFFileSysData *sysData)
+{
+    return sysData->position;
+}
+
+static int64_t cache_file_size(MXFFileSysData *sysData)
+{
+    int64_t size;
+
+    lock_cache(sysData);
+
+    size = target_size(sysData);
+    if (sysData->numWays > 1) {
+        if (sysData->writeEnd > size)
+            size = sysData->writeEnd;
+    } else if (sysData->dirtyCount > 0) {
+        /* if there are dirty pages then check the end of the last dirty page */
+        uint32_t lastDirtyPage = (sysData->firstDirtyPage + sysData->dirtyCount - 1) % sysData->numPages;
+        if (sysData->pages[lastDirtyPage].position + sysData->pages[lastDirtyPage].size > size)
+            size = sysData->pages[lastDirtyPage].position + sysData->pages[lastDirtyPage].size;
+    }
+
+    unlock_cache(sysData);
+
+    return size;
+}
+
 static int cache_file_seek(MXFFileSysData *sysData, int64_t offset, int whence)
 {
     int64_t newPosition = 0;
@@ -333,10 +1114,10 @@ static int cache_file_seek(MXFFileSysData *sysData, int64_t offset, int whence)
             newPosition = offset;
             break;
         case SEEK_CUR:
-            newPosition = sysData->position + offset;
+            newPosition = cache_file_tell(sysData) + offset;
             break;
         case SEEK_END:
-            fileSize = mxf_file_size(sysData->target);
+            fileSize = cache_file_size(sysData);
             newPosition = fileSize + offset;
             break;
         default:
@@ -345,41 +1126,89 @@ static int cache_file_seek(MXFFileSysData *sysData, int64_t offset, int whence)
     if (newPosition < 0)
         return 0;
 
+    lock_cache(sysData);
+
     sysData->eof          = 0;
     sysData->position     = newPosition;
     sysData->writingAtEOF = 0;
 
+    /* the associative cache positions the target before each page read or write */
+    if (sysData->numWays > 1) {
+        unlock_cache(sysData);
+        return 1;
+    }
+
     get_current_page_info(sysData, &pagePosition, &pageIndex, &pageOffset);
     if (sysData->pages[pageIndex].position == pagePosition)
         targetPosition = pagePosition + sysData->pageSize; /* page has been read and so seek to after the page */
     else
         targetPosition = pagePosition; /* page will need to be read so seek to the start of the page */
 
-    return mxf_file_seek(sysData->target, targetPosition, SEEK_SET);
-}
+    unlock_cache(sysData);
 
-static int64_t cache_file_tell(MXFFileSysData *sysData)
-{
-    return sysData->position;
+    return seek_target(sysData, targetPosition);
 }
 
 static int cache_file_is_seekable(MXFFileSysData *sysData)
 {
-    return mxf_file_is_seekable(sysData->target);
+    int result;
+
+    lock_target(sysData);
+    result = mxf_file_is_seekable(sysData->target);
+    unlock_target(sysData);
+
+    return result;
 }
 
-static int64_t cache_file_size(MXFFileSysData *sysData)
+static int cache_file_advise(MXFFileSysData *sysData, int64_t offset, int64_t len, MXFFileAdvice advice)
 {
-    int64_t size = mxf_file_size(sysData->target);
+    int64_t originalPosition;
+    int originalEOF;
+    int64_t prefetchLen;
+    int64_t size;
 
-    if (sysData->dirtyCount > 0) {
-        /* if there are dirty pages then check the end of the last dirty page */
-        uint32_t lastDirtyPage = (sysData->firstDirtyPage + sysData->dirtyCount - 1) % sysData->numPages;
-        if (sysData->pages[lastDirtyPage].position + sysData->pages[lastDirtyPage].size > size)
-            size = sysData->pages[lastDirtyPage].position + sysData->pages[lastDirtyPage].size;
+    int result;
+
+    if (advice != MXF_ADVISE_WILLNEED) {
+        lock_target(sysData);
+        result = mxf_file_advise(sysData->target, offset, len, advice);
+        unlock_target(sysData);
+        return result;
     }
 
-    return size;
+    /* prefetch the range into the cache, limited to half the cache to leave pages for the current position */
+    size = target_size(sysData);
+    if (offset < 0 || offset >= size)
+        return 1;
+    prefetchLen = (len == 0 || offset + len > size ? size - offset : len);
+    if (prefetchLen > sysData->cacheSize / 2)
+        prefetchLen = sysData->cacheSize / 2;
+
+    lock_cache(sysData);
+
+    originalPosition = sysData->position;
+    originalEOF      = sysData->eof;
+
+    sysData->position = offset;
+    read_pages(sysData, NULL, (uint32_t)prefetchLen);
+
+    sysData->position = originalPosition;
+    sysData->eof      = originalEOF;
+
+    unlock_cache(sysData);
+
+    return 1;
+}
+
+static int cache_file_preallocate(MXFFileSysData *sysData, int64_t offset, int64_t len)
+{
+    int result;
+
+    lock_target(sysData);
+    result = mxf_file_preallocate(sysData->target, offset, len);
+    unlock_target(sysData);
+
+    return result;
 }
 
 static void free_cache_file(MXFFileSysData *sysData)
@@ -389,7 +1218,13 @@ static void free_cache_file(MXFFileSysData *sysData)
 
 
 
-int mxf_cache_file_open(MXFFile *target, uint32_t in_cachePageSize, uint32_t cacheSize, MXFCacheFile **cacheFile)
+int mxf_cache_file_open(MXFFile *target, uint32_t cachePageSize, uint32_t cacheSize, MXFCacheFile **cacheFile)
+{
+    return mxf_cache_file_open_2(target, cachePageSize, cacheSize, 1, cacheFile);
+}
+
+int mxf_cache_file_open_2(MXFFile *target, uint32_t in_cachePageSize, uint32_t cacheSize, uint32_t numWays,
+                          MXFCacheFile **cacheFile)
 {
     MXFFile *newMXFFile = NULL;
     MXFFileSysData *newDiskFile = NULL;
@@ -398,6 +1233,9 @@ int mxf_cache_file_open(MXFFile *target, uint32_t in_cachePageSize, uint32_t cac
     uint32_t numPages;
     uint32_t sysPageSize;
     uint32_t cachePageSize = in_cachePageSize;
+    uint32_t numBuckets;
+    uint32_t set;
+    uint32_t i;
 
     sysPageSize = mxf_get_system_page_size();
     CHK_ORET(sysPageSize > 0);
@@ -418,6 +1256,11 @@ int mxf_cache_file_open(MXFFile *target, uint32_t in_cachePageSize, uint32_t cac
     CHK_ORET(numPages > 0);
     CHK_ORET(numPages < UINT32_MAX / 2); /* required to prevent overflows in calculations */
 
+    /* 0 selects a fully associative cache and the page count is rounded down to a whole number of sets */
+    if (numWays == 0 || numWays > numPages)
+        numWays = numPages;
+    numPages -= numPages % numWays;
+
     CHK_MALLOC_ORET(newMXFFile, MXFFile);
     memset(newMXFFile, 0, sizeof(MXFFile));
     CHK_MALLOC_OFAIL(newDiskFile, MXFFileSysData);
@@ -434,6 +1277,32 @@ int mxf_cache_file_open(MXFFile *target, uint32_t in_cachePageSize, uint32_t cac
     newDiskFile->pages          = newPages;
     newDiskFile->numPages       = numPages;
     newDiskFile->pageSize       = cachePageSize;
+    newDiskFile->numWays        = numWays;
+    newDiskFile->numSets        = numPages / numWays;
+
+    if (numWays > 1) {
+        numBuckets = 1;
+        while (numBuckets < numPages)
+            numBuckets <<= 1;
+        CHK_MALLOC_ARRAY_OFAIL(newDiskFile->hashBuckets, uint32_t, numBuckets);
+        for (i = 0; i < numBuckets; i++)
+            newDiskFile->hashBuckets[i] = NO_PAGE;
+        newDiskFile->hashMask = numBuckets - 1;
+
+        /* the slots of each set are numWays consecutive pages, linked in least to most recently used order */
+        CHK_MALLOC_ARRAY_OFAIL(newDiskFile->lruHead, uint32_t, newDiskFile->numSets);
+        CHK_MALLOC_ARRAY_OFAIL(newDiskFile->lruTail, uint32_t, newDiskFile->numSets);
+        for (set = 0; set < newDiskFile->numSets; set++) {
+            newDiskFile->lruHead[set] = set * numWays;
+            newDiskFile->lruTail[set] = set * numWays + numWays - 1;
+            for (i = set * numWays; i < set * numWays + numWays; i++) {
+                newPages[i].position = -1;
+                newPages[i].hashNext = NO_PAGE;
+                newPages[i].lruPrev  = (i == set * numWays ? NO_PAGE : i - 1);
+                newPages[i].lruNext  = (i == set * numWays + numWays - 1 ? NO_PAGE : i + 1);
+            }
+        }
+    }
 
     newDiskFile->cacheFile.mxfFile = newMXFFile;
 
@@ -447,6 +1316,8 @@ int mxf_cache_file_open(MXFFile *target, uint32_t in_cachePageSize, uint32_t cac
     newMXFFile->tell          = cache_file_tell;
     newMXFFile->is_seekable   = cache_file_is_seekable;
     newMXFFile->size          = cache_file_size;
+    newMXFFile->advise        = cache_file_advise;
+    newMXFFile->preallocate   = cache_file_preallocate;
     newMXFFile->free_sys_data = free_cache_file;
     newMXFFile->sysData       = newDiskFile;
     newMXFFile->minLLen       = target->minLLen;
@@ -457,6 +1328,11 @@ int mxf_cache_file_open(MXFFile *target, uint32_t in_cachePageSize, uint32_t cac
     return 1;
 
 fail:
+    if (newDiskFile) {
+        SAFE_FREE(newDiskFile->hashBuckets);
+        SAFE_FREE(newDiskFile->lruHead);
+        SAFE_FREE(newDiskFile->lruTail);
+    }
     SAFE_FREE(newMXFFile);
     SAFE_FREE(newDiskFile);
     SAFE_FREE(newPages);
@@ -469,21 +1345,199 @@ MXFFile* mxf_cache_file_get_file(MXFCacheFile *cacheFile)
     return cacheFile->mxfFile;
 }
 
+uint32_t mxf_cache_file_get_page_size(MXFCacheFile *cacheFile)
+{
+    return cacheFile->mxfFile->sysData->pageSize;
+}
+
 uint32_t mxf_cache_file_get_dirty_count(MXFCacheFile *cacheFile)
 {
-    return cacheFile->mxfFile->sysData->dirtyCount;
+    MXFFileSysData *sysData = cacheFile->mxfFile->sysData;
+    uint32_t dirtyCount;
+
+    lock_cache(sysData);
+    dirtyCount = sysData->dirtyCount;
+    unlock_cache(sysData);
+
+    return dirtyCount;
 }
 
 uint32_t mxf_cache_file_flush(MXFCacheFile *cacheFile, uint32_t minSize)
 {
     MXFFileSysData *sysData = cacheFile->mxfFile->sysData;
-    uint32_t originalDirtyCount = sysData->dirtyCount;
+    uint32_t originalDirtyCount;
+    uint32_t numFlushed;
+
+    lock_cache(sysData);
+
+    originalDirtyCount = sysData->dirtyCount;
+    if (minSize == 0 || sysData->dirtyCount == 0) {
+        numFlushed = 0;
+    } else if (sysData->numWays > 1) {
+        numFlushed = assoc_flush(sysData, (minSize + sysData->pageSize - 1) / sysData->pageSize) * sysData->pageSize;
+    } else {
+        flush_dirty_pages(sysData, sysData->firstDirtyPage, (minSize + sysData->pageSize - 1) / sysData->pageSize);
+        numFlushed = (originalDirtyCount - sysData->dirtyCount) * sysData->pageSize;
+    }
+
+    unlock_cache(sysData);
+
+    return numFlushed;
+}
+
+int mxf_cache_file_start_flusher(MXFCacheFile *cacheFile, uint32_t highWatermark, uint32_t lowWatermark)
+{
+#if defined(HAVE_PTHREAD)
+    MXFFileSysData *sysData = cacheFile->mxfFile->sysData;
+    Worker *worker;
+    uint32_t maxBatchPages;
+
+    CHK_ORET(start_worker(sysData));
+    worker = sysData->worker;
+
+    lock_cache(sysData);
+
+    if (!worker->batchData) {
+        maxBatchPages = MAX_FLUSH_BATCH_SIZE / sysData->pageSize;
+        if (maxBatchPages == 0)
+            maxBatchPages = 1;
+        if (maxBatchPages > sysData->numPages)
+            maxBatchPages = sysData->numPages;
+        CHK_MALLOC_ARRAY_OFAIL(worker->batchPositions, int64_t, maxBatchPages);
+        CHK_MALLOC_ARRAY_OFAIL(worker->batchSizes, uint32_t, maxBatchPages);
+        CHK_MALLOC_ARRAY_OFAIL(worker->batchData, unsigned char, maxBatchPages * sysData->pageSize);
+        worker->maxBatchPages = maxBatchPages;
+    }
+
+    /* watermarks are converted to page counts. At least 2 pages must be dirty before the flusher starts because
+       the direct-mapped cache leaves the last dirty page */
+    if (highWatermark == 0)
+        highWatermark = sysData->cacheSize / 2;
+    if (lowWatermark == 0 || lowWatermark >= highWatermark)
+        lowWatermark = highWatermark / 4;
+    worker->highWatermark = highWatermark / sysData->pageSize;
+    if (worker->highWatermark < 2)
+        worker->highWatermark = 2;
+    worker->lowWatermark = lowWatermark / sysData->pageSize;
+    if (worker->lowWatermark >= worker->highWatermark)
+        worker->lowWatermark = worker->highWatermark - 1;
+    worker->error = 0;
+
+    unlock_cache(sysData);
+    return 1;
+
+fail:
+    unlock_cache(sysData);
+    return 0;
+#else
+    (void)cacheFile;
+    (void)highWatermark;
+    (void)lowWatermark;
+
+    mxf_log_error("Cache file background flushing is not supported on this platform\n");
+    return 0;
+#endif
+}
+
+int mxf_cache_file_stop_flusher(MXFCacheFile *cacheFile)
+{
+#if defined(HAVE_PTHREAD)
+    MXFFileSysData *sysData = cacheFile->mxfFile->sysData;
+    int result;
+
+    if (!sysData->worker)
+        return 1;
 
-    if (minSize == 0 || sysData->dirtyCount == 0)
+    lock_cache(sysData);
+    sysData->worker->highWatermark = 0;
+    result = !sysData->worker->error;
+    unlock_cache(sysData);
+
+    if (sysData->worker->prefetchPages == 0) {
+        stop_worker(sysData);
+    } else {
+        /* a batch being written holds the target lock */
+        lock_target(sysData);
+        unlock_target(sysData);
+        lock_cache(sysData);
+        result = !sysData->worker->error;
+        sysData->worker->error = 0;
+        unlock_cache(sysData);
+    }
+
+    return result;
+#else
+    (void)cacheFile;
+    return 1;
+#endif
+}
+
+int mxf_cache_file_start_prefetcher(MXFCacheFile *cacheFile, uint32_t readAheadSize)
+{
+#if defined(HAVE_PTHREAD)
+    MXFFileSysData *sysData = cacheFile->mxfFile->sysData;
+    Worker *worker;
+    uint32_t prefetchPages;
+
+    /* limit read-ahead to half the cache to leave pages for the current read position */
+    if (readAheadSize == 0)
+        readAheadSize = sysData->cacheSize / 4;
+    prefetchPages = readAheadSize / sysData->pageSize;
+    if (prefetchPages > sysData->numPages / 2)
+        prefetchPages = sysData->numPages / 2;
+    if (prefetchPages == 0) {
+        mxf_log_error("Cache file is too small for prefetching\n");
         return 0;
+    }
+
+    CHK_ORET(start_worker(sysData));
+    worker = sysData->worker;
+
+    lock_cache(sysData);
+
+    if (!worker->prefetchData)
+        CHK_MALLOC_ARRAY_OFAIL(worker->prefetchData, unsigned char, sysData->pageSize);
+    worker->prefetchPages    = prefetchPages;
+    worker->prefetchPosition = 0;
+    worker->prefetchEnd      = 0;
+    worker->prefetchFileEnd  = -1;
+    sysData->lastReadEnd     = sysData->position;
+    sysData->sequentialReads = 0;
 
-    flush_dirty_pages(sysData, sysData->firstDirtyPage, (minSize + sysData->pageSize - 1) / sysData->pageSize);
+    unlock_cache(sysData);
+    return 1;
+
+fail:
+    unlock_cache(sysData);
+    return 0;
+#else
+    (void)cacheFile;
+    (void)readAheadSize;
 
-    return (originalDirtyCount - sysData->dirtyCount) * sysData->pageSize;
+    mxf_log_error("Cache file prefetching is not supported on this platform\n");
+    return 0;
+#endif
 }
 
+void mxf_cache_file_stop_prefetcher(MXFCacheFile *cacheFile)
+{
+#if defined(HAVE_PTHREAD)
+    MXFFileSysData *sysData = cacheFile->mxfFile->sysData;
+
+    if (!sysData->worker)
+        return;
+
+    if (sysData->worker->highWatermark == 0) {
+        stop_worker(sysData);
+    } else {
+        /* wait for a page being prefetched, which holds the target lock */
+        lock_cache(sysData);
+        sysData->worker->prefetchPages = 0;
+        unlock_cache(sysData);
+        lock_target(sysData);
+        unlock_target(sysData);
+    }
+#else
+    (void)cacheFile;
+#endif
+}
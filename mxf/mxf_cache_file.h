@@ -48,13 +48,36 @@ typedef struct MXFCacheFile MXFCacheFile;
 
 int mxf_cache_file_open(MXFFile *target, uint32_t cachePageSize, uint32_t cacheSize, MXFCacheFile **cacheFile);
 
+/* numWays sets the cache associativity. 1 selects the direct-mapped cache used by mxf_cache_file_open, which
+   suits sequential writes. Larger values select an N-way set associative cache with least recently used
+   replacement within each set, and 0 selects a fully associative LRU cache. The associative caches suit random
+   access reads, e.g. alternating between index and essence data */
+int mxf_cache_file_open_2(MXFFile *target, uint32_t cachePageSize, uint32_t cacheSize, uint32_t numWays,
+                          MXFCacheFile **cacheFile);
+
 MXFFile* mxf_cache_file_get_file(MXFCacheFile *cacheFile);
 
 
+uint32_t mxf_cache_file_get_page_size(MXFCacheFile *cacheFile);
 uint32_t mxf_cache_file_get_dirty_count(MXFCacheFile *cacheFile);
 
 uint32_t mxf_cache_file_flush(MXFCacheFile *cacheFile, uint32_t minSize);
 
+/* start a background thread that writes dirty pages once highWatermark bytes are dirty, until no more than
+   lowWatermark bytes are dirty. Writes then only copy into the cache and block on the target when the cache is full
+   of dirty pages. A highWatermark of 0 selects half the cache size and an invalid lowWatermark selects a quarter of
+   the highWatermark. Returns 0 if threads are not supported. Once started, the cache file can be used from one
+   thread at a time, other than the flusher */
+int mxf_cache_file_start_flusher(MXFCacheFile *cacheFile, uint32_t highWatermark, uint32_t lowWatermark);
+/* stop the flusher, leaving any remaining dirty pages in the cache. Returns 0 if a background write failed */
+int mxf_cache_file_stop_flusher(MXFCacheFile *cacheFile);
+
+/* start prefetching up to readAheadSize bytes ahead of the read position once sequential reads are detected. Pages
+   are read in a background thread that is shared with the flusher. A readAheadSize of 0 selects a quarter of the
+   cache size and the size is limited to half the cache. Returns 0 if threads are not supported */
+int mxf_cache_file_start_prefetcher(MXFCacheFile *cacheFile, uint32_t readAheadSize);
+void mxf_cache_file_stop_prefetcher(MXFCacheFile *cacheFile);
+
 
 
 #ifdef __cplusplus
@@ -142,6 +142,20 @@ int mxf_write_essence_element_data(MXFFile *mxfFile, MXFEssenceElement *essenceE
     return 1;
 }
 
+int mxf_write_essence_element_data_64(MXFFile *mxfFile, MXFEssenceElement *essenceElement,
+                                      const uint8_t *data, uint64_t len)
+{
+    uint64_t numWritten = mxf_file_write_64(mxfFile, data, len);
+    essenceElement->totalLen += numWritten;
+    essenceElement->currentFilePos += numWritten;
+
+    if (numWritten != len)
+    {
+        return 0;
+    }
+    return 1;
+}
+
 int mxf_finalize_essence_element_write(MXFFile *mxfFile, MXFEssenceElement *essenceElement)
 {
     int64_t filePos;
@@ -206,6 +220,61 @@ int mxf_read_essence_element_data(MXFFile *mxfFile, MXFEssenceElement *essenceEl
     return 1;
 }
 
+int mxf_read_essence_element_data_64(MXFFile *mxfFile, MXFEssenceElement *essenceElement,
+                                     uint64_t len, uint8_t *data, uint64_t *numRead)
+{
+    uint64_t actualNumRead = 0;
+    uint64_t actualLen = len;
+    uint64_t offset = (uint64_t)(essenceElement->currentFilePos - essenceElement->startFilePos);
+
+    if (offset >= essenceElement->totalLen)
+    {
+        *numRead = 0;
+        return 1;
+    }
+
+    if (actualLen + offset > essenceElement->totalLen)
+    {
+        actualLen = essenceElement->totalLen - offset;
+    }
+
+    actualNumRead = mxf_file_read_64(mxfFile, data, actualLen);
+    essenceElement->currentFilePos += actualNumRead;
+    CHK_ORET(actualNumRead == actualLen);
+
+    *numRead = actualNumRead;
+    return 1;
+}
+
+int mxf_copy_essence_element_data(MXFFile *srcFile, MXFEssenceElement *srcElement,
+                                  MXFFile *dstFile, MXFEssenceElement *dstElement,
+                                  uint64_t len, uint64_t *numCopied)
+{
+    uint64_t actualNumCopied = 0;
+    uint64_t actualLen = len;
+    uint64_t srcOffset = (uint64_t)(srcElement->currentFilePos - srcElement->startFilePos);
+
+    if (srcOffset >= srcElement->totalLen)
+    {
+        *numCopied = 0;
+        return 1;
+    }
+
+    if (actualLen + srcOffset > srcElement->totalLen)
+    {
+        actualLen = srcElement->totalLen - srcOffset;
+    }
+
+    actualNumCopied = mxf_file_copy_range(srcFile, dstFile, actualLen);
+    srcElement->currentFilePos += actualNumCopied;
+    dstElement->totalLen += actualNumCopied;
+    dstElement->currentFilePos += actualNumCopied;
+    CHK_ORET(actualNumCopied == actualLen);
+
+    *numCopied = actualNumCopied;
+    return 1;
+}
+
 void mxf_close_essence_element(MXFEssenceElement **essenceElement)
 {
     free_essence_element(essenceElement);
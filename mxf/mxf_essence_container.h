@@ -57,12 +57,19 @@ int mxf_open_essence_element_write(MXFFile *mxfFile, const mxfKey *key, uint8_t
                                    MXFEssenceElement **essenceElement);
 int mxf_write_essence_element_data(MXFFile *mxfFile, MXFEssenceElement *essenceElement,
                                    const uint8_t *data, uint32_t len);
+int mxf_write_essence_element_data_64(MXFFile *mxfFile, MXFEssenceElement *essenceElement,
+                                      const uint8_t *data, uint64_t len);
 int mxf_finalize_essence_element_write(MXFFile *mxfFile, MXFEssenceElement *essenceElement);
 
 int mxf_open_essence_element_read(MXFFile *mxfFile, const mxfKey *key, uint8_t llen, uint64_t len,
                                   MXFEssenceElement **essenceElement);
 int mxf_read_essence_element_data(MXFFile *mxfFile, MXFEssenceElement *essenceElement,
                                   uint32_t len, uint8_t *data, uint32_t *numRead);
+int mxf_read_essence_element_data_64(MXFFile *mxfFile, MXFEssenceElement *essenceElement,
+                                     uint64_t len, uint8_t *data, uint64_t *numRead);
+int mxf_copy_essence_element_data(MXFFile *srcFile, MXFEssenceElement *srcElement,
+                                  MXFFile *dstFile, MXFEssenceElement *dstElement,
+                                  uint64_t len, uint64_t *numCopied);
 
 void mxf_close_essence_element(MXFEssenceElement **essenceElement);
 
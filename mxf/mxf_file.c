@@ -35,6 +35,10 @@
 #include "config.h"
 #endif
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     /* copy_file_range, readahead, fallocate */
+#endif
+
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
@@ -42,9 +46,35 @@
 #include <sys/stat.h>
 #include <errno.h>
 
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#endif
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define SWAP_SSSE3      1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SWAP_SSE2       1
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(__ARM_BIG_ENDIAN)
+#include <arm_neon.h>
+#define SWAP_NEON       1
+#endif
+
 #include <mxf/mxf.h>
 #include <mxf/mxf_macros.h>
 
+#include "mxf_file_int.h"
+
 
 #if defined(_MSC_VER) && (_MSC_VER < 1400)
 #error Visual C++ 2005 or later is required. Earlier versions do not support 64-bit stream I/O
@@ -55,9 +85,24 @@
 /* size of buffer used to skip data by reading and discarding */
 #define SKIP_BUFFER_SIZE        2048
 
+/* size of stack buffer used to byte swap arrays before writing */
+#define ARRAY_BUFFER_SIZE       4096
+
 #define MAX_ZEROS_BUFFER_SIZE   16384
 #define ZEROS_BUFFER_INCREMENT  2048
 
+#define DEFAULT_DIRECT_BUFFER_SIZE  (4 * 1024 * 1024)
+
+/* maximum number of buffers passed to a single writev call */
+#define WRITEV_BATCH_SIZE           64
+
+#define COPY_BUFFER_SIZE            (1024 * 1024)
+
+/* maximum count passed to the 32-bit read and write functions by the 64-bit functions */
+#define MAX_IO_CHUNK_SIZE           0x80000000U
+/* maximum size passed to a single copy_file_range or sendfile call */
+#define MAX_KERNEL_COPY_SIZE        (64 * 1024 * 1024)
+
 
 typedef enum
 {
@@ -75,6 +120,28 @@ struct MXFFileSysData
     int haveTestedIsSeekable;
     int isStream;
     int64_t streamPosition;
+    int64_t preallocEnd;
+
+    const uint8_t *mapData;
+    int64_t mapSize;
+    int64_t mapPosition;
+    int mapEOF;
+
+    int fileId;
+    uint8_t *directAllocBuffer;
+    uint8_t *directBuffer;
+    uint32_t directBufferSize;
+    uint32_t directAlignment;
+    int64_t directBufferOffset;
+    uint32_t directValidEnd;
+    uint32_t directDirtyStart;
+    uint32_t directDirtyEnd;
+    int64_t directPosition;
+    int64_t directFileSize;
+    int directEOF;
+
+    int64_t posPosition;
+    int posEOF;
 };
 
 
@@ -96,6 +163,22 @@ static int check_file_is_stream(int fileId)
 
 static void disk_file_close(MXFFileSysData *sysData)
 {
+#if !defined(_WIN32)
+    /* release preallocated space beyond the end of the file */
+    if (sysData->preallocEnd > 0 && sysData->file != NULL && fflush(sysData->file) == 0) {
+        struct stat statBuf;
+        int fileId = fileno(sysData->file);
+        if (fstat(fileId, &statBuf) == 0 && statBuf.st_size < sysData->preallocEnd &&
+            ftruncate(fileId, statBuf.st_size) != 0)
+        {
+            mxf_log_warn("Failed to truncate preallocated space: %s\n", strerror(errno));
+        }
+    }
+#endif
+
+    if (sysData->file == stdout)
+        fflush(sysData->file);
+
     if (sysData->file != NULL &&
         sysData->file != stdin && sysData->file != stdout && sysData->file != stderr)
     {
@@ -122,6 +205,48 @@ static uint32_t disk_file_write(MXFFileSysData *sysData, const uint8_t *data, ui
     return result;
 }
 
+static uint64_t disk_file_read_64(MXFFileSysData *sysData, uint8_t *data, uint64_t count)
+{
+    uint64_t totalRead = 0;
+    size_t numRead;
+    size_t chunkSize;
+
+    /* the count is limited by size_t on 32-bit systems */
+    while (totalRead < count) {
+        chunkSize = (count - totalRead > (size_t)-1 ? (size_t)-1 : (size_t)(count - totalRead));
+        numRead = fread(&data[totalRead], 1, chunkSize, sysData->file);
+        totalRead += numRead;
+        if (numRead != chunkSize) {
+            if (ferror(sysData->file))
+                mxf_log_error("fread failed: %s\n", strerror(errno));
+            break;
+        }
+    }
+    sysData->streamPosition += totalRead;
+
+    return totalRead;
+}
+
+static uint64_t disk_file_write_64(MXFFileSysData *sysData, const uint8_t *data, uint64_t count)
+{
+    uint64_t totalWrite = 0;
+    size_t numWrite;
+    size_t chunkSize;
+
+    while (totalWrite < count) {
+        chunkSize = (count - totalWrite > (size_t)-1 ? (size_t)-1 : (size_t)(count - totalWrite));
+        numWrite = fwrite(&data[totalWrite], 1, chunkSize, sysData->file);
+        totalWrite += numWrite;
+        if (numWrite != chunkSize) {
+            mxf_log_error("fwrite failed: %s\n", strerror(errno));
+            break;
+        }
+    }
+    sysData->streamPosition += totalWrite;
+
+    return totalWrite;
+}
+
 static int disk_file_getchar(MXFFileSysData *sysData)
 {
     int result = fgetc(sysData->file);
@@ -178,6 +303,10 @@ static int64_t disk_file_tell(MXFFileSysData *sysData)
 
 static int disk_file_is_seekable(MXFFileSysData *sysData)
 {
+    /* seeking is limited to the current position for streams, even if the wrapped standard stream is a file */
+    if (sysData->isStream)
+        return 0;
+
     if (!sysData->haveTestedIsSeekable)
     {
         sysData->isSeekable = (fseek(sysData->file, 0, SEEK_CUR) == 0);
@@ -211,168 +340,1616 @@ static int64_t disk_file_size(MXFFileSysData *sysData)
     return statBuf.st_size;
 }
 
+uint64_t mxf_get_time_ns(void)
+{
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000 +
+           (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000 / frequency.QuadPart;
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+#if !defined(_WIN32)
+static uint64_t disk_file_writev(MXFFileSysData *sysData, const MXFIOVec *iov, int iovcnt)
+{
+    struct iovec vecs[WRITEV_BATCH_SIZE];
+    uint64_t totalWrite = 0;
+    int64_t position = 0;
+    ssize_t result;
+    size_t done;
+    int fileId;
+    int count;
+    int i;
+
+    /* write the stdio buffered data first and then write directly to the descriptor */
+    if (!sysData->isStream) {
+        if ((position = ftello(sysData->file)) < 0)
+            return 0;
+    }
+    if (fflush(sysData->file) != 0) {
+        mxf_log_error("fflush failed: %s\n", strerror(errno));
+        return 0;
+    }
+    fileId = fileno(sysData->file);
+    if (!sysData->isStream && lseek(fileId, position, SEEK_SET) != position) {
+        mxf_log_error("lseek failed: %s\n", strerror(errno));
+        return 0;
+    }
+
+    while (iovcnt > 0) {
+        count = (iovcnt > WRITEV_BATCH_SIZE ? WRITEV_BATCH_SIZE : iovcnt);
+        for (i = 0; i < count; i++) {
+            vecs[i].iov_base = (void*)iov[i].data;
+            vecs[i].iov_len  = iov[i].size;
+        }
+
+        i = 0;
+        while (i < count) {
+            result = writev(fileId, &vecs[i], count - i);
+            if (result < 0) {
+                if (errno == EINTR)
+                    continue;
+                mxf_log_error("writev failed: %s\n", strerror(errno));
+                break;
+            }
+            totalWrite += result;
+
+            /* skip the buffers that were completely written after a partial write */
+            done = (size_t)result;
+            while (i < count && done >= vecs[i].iov_len) {
+                done -= vecs[i].iov_len;
+                i++;
+            }
+            if (i < count) {
+                vecs[i].iov_base = (uint8_t*)vecs[i].iov_base + done;
+                vecs[i].iov_len -= done;
+            }
+        }
+        if (i < count)
+            break;
+
+        iov    += count;
+        iovcnt -= count;
+    }
+
+    /* set the stdio stream position to the end of the written data */
+    if (sysData->isStream)
+        sysData->streamPosition += totalWrite;
+    else if (fseeko(sysData->file, position + totalWrite, SEEK_SET) != 0)
+        mxf_log_error("fseeko failed: %s\n", strerror(errno));
+
+    return totalWrite;
+}
+
+static int disk_file_get_fd(MXFFileSysData *sysData)
+{
+    int64_t position;
+    int fileId;
+
+    if (sysData->isStream)
+        return -1;
+
+    if ((position = ftello(sysData->file)) < 0)
+        return -1;
+    if (fflush(sysData->file) != 0) {
+        mxf_log_error("fflush failed: %s\n", strerror(errno));
+        return -1;
+    }
+    fileId = fileno(sysData->file);
+    if (lseek(fileId, position, SEEK_SET) != position) {
+        mxf_log_error("lseek failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    return fileId;
+}
+
+int mxf_fd_advise(int fileId, int64_t offset, int64_t len, MXFFileAdvice advice)
+{
+#if defined(HAVE_POSIX_FADVISE)
+    int posixAdvice;
+    int result;
+
+#if defined(__linux__)
+    /* readahead populates the page cache for the range without the size limit that applies to the hint */
+    if (advice == MXF_ADVISE_WILLNEED && len > 0)
+        return readahead(fileId, offset, (size_t)len) == 0;
+#endif
+
+    switch (advice)
+    {
+        case MXF_ADVISE_SEQUENTIAL: posixAdvice = POSIX_FADV_SEQUENTIAL; break;
+        case MXF_ADVISE_RANDOM:     posixAdvice = POSIX_FADV_RANDOM;     break;
+        case MXF_ADVISE_WILLNEED:   posixAdvice = POSIX_FADV_WILLNEED;   break;
+        case MXF_ADVISE_DONTNEED:   posixAdvice = POSIX_FADV_DONTNEED;   break;
+        case MXF_ADVISE_NORMAL:
+        default:                    posixAdvice = POSIX_FADV_NORMAL;     break;
+    }
+
+    result = posix_fadvise(fileId, offset, len, posixAdvice);
+    if (result != 0) {
+        mxf_log_warn("posix_fadvise failed: %s\n", strerror(result));
+        return 0;
+    }
+#else
+    (void)fileId;
+    (void)offset;
+    (void)len;
+    (void)advice;
+#endif
+
+    return 1;
+}
+
+static int fd_preallocate(int fileId, int64_t offset, int64_t len)
+{
+#if defined(HAVE_FALLOCATE)
+    /* the size is kept so that the file size and end of file are still set by the data written */
+    if (fallocate(fileId, FALLOC_FL_KEEP_SIZE, offset, len) != 0) {
+        if (errno == EOPNOTSUPP || errno == ENOSYS)
+            return 1;
+        mxf_log_warn("fallocate failed: %s\n", strerror(errno));
+        return 0;
+    }
+#else
+    (void)fileId;
+    (void)offset;
+    (void)len;
+#endif
+
+    return 1;
+}
+
+static int disk_file_advise(MXFFileSysData *sysData, int64_t offset, int64_t len, MXFFileAdvice advice)
+{
+    if (sysData->isStream)
+        return 1;
+
+    /* dirty stdio data is not in the page cache yet and would be unaffected by DONTNEED */
+    if (advice == MXF_ADVISE_DONTNEED && fflush(sysData->file) != 0)
+        return 0;
+
+    return mxf_fd_advise(fileno(sysData->file), offset, len, advice);
+}
+
+static int disk_file_preallocate(MXFFileSysData *sysData, int64_t offset, int64_t len)
+{
+    if (sysData->isStream)
+        return 1;
+
+    if (offset + len > sysData->preallocEnd)
+        sysData->preallocEnd = offset + len;
+
+    return fd_preallocate(fileno(sysData->file), offset, len);
+}
+#endif
+
 static void free_disk_file(MXFFileSysData *sysData)
 {
     free(sysData);
 }
 
 
-static void assign_file_struct(MXFFile *mxfFile, MXFFileSysData *sysData)
+
+#if !defined(_WIN32)
+
+static void mmap_file_close(MXFFileSysData *sysData)
 {
-    mxfFile->close         = disk_file_close;
-    mxfFile->read          = disk_file_read;
-    mxfFile->write         = disk_file_write;
-    mxfFile->get_char      = disk_file_getchar;
-    mxfFile->put_char      = disk_file_putchar;
-    mxfFile->eof           = disk_file_eof;
-    mxfFile->seek          = disk_file_seek;
-    mxfFile->tell          = disk_file_tell;
-    mxfFile->is_seekable   = disk_file_is_seekable;
-    mxfFile->size          = disk_file_size;
+    if (sysData->mapData)
+        munmap((void*)sysData->mapData, (size_t)sysData->mapSize);
+    sysData->mapData = NULL;
+    sysData->mapSize = 0;
+}
 
-    mxfFile->free_sys_data = free_disk_file;
-    mxfFile->sysData       = sysData;
+static uint32_t mmap_file_read_view(MXFFileSysData *sysData, const uint8_t **data, uint32_t count)
+{
+    uint32_t numRead;
+
+    if (sysData->mapPosition >= sysData->mapSize) {
+        sysData->mapEOF = (count > 0);
+        return 0;
+    }
+
+    if (count > sysData->mapSize - sysData->mapPosition) {
+        numRead = (uint32_t)(sysData->mapSize - sysData->mapPosition);
+        sysData->mapEOF = 1;
+    } else {
+        numRead = count;
+    }
+
+    *data = &sysData->mapData[sysData->mapPosition];
+    sysData->mapPosition += numRead;
+
+    return numRead;
 }
 
-static int disk_file_open(const char *filename, OpenMode mode, MXFFile **mxfFile)
+static uint32_t mmap_file_read(MXFFileSysData *sysData, uint8_t *data, uint32_t count)
 {
-    MXFFile *newMXFFile = NULL;
-    MXFFileSysData *newDiskFile = NULL;
+    const uint8_t *viewData;
+    uint32_t numRead;
 
-    CHK_MALLOC_ORET(newMXFFile, MXFFile);
-    memset(newMXFFile, 0, sizeof(MXFFile));
-    CHK_MALLOC_OFAIL(newDiskFile, MXFFileSysData);
-    memset(newDiskFile, 0, sizeof(MXFFileSysData));
+    numRead = mmap_file_read_view(sysData, &viewData, count);
+    if (numRead > 0)
+        memcpy(data, viewData, numRead);
 
-    switch (mode)
+    return numRead;
+}
+
+static uint64_t mmap_file_read_64(MXFFileSysData *sysData, uint8_t *data, uint64_t count)
+{
+    uint64_t numRead;
+
+    if (sysData->mapPosition >= sysData->mapSize) {
+        sysData->mapEOF = (count > 0);
+        return 0;
+    }
+
+    if (count > (uint64_t)(sysData->mapSize - sysData->mapPosition)) {
+        numRead = sysData->mapSize - sysData->mapPosition;
+        sysData->mapEOF = 1;
+    } else {
+        numRead = count;
+    }
+
+    memcpy(data, &sysData->mapData[sysData->mapPosition], (size_t)numRead);
+    sysData->mapPosition += numRead;
+
+    return numRead;
+}
+
+static uint32_t mmap_file_write(MXFFileSysData *sysData, const uint8_t *data, uint32_t count)
+{
+    (void)sysData;
+    (void)data;
+    (void)count;
+
+    mxf_log_error("Cannot write to a read-only memory mapped file\n");
+    return 0;
+}
+
+static int mmap_file_getchar(MXFFileSysData *sysData)
+{
+    if (sysData->mapPosition >= sysData->mapSize) {
+        sysData->mapEOF = 1;
+        return EOF;
+    }
+
+    return sysData->mapData[sysData->mapPosition++];
+}
+
+static int mmap_file_putchar(MXFFileSysData *sysData, int c)
+{
+    (void)sysData;
+    (void)c;
+
+    return EOF;
+}
+
+static int mmap_file_eof(MXFFileSysData *sysData)
+{
+    return sysData->mapEOF;
+}
+
+static int mmap_file_seek(MXFFileSysData *sysData, int64_t offset, int whence)
+{
+    int64_t position;
+
+    switch (whence)
     {
-        case NEW_MODE:
-            newDiskFile->file = fopen(filename, "w+b");
+        case SEEK_SET:
+            position = offset;
             break;
-        case READ_MODE:
-            newDiskFile->file = fopen(filename, "rb");
+        case SEEK_CUR:
+            position = sysData->mapPosition + offset;
             break;
-        case MODIFY_MODE:
-            newDiskFile->file = fopen(filename, "r+b");
+        case SEEK_END:
+            position = sysData->mapSize + offset;
             break;
+        default:
+            return 0;
+    }
+    if (position < 0)
+        return 0;
+
+    sysData->mapPosition = position;
+    sysData->mapEOF      = 0;
+
+    return 1;
+}
+
+static int64_t mmap_file_tell(MXFFileSysData *sysData)
+{
+    return sysData->mapPosition;
+}
 
+static int mmap_file_is_seekable(MXFFileSysData *sysData)
+{
+    (void)sysData;
+
+    return 1;
+}
+
+static int64_t mmap_file_size(MXFFileSysData *sysData)
+{
+    return sysData->mapSize;
+}
+
+static int mmap_file_advise(MXFFileSysData *sysData, int64_t offset, int64_t len, MXFFileAdvice advice)
+{
+    uint32_t pageSize = mxf_get_system_page_size();
+    int64_t start;
+    int64_t end;
+    int madvice;
+
+    if (offset >= sysData->mapSize || pageSize == 0)
+        return 1;
+
+    /* madvise requires a page aligned address */
+    start = offset - (offset % pageSize);
+    if (len == 0 || offset + len > sysData->mapSize)
+        end = sysData->mapSize;
+    else
+        end = offset + len;
+
+    switch (advice)
+    {
+        case MXF_ADVISE_SEQUENTIAL: madvice = MADV_SEQUENTIAL; break;
+        case MXF_ADVISE_RANDOM:     madvice = MADV_RANDOM;     break;
+        case MXF_ADVISE_WILLNEED:   madvice = MADV_WILLNEED;   break;
+        case MXF_ADVISE_DONTNEED:   madvice = MADV_DONTNEED;   break;
+        case MXF_ADVISE_NORMAL:
+        default:                    madvice = MADV_NORMAL;     break;
     }
-    if (!newDiskFile->file)
-        goto fail;
 
-#if defined(_WIN32)
-    newDiskFile->isStream = check_file_is_stream(_fileno(newDiskFile->file));
-#else
-    newDiskFile->isStream = check_file_is_stream(fileno(newDiskFile->file));
-#endif
-    newDiskFile->mode = mode;
-    assign_file_struct(newMXFFile, newDiskFile);
+    if (madvise((void*)(sysData->mapData + start), (size_t)(end - start), madvice) != 0) {
+        mxf_log_warn("madvise failed: %s\n", strerror(errno));
+        return 0;
+    }
+
+    return 1;
+}
+
+
+static int direct_file_flush(MXFFileSysData *sysData)
+{
+    uint32_t start;
+    uint32_t end;
+    ssize_t result;
+
+    if (sysData->directDirtyEnd <= sysData->directDirtyStart)
+        return 1;
+
+    /* O_DIRECT transfers are whole aligned blocks, so the partial block at the end of the file is padded
+       with zeros. The padding is removed when the file is closed */
+    start = sysData->directDirtyStart - sysData->directDirtyStart % sysData->directAlignment;
+    end   = (sysData->directDirtyEnd + sysData->directAlignment - 1) & ~(sysData->directAlignment - 1);
+    if (sysData->directValidEnd < end)
+        memset(&sysData->directBuffer[sysData->directValidEnd], 0, end - sysData->directValidEnd);
+
+    while (start < end) {
+        result = pwrite(sysData->fileId, &sysData->directBuffer[start], end - start,
+                        sysData->directBufferOffset + start);
+        if (result < 0) {
+            if (errno == EINTR)
+                continue;
+            mxf_log_error("pwrite failed: %s\n", strerror(errno));
+            return 0;
+        }
+        start += (uint32_t)result;
+    }
+
+    sysData->directDirtyStart = 0;
+    sysData->directDirtyEnd   = 0;
 
-    *mxfFile = newMXFFile;
     return 1;
+}
+
+static int direct_file_load(MXFFileSysData *sysData, int64_t position)
+{
+    int64_t offset = position - position % sysData->directBufferSize;
+    uint32_t numRead = 0;
+    ssize_t result;
+
+    if (sysData->directBufferOffset == offset)
+        return 1;
+
+    CHK_ORET(direct_file_flush(sysData));
+
+    sysData->directBufferOffset = -1;
+    sysData->directValidEnd     = 0;
+
+    /* a buffer that starts at or beyond the end of the file is written without reading it first */
+    while (offset + numRead < sysData->directFileSize && numRead < sysData->directBufferSize) {
+        result = pread(sysData->fileId, &sysData->directBuffer[numRead], sysData->directBufferSize - numRead,
+                       offset + numRead);
+        if (result < 0) {
+            if (errno == EINTR)
+                continue;
+            mxf_log_error("pread failed: %s\n", strerror(errno));
+            return 0;
+        } else if (result == 0) {
+            break;
+        }
+        numRead += (uint32_t)result;
+    }
+
+    sysData->directBufferOffset = offset;
+    sysData->directValidEnd     = numRead;
+
+    return 1;
+}
+
+static int direct_file_preallocate(MXFFileSysData *sysData, int64_t offset, int64_t len)
+{
+    return fd_preallocate(sysData->fileId, offset, len);
+}
+
+static void direct_file_close(MXFFileSysData *sysData)
+{
+    if (sysData->fileId >= 0) {
+        if (sysData->mode != READ_MODE) {
+            if (!direct_file_flush(sysData))
+                mxf_log_error("Failed to flush direct I/O file buffer\n");
+            if (ftruncate(sysData->fileId, sysData->directFileSize) != 0)
+                mxf_log_error("Failed to truncate direct I/O file: %s\n", strerror(errno));
+        }
+        close(sysData->fileId);
+        sysData->fileId = -1;
+    }
+
+    SAFE_FREE(sysData->directAllocBuffer);
+    sysData->directBuffer = NULL;
+}
+
+static uint32_t direct_file_read(MXFFileSysData *sysData, uint8_t *data, uint32_t count)
+{
+    uint32_t totalRead = 0;
+    uint32_t bufferPos;
+    uint32_t numRead;
+
+    while (totalRead < count) {
+        if (sysData->directPosition >= sysData->directFileSize) {
+            sysData->directEOF = 1;
+            break;
+        }
+        if (!direct_file_load(sysData, sysData->directPosition))
+            break;
+
+        bufferPos = (uint32_t)(sysData->directPosition - sysData->directBufferOffset);
+        numRead = sysData->directBufferSize - bufferPos;
+        if (numRead > count - totalRead)
+            numRead = count - totalRead;
+        if (numRead > sysData->directFileSize - sysData->directPosition)
+            numRead = (uint32_t)(sysData->directFileSize - sysData->directPosition);
+
+        memcpy(&data[totalRead], &sysData->directBuffer[bufferPos], numRead);
+        totalRead += numRead;
+        sysData->directPosition += numRead;
+    }
+
+    return totalRead;
+}
+
+static uint32_t direct_file_write(MXFFileSysData *sysData, const uint8_t *data, uint32_t count)
+{
+    uint32_t totalWrite = 0;
+    uint32_t bufferPos;
+    uint32_t numWrite;
+
+    if (sysData->mode == READ_MODE)
+        return 0;
+
+    while (totalWrite < count) {
+        if (!direct_file_load(sysData, sysData->directPosition))
+            break;
+
+        bufferPos = (uint32_t)(sysData->directPosition - sysData->directBufferOffset);
+        numWrite = sysData->directBufferSize - bufferPos;
+        if (numWrite > count - totalWrite)
+            numWrite = count - totalWrite;
+
+        /* zero the gap left by seeking beyond the end of the file */
+        if (bufferPos > sysData->directValidEnd)
+            memset(&sysData->directBuffer[sysData->directValidEnd], 0, bufferPos - sysData->directValidEnd);
+
+        memcpy(&sysData->directBuffer[bufferPos], &data[totalWrite], numWrite);
+        if (sysData->directDirtyEnd <= sysData->directDirtyStart) {
+            sysData->directDirtyStart = bufferPos;
+            sysData->directDirtyEnd   = bufferPos + numWrite;
+        } else {
+            if (bufferPos < sysData->directDirtyStart)
+                sysData->directDirtyStart = bufferPos;
+            if (bufferPos + numWrite > sysData->directDirtyEnd)
+                sysData->directDirtyEnd = bufferPos + numWrite;
+        }
+        if (bufferPos + numWrite > sysData->directValidEnd)
+            sysData->directValidEnd = bufferPos + numWrite;
+
+        totalWrite += numWrite;
+        sysData->directPosition += numWrite;
+        if (sysData->directPosition > sysData->directFileSize)
+            sysData->directFileSize = sysData->directPosition;
+
+        /* write a full buffer immediately rather than when the next buffer is loaded */
+        if (sysData->directDirtyStart == 0 && sysData->directDirtyEnd == sysData->directBufferSize &&
+            !direct_file_flush(sysData))
+        {
+            break;
+        }
+    }
+
+    return totalWrite;
+}
+
+static int direct_file_getchar(MXFFileSysData *sysData)
+{
+    uint8_t data;
+    if (direct_file_read(sysData, &data, 1) != 1)
+        return EOF;
+
+    return data;
+}
+
+static int direct_file_putchar(MXFFileSysData *sysData, int c)
+{
+    uint8_t data = (uint8_t)c;
+    if (direct_file_write(sysData, &data, 1) != 1)
+        return EOF;
+
+    return data;
+}
+
+static int direct_file_eof(MXFFileSysData *sysData)
+{
+    return sysData->directEOF;
+}
+
+static int direct_file_seek(MXFFileSysData *sysData, int64_t offset, int whence)
+{
+    int64_t position;
+
+    switch (whence)
+    {
+        case SEEK_SET:
+            position = offset;
+            break;
+        case SEEK_CUR:
+            position = sysData->directPosition + offset;
+            break;
+        case SEEK_END:
+            position = sysData->directFileSize + offset;
+            break;
+        default:
+            return 0;
+    }
+    if (position < 0)
+        return 0;
+
+    sysData->directPosition = position;
+    sysData->directEOF      = 0;
+
+    return 1;
+}
+
+static int64_t direct_file_tell(MXFFileSysData *sysData)
+{
+    return sysData->directPosition;
+}
+
+static int direct_file_is_seekable(MXFFileSysData *sysData)
+{
+    (void)sysData;
+
+    return 1;
+}
+
+static int64_t direct_file_size(MXFFileSysData *sysData)
+{
+    return sysData->directFileSize;
+}
+
+static int direct_file_open(const char *filename, OpenMode mode, uint32_t bufferSize, MXFFile **mxfFile)
+{
+    MXFFile *newMXFFile = NULL;
+    MXFFileSysData *newDirectFile = NULL;
+    struct stat statBuf;
+    uint32_t alignment;
+    int flags;
+
+    assert(mode == NEW_MODE || mode == MODIFY_MODE);
+
+    /* the system page size is a multiple of the logical block size of the storage devices */
+    alignment = mxf_get_system_page_size();
+    CHK_ORET(alignment > 0);
+    if (bufferSize == 0)
+        bufferSize = DEFAULT_DIRECT_BUFFER_SIZE;
+    bufferSize = (bufferSize + alignment - 1) & ~(alignment - 1);
+
+    CHK_MALLOC_ORET(newMXFFile, MXFFile);
+    memset(newMXFFile, 0, sizeof(MXFFile));
+    CHK_MALLOC_OFAIL(newDirectFile, MXFFileSysData);
+    memset(newDirectFile, 0, sizeof(MXFFileSysData));
+    newDirectFile->fileId = -1;
+
+    flags = O_RDWR;
+    if (mode == NEW_MODE)
+        flags |= O_CREAT | O_TRUNC;
+
+#if defined(O_DIRECT)
+    newDirectFile->fileId = open(filename, flags | O_DIRECT, 0666);
+    if (newDirectFile->fileId < 0 && errno == EINVAL) {
+        /* file systems such as tmpfs don't support O_DIRECT */
+        mxf_log_warn("O_DIRECT is not supported for file '%s'; using the page cache\n", filename);
+        newDirectFile->fileId = open(filename, flags, 0666);
+    }
+#else
+    newDirectFile->fileId = open(filename, flags, 0666);
+#if defined(F_NOCACHE)
+    if (newDirectFile->fileId >= 0)
+        fcntl(newDirectFile->fileId, F_NOCACHE, 1);
+#endif
+#endif
+    if (newDirectFile->fileId < 0)
+        goto fail;
+
+    if (fstat(newDirectFile->fileId, &statBuf) != 0) {
+        mxf_log_error("Failed to stat file '%s': %s\n", filename, strerror(errno));
+        goto fail;
+    }
+    if (!S_ISREG(statBuf.st_mode)) {
+        mxf_log_error("Direct I/O file '%s' is not a regular file\n", filename);
+        goto fail;
+    }
+
+    CHK_MALLOC_ARRAY_OFAIL(newDirectFile->directAllocBuffer, uint8_t, bufferSize + alignment);
+    newDirectFile->directBuffer = (uint8_t*)(((uintptr_t)newDirectFile->directAllocBuffer + alignment - 1) &
+                                             ~(uintptr_t)(alignment - 1));
+    newDirectFile->directBufferSize   = bufferSize;
+    newDirectFile->directAlignment    = alignment;
+    newDirectFile->directBufferOffset = -1;
+    newDirectFile->directFileSize     = statBuf.st_size;
+    newDirectFile->mode               = mode;
+
+    newMXFFile->close         = direct_file_close;
+    newMXFFile->read          = direct_file_read;
+    newMXFFile->write         = direct_file_write;
+    newMXFFile->get_char      = direct_file_getchar;
+    newMXFFile->put_char      = direct_file_putchar;
+    newMXFFile->eof           = direct_file_eof;
+    newMXFFile->seek          = direct_file_seek;
+    newMXFFile->tell          = direct_file_tell;
+    newMXFFile->is_seekable   = direct_file_is_seekable;
+    newMXFFile->size          = direct_file_size;
+    newMXFFile->preallocate   = direct_file_preallocate;
+
+    newMXFFile->free_sys_data = free_disk_file;
+    newMXFFile->sysData       = newDirectFile;
+
+    *mxfFile = newMXFFile;
+    return 1;
+
+fail:
+    if (newDirectFile) {
+        if (newDirectFile->fileId >= 0)
+            close(newDirectFile->fileId);
+        SAFE_FREE(newDirectFile->directAllocBuffer);
+    }
+    SAFE_FREE(newMXFFile);
+    SAFE_FREE(newDirectFile);
+    return 0;
+}
+
+
+
+/* positional files use pread and pwrite on a duplicated descriptor. The descriptor's shared file offset is never
+   used, allowing positional files and the file they were duplicated from to be used concurrently */
+
+static int pos_file_open(int fileId, OpenMode mode, int64_t position, MXFFile **mxfFile);
+
+static void pos_file_close(MXFFileSysData *sysData)
+{
+    if (sysData->fileId >= 0)
+        close(sysData->fileId);
+    sysData->fileId = -1;
+}
+
+static uint64_t pos_file_read_64(MXFFileSysData *sysData, uint8_t *data, uint64_t count)
+{
+    uint64_t totalRead = 0;
+    ssize_t result;
+
+    while (totalRead < count) {
+        result = pread(sysData->fileId, &data[totalRead],
+                       (size_t)(count - totalRead > MAX_IO_CHUNK_SIZE ? MAX_IO_CHUNK_SIZE : count - totalRead),
+                       (off_t)(sysData->posPosition + totalRead));
+        if (result < 0) {
+            if (errno == EINTR)
+                continue;
+            mxf_log_error("pread failed: %s\n", strerror(errno));
+            break;
+        }
+        if (result == 0) {
+            sysData->posEOF = 1;
+            break;
+        }
+        totalRead += result;
+    }
+    sysData->posPosition += totalRead;
+
+    return totalRead;
+}
+
+static uint64_t pos_file_write_64(MXFFileSysData *sysData, const uint8_t *data, uint64_t count)
+{
+    uint64_t totalWrite = 0;
+    ssize_t result;
+
+    while (totalWrite < count) {
+        result = pwrite(sysData->fileId, &data[totalWrite],
+                        (size_t)(count - totalWrite > MAX_IO_CHUNK_SIZE ? MAX_IO_CHUNK_SIZE : count - totalWrite),
+                        (off_t)(sysData->posPosition + totalWrite));
+        if (result < 0) {
+            if (errno == EINTR)
+                continue;
+            mxf_log_error("pwrite failed: %s\n", strerror(errno));
+            break;
+        }
+        totalWrite += result;
+    }
+    sysData->posPosition += totalWrite;
+
+    return totalWrite;
+}
+
+static uint32_t pos_file_read(MXFFileSysData *sysData, uint8_t *data, uint32_t count)
+{
+    return (uint32_t)pos_file_read_64(sysData, data, count);
+}
+
+static uint32_t pos_file_write(MXFFileSysData *sysData, const uint8_t *data, uint32_t count)
+{
+    return (uint32_t)pos_file_write_64(sysData, data, count);
+}
+
+static int pos_file_getchar(MXFFileSysData *sysData)
+{
+    uint8_t c;
+    if (pos_file_read_64(sysData, &c, 1) != 1)
+        return EOF;
+    return c;
+}
+
+static int pos_file_putchar(MXFFileSysData *sysData, int c)
+{
+    uint8_t value = (uint8_t)c;
+    if (pos_file_write_64(sysData, &value, 1) != 1)
+        return EOF;
+    return c;
+}
+
+static int pos_file_eof(MXFFileSysData *sysData)
+{
+    return sysData->posEOF;
+}
+
+static int64_t pos_file_size(MXFFileSysData *sysData)
+{
+    struct stat statBuf;
+    if (fstat(sysData->fileId, &statBuf) != 0)
+        return -1;
+
+    return statBuf.st_size;
+}
+
+static int pos_file_seek(MXFFileSysData *sysData, int64_t offset, int whence)
+{
+    int64_t position;
+    int64_t size;
+
+    if (whence == SEEK_SET) {
+        position = offset;
+    } else if (whence == SEEK_CUR) {
+        position = sysData->posPosition + offset;
+    } else {
+        size = pos_file_size(sysData);
+        if (size < 0)
+            return 0;
+        position = size + offset;
+    }
+    if (position < 0)
+        return 0;
+
+    sysData->posPosition = position;
+    sysData->posEOF = 0;
+    return 1;
+}
+
+static int64_t pos_file_tell(MXFFileSysData *sysData)
+{
+    return sysData->posPosition;
+}
+
+static int pos_file_is_seekable(MXFFileSysData *sysData)
+{
+    (void)sysData;
+    return 1;
+}
+
+static int pos_file_advise(MXFFileSysData *sysData, int64_t offset, int64_t len, MXFFileAdvice advice)
+{
+    return mxf_fd_advise(sysData->fileId, offset, len, advice);
+}
+
+static int pos_file_preallocate(MXFFileSysData *sysData, int64_t offset, int64_t len)
+{
+    return fd_preallocate(sysData->fileId, offset, len);
+}
+
+static int pos_file_dup(MXFFileSysData *sysData, MXFFile **dupFile)
+{
+    return pos_file_open(sysData->fileId, sysData->mode, sysData->posPosition, dupFile);
+}
+
+static int pos_file_open(int fileId, OpenMode mode, int64_t position, MXFFile **mxfFile)
+{
+    MXFFile *newMXFFile = NULL;
+    MXFFileSysData *newPosFile = NULL;
+
+    CHK_MALLOC_ORET(newMXFFile, MXFFile);
+    memset(newMXFFile, 0, sizeof(MXFFile));
+    CHK_MALLOC_OFAIL(newPosFile, MXFFileSysData);
+    memset(newPosFile, 0, sizeof(MXFFileSysData));
+
+    newPosFile->fileId = dup(fileId);
+    if (newPosFile->fileId < 0) {
+        mxf_log_error("Failed to duplicate file descriptor: %s\n", strerror(errno));
+        goto fail;
+    }
+    newPosFile->mode        = mode;
+    newPosFile->posPosition = position;
+
+    newMXFFile->close         = pos_file_close;
+    newMXFFile->read          = pos_file_read;
+    newMXFFile->write         = pos_file_write;
+    newMXFFile->get_char      = pos_file_getchar;
+    newMXFFile->put_char      = pos_file_putchar;
+    newMXFFile->eof           = pos_file_eof;
+    newMXFFile->seek          = pos_file_seek;
+    newMXFFile->tell          = pos_file_tell;
+    newMXFFile->is_seekable   = pos_file_is_seekable;
+    newMXFFile->size          = pos_file_size;
+    newMXFFile->read_64       = pos_file_read_64;
+    newMXFFile->write_64      = pos_file_write_64;
+    newMXFFile->advise        = pos_file_advise;
+    newMXFFile->preallocate   = pos_file_preallocate;
+    newMXFFile->dup           = pos_file_dup;
+
+    newMXFFile->free_sys_data = free_disk_file;
+    newMXFFile->sysData       = newPosFile;
+
+    *mxfFile = newMXFFile;
+    return 1;
+
+fail:
+    SAFE_FREE(newMXFFile);
+    SAFE_FREE(newPosFile);
+    return 0;
+}
+
+static int disk_file_dup(MXFFileSysData *sysData, MXFFile **dupFile)
+{
+    int64_t position;
+
+    if (sysData->isStream) {
+        mxf_log_error("Cannot duplicate a stream file\n");
+        return 0;
+    }
+
+    /* written data must be visible to the duplicate */
+    if ((position = ftello(sysData->file)) < 0)
+        return 0;
+    if (sysData->mode != READ_MODE && fflush(sysData->file) != 0) {
+        mxf_log_error("fflush failed: %s\n", strerror(errno));
+        return 0;
+    }
+
+    return pos_file_open(fileno(sysData->file), sysData->mode, position, dupFile);
+}
+
+#endif
+
+
+static void assign_file_struct(MXFFile *mxfFile, MXFFileSysData *sysData)
+{
+    mxfFile->close         = disk_file_close;
+    mxfFile->read          = disk_file_read;
+    mxfFile->write         = disk_file_write;
+    mxfFile->get_char      = disk_file_getchar;
+    mxfFile->put_char      = disk_file_putchar;
+    mxfFile->eof           = disk_file_eof;
+    mxfFile->seek          = disk_file_seek;
+    mxfFile->tell          = disk_file_tell;
+    mxfFile->is_seekable   = disk_file_is_seekable;
+    mxfFile->size          = disk_file_size;
+    mxfFile->read_64       = disk_file_read_64;
+    mxfFile->write_64      = disk_file_write_64;
+#if !defined(_WIN32)
+    mxfFile->writev        = disk_file_writev;
+    mxfFile->get_fd        = disk_file_get_fd;
+    mxfFile->advise        = disk_file_advise;
+    mxfFile->preallocate   = disk_file_preallocate;
+    mxfFile->dup           = disk_file_dup;
+#endif
+
+    mxfFile->free_sys_data = free_disk_file;
+    mxfFile->sysData       = sysData;
+}
+
+static int disk_file_open(const char *filename, OpenMode mode, MXFFile **mxfFile)
+{
+    MXFFile *newMXFFile = NULL;
+    MXFFileSysData *newDiskFile = NULL;
+
+    CHK_MALLOC_ORET(newMXFFile, MXFFile);
+    memset(newMXFFile, 0, sizeof(MXFFile));
+    CHK_MALLOC_OFAIL(newDiskFile, MXFFileSysData);
+    memset(newDiskFile, 0, sizeof(MXFFileSysData));
+
+    switch (mode)
+    {
+        case NEW_MODE:
+            newDiskFile->file = fopen(filename, "w+b");
+            break;
+        case READ_MODE:
+            newDiskFile->file = fopen(filename, "rb");
+            break;
+        case MODIFY_MODE:
+            newDiskFile->file = fopen(filename, "r+b");
+            break;
+
+    }
+    if (!newDiskFile->file)
+        goto fail;
+
+#if defined(_WIN32)
+    newDiskFile->isStream = check_file_is_stream(_fileno(newDiskFile->file));
+#else
+    newDiskFile->isStream = check_file_is_stream(fileno(newDiskFile->file));
+#endif
+    newDiskFile->mode = mode;
+    assign_file_struct(newMXFFile, newDiskFile);
+
+    *mxfFile = newMXFFile;
+    return 1;
+
+fail:
+    SAFE_FREE(newMXFFile);
+    SAFE_FREE(newDiskFile);
+    return 0;
+}
+
+
+int mxf_disk_file_open_new(const char *filename, MXFFile **mxfFile)
+{
+    return disk_file_open(filename, NEW_MODE, mxfFile);
+}
+
+int mxf_disk_file_open_read(const char *filename, MXFFile **mxfFile)
+{
+    return disk_file_open(filename, READ_MODE, mxfFile);
+}
+
+int mxf_disk_file_open_modify(const char *filename, MXFFile **mxfFile)
+{
+    return disk_file_open(filename, MODIFY_MODE, mxfFile);
+}
+
+
+int mxf_disk_file_open_new_direct(const char *filename, uint32_t bufferSize, MXFFile **mxfFile)
+{
+#if defined(_WIN32)
+    (void)bufferSize;
+    (void)mxfFile;
+
+    mxf_log_error("Direct I/O MXF file '%s' is not supported on this platform\n", filename);
+    return 0;
+#else
+    return direct_file_open(filename, NEW_MODE, bufferSize, mxfFile);
+#endif
+}
+
+int mxf_disk_file_open_modify_direct(const char *filename, uint32_t bufferSize, MXFFile **mxfFile)
+{
+#if defined(_WIN32)
+    (void)bufferSize;
+    (void)mxfFile;
+
+    mxf_log_error("Direct I/O MXF file '%s' is not supported on this platform\n", filename);
+    return 0;
+#else
+    return direct_file_open(filename, MODIFY_MODE, bufferSize, mxfFile);
+#endif
+}
+
+int mxf_mmap_file_open_read(const char *filename, MXFFile **mxfFile)
+{
+#if defined(_WIN32)
+    (void)mxfFile;
+
+    mxf_log_error("Memory mapped MXF file '%s' is not supported on this platform\n", filename);
+    return 0;
+#else
+    MXFFile *newMXFFile = NULL;
+    MXFFileSysData *newMMapFile = NULL;
+    struct stat statBuf;
+    void *mapData;
+    int fileId;
+
+    if ((fileId = open(filename, O_RDONLY)) == -1)
+        return 0;
+
+    if (fstat(fileId, &statBuf) != 0) {
+        mxf_log_error("Failed to stat file '%s': %s\n", filename, strerror(errno));
+        close(fileId);
+        return 0;
+    }
+    if ((uint64_t)statBuf.st_size > (size_t)(-1)) {
+        mxf_log_error("File '%s' is too large to be memory mapped\n", filename);
+        close(fileId);
+        return 0;
+    }
+
+    /* a zero length mapping is not allowed */
+    mapData = NULL;
+    if (statBuf.st_size > 0) {
+        mapData = mmap(NULL, (size_t)statBuf.st_size, PROT_READ, MAP_SHARED, fileId, 0);
+        if (mapData == MAP_FAILED) {
+            mxf_log_error("Failed to memory map file '%s': %s\n", filename, strerror(errno));
+            close(fileId);
+            return 0;
+        }
+    }
+
+    /* the mapping remains valid after the file descriptor is closed */
+    close(fileId);
+
+    CHK_MALLOC_OFAIL(newMXFFile, MXFFile);
+    memset(newMXFFile, 0, sizeof(MXFFile));
+    CHK_MALLOC_OFAIL(newMMapFile, MXFFileSysData);
+    memset(newMMapFile, 0, sizeof(MXFFileSysData));
+
+    newMMapFile->mapData = (const uint8_t*)mapData;
+    newMMapFile->mapSize = statBuf.st_size;
+    newMMapFile->mode    = READ_MODE;
+
+    newMXFFile->close         = mmap_file_close;
+    newMXFFile->read          = mmap_file_read;
+    newMXFFile->write         = mmap_file_write;
+    newMXFFile->get_char      = mmap_file_getchar;
+    newMXFFile->put_char      = mmap_file_putchar;
+    newMXFFile->eof           = mmap_file_eof;
+    newMXFFile->seek          = mmap_file_seek;
+    newMXFFile->tell          = mmap_file_tell;
+    newMXFFile->is_seekable   = mmap_file_is_seekable;
+    newMXFFile->size          = mmap_file_size;
+    newMXFFile->read_view     = mmap_file_read_view;
+    newMXFFile->read_64       = mmap_file_read_64;
+    newMXFFile->advise        = mmap_file_advise;
+
+    newMXFFile->free_sys_data = free_disk_file;
+    newMXFFile->sysData       = newMMapFile;
+
+    *mxfFile = newMXFFile;
+    return 1;
+
+fail:
+    if (mapData)
+        munmap(mapData, (size_t)statBuf.st_size);
+    SAFE_FREE(newMXFFile);
+    SAFE_FREE(newMMapFile);
+    return 0;
+#endif
+}
+
+int mxf_stdin_wrap_read(MXFFile **mxfFile)
+{
+    MXFFile *newMXFFile = NULL;
+    MXFFileSysData *newStdInFile = NULL;
+
+    CHK_MALLOC_ORET(newMXFFile, MXFFile);
+    memset(newMXFFile, 0, sizeof(MXFFile));
+    CHK_MALLOC_OFAIL(newStdInFile, MXFFileSysData);
+    memset(newStdInFile, 0, sizeof(MXFFileSysData));
+
+    newStdInFile->file     = stdin;
+    newStdInFile->isStream = 1;
+    assign_file_struct(newMXFFile, newStdInFile);
+
+    *mxfFile = newMXFFile;
+    return 1;
+
+fail:
+    SAFE_FREE(newMXFFile);
+    SAFE_FREE(newStdInFile);
+    return 0;
+}
+
+int mxf_stdout_wrap_write(MXFFile **mxfFile)
+{
+    MXFFile *newMXFFile = NULL;
+    MXFFileSysData *newStdOutFile = NULL;
+
+    CHK_MALLOC_ORET(newMXFFile, MXFFile);
+    memset(newMXFFile, 0, sizeof(MXFFile));
+    CHK_MALLOC_OFAIL(newStdOutFile, MXFFileSysData);
+    memset(newStdOutFile, 0, sizeof(MXFFileSysData));
+
+    newStdOutFile->file     = stdout;
+    newStdOutFile->mode     = NEW_MODE;
+    newStdOutFile->isStream = 1;
+    assign_file_struct(newMXFFile, newStdOutFile);
+
+    *mxfFile = newMXFFile;
+    return 1;
+
+fail:
+    SAFE_FREE(newMXFFile);
+    SAFE_FREE(newStdOutFile);
+    return 0;
+}
+
+
+
+void mxf_file_close(MXFFile **mxfFile)
+{
+    mxf_file_close_2(mxfFile, free);
+}
+
+void mxf_file_close_2(MXFFile **mxfFile, void (*free_func)(void*))
+{
+    if (!(*mxfFile))
+        return;
+
+    free((*mxfFile)->zerosBuffer);
+    free((*mxfFile)->readAheadBuffer);
+
+    if ((*mxfFile)->sysData) {
+        (*mxfFile)->close((*mxfFile)->sysData);
+        if ((*mxfFile)->free_sys_data)
+            (*mxfFile)->free_sys_data((*mxfFile)->sysData);
+    }
+
+    free_func(*mxfFile);
+    *mxfFile = NULL;
+}
+
+static void reset_read_ahead(MXFFile *mxfFile)
+{
+    mxfFile->readAheadPos    = 0;
+    mxfFile->readAheadEnd    = 0;
+    mxfFile->readAheadOffset = 0;
+    mxfFile->readAheadEOF    = 0;
+}
+
+static int drop_read_ahead(MXFFile *mxfFile)
+{
+    /* position the file at the logical position before bypassing the window */
+    if (mxfFile->readAheadEnd > 0) {
+        int64_t position = mxfFile->readAheadOffset + mxfFile->readAheadPos;
+        reset_read_ahead(mxfFile);
+        return mxfFile->seek(mxfFile->sysData, position, SEEK_SET);
+    }
+
+    mxfFile->readAheadEOF = 0;
+    return 1;
+}
+
+static uint32_t fill_read_ahead(MXFFile *mxfFile)
+{
+    uint32_t remainder = mxfFile->readAheadEnd - mxfFile->readAheadPos;
+    uint32_t numRead;
+
+    if (mxfFile->readAheadEnd == 0) {
+        mxfFile->readAheadOffset = mxfFile->tell(mxfFile->sysData);
+    } else if (mxfFile->readAheadPos > 0) {
+        memmove(mxfFile->readAheadBuffer, &mxfFile->readAheadBuffer[mxfFile->readAheadPos], remainder);
+        mxfFile->readAheadOffset += mxfFile->readAheadPos;
+    }
+    mxfFile->readAheadPos = 0;
+    mxfFile->readAheadEnd = remainder;
+
+    numRead = mxfFile->read(mxfFile->sysData, &mxfFile->readAheadBuffer[remainder],
+                            mxfFile->readAheadSize - remainder);
+    mxfFile->readAheadEnd += numRead;
+    if (mxfFile->readAheadEnd == 0)
+        mxfFile->readAheadOffset = 0;
+
+    return numRead;
+}
+
+uint32_t mxf_file_read(MXFFile *mxfFile, uint8_t *data, uint32_t count)
+{
+    uint32_t totalRead = 0;
+    uint32_t numRead;
+
+    if (!mxfFile->readAheadBuffer)
+        return mxfFile->read(mxfFile->sysData, data, count);
+
+    while (totalRead < count) {
+        numRead = mxfFile->readAheadEnd - mxfFile->readAheadPos;
+        if (numRead > 0) {
+            if (numRead > count - totalRead)
+                numRead = count - totalRead;
+            memcpy(&data[totalRead], &mxfFile->readAheadBuffer[mxfFile->readAheadPos], numRead);
+            mxfFile->readAheadPos += numRead;
+            totalRead += numRead;
+        } else if (count - totalRead >= mxfFile->readAheadSize) {
+            /* large reads bypass the window */
+            reset_read_ahead(mxfFile);
+            totalRead += mxfFile->read(mxfFile->sysData, &data[totalRead], count - totalRead);
+            break;
+        } else {
+            mxfFile->readAheadPos = 0;
+            mxfFile->readAheadEnd = 0;
+            if (fill_read_ahead(mxfFile) == 0)
+                break;
+        }
+    }
+
+    mxfFile->readAheadEOF = (count > 0 && totalRead < count);
+
+    return totalRead;
+}
+
+uint32_t mxf_file_write(MXFFile *mxfFile, const uint8_t *data, uint32_t count)
+{
+    if (mxfFile->readAheadBuffer && !drop_read_ahead(mxfFile))
+        return 0;
+
+    return mxfFile->write(mxfFile->sysData, data, count);
+}
+
+uint64_t mxf_file_read_64(MXFFile *mxfFile, uint8_t *data, uint64_t count)
+{
+    uint64_t totalRead = 0;
+    uint32_t numRead;
+    uint32_t chunkSize;
+
+    if (count <= UINT32_MAX)
+        return mxf_file_read(mxfFile, data, (uint32_t)count);
+
+    /* take the remainder of the read-ahead window and bypass it for the rest */
+    if (mxfFile->readAheadBuffer) {
+        totalRead = mxfFile->readAheadEnd - mxfFile->readAheadPos;
+        if (totalRead > 0)
+            memcpy(data, &mxfFile->readAheadBuffer[mxfFile->readAheadPos], (size_t)totalRead);
+        reset_read_ahead(mxfFile);
+    }
+
+    if (mxfFile->read_64) {
+        totalRead += mxfFile->read_64(mxfFile->sysData, &data[totalRead], count - totalRead);
+    } else {
+        while (totalRead < count) {
+            chunkSize = (count - totalRead > MAX_IO_CHUNK_SIZE ? MAX_IO_CHUNK_SIZE : (uint32_t)(count - totalRead));
+            numRead = mxfFile->read(mxfFile->sysData, &data[totalRead], chunkSize);
+            totalRead += numRead;
+            if (numRead != chunkSize)
+                break;
+        }
+    }
 
-fail:
-    SAFE_FREE(newMXFFile);
-    SAFE_FREE(newDiskFile);
-    return 0;
-}
+    if (mxfFile->readAheadBuffer)
+        mxfFile->readAheadEOF = (totalRead < count);
 
+    return totalRead;
+}
 
-int mxf_disk_file_open_new(const char *filename, MXFFile **mxfFile)
+uint64_t mxf_file_write_64(MXFFile *mxfFile, const uint8_t *data, uint64_t count)
 {
-    return disk_file_open(filename, NEW_MODE, mxfFile);
+    uint64_t totalWrite = 0;
+    uint32_t numWrite;
+    uint32_t chunkSize;
+
+    if (count <= UINT32_MAX)
+        return mxf_file_write(mxfFile, data, (uint32_t)count);
+
+    if (mxfFile->readAheadBuffer && !drop_read_ahead(mxfFile))
+        return 0;
+
+    if (mxfFile->write_64)
+        return mxfFile->write_64(mxfFile->sysData, data, count);
+
+    while (totalWrite < count) {
+        chunkSize = (count - totalWrite > MAX_IO_CHUNK_SIZE ? MAX_IO_CHUNK_SIZE : (uint32_t)(count - totalWrite));
+        numWrite = mxfFile->write(mxfFile->sysData, &data[totalWrite], chunkSize);
+        totalWrite += numWrite;
+        if (numWrite != chunkSize)
+            break;
+    }
+
+    return totalWrite;
 }
 
-int mxf_disk_file_open_read(const char *filename, MXFFile **mxfFile)
+uint64_t mxf_file_writev(MXFFile *mxfFile, const MXFIOVec *iov, int iovcnt)
 {
-    return disk_file_open(filename, READ_MODE, mxfFile);
+    uint64_t totalWrite = 0;
+    uint32_t numWrite;
+    int i;
+
+    if (mxfFile->readAheadBuffer && !drop_read_ahead(mxfFile))
+        return 0;
+
+    if (mxfFile->writev)
+        return mxfFile->writev(mxfFile->sysData, iov, iovcnt);
+
+    for (i = 0; i < iovcnt; i++) {
+        numWrite = mxfFile->write(mxfFile->sysData, iov[i].data, iov[i].size);
+        totalWrite += numWrite;
+        if (numWrite != iov[i].size)
+            break;
+    }
+
+    return totalWrite;
 }
 
-int mxf_disk_file_open_modify(const char *filename, MXFFile **mxfFile)
+#if defined(__linux__)
+/* returns 0 if the file positions could not be set after copying, in which case the copy cannot be continued */
+static int kernel_copy_range(MXFFile *src, MXFFile *dst, uint64_t len, uint64_t *totalCopyOut)
 {
-    return disk_file_open(filename, MODIFY_MODE, mxfFile);
-}
+    uint64_t totalCopy = 0;
+    int64_t srcStart;
+    int64_t dstStart;
+    loff_t srcOffset;
+    ssize_t result;
+    size_t count;
+    int srcFd;
+    int dstFd;
+    int eof = 0;
 
+    *totalCopyOut = 0;
+    if ((srcStart = src->tell(src->sysData)) < 0 || (dstStart = dst->tell(dst->sysData)) < 0)
+        return 1;
+    if ((srcFd = src->get_fd(src->sysData)) < 0 || (dstFd = dst->get_fd(dst->sysData)) < 0)
+        return 1;
 
-int mxf_stdin_wrap_read(MXFFile **mxfFile)
-{
-    MXFFile *newMXFFile = NULL;
-    MXFFileSysData *newStdInFile = NULL;
+    /* copy_file_range allows file systems to share extents (reflinks) or copy on the server side. It fails
+       for older kernels and for copies across file systems, in which case sendfile is tried */
+#if defined(HAVE_COPY_FILE_RANGE)
+    {
+        loff_t dstOffset = dstStart;
+
+        srcOffset = srcStart;
+        while (totalCopy < len) {
+            count = (len - totalCopy > MAX_KERNEL_COPY_SIZE ? MAX_KERNEL_COPY_SIZE : (size_t)(len - totalCopy));
+            result = copy_file_range(srcFd, &srcOffset, dstFd, &dstOffset, count, 0);
+            if (result < 0) {
+                if (errno == EINTR)
+                    continue;
+                break;
+            } else if (result == 0) {
+                eof = 1;
+                break;
+            }
+            totalCopy += result;
+        }
+    }
+#endif
 
-    CHK_MALLOC_ORET(newMXFFile, MXFFile);
-    memset(newMXFFile, 0, sizeof(MXFFile));
-    CHK_MALLOC_OFAIL(newStdInFile, MXFFileSysData);
-    memset(newStdInFile, 0, sizeof(MXFFileSysData));
+    if (totalCopy < len && !eof && lseek(dstFd, dstStart + totalCopy, SEEK_SET) == (off_t)(dstStart + totalCopy)) {
+        srcOffset = srcStart + totalCopy;
+        while (totalCopy < len) {
+            count = (len - totalCopy > MAX_KERNEL_COPY_SIZE ? MAX_KERNEL_COPY_SIZE : (size_t)(len - totalCopy));
+            result = sendfile(dstFd, srcFd, &srcOffset, count);
+            if (result < 0) {
+                if (errno == EINTR)
+                    continue;
+                break;
+            } else if (result == 0) {
+                break;
+            }
+            totalCopy += result;
+        }
+    }
 
-    newStdInFile->file     = stdin;
-    newStdInFile->isStream = 1;
-    assign_file_struct(newMXFFile, newStdInFile);
+    /* set the positions after the copied data */
+    *totalCopyOut = totalCopy;
+    if (!src->seek(src->sysData, srcStart + totalCopy, SEEK_SET) ||
+        !dst->seek(dst->sysData, dstStart + totalCopy, SEEK_SET))
+    {
+        mxf_log_error("Failed to set file positions after kernel copy\n");
+        return 0;
+    }
 
-    *mxfFile = newMXFFile;
     return 1;
-
-fail:
-    SAFE_FREE(newMXFFile);
-    SAFE_FREE(newStdInFile);
-    return 0;
 }
+#endif
 
+static uint64_t buffered_copy_range(MXFFile *src, MXFFile *dst, uint64_t len)
+{
+    uint64_t totalCopy = 0;
+    const uint8_t *data;
+    uint8_t *buffer = NULL;
+    uint32_t count;
+    uint32_t numRead;
+    uint32_t numWrite;
+
+    /* read views avoid copying the data from memory mapped and memory files into a buffer */
+    if (!src->read_view)
+        CHK_MALLOC_ARRAY_ORET(buffer, uint8_t, COPY_BUFFER_SIZE);
+
+    while (totalCopy < len) {
+        count = (len - totalCopy > COPY_BUFFER_SIZE ? COPY_BUFFER_SIZE : (uint32_t)(len - totalCopy));
+        if (buffer) {
+            numRead = mxf_file_read(src, buffer, count);
+            data = buffer;
+        } else {
+            numRead = mxf_file_read_view(src, &data, count);
+        }
+        if (numRead == 0)
+            break;
+
+        numWrite = mxf_file_write(dst, data, numRead);
+        totalCopy += numWrite;
+        if (numWrite != numRead)
+            break;
+    }
 
+    free(buffer);
+    return totalCopy;
+}
 
-void mxf_file_close(MXFFile **mxfFile)
+uint64_t mxf_file_copy_range(MXFFile *src, MXFFile *dst, uint64_t len)
 {
-    mxf_file_close_2(mxfFile, free);
+    uint64_t totalCopy = 0;
+
+    if (src->readAheadBuffer && !drop_read_ahead(src))
+        return 0;
+    if (dst->readAheadBuffer && !drop_read_ahead(dst))
+        return 0;
+
+#if defined(__linux__)
+    /* the buffered copy is not attempted if the file positions are unknown after the kernel copy */
+    if (src->get_fd && dst->get_fd && !kernel_copy_range(src, dst, len, &totalCopy))
+        return totalCopy;
+#endif
+
+    if (totalCopy < len)
+        totalCopy += buffered_copy_range(src, dst, len - totalCopy);
+
+    return totalCopy;
 }
 
-void mxf_file_close_2(MXFFile **mxfFile, void (*free_func)(void*))
+int mxf_file_dup(MXFFile *mxfFile, MXFFile **dupFile)
 {
-    if (!(*mxfFile))
-        return;
-
-    free((*mxfFile)->zerosBuffer);
+    MXFFile *newMXFFile = NULL;
 
-    if ((*mxfFile)->sysData) {
-        (*mxfFile)->close((*mxfFile)->sysData);
-        if ((*mxfFile)->free_sys_data)
-            (*mxfFile)->free_sys_data((*mxfFile)->sysData);
+    if (!mxfFile->dup) {
+        mxf_log_error("MXF file does not support duplication\n");
+        return 0;
     }
 
-    free_func(*mxfFile);
-    *mxfFile = NULL;
+    CHK_ORET(mxfFile->dup(mxfFile->sysData, &newMXFFile));
+
+    /* position the duplicate at the logical position, which excludes data held in the read-ahead window */
+    CHK_OFAIL(mxf_file_seek(newMXFFile, mxf_file_tell(mxfFile), SEEK_SET));
+    newMXFFile->minLLen  = mxfFile->minLLen;
+    newMXFFile->runinLen = mxfFile->runinLen;
+
+    *dupFile = newMXFFile;
+    return 1;
+
+fail:
+    mxf_file_close(&newMXFFile);
+    return 0;
 }
 
-uint32_t mxf_file_read(MXFFile *mxfFile, uint8_t *data, uint32_t count)
+int mxf_file_advise(MXFFile *mxfFile, int64_t offset, int64_t len, MXFFileAdvice advice)
 {
-    return mxfFile->read(mxfFile->sysData, data, count);
+    if (!mxfFile->advise)
+        return 1;
+
+    return mxfFile->advise(mxfFile->sysData, offset, len, advice);
 }
 
-uint32_t mxf_file_write(MXFFile *mxfFile, const uint8_t *data, uint32_t count)
+int mxf_file_preallocate(MXFFile *mxfFile, int64_t offset, int64_t len)
 {
-    return mxfFile->write(mxfFile->sysData, data, count);
+    if (!mxfFile->preallocate || len <= 0)
+        return 1;
+
+    return mxfFile->preallocate(mxfFile->sysData, offset, len);
 }
 
 int mxf_file_getc(MXFFile *mxfFile)
 {
-    return mxfFile->get_char(mxfFile->sysData);
+    if (!mxfFile->readAheadBuffer)
+        return mxfFile->get_char(mxfFile->sysData);
+
+    if (mxfFile->readAheadPos >= mxfFile->readAheadEnd) {
+        mxfFile->readAheadPos = 0;
+        mxfFile->readAheadEnd = 0;
+        if (fill_read_ahead(mxfFile) == 0) {
+            mxfFile->readAheadEOF = 1;
+            return EOF;
+        }
+    }
+
+    return mxfFile->readAheadBuffer[mxfFile->readAheadPos++];
 }
 
 int mxf_file_putc(MXFFile *mxfFile, int c)
 {
+    if (mxfFile->readAheadBuffer && !drop_read_ahead(mxfFile))
+        return EOF;
+
     return mxfFile->put_char(mxfFile->sysData, c);
 }
 
 int mxf_file_eof(MXFFile *mxfFile)
 {
+    if (mxfFile->readAheadBuffer && (mxfFile->readAheadEnd > 0 || mxfFile->readAheadEOF))
+        return mxfFile->readAheadEOF;
+
     return mxfFile->eof(mxfFile->sysData);
 }
 
 int mxf_file_seek(MXFFile *mxfFile, int64_t offset, int whence)
 {
-    return mxfFile->seek(mxfFile->sysData, offset, whence);
+    int64_t currentPosition;
+    int64_t position;
+
+    if (!mxfFile->readAheadBuffer || mxfFile->readAheadEnd == 0) {
+        if (mxfFile->readAheadBuffer)
+            reset_read_ahead(mxfFile);
+        return mxfFile->seek(mxfFile->sysData, offset, whence);
+    }
+
+    switch (whence)
+    {
+        case SEEK_SET:
+            position = offset;
+            break;
+        case SEEK_CUR:
+            position = mxfFile->readAheadOffset + mxfFile->readAheadPos + offset;
+            break;
+        default:
+            reset_read_ahead(mxfFile);
+            return mxfFile->seek(mxfFile->sysData, offset, whence);
+    }
+
+    /* seeks within the window don't require a seek in the file */
+    if (position >= mxfFile->readAheadOffset && position <= mxfFile->readAheadOffset + mxfFile->readAheadEnd) {
+        mxfFile->readAheadPos = (uint32_t)(position - mxfFile->readAheadOffset);
+        mxfFile->readAheadEOF = 0;
+        return 1;
+    }
+
+    currentPosition = mxfFile->readAheadOffset + mxfFile->readAheadPos;
+    reset_read_ahead(mxfFile);
+    if (!mxfFile->seek(mxfFile->sysData, position, SEEK_SET)) {
+        /* the file is positioned at the end of the window; restore the logical position */
+        mxfFile->seek(mxfFile->sysData, currentPosition, SEEK_SET);
+        return 0;
+    }
+    return 1;
 }
 
 int64_t mxf_file_tell(MXFFile *mxfFile)
 {
+    if (mxfFile->readAheadBuffer && mxfFile->readAheadEnd > 0)
+        return mxfFile->readAheadOffset + mxfFile->readAheadPos;
+
     return mxfFile->tell(mxfFile->sysData);
 }
 
@@ -386,6 +1963,73 @@ int64_t mxf_file_size(MXFFile *mxfFile)
     return mxfFile->size(mxfFile->sysData);
 }
 
+int mxf_file_can_read_view(MXFFile *mxfFile)
+{
+    return mxfFile->read_view != NULL;
+}
+
+uint32_t mxf_file_read_view(MXFFile *mxfFile, const uint8_t **data, uint32_t count)
+{
+    if (!mxfFile->read_view)
+        return 0;
+
+    if (mxfFile->readAheadBuffer && !drop_read_ahead(mxfFile))
+        return 0;
+
+    return mxfFile->read_view(mxfFile->sysData, data, count);
+}
+
+int mxf_file_set_read_ahead(MXFFile *mxfFile, uint32_t bufferSize)
+{
+    uint8_t *newBuffer = NULL;
+
+    if (mxfFile->readAheadBuffer) {
+        CHK_ORET(drop_read_ahead(mxfFile));
+        SAFE_FREE(mxfFile->readAheadBuffer);
+        mxfFile->readAheadSize = 0;
+    }
+
+    if (bufferSize > 0) {
+        CHK_MALLOC_ARRAY_ORET(newBuffer, uint8_t, bufferSize);
+        mxfFile->readAheadBuffer = newBuffer;
+        mxfFile->readAheadSize   = bufferSize;
+        reset_read_ahead(mxfFile);
+    }
+
+    return 1;
+}
+
+uint32_t mxf_file_peek(MXFFile *mxfFile, const uint8_t **data, uint32_t count)
+{
+    uint32_t numAvailable;
+
+    if (!mxfFile->readAheadBuffer)
+        return 0;
+
+    if (count > mxfFile->readAheadSize)
+        count = mxfFile->readAheadSize;
+
+    if (mxfFile->readAheadEnd - mxfFile->readAheadPos < count)
+        fill_read_ahead(mxfFile);
+
+    numAvailable = mxfFile->readAheadEnd - mxfFile->readAheadPos;
+    if (numAvailable > count)
+        numAvailable = count;
+
+    *data = &mxfFile->readAheadBuffer[mxfFile->readAheadPos];
+    return numAvailable;
+}
+
+void mxf_file_consume(MXFFile *mxfFile, uint32_t count)
+{
+    uint32_t numAvailable = mxfFile->readAheadEnd - mxfFile->readAheadPos;
+
+    if (count > numAvailable)
+        count = numAvailable;
+
+    mxfFile->readAheadPos += count;
+}
+
 
 void mxf_file_set_min_llen(MXFFile *mxfFile, uint8_t llen)
 {
@@ -474,6 +2118,156 @@ int mxf_read_int64(MXFFile *mxfFile, int64_t *value)
 }
 
 
+static int host_is_little_endian(void)
+{
+    const uint16_t value = 1;
+    return *(const uint8_t*)&value == 1;
+}
+
+/* reverse the byte order of each eleSize element in data, converting between big-endian and host order on a
+   little-endian host. 16 byte blocks are swapped using SIMD shuffles where available */
+static void swap_array_bytes(uint8_t *data, size_t count, unsigned int eleSize)
+{
+    size_t numBytes = count * eleSize;
+    size_t i = 0;
+    uint8_t temp;
+
+#if defined(SWAP_SSSE3)
+    __m128i mask;
+    if (eleSize == 2)
+        mask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    else if (eleSize == 4)
+        mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    else
+        mask = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    for (; i + 16 <= numBytes; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)&data[i]);
+        _mm_storeu_si128((__m128i*)&data[i], _mm_shuffle_epi8(v, mask));
+    }
+#elif defined(SWAP_SSE2)
+    for (; i + 16 <= numBytes; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)&data[i]);
+        /* reverse the 16-bit words within each element and then the bytes within each word */
+        if (eleSize == 4) {
+            v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+            v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        } else if (eleSize == 8) {
+            v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+            v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+        }
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128((__m128i*)&data[i], v);
+    }
+#elif defined(SWAP_NEON)
+    for (; i + 16 <= numBytes; i += 16) {
+        uint8x16_t v = vld1q_u8(&data[i]);
+        if (eleSize == 2)
+            v = vrev16q_u8(v);
+        else if (eleSize == 4)
+            v = vrev32q_u8(v);
+        else
+            v = vrev64q_u8(v);
+        vst1q_u8(&data[i], v);
+    }
+#endif
+
+    for (; i < numBytes; i += eleSize) {
+        switch (eleSize)
+        {
+            case 8:
+                temp = data[i + 0]; data[i + 0] = data[i + 7]; data[i + 7] = temp;
+                temp = data[i + 1]; data[i + 1] = data[i + 6]; data[i + 6] = temp;
+                temp = data[i + 2]; data[i + 2] = data[i + 5]; data[i + 5] = temp;
+                temp = data[i + 3]; data[i + 3] = data[i + 4]; data[i + 4] = temp;
+                break;
+            case 4:
+                temp = data[i + 0]; data[i + 0] = data[i + 3]; data[i + 3] = temp;
+                temp = data[i + 1]; data[i + 1] = data[i + 2]; data[i + 2] = temp;
+                break;
+            default:
+                temp = data[i + 0]; data[i + 0] = data[i + 1]; data[i + 1] = temp;
+                break;
+        }
+    }
+}
+
+static int read_array(MXFFile *mxfFile, uint8_t *values, uint32_t count, unsigned int eleSize)
+{
+    if (count == 0)
+        return 1;
+
+    CHK_ORET(count <= UINT32_MAX / eleSize);
+    CHK_ORET(mxf_file_read(mxfFile, values, count * eleSize) == count * eleSize);
+
+    if (host_is_little_endian())
+        swap_array_bytes(values, count, eleSize);
+
+    return 1;
+}
+
+static int write_array(MXFFile *mxfFile, const uint8_t *values, uint32_t count, unsigned int eleSize)
+{
+    uint8_t buffer[ARRAY_BUFFER_SIZE];
+    uint32_t maxCount = ARRAY_BUFFER_SIZE / eleSize;
+    uint32_t numBytes;
+    uint32_t num;
+
+    if (!host_is_little_endian()) {
+        if (count == 0)
+            return 1;
+        CHK_ORET(count <= UINT32_MAX / eleSize);
+        CHK_ORET(mxf_file_write(mxfFile, values, count * eleSize) == count * eleSize);
+        return 1;
+    }
+
+    while (count > 0) {
+        num = count;
+        if (num > maxCount)
+            num = maxCount;
+        numBytes = num * eleSize;
+
+        memcpy(buffer, values, numBytes);
+        swap_array_bytes(buffer, num, eleSize);
+        CHK_ORET(mxf_file_write(mxfFile, buffer, numBytes) == numBytes);
+
+        values += numBytes;
+        count  -= num;
+    }
+
+    return 1;
+}
+
+int mxf_read_uint16_array(MXFFile *mxfFile, uint16_t *values, uint32_t count)
+{
+    return read_array(mxfFile, (uint8_t*)values, count, 2);
+}
+
+int mxf_read_uint32_array(MXFFile *mxfFile, uint32_t *values, uint32_t count)
+{
+    return read_array(mxfFile, (uint8_t*)values, count, 4);
+}
+
+int mxf_read_uint64_array(MXFFile *mxfFile, uint64_t *values, uint32_t count)
+{
+    return read_array(mxfFile, (uint8_t*)values, count, 8);
+}
+
+int mxf_write_uint16_array(MXFFile *mxfFile, const uint16_t *values, uint32_t count)
+{
+    return write_array(mxfFile, (const uint8_t*)values, count, 2);
+}
+
+int mxf_write_uint32_array(MXFFile *mxfFile, const uint32_t *values, uint32_t count)
+{
+    return write_array(mxfFile, (const uint8_t*)values, count, 4);
+}
+
+int mxf_write_uint64_array(MXFFile *mxfFile, const uint64_t *values, uint32_t count)
+{
+    return write_array(mxfFile, (const uint8_t*)values, count, 8);
+}
+
+
 int mxf_write_uint8(MXFFile *mxfFile, uint8_t value)
 {
     CHK_ORET(mxf_file_write(mxfFile, &value, 1) == 1);
@@ -554,12 +2348,53 @@ int mxf_read_k(MXFFile *mxfFile, mxfKey *key)
     return 1;
 }
 
+static int decode_ber_length(const uint8_t *data, uint32_t size, uint8_t *llen, uint64_t *len)
+{
+    uint8_t bytesToRead;
+    uint64_t length;
+    uint8_t i;
+
+    if (size == 0)
+        return 0;
+
+    if (data[0] < 0x80) {
+        *llen = 1;
+        *len  = data[0];
+        return 1;
+    }
+
+    bytesToRead = data[0] & 0x7f;
+    if (bytesToRead > 8 || 1 + (uint32_t)bytesToRead > size)
+        return 0;
+
+    length = 0;
+    for (i = 0; i < bytesToRead; i++) {
+        length <<= 8;
+        length |= data[1 + i];
+    }
+
+    *llen = 1 + bytesToRead;
+    *len  = length;
+    return 1;
+}
+
 int mxf_read_l(MXFFile *mxfFile, uint8_t *llen, uint64_t *len)
 {
     int i;
     int c;
     uint64_t length;
     uint8_t llength;
+    const uint8_t *data;
+    uint32_t numAvailable;
+
+    if (mxfFile->readAheadBuffer) {
+        numAvailable = mxf_file_peek(mxfFile, &data, 9);
+        if (decode_ber_length(data, numAvailable, llen, len)) {
+            mxf_file_consume(mxfFile, *llen);
+            return 1;
+        }
+        /* insufficient data or an invalid length is handled and reported below */
+    }
 
     CHK_ORET((c = mxf_file_getc(mxfFile)) != EOF);
 
@@ -590,6 +2425,19 @@ int mxf_read_l(MXFFile *mxfFile, uint8_t *llen, uint64_t *len)
 
 int mxf_read_kl(MXFFile *mxfFile, mxfKey *key, uint8_t *llen, uint64_t *len)
 {
+    const uint8_t *data;
+    uint32_t numAvailable;
+
+    /* decode the key and length from the read-ahead window in one go */
+    if (mxfFile->readAheadBuffer) {
+        numAvailable = mxf_file_peek(mxfFile, &data, 16 + 9);
+        if (numAvailable > 16 && decode_ber_length(&data[16], numAvailable - 16, llen, len)) {
+            memcpy(key, data, 16);
+            mxf_file_consume(mxfFile, 16 + *llen);
+            return 1;
+        }
+    }
+
     CHK_ORET(mxf_read_k(mxfFile, key));
     CHK_ORET(mxf_read_l(mxfFile, llen, len));
 
@@ -699,6 +2547,23 @@ int mxf_write_kl(MXFFile *mxfFile, const mxfKey *key, uint64_t len)
 int mxf_write_fixed_l(MXFFile *mxfFile, uint8_t llen, uint64_t len)
 {
     uint8_t buffer[9];
+
+    CHK_ORET(mxf_encode_fixed_l(llen, len, buffer));
+    CHK_ORET(mxf_file_write(mxfFile, buffer, llen) == llen);
+
+    return 1;
+}
+
+int mxf_write_fixed_kl(MXFFile *mxfFile, const mxfKey *key, uint8_t llen, uint64_t len)
+{
+    CHK_ORET(mxf_write_k(mxfFile, key));
+    CHK_ORET(mxf_write_fixed_l(mxfFile, llen, len));
+
+    return 1;
+}
+
+int mxf_encode_fixed_l(uint8_t llen, uint64_t len, uint8_t *buffer)
+{
     uint8_t i;
 
     assert(llen > 0 && llen <= 9);
@@ -711,10 +2576,7 @@ int mxf_write_fixed_l(MXFFile *mxfFile, uint8_t llen, uint64_t len)
             return 0;
         }
 
-        if (mxf_file_putc(mxfFile, (int)len) != (int)len)
-        {
-            return 0;
-        }
+        buffer[0] = (uint8_t)len;
     }
     else
     {
@@ -725,23 +2587,21 @@ int mxf_write_fixed_l(MXFFile *mxfFile, uint8_t llen, uint64_t len)
             return 0;
         }
 
+        buffer[0] = 0x80 + llen - 1;
         for (i = 0; i < llen - 1; i++)
         {
-            buffer[llen - 1 - i - 1] = (uint8_t)((len >> (i * 8)) & 0xff);
+            buffer[llen - 1 - i] = (uint8_t)((len >> (i * 8)) & 0xff);
         }
-        CHK_ORET(mxf_file_putc(mxfFile, 0x80 + llen - 1) == 0x80 + llen - 1);
-        CHK_ORET(mxf_file_write(mxfFile, buffer, llen - 1) == (uint8_t)(llen - 1));
     }
 
     return 1;
 }
 
-int mxf_write_fixed_kl(MXFFile *mxfFile, const mxfKey *key, uint8_t llen, uint64_t len)
+int mxf_encode_fixed_kl(const mxfKey *key, uint8_t llen, uint64_t len, uint8_t *buffer)
 {
-    CHK_ORET(mxf_write_k(mxfFile, key));
-    CHK_ORET(mxf_write_fixed_l(mxfFile, llen, len));
+    memcpy(buffer, key, mxfKey_extlen);
 
-    return 1;
+    return mxf_encode_fixed_l(llen, len, &buffer[mxfKey_extlen]);
 }
 
 int mxf_write_ul(MXFFile *mxfFile, const mxfUL *label)
@@ -47,6 +47,21 @@ extern "C"
 typedef struct MXFFileSysData MXFFileSysData;
 
 typedef struct
+{
+    const uint8_t *data;
+    uint32_t size;
+} MXFIOVec;
+
+typedef enum
+{
+    MXF_ADVISE_NORMAL = 0,
+    MXF_ADVISE_SEQUENTIAL,
+    MXF_ADVISE_RANDOM,
+    MXF_ADVISE_WILLNEED,
+    MXF_ADVISE_DONTNEED
+} MXFFileAdvice;
+
+typedef struct MXFFile
 {
     /* MXF file implementations must set and implement these functions */
     void        (*close)        (MXFFileSysData *sysData);
@@ -60,6 +75,18 @@ typedef struct
     int         (*is_seekable)  (MXFFileSysData *sysData);
     int64_t     (*size)         (MXFFileSysData *sysData);
 
+    /* MXF file implementations can optionally set these functions */
+    uint32_t    (*read_view)    (MXFFileSysData *sysData, const uint8_t **data, uint32_t count);
+    uint64_t    (*writev)       (MXFFileSysData *sysData, const MXFIOVec *iov, int iovcnt);
+    /* write buffered data and return a descriptor set at the current position, or -1 */
+    int         (*get_fd)       (MXFFileSysData *sysData);
+    int         (*advise)       (MXFFileSysData *sysData, int64_t offset, int64_t len, MXFFileAdvice advice);
+    int         (*preallocate)  (MXFFileSysData *sysData, int64_t offset, int64_t len);
+    uint64_t    (*read_64)      (MXFFileSysData *sysData, uint8_t *data, uint64_t count);
+    uint64_t    (*write_64)     (MXFFileSysData *sysData, const uint8_t *data, uint64_t count);
+    /* open an independent file positioned at the current position over the same underlying file */
+    int         (*dup)          (MXFFileSysData *sysData, struct MXFFile **dupFile);
+
     /* private data for the MXF file implementation */
     void (*free_sys_data)(MXFFileSysData *sysData);
     MXFFileSysData *sysData;
@@ -69,6 +96,14 @@ typedef struct
     uint16_t runinLen;
     uint8_t *zerosBuffer;
     uint32_t zerosBufferSize;
+
+    /* read-ahead window; readAheadOffset is the file position of readAheadBuffer[0] */
+    uint8_t *readAheadBuffer;
+    uint32_t readAheadSize;
+    uint32_t readAheadPos;
+    uint32_t readAheadEnd;
+    int64_t readAheadOffset;
+    int readAheadEOF;
 } MXFFile;
 
 
@@ -77,13 +112,28 @@ int mxf_disk_file_open_new(const char *filename, MXFFile **mxfFile);
 int mxf_disk_file_open_read(const char *filename, MXFFile **mxfFile);
 int mxf_disk_file_open_modify(const char *filename, MXFFile **mxfFile);
 
+/* open a file on disk for writing with direct I/O (O_DIRECT) that bypasses the page cache. Data is copied through
+   an aligned buffer of bufferSize bytes (0 selects the default) and the partial block at the end of the file is
+   padded until the file is closed */
+int mxf_disk_file_open_new_direct(const char *filename, uint32_t bufferSize, MXFFile **mxfFile);
+int mxf_disk_file_open_modify_direct(const char *filename, uint32_t bufferSize, MXFFile **mxfFile);
+
+/* open a file on disk for reading through a read-only memory mapping of the whole file */
+int mxf_mmap_file_open_read(const char *filename, MXFFile **mxfFile);
+
 /* wrap standard input in an MXF file */
 int mxf_stdin_wrap_read(MXFFile **mxfFile);
+/* wrap standard output in a (non-seekable) MXF file */
+int mxf_stdout_wrap_write(MXFFile **mxfFile);
 
 void mxf_file_close(MXFFile **mxfFile);
 void mxf_file_close_2(MXFFile **mxfFile, void (*free_func)(void*));
 uint32_t mxf_file_read(MXFFile *mxfFile, uint8_t *data, uint32_t count);
 uint32_t mxf_file_write(MXFFile *mxfFile, const uint8_t *data, uint32_t count);
+/* read and write counts beyond 4GB, e.g. for clip wrapped essence. Files that don't implement the 64-bit
+   functions fall back to a sequence of 32-bit reads or writes */
+uint64_t mxf_file_read_64(MXFFile *mxfFile, uint8_t *data, uint64_t count);
+uint64_t mxf_file_write_64(MXFFile *mxfFile, const uint8_t *data, uint64_t count);
 int mxf_file_getc(MXFFile *mxfFile);
 int mxf_file_putc(MXFFile *mxfFile, int c);
 int mxf_file_eof(MXFFile *mxfFile);
@@ -92,6 +142,44 @@ int64_t mxf_file_tell(MXFFile *mxfFile);
 int mxf_file_is_seekable(MXFFile *mxfFile);
 int64_t mxf_file_size(MXFFile *mxfFile);
 
+/* zero-copy read: sets data to point to the next (up to) count bytes in the file and advances the position.
+   Less than count bytes are returned at the end of the file or at an internal buffer boundary, in which case the
+   function can be called again for the remainder. The data remains valid until the file is modified or closed.
+   mxf_file_can_read_view returns 0 if the file implementation does not support views */
+int mxf_file_can_read_view(MXFFile *mxfFile);
+uint32_t mxf_file_read_view(MXFFile *mxfFile, const uint8_t **data, uint32_t count);
+
+/* read-ahead: small reads, get_char calls and KL parsing are served from an in-memory window that is refilled
+   with a single read. Reads larger than the window go directly to the file. A bufferSize of 0 disables it.
+   mxf_file_peek returns a pointer to up to count bytes (count <= bufferSize) without changing the position and
+   returns 0 if read-ahead is disabled; mxf_file_consume advances the position within the peeked data */
+int mxf_file_set_read_ahead(MXFFile *mxfFile, uint32_t bufferSize);
+uint32_t mxf_file_peek(MXFFile *mxfFile, const uint8_t **data, uint32_t count);
+void mxf_file_consume(MXFFile *mxfFile, uint32_t count);
+
+
+/* gather-write: writes the iovcnt buffers in order and returns the total number of bytes written. Files that
+   don't implement writev fall back to a write per buffer */
+uint64_t mxf_file_writev(MXFFile *mxfFile, const MXFIOVec *iov, int iovcnt);
+
+/* copy len bytes from the current position in src to the current position in dst and return the number of bytes
+   copied. The copy is done in the kernel (copy_file_range or sendfile) if both files are regular disk files,
+   otherwise data is copied through a buffer or read view */
+uint64_t mxf_file_copy_range(MXFFile *src, MXFFile *dst, uint64_t len);
+
+/* access pattern hint for the byte range starting at offset. A len of 0 extends the range to the end of the file.
+   MXF_ADVISE_WILLNEED starts reading the range in the background. Files that don't support hints ignore them */
+int mxf_file_advise(MXFFile *mxfFile, int64_t offset, int64_t len, MXFFileAdvice advice);
+
+/* open an independent file over the same underlying file, positioned at the current position. Disk files are
+   duplicated as files using positional reads and writes (pread/pwrite) so that the duplicates and the original can
+   be read from different threads without locking. Returns 0 if the file type does not support duplication */
+int mxf_file_dup(MXFFile *mxfFile, MXFFile **dupFile);
+
+/* reserve disk space for the byte range without changing the file size, reducing fragmentation of files that are
+   written sequentially over a long period. Files and file systems that don't support it ignore the request */
+int mxf_file_preallocate(MXFFile *mxfFile, int64_t offset, int64_t len);
+
 
 void mxf_file_set_min_llen(MXFFile *mxfFile, uint8_t llen);
 uint8_t mxf_get_min_llen(MXFFile *mxfFile);
@@ -114,6 +202,15 @@ int mxf_read_int16(MXFFile *mxfFile, int16_t *value);
 int mxf_read_int32(MXFFile *mxfFile, int32_t *value);
 int mxf_read_int64(MXFFile *mxfFile, int64_t *value);
 
+/* read or write count big-endian values using a single file read or a few buffered writes, converting between
+   big-endian and host byte order in bulk */
+int mxf_read_uint16_array(MXFFile *mxfFile, uint16_t *values, uint32_t count);
+int mxf_read_uint32_array(MXFFile *mxfFile, uint32_t *values, uint32_t count);
+int mxf_read_uint64_array(MXFFile *mxfFile, uint64_t *values, uint32_t count);
+int mxf_write_uint16_array(MXFFile *mxfFile, const uint16_t *values, uint32_t count);
+int mxf_write_uint32_array(MXFFile *mxfFile, const uint32_t *values, uint32_t count);
+int mxf_write_uint64_array(MXFFile *mxfFile, const uint64_t *values, uint32_t count);
+
 int mxf_read_k(MXFFile *mxfFile, mxfKey *key);
 int mxf_read_l(MXFFile *mxfFile, uint8_t *llen, uint64_t *len);
 int mxf_read_kl(MXFFile *mxfFile, mxfKey *key, uint8_t *llen, uint64_t *len);
@@ -134,6 +231,11 @@ uint8_t mxf_write_l(MXFFile *mxfFile, uint64_t len);
 int mxf_write_kl(MXFFile *mxfFile, const mxfKey *key, uint64_t len);
 int mxf_write_fixed_l(MXFFile *mxfFile, uint8_t llen, uint64_t len);
 int mxf_write_fixed_kl(MXFFile *mxfFile, const mxfKey *key, uint8_t llen, uint64_t len);
+
+/* encode a BER length into llen bytes, or a key and BER length into mxfKey_extlen + llen bytes, of buffer.
+   Used to prepare KLs for mxf_file_writev */
+int mxf_encode_fixed_l(uint8_t llen, uint64_t len, uint8_t *buffer);
+int mxf_encode_fixed_kl(const mxfKey *key, uint8_t llen, uint64_t len, uint8_t *buffer);
 int mxf_write_ul(MXFFile *mxfFile, const mxfUL *label);
 int mxf_write_uid(MXFFile *mxfFile, const mxfUID *uid);
 int mxf_write_uuid(MXFFile *mxfFile, const mxfUUID *uuid);
@@ -314,7 +314,6 @@ int mxf_write_index_table_segment(MXFFile *mxfFile, const MXFIndexTableSegment *
     if (segment->indexEntryArray != NULL)
     {
         MXFIndexEntry *entry = segment->indexEntryArray;
-        uint32_t i;
         CHK_ORET(mxf_write_local_tl(mxfFile, 0x3f0a, (uint16_t)(8 + indexEntryArrayLen *
                                                         (11 + segment->sliceCount * 4 + segment->posTableCount * 8))));
         CHK_ORET(mxf_write_uint32(mxfFile, indexEntryArrayLen));
@@ -325,15 +324,8 @@ int mxf_write_index_table_segment(MXFFile *mxfFile, const MXFIndexTableSegment *
             CHK_ORET(mxf_write_uint8(mxfFile, entry->keyFrameOffset));
             CHK_ORET(mxf_write_uint8(mxfFile, entry->flags));
             CHK_ORET(mxf_write_uint64(mxfFile, entry->streamOffset));
-            for (i = 0; i < segment->sliceCount; i++)
-            {
-                CHK_ORET(mxf_write_uint32(mxfFile, entry->sliceOffset[i]));
-            }
-            for (i = 0; i < segment->posTableCount; i++)
-            {
-                CHK_ORET(mxf_write_int32(mxfFile, entry->posTable[i].numerator));
-                CHK_ORET(mxf_write_int32(mxfFile, entry->posTable[i].denominator));
-            }
+            CHK_ORET(mxf_write_uint32_array(mxfFile, entry->sliceOffset, segment->sliceCount));
+            CHK_ORET(mxf_write_uint32_array(mxfFile, (const uint32_t*)entry->posTable, segment->posTableCount * 2));
             entry = entry->next;
         }
     }
@@ -365,7 +357,7 @@ int mxf_read_index_table_segment_2(MXFFile *mxfFile, uint64_t segmentLen,
     uint64_t streamOffset;
     uint32_t entry;
     uint32_t actualEntryLen;
-    uint8_t i;
+    uint32_t numValues;
 
     CHK_ORET(mxf_create_index_table_segment(&newSegment));
 
@@ -463,16 +455,21 @@ int mxf_read_index_table_segment_2(MXFFile *mxfFile, uint64_t segmentLen,
                     CHK_OFAIL(mxf_read_uint8(mxfFile, &flags));
                     CHK_OFAIL(mxf_read_uint64(mxfFile, &streamOffset));
                     actualEntryLen += 11;
-                    for (i = 0; i < newSegment->sliceCount && actualEntryLen < indexEntryLen; i++)
+                    if (newSegment->sliceCount > 0 && actualEntryLen < indexEntryLen)
                     {
-                        CHK_OFAIL(mxf_read_uint32(mxfFile, &sliceOffset[i]));
-                        actualEntryLen += 4;
+                        numValues = (indexEntryLen - actualEntryLen + 3) / 4;
+                        if (numValues > newSegment->sliceCount)
+                            numValues = newSegment->sliceCount;
+                        CHK_OFAIL(mxf_read_uint32_array(mxfFile, sliceOffset, numValues));
+                        actualEntryLen += numValues * 4;
                     }
-                    for (i = 0; i < newSegment->posTableCount && actualEntryLen < indexEntryLen; i++)
+                    if (newSegment->posTableCount > 0 && actualEntryLen < indexEntryLen)
                     {
-                        CHK_OFAIL(mxf_read_int32(mxfFile, &posTable[i].numerator));
-                        CHK_OFAIL(mxf_read_int32(mxfFile, &posTable[i].denominator));
-                        actualEntryLen += 8;
+                        numValues = (indexEntryLen - actualEntryLen + 7) / 8;
+                        if (numValues > newSegment->posTableCount)
+                            numValues = newSegment->posTableCount;
+                        CHK_OFAIL(mxf_read_uint32_array(mxfFile, (uint32_t*)posTable, numValues * 2));
+                        actualEntryLen += numValues * 8;
                     }
                     if (addIndexEntry != NULL)
                     {
@@ -589,21 +586,12 @@ int mxf_write_index_entry_array_header(MXFFile *mxfFile, uint8_t sliceCount, uin
 
 int mxf_write_index_entry(MXFFile *mxfFile, uint8_t sliceCount, uint8_t posTableCount, MXFIndexEntry *entry)
 {
-    uint32_t i;
-
     CHK_ORET(mxf_write_uint8(mxfFile, entry->temporalOffset));
     CHK_ORET(mxf_write_uint8(mxfFile, entry->keyFrameOffset));
     CHK_ORET(mxf_write_uint8(mxfFile, entry->flags));
     CHK_ORET(mxf_write_uint64(mxfFile, entry->streamOffset));
-    for (i = 0; i < sliceCount; i++)
-    {
-        CHK_ORET(mxf_write_uint32(mxfFile, entry->sliceOffset[i]));
-    }
-    for (i = 0; i < posTableCount; i++)
-    {
-        CHK_ORET(mxf_write_int32(mxfFile, entry->posTable[i].numerator));
-        CHK_ORET(mxf_write_int32(mxfFile, entry->posTable[i].denominator));
-    }
+    CHK_ORET(mxf_write_uint32_array(mxfFile, entry->sliceOffset, sliceCount));
+    CHK_ORET(mxf_write_uint32_array(mxfFile, (const uint32_t*)entry->posTable, posTableCount * 2));
 
     return 1;
 }
@@ -33,11 +33,24 @@
 #include "config.h"
 #endif
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     /* memfd_create */
+#endif
+
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <assert.h>
 
+#if !defined(_WIN32) && (defined(HAVE_MEMFD_CREATE) || defined(HAVE_SHM_OPEN))
+#define HAVE_SHARED_MEM_FILE    1
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #include <mxf/mxf.h>
 #include <mxf/mxf_memory_file.h>
 #include <mxf/mxf_macros.h>
@@ -45,12 +58,17 @@
 
 #define DEFAULT_CHUNK_SIZE      4096
 
+/* maximum buffer size passed to mxf_file_writev */
+#define MAX_FLUSH_IOVEC_SIZE    (1U << 30)
+
 
 typedef struct
 {
     unsigned char *data;
     int64_t allocSize;
     int64_t size;
+    int64_t start;      /* file position of the first byte */
+    int owned;          /* data is freed when the file is closed */
 } Chunk;
 
 struct MXFMemoryFile
@@ -62,6 +80,8 @@ struct MXFFileSysData
 {
     MXFMemoryFile mxfMemFile;
     uint32_t chunkSize;
+    uint32_t maxChunkSize;      /* chunk sizes double up to this size */
+    uint32_t nextChunkSize;
     int contiguous;
     int readOnly;
     int64_t virtualStartPos;
@@ -69,6 +89,9 @@ struct MXFFileSysData
     size_t numChunks;
     int64_t position;
     int eof;
+    int isShared;               /* the single chunk is a mapping of a shared memory segment */
+    int sharedFd;               /* segment descriptor owned by the file, or -1 */
+    int canSeal;                /* segment is a memfd that supports seals */
 };
 
 
@@ -76,23 +99,31 @@ struct MXFFileSysData
 static int get_chunk_pos(MXFFileSysData *sysData, size_t *posChunkIndex, int64_t *posChunkPos)
 {
     size_t chunkIndex;
+    size_t lastIndex;
+    size_t midIndex;
     int64_t chunkPos;
 
     if (sysData->numChunks == 0)
         return 0;
 
     assert(sysData->position >= 0);
-    if (sysData->numChunks == 1) {
-        chunkIndex = 0;
-        chunkPos = sysData->position;
+
+    /* chunks can have different sizes and so a binary search is used to find the chunk. All chunks except the last
+       one are full. The last chunk is checked first because it is the one written to when appending */
+    lastIndex = sysData->numChunks - 1;
+    if (sysData->position >= sysData->chunks[lastIndex].start) {
+        chunkIndex = lastIndex;
     } else {
-        chunkIndex = (size_t)(sysData->position / sysData->chunkSize);
-        if (chunkIndex > sysData->numChunks)
-            return 0;
-        if (chunkIndex == sysData->numChunks) /* when position == size then return 1 */
-            chunkIndex--;
-        chunkPos = sysData->position - (int64_t)sysData->chunkSize * chunkIndex;
+        chunkIndex = 0;
+        while (chunkIndex < lastIndex) {
+            midIndex = (chunkIndex + lastIndex + 1) / 2;
+            if (sysData->chunks[midIndex].start <= sysData->position)
+                chunkIndex = midIndex;
+            else
+                lastIndex = midIndex - 1;
+        }
     }
+    chunkPos = sysData->position - sysData->chunks[chunkIndex].start;
     if (chunkPos > sysData->chunks[chunkIndex].size)
         return 0;
 
@@ -101,25 +132,185 @@ static int get_chunk_pos(MXFFileSysData *sysData, size_t *posChunkIndex, int64_t
     return 1;
 }
 
-static int extend_mem_file(MXFFileSysData *sysData, uint32_t minSize)
+static uint32_t next_chunk_size(MXFFileSysData *sysData, uint32_t chunkSize)
+{
+    if (chunkSize >= sysData->maxChunkSize / 2)
+        return sysData->maxChunkSize > chunkSize ? sysData->maxChunkSize : chunkSize;
+
+    return chunkSize * 2;
+}
+
+#if defined(HAVE_SHARED_MEM_FILE)
+
+static int map_shared_segment(int fd, int64_t size, int writable, unsigned char **mapData)
+{
+    void *data;
+
+    /* a zero length mapping is not allowed */
+    if (size == 0) {
+        *mapData = NULL;
+        return 1;
+    }
+    if ((uint64_t)size > (size_t)(-1)) {
+        mxf_log_error("Shared memory segment is too large to be mapped" LOG_LOC_FORMAT, LOG_LOC_PARAMS);
+        return 0;
+    }
+
+    data = mmap(NULL, (size_t)size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        mxf_log_error("Failed to map shared memory segment: %s" LOG_LOC_FORMAT, strerror(errno), LOG_LOC_PARAMS);
+        return 0;
+    }
+
+    *mapData = (unsigned char*)data;
+    return 1;
+}
+
+static void unmap_shared_segment(MXFFileSysData *sysData)
+{
+    if (sysData->numChunks > 0 && sysData->chunks[0].data)
+        munmap(sysData->chunks[0].data, (size_t)sysData->chunks[0].allocSize);
+}
+
+static int extend_shared_mem_file(MXFFileSysData *sysData, uint64_t minSize)
+{
+    unsigned char *mapData;
+    int64_t allocSize;
+    int64_t size;
+    int64_t pageSize;
+
+    if (sysData->numChunks == 0) {
+        CHK_MALLOC_ORET(sysData->chunks, Chunk);
+        memset(sysData->chunks, 0, sizeof(*sysData->chunks));
+        sysData->numChunks = 1;
+    }
+    allocSize = sysData->chunks[0].allocSize;
+    size = sysData->chunks[0].size;
+    if ((uint64_t)(allocSize - size) >= minSize)
+        return 1;
+
+    /* the segment is kept contiguous so that it can be mapped as a whole by the consumer. The capacity doubles
+       and is a multiple of the page size */
+    pageSize = sysconf(_SC_PAGESIZE);
+    if (pageSize <= 0)
+        pageSize = 4096;
+    allocSize = (allocSize == 0 ? sysData->chunkSize : allocSize * 2);
+    if ((uint64_t)allocSize < size + minSize)
+        allocSize = size + minSize;
+    allocSize = (allocSize + pageSize - 1) / pageSize * pageSize;
+
+    if (ftruncate(sysData->sharedFd, allocSize) != 0) {
+        mxf_log_error("Failed to extend shared memory segment to %"PRId64" bytes: %s" LOG_LOC_FORMAT,
+                      allocSize, strerror(errno), LOG_LOC_PARAMS);
+        return 0;
+    }
+    CHK_ORET(map_shared_segment(sysData->sharedFd, allocSize, 1, &mapData));
+
+    /* the data is held by the segment and so the new mapping already contains it */
+    unmap_shared_segment(sysData);
+    sysData->chunks[0].data      = mapData;
+    sysData->chunks[0].allocSize = allocSize;
+
+    return 1;
+}
+
+static int create_shared_segment(const char *name, int *fd, int *canSeal)
 {
-    uint32_t i;
+    static int anonCount = 0;
+    char anonName[64];
+
+    *canSeal = 0;
+
+    if (!name) {
+#if defined(HAVE_MEMFD_CREATE)
+        *fd = memfd_create("mxf_mem_file", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (*fd >= 0) {
+            *canSeal = 1;
+            return 1;
+        }
+        mxf_log_error("Failed to create memfd: %s" LOG_LOC_FORMAT, strerror(errno), LOG_LOC_PARAMS);
+        return 0;
+#elif defined(HAVE_SHM_OPEN)
+        /* anonymous segment: create a unique name and unlink it immediately */
+        snprintf(anonName, sizeof(anonName), "/mxf_mem_file_%ld_%d", (long)getpid(), anonCount++);
+        *fd = shm_open(anonName, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (*fd < 0) {
+            mxf_log_error("Failed to create shared memory segment: %s" LOG_LOC_FORMAT, strerror(errno), LOG_LOC_PARAMS);
+            return 0;
+        }
+        shm_unlink(anonName);
+        return 1;
+#endif
+    }
+
+#if defined(HAVE_SHM_OPEN)
+    (void)anonCount;
+    (void)anonName;
+    *fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (*fd < 0) {
+        mxf_log_error("Failed to create shared memory segment '%s': %s" LOG_LOC_FORMAT,
+                      name, strerror(errno), LOG_LOC_PARAMS);
+        return 0;
+    }
+    return 1;
+#else
+    (void)anonCount;
+    (void)anonName;
+    mxf_log_error("Named shared memory segments are not supported" LOG_LOC_FORMAT, LOG_LOC_PARAMS);
+    return 0;
+#endif
+}
+
+#else
+
+static void unmap_shared_segment(MXFFileSysData *sysData)
+{
+    (void)sysData;
+}
+
+static int extend_shared_mem_file(MXFFileSysData *sysData, uint64_t minSize)
+{
+    (void)sysData;
+    (void)minSize;
+    return 0;
+}
+
+#endif
+
+
+static int extend_mem_file(MXFFileSysData *sysData, uint64_t minSize)
+{
+    size_t i;
     Chunk *newChunks;
-    uint32_t numExtendChunks;
+    size_t numExtendChunks;
     int64_t chunkRemainder;
+    uint64_t extendSize;
+    uint32_t chunkSize;
 
     assert(!sysData->readOnly);
 
+    if (sysData->isShared)
+        return extend_shared_mem_file(sysData, minSize);
+
     if (sysData->numChunks == 0) {
         chunkRemainder = 0;
     } else {
         chunkRemainder = sysData->chunks[sysData->numChunks - 1].allocSize -
                             sysData->chunks[sysData->numChunks - 1].size;
     }
-    if (minSize <= chunkRemainder)
+    if (minSize <= (uint64_t)chunkRemainder)
         return 1;
 
-    numExtendChunks = (uint32_t)((minSize - chunkRemainder + sysData->chunkSize - 1) / sysData->chunkSize);
+    /* count the chunks required, with sizes doubling up to maxChunkSize if growth is enabled */
+    numExtendChunks = 0;
+    chunkSize = sysData->nextChunkSize;
+    extendSize = 0;
+    while (extendSize < minSize - chunkRemainder) {
+        extendSize += chunkSize;
+        numExtendChunks++;
+        chunkSize = next_chunk_size(sysData, chunkSize);
+    }
+
     newChunks = (Chunk*)realloc(sysData->chunks, (sysData->numChunks + numExtendChunks) * sizeof(Chunk));
     if (!newChunks) {
         mxf_log_error("Failed to reallocate memory file chunks" LOG_LOC_FORMAT, LOG_LOC_PARAMS);
@@ -128,10 +319,17 @@ static int extend_mem_file(MXFFileSysData *sysData, uint32_t minSize)
     sysData->chunks = newChunks;
 
     for (i = 0; i < numExtendChunks; i++) {
-        CHK_MALLOC_ARRAY_ORET(sysData->chunks[sysData->numChunks].data, unsigned char, sysData->chunkSize);
-        sysData->chunks[sysData->numChunks].allocSize = sysData->chunkSize;
-        sysData->chunks[sysData->numChunks].size = 0;
+        Chunk *chunk = &sysData->chunks[sysData->numChunks];
+        CHK_MALLOC_ARRAY_ORET(chunk->data, unsigned char, sysData->nextChunkSize);
+        chunk->allocSize = sysData->nextChunkSize;
+        chunk->size = 0;
+        chunk->owned = 1;
+        if (sysData->numChunks == 0)
+            chunk->start = 0;
+        else
+            chunk->start = sysData->chunks[sysData->numChunks - 1].start + sysData->chunks[sysData->numChunks - 1].allocSize;
         sysData->numChunks++;
+        sysData->nextChunkSize = next_chunk_size(sysData, sysData->nextChunkSize);
     }
 
     return 1;
@@ -145,9 +343,19 @@ static void free_mem_file(MXFFileSysData *sysData)
 
 static void mem_file_close(MXFFileSysData *sysData)
 {
-    if (!sysData->readOnly) {
-        size_t i;
-        for (i = 0; i < sysData->numChunks; i++)
+    size_t i;
+
+    if (sysData->isShared) {
+        unmap_shared_segment(sysData);
+#if defined(HAVE_SHARED_MEM_FILE)
+        if (sysData->sharedFd >= 0)
+            close(sysData->sharedFd);
+#endif
+        sysData->sharedFd = -1;
+    }
+
+    for (i = 0; i < sysData->numChunks; i++) {
+        if (sysData->chunks[i].owned)
             free(sysData->chunks[i].data);
     }
     free(sysData->chunks);
@@ -161,9 +369,9 @@ static int64_t mem_file_size(MXFFileSysData *sysData)
     return sysData->virtualStartPos + mxf_mem_file_get_size(&sysData->mxfMemFile);
 }
 
-static uint32_t mem_file_read(MXFFileSysData *sysData, uint8_t *data, uint32_t count)
+static uint64_t mem_file_read_64(MXFFileSysData *sysData, uint8_t *data, uint64_t count)
 {
-    uint32_t totalRead = 0;
+    uint64_t totalRead = 0;
     size_t posChunkIndex;
     int64_t posChunkPos;
     int64_t numRead;
@@ -178,10 +386,10 @@ static uint32_t mem_file_read(MXFFileSysData *sysData, uint8_t *data, uint32_t c
     while (totalRead < count) {
         numRead = sysData->chunks[posChunkIndex].size - posChunkPos;
         if (numRead > 0) {
-            if (numRead > count - totalRead)
+            if ((uint64_t)numRead > count - totalRead)
                 numRead = count - totalRead;
-            memcpy(&data[totalRead], &sysData->chunks[posChunkIndex].data[posChunkPos], (uint32_t)numRead);
-            totalRead += (uint32_t)numRead;
+            memcpy(&data[totalRead], &sysData->chunks[posChunkIndex].data[posChunkPos], (size_t)numRead);
+            totalRead += numRead;
             sysData->position += numRead;
             posChunkPos += numRead;
         }
@@ -199,9 +407,48 @@ static uint32_t mem_file_read(MXFFileSysData *sysData, uint8_t *data, uint32_t c
     return totalRead;
 }
 
-static uint32_t mem_file_write(MXFFileSysData *sysData, const uint8_t *data, uint32_t count)
+static uint32_t mem_file_read(MXFFileSysData *sysData, uint8_t *data, uint32_t count)
+{
+    return (uint32_t)mem_file_read_64(sysData, data, count);
+}
+
+static uint32_t mem_file_read_view(MXFFileSysData *sysData, const uint8_t **data, uint32_t count)
 {
-    uint32_t totalWrite = 0;
+    size_t posChunkIndex;
+    int64_t posChunkPos;
+    int64_t numRead;
+
+    if (count == 0)
+        return 0;
+
+    if (!get_chunk_pos(sysData, &posChunkIndex, &posChunkPos))
+        return 0;
+
+    /* move to the start of the next chunk if positioned at the end of a chunk */
+    if (posChunkPos >= sysData->chunks[posChunkIndex].size && posChunkIndex + 1 < sysData->numChunks) {
+        posChunkIndex++;
+        posChunkPos = 0;
+    }
+
+    /* the view is limited to the remainder of the chunk */
+    numRead = sysData->chunks[posChunkIndex].size - posChunkPos;
+    if (numRead <= 0) {
+        sysData->eof = 1;
+        return 0;
+    }
+    if (numRead > count)
+        numRead = count;
+
+    *data = &sysData->chunks[posChunkIndex].data[posChunkPos];
+    sysData->position += numRead;
+    sysData->eof = 0;
+
+    return (uint32_t)numRead;
+}
+
+static uint64_t mem_file_write_64(MXFFileSysData *sysData, const uint8_t *data, uint64_t count)
+{
+    uint64_t totalWrite = 0;
     size_t posChunkIndex;
     int64_t posChunkPos;
     int64_t numWrite;
@@ -211,12 +458,9 @@ static uint32_t mem_file_write(MXFFileSysData *sysData, const uint8_t *data, uin
         return 0;
 
     fileSize = mxf_mem_file_get_size(&sysData->mxfMemFile);
-    if (sysData->position + count > fileSize) {
-        if (sysData->position + count - fileSize > UINT32_MAX ||
-            !extend_mem_file(sysData, (uint32_t)(sysData->position + count - fileSize)))
-        {
+    if (sysData->position + count > (uint64_t)fileSize) {
+        if (!extend_mem_file(sysData, sysData->position + count - fileSize))
             return 0;
-        }
 
         /* add data from fileSize to sysData->position */
         if (sysData->position > fileSize) {
@@ -250,10 +494,10 @@ static uint32_t mem_file_write(MXFFileSysData *sysData, const uint8_t *data, uin
     while (totalWrite < count) {
         numWrite = sysData->chunks[posChunkIndex].allocSize - posChunkPos;
         if (numWrite > 0) {
-            if (numWrite > count - totalWrite)
+            if ((uint64_t)numWrite > count - totalWrite)
                 numWrite = count - totalWrite;
-            memcpy(&sysData->chunks[posChunkIndex].data[posChunkPos], &data[totalWrite], (uint32_t)numWrite);
-            totalWrite += (uint32_t)numWrite;
+            memcpy(&sysData->chunks[posChunkIndex].data[posChunkPos], &data[totalWrite], (size_t)numWrite);
+            totalWrite += numWrite;
             sysData->position += numWrite;
             posChunkPos += numWrite;
             if (posChunkPos > sysData->chunks[posChunkIndex].size)
@@ -269,6 +513,11 @@ static uint32_t mem_file_write(MXFFileSysData *sysData, const uint8_t *data, uin
     return totalWrite;
 }
 
+static uint32_t mem_file_write(MXFFileSysData *sysData, const uint8_t *data, uint32_t count)
+{
+    return (uint32_t)mem_file_write_64(sysData, data, count);
+}
+
 static int mem_file_getchar(MXFFileSysData *sysData)
 {
     unsigned char data;
@@ -354,6 +603,9 @@ int mxf_mem_file_open_new(uint32_t chunkSize, int64_t virtualStartPos, MXFMemory
     newMXFFile->tell            = mem_file_tell;
     newMXFFile->is_seekable     = mem_file_is_seekable;
     newMXFFile->size            = mem_file_size;
+    newMXFFile->read_view       = mem_file_read_view;
+    newMXFFile->read_64         = mem_file_read_64;
+    newMXFFile->write_64        = mem_file_write_64;
     newMXFFile->free_sys_data   = free_mem_file;
 
 
@@ -361,6 +613,8 @@ int mxf_mem_file_open_new(uint32_t chunkSize, int64_t virtualStartPos, MXFMemory
     memset(newMXFFile->sysData, 0, sizeof(*newMXFFile->sysData));
 
     newMXFFile->sysData->chunkSize          = (chunkSize == 0 ? DEFAULT_CHUNK_SIZE : chunkSize);
+    newMXFFile->sysData->maxChunkSize       = newMXFFile->sysData->chunkSize;
+    newMXFFile->sysData->nextChunkSize      = newMXFFile->sysData->chunkSize;
     newMXFFile->sysData->virtualStartPos    = virtualStartPos;
     newMXFFile->sysData->mxfMemFile.mxfFile = newMXFFile;
 
@@ -391,6 +645,9 @@ int mxf_mem_file_open_read(const unsigned char *data, int64_t size, int64_t virt
     newMXFFile->tell            = mem_file_tell;
     newMXFFile->is_seekable     = mem_file_is_seekable;
     newMXFFile->size            = mem_file_size;
+    newMXFFile->read_view       = mem_file_read_view;
+    newMXFFile->read_64         = mem_file_read_64;
+    newMXFFile->write_64        = mem_file_write_64;
     newMXFFile->free_sys_data   = free_mem_file;
 
 
@@ -407,6 +664,8 @@ int mxf_mem_file_open_read(const unsigned char *data, int64_t size, int64_t virt
     newMXFFile->sysData->chunks->data      = (unsigned char*)data;
     newMXFFile->sysData->chunks->allocSize = size;
     newMXFFile->sysData->chunks->size      = size;
+    newMXFFile->sysData->chunks->start     = 0;
+    newMXFFile->sysData->chunks->owned     = 0;
     newMXFFile->sysData->numChunks++;
 
 
@@ -456,33 +715,278 @@ int64_t mxf_mem_file_get_size(MXFMemoryFile *mxfMemFile)
     if (sysData->numChunks == 0)
         return 0;
 
-    return (int64_t)sysData->chunkSize * (sysData->numChunks - 1) +
-           sysData->chunks[sysData->numChunks - 1].size;
+    return sysData->chunks[sysData->numChunks - 1].start + sysData->chunks[sysData->numChunks - 1].size;
 }
 
-int mxf_mem_file_flush_to_file(MXFMemoryFile *mxfMemFile, MXFFile *mxfFile)
+int mxf_mem_file_set_chunk_growth(MXFMemoryFile *mxfMemFile, uint32_t maxChunkSize)
+{
+    MXFFileSysData *sysData = mxfMemFile->mxfFile->sysData;
+
+    if (sysData->readOnly || maxChunkSize < sysData->chunkSize) {
+        mxf_log_error("Invalid memory file maximum chunk size %u" LOG_LOC_FORMAT, maxChunkSize, LOG_LOC_PARAMS);
+        return 0;
+    }
+
+    sysData->maxChunkSize = maxChunkSize;
+    return 1;
+}
+
+int mxf_mem_file_adopt_chunk(MXFMemoryFile *mxfMemFile, unsigned char *data, int64_t size, int takeOwnership)
 {
     MXFFileSysData *sysData = mxfMemFile->mxfFile->sysData;
+    Chunk *newChunks;
+    Chunk *chunk;
+
+    if (sysData->readOnly || sysData->isShared || size <= 0) {
+        mxf_log_error("Cannot adopt memory file chunk" LOG_LOC_FORMAT, LOG_LOC_PARAMS);
+        return 0;
+    }
+
+    newChunks = (Chunk*)realloc(sysData->chunks, (sysData->numChunks + 1) * sizeof(Chunk));
+    if (!newChunks) {
+        mxf_log_error("Failed to reallocate memory file chunks" LOG_LOC_FORMAT, LOG_LOC_PARAMS);
+        return 0;
+    }
+    sysData->chunks = newChunks;
 
+    /* the unused space at the end of the last chunk is no longer available because all but the last chunk must
+       be full. Trailing empty chunks are removed */
+    while (sysData->numChunks > 0 && sysData->chunks[sysData->numChunks - 1].size == 0) {
+        if (sysData->chunks[sysData->numChunks - 1].owned)
+            free(sysData->chunks[sysData->numChunks - 1].data);
+        sysData->numChunks--;
+    }
+    if (sysData->numChunks > 0)
+        sysData->chunks[sysData->numChunks - 1].allocSize = sysData->chunks[sysData->numChunks - 1].size;
+
+    chunk = &sysData->chunks[sysData->numChunks];
+    chunk->data      = data;
+    chunk->allocSize = size;
+    chunk->size      = size;
+    chunk->start     = mxf_mem_file_get_size(mxfMemFile);
+    chunk->owned     = takeOwnership;
+    sysData->numChunks++;
+
+    return 1;
+}
+
+int mxf_mem_file_flush_to_file(MXFMemoryFile *mxfMemFile, MXFFile *mxfFile)
+{
+    MXFFileSysData *sysData = mxfMemFile->mxfFile->sysData;
+    MXFIOVec *iov;
+    int iovcnt = 0;
+    int64_t offset;
+    uint64_t total = 0;
     size_t i;
+    int result;
+
+    /* gather the chunks into a single vectored write, splitting chunks that exceed the buffer size limit */
+    for (i = 0; i < sysData->numChunks; i++)
+        iovcnt += (int)((sysData->chunks[i].size + MAX_FLUSH_IOVEC_SIZE - 1) / MAX_FLUSH_IOVEC_SIZE);
+    if (iovcnt == 0)
+        return 1;
+
+    CHK_MALLOC_ARRAY_ORET(iov, MXFIOVec, iovcnt);
+    iovcnt = 0;
     for (i = 0; i < sysData->numChunks; i++) {
-        const unsigned char *data = sysData->chunks[i].data;
-        int64_t remainder = sysData->chunks[i].size;
-        uint32_t writeSize;
-        while (remainder > 0) {
-            if (remainder > UINT32_MAX)
-                writeSize = UINT32_MAX;
+        for (offset = 0; offset < sysData->chunks[i].size; offset += MAX_FLUSH_IOVEC_SIZE) {
+            iov[iovcnt].data = &sysData->chunks[i].data[offset];
+            if (sysData->chunks[i].size - offset > MAX_FLUSH_IOVEC_SIZE)
+                iov[iovcnt].size = MAX_FLUSH_IOVEC_SIZE;
             else
-                writeSize = (uint32_t)remainder;
+                iov[iovcnt].size = (uint32_t)(sysData->chunks[i].size - offset);
+            total += iov[iovcnt].size;
+            iovcnt++;
+        }
+    }
 
-            if (!mxf_file_write(mxfFile, data, writeSize))
-                return 0;
+    result = (mxf_file_writev(mxfFile, iov, iovcnt) == total);
 
-            data += writeSize;
-            remainder -= writeSize;
-        }
+    free(iov);
+    return result;
+}
+
+
+int mxf_mem_file_open_new_shared(const char *name, uint32_t initialSize, int64_t virtualStartPos,
+                                 MXFMemoryFile **mxfMemFile)
+{
+#if defined(HAVE_SHARED_MEM_FILE)
+    MXFMemoryFile *newMemFile = NULL;
+    MXFFileSysData *sysData;
+    int fd;
+    int canSeal;
+
+    CHK_ORET(create_shared_segment(name, &fd, &canSeal));
+    if (!mxf_mem_file_open_new(initialSize, virtualStartPos, &newMemFile)) {
+        close(fd);
+        if (name)
+            shm_unlink(name);
+        return 0;
+    }
+
+    sysData = newMemFile->mxfFile->sysData;
+    sysData->isShared = 1;
+    sysData->sharedFd = fd;
+    sysData->canSeal  = canSeal;
+
+    *mxfMemFile = newMemFile;
+    return 1;
+#else
+    (void)name;
+    (void)initialSize;
+    (void)virtualStartPos;
+    (void)mxfMemFile;
+    mxf_log_error("Shared memory files are not supported on this platform" LOG_LOC_FORMAT, LOG_LOC_PARAMS);
+    return 0;
+#endif
+}
+
+int mxf_mem_file_open_read_shared_fd(int fd, int64_t virtualStartPos, MXFMemoryFile **mxfMemFile)
+{
+#if defined(HAVE_SHARED_MEM_FILE)
+    MXFMemoryFile *newMemFile = NULL;
+    MXFFileSysData *sysData;
+    unsigned char *mapData;
+    struct stat statBuf;
+
+    if (fstat(fd, &statBuf) != 0) {
+        mxf_log_error("Failed to stat shared memory segment: %s" LOG_LOC_FORMAT, strerror(errno), LOG_LOC_PARAMS);
+        return 0;
     }
+    CHK_ORET(map_shared_segment(fd, statBuf.st_size, 0, &mapData));
+
+    /* the mapping remains valid after the descriptor is closed and so the descriptor is not kept */
+    if (!mxf_mem_file_open_read(mapData, statBuf.st_size, virtualStartPos, &newMemFile)) {
+        if (mapData)
+            munmap(mapData, (size_t)statBuf.st_size);
+        return 0;
+    }
+
+    sysData = newMemFile->mxfFile->sysData;
+    sysData->isShared = 1;
+    sysData->sharedFd = -1;
 
+    *mxfMemFile = newMemFile;
     return 1;
+#else
+    (void)fd;
+    (void)virtualStartPos;
+    (void)mxfMemFile;
+    mxf_log_error("Shared memory files are not supported on this platform" LOG_LOC_FORMAT, LOG_LOC_PARAMS);
+    return 0;
+#endif
+}
+
+int mxf_mem_file_open_read_shared(const char *name, int64_t virtualStartPos, MXFMemoryFile **mxfMemFile)
+{
+#if defined(HAVE_SHARED_MEM_FILE) && defined(HAVE_SHM_OPEN)
+    int fd;
+    int result;
+
+    fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        mxf_log_error("Failed to open shared memory segment '%s': %s" LOG_LOC_FORMAT,
+                      name, strerror(errno), LOG_LOC_PARAMS);
+        return 0;
+    }
+
+    result = mxf_mem_file_open_read_shared_fd(fd, virtualStartPos, mxfMemFile);
+
+    close(fd);
+    return result;
+#else
+    (void)name;
+    (void)virtualStartPos;
+    (void)mxfMemFile;
+    mxf_log_error("Named shared memory segments are not supported" LOG_LOC_FORMAT, LOG_LOC_PARAMS);
+    return 0;
+#endif
+}
+
+int mxf_mem_file_get_shared_fd(MXFMemoryFile *mxfMemFile)
+{
+    MXFFileSysData *sysData = mxfMemFile->mxfFile->sysData;
+
+    if (!sysData->isShared)
+        return -1;
+
+    return sysData->sharedFd;
 }
 
+int mxf_mem_file_seal_shared(MXFMemoryFile *mxfMemFile)
+{
+#if defined(HAVE_SHARED_MEM_FILE)
+    MXFFileSysData *sysData = mxfMemFile->mxfFile->sysData;
+    unsigned char *mapData;
+    int64_t allocSize;
+    int64_t size;
+    int sealed = 0;
+
+    if (!sysData->isShared || sysData->readOnly) {
+        mxf_log_error("Memory file is not a writable shared memory file" LOG_LOC_FORMAT, LOG_LOC_PARAMS);
+        return 0;
+    }
+
+    /* remove the writable mapping first because a memfd cannot be write sealed whilst it exists */
+    size = mxf_mem_file_get_size(mxfMemFile);
+    allocSize = (sysData->numChunks > 0 ? sysData->chunks[0].allocSize : 0);
+    unmap_shared_segment(sysData);
+    if (sysData->numChunks > 0) {
+        sysData->chunks[0].data      = NULL;
+        sysData->chunks[0].allocSize = 0;
+    }
+
+    if (ftruncate(sysData->sharedFd, size) != 0) {
+        mxf_log_error("Failed to truncate shared memory segment to %"PRId64" bytes: %s" LOG_LOC_FORMAT,
+                      size, strerror(errno), LOG_LOC_PARAMS);
+        goto fail;
+    }
+    allocSize = size;
+#if defined(F_ADD_SEALS)
+    if (sysData->canSeal &&
+        fcntl(sysData->sharedFd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0)
+    {
+        mxf_log_error("Failed to seal shared memory segment: %s" LOG_LOC_FORMAT, strerror(errno), LOG_LOC_PARAMS);
+        goto fail;
+    }
+    sealed = sysData->canSeal;
+#endif
+    CHK_OFAIL(map_shared_segment(sysData->sharedFd, size, 0, &mapData));
+
+    if (sysData->numChunks > 0) {
+        sysData->chunks[0].data      = mapData;
+        sysData->chunks[0].allocSize = size;
+    }
+    sysData->readOnly = 1;
+
+    return 1;
+
+fail:
+    /* restore the writable mapping if the segment was not write sealed, otherwise the file is made unusable by
+       removing the chunk so that reads and writes fail */
+    if (sysData->numChunks > 0) {
+        if (!sealed && map_shared_segment(sysData->sharedFd, allocSize, 1, &mapData)) {
+            sysData->chunks[0].data      = mapData;
+            sysData->chunks[0].allocSize = allocSize;
+        } else {
+            SAFE_FREE(sysData->chunks);
+            sysData->numChunks = 0;
+            sysData->readOnly = 1;
+        }
+    }
+    return 0;
+#else
+    (void)mxfMemFile;
+    return 0;
+#endif
+}
+
+int mxf_mem_file_unlink_shared(const char *name)
+{
+#if defined(HAVE_SHARED_MEM_FILE) && defined(HAVE_SHM_OPEN)
+    return shm_unlink(name) == 0;
+#else
+    (void)name;
+    return 0;
+#endif
+}
@@ -57,9 +57,36 @@ int64_t mxf_mem_file_get_chunk_size(MXFMemoryFile *mxfMemFile, size_t chunkIndex
 
 int64_t mxf_mem_file_get_size(MXFMemoryFile *mxfMemFile);
 
+/* allocate new chunks that double in size, starting at chunkSize, up to maxChunkSize */
+int mxf_mem_file_set_chunk_growth(MXFMemoryFile *mxfMemFile, uint32_t maxChunkSize);
+
+/* append the data to the end of the file as a new chunk without copying. The data is freed when the file is
+   closed if takeOwnership is true, otherwise the caller must keep the data until the file is closed */
+int mxf_mem_file_adopt_chunk(MXFMemoryFile *mxfMemFile, unsigned char *data, int64_t size, int takeOwnership);
+
+/* write all chunks to the file using a single vectored write */
 int mxf_mem_file_flush_to_file(MXFMemoryFile *mxfMemFile, MXFFile *mxfFile);
 
 
+/* shared memory files hold the data in a single contiguous shared memory segment that another process can map
+   without copying. The segment is a memfd if name is NULL, which is passed to the consumer as a file descriptor,
+   otherwise it is a named POSIX shared memory segment. The segment grows by remapping, which invalidates
+   pointers returned by mxf_mem_file_get_chunk_data and read views */
+int mxf_mem_file_open_new_shared(const char *name, uint32_t initialSize, int64_t virtualStartPos,
+                                 MXFMemoryFile **mxfMemFile);
+int mxf_mem_file_get_shared_fd(MXFMemoryFile *mxfMemFile);
+
+/* truncate the segment to the file size and make the file read-only. A memfd is also sealed against writes and
+   size changes so that the consumer can use the data without copying it */
+int mxf_mem_file_seal_shared(MXFMemoryFile *mxfMemFile);
+
+/* map the whole segment read-only. The descriptor is not kept open */
+int mxf_mem_file_open_read_shared_fd(int fd, int64_t virtualStartPos, MXFMemoryFile **mxfMemFile);
+int mxf_mem_file_open_read_shared(const char *name, int64_t virtualStartPos, MXFMemoryFile **mxfMemFile);
+
+int mxf_mem_file_unlink_shared(const char *name);
+
+
 
 #ifdef __cplusplus
 }
@@ -39,29 +39,59 @@
 #include <errno.h>
 
 #if defined(_WIN32)
+#include <windows.h>
 #include <io.h>
 #include <fcntl.h>
 #include <sys/stat.h>
 #else
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #endif
 
+#if defined(HAVE_PTHREAD)
+#include <pthread.h>
+#endif
+
 #include <mxf/mxf.h>
 #include <mxf/mxf_page_file.h>
 #include <mxf/mxf_macros.h>
 
+#include "mxf_file_int.h"
+
 
 #if defined(_MSC_VER) && (_MSC_VER < 1400)
 #error Visual C++ 2005 or later is required. Earlier versions do not support 64-bit stream I/O
 #endif
 
-
-#define MAX_FILE_DESCRIPTORS        32
+/* default maximum number of page files kept open */
+#define DEFAULT_MAX_OPEN_FILES      32
 
 #define PAGE_ALLOC_INCR             64
 
+/* direct I/O buffer size for each open page file */
+#define DIRECT_BUFFER_SIZE          (1024 * 1024)
+
+/* maximum number of page files opened to start reading ahead a range */
+#define MAX_WILLNEED_PAGES          4
+
+/* minimum size of a buffer queued for writing to a striped page file directory */
+#define STRIPE_BUFFER_SIZE          (1024 * 1024)
+
+/* maximum size of the data queued for writing to each striped page file directory */
+#define MAX_STRIPE_QUEUE_SIZE       (8 * 1024 * 1024)
+
+
+/* the descriptor pool is shared by threads reading duplicates of the page file */
+#if defined(_WIN32)
+#define HAVE_POOL_MUTEX             1
+typedef CRITICAL_SECTION PoolMutex;
+#elif defined(HAVE_PTHREAD)
+#define HAVE_POOL_MUTEX             1
+typedef pthread_mutex_t PoolMutex;
+#endif
+
 
 typedef enum
 {
@@ -75,21 +105,89 @@ typedef struct FileDescriptor
     struct FileDescriptor *prev;
     struct FileDescriptor *next;
 
-    struct Page *page;
+    int fileIndex;
+    int useCount;       /* number of reads or writes in progress */
+    int isDetached;     /* removed from the pool whilst in use; closed when the last use is released */
 
-    FILE *file;
+    int fileId;
+    MXFFile *directFile;
+#if defined(HAVE_POOL_MUTEX)
+    PoolMutex ioLock;   /* serialises seek followed by read or write where there is no positional I/O */
+#endif
 } FileDescriptor;
 
+/* the open page files are shared by a page file and its duplicates. Reads and writes use positional I/O and don't
+   depend on a file offset, allowing the duplicates to read different pages (or the same page) concurrently */
+typedef struct
+{
+#if defined(HAVE_POOL_MUTEX)
+    PoolMutex lock;
+#endif
+    int refCount;
+
+    FileMode mode;
+    char **filenameTemplates;           /* page i is in file filenameTemplates[i % numFilenameTemplates] */
+    int numFilenameTemplates;
+    int directIO;
+    MXFFileAdvice accessAdvice;
+
+    FileDescriptor **fileDescriptors;   /* open file descriptor for each page file, or NULL */
+    int numFileDescriptors;
+
+    FileDescriptor *head;               /* least recently used */
+    FileDescriptor *tail;
+    int numOpen;
+    int maxOpen;
+
+    /* time-shift ring mode: page i is in file i % ringMaxPages and only pages ringFirstPage .. ringNumPages - 1
+       are available. The ring state is shared with the ring readers */
+    int ringMaxPages;
+    int64_t ringFirstPage;
+    int64_t ringNumPages;
+    int64_t ringSize;
+    int64_t *ringReaderPositions;       /* position of each ring reader, or -1 for an unused entry */
+    int numRingReaderPositions;
+} DescriptorPool;
+
+typedef struct StripeBuffer
+{
+    struct StripeBuffer *next;
+
+    FileDescriptor *fileDesc;   /* held in use until the buffer is written */
+    int64_t offset;
+    uint8_t *data;
+    uint32_t size;
+    uint32_t allocatedSize;
+} StripeBuffer;
+
+/* the pages of a striped page file placed in one directory are written by a separate thread, allowing the pages
+   on independent volumes to be written concurrently */
+typedef struct
+{
+#if defined(HAVE_PTHREAD)
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+#endif
+    DescriptorPool *pool;
+    int threadStarted;
+
+    StripeBuffer *head;
+    StripeBuffer *tail;
+    uint32_t queuedSize;
+    int isWriting;
+    int stop;
+    int error;
+} StripeWriter;
+
 typedef struct Page
 {
     int wasRemoved;
 
-    FileDescriptor *fileDescriptor;
     int wasOpenedBefore;
     int index;
 
     int64_t size;
-    int64_t offset;
 } Page;
 
 struct MXFPageFile
@@ -103,51 +201,248 @@ struct MXFFileSysData
 
     int64_t pageSize;
     FileMode mode;
-    char *filenameTemplate;
+    DescriptorPool *pool;
+
+    StripeWriter *stripeWriters;
+    int numStripeWriters;
+
+    int isRingReader;
+    int ringReaderIndex;
 
     int64_t position;
 
     Page *pages;
     int numPages;
     int numPagesAllocated;
-
-    FileDescriptor *fileDescriptorHead;
-    FileDescriptor *fileDescriptorTail;
-    int numFileDescriptors;
 };
 
 
+#if defined(HAVE_POOL_MUTEX)
+static int init_pool_mutex(PoolMutex *mutex)
+{
+#if defined(_WIN32)
+    InitializeCriticalSection(mutex);
+    return 1;
+#else
+    return pthread_mutex_init(mutex, NULL) == 0;
+#endif
+}
+
+static void destroy_pool_mutex(PoolMutex *mutex)
+{
+#if defined(_WIN32)
+    DeleteCriticalSection(mutex);
+#else
+    pthread_mutex_destroy(mutex);
+#endif
+}
+
+static void lock_pool_mutex(PoolMutex *mutex)
+{
+#if defined(_WIN32)
+    EnterCriticalSection(mutex);
+#else
+    pthread_mutex_lock(mutex);
+#endif
+}
+
+static void unlock_pool_mutex(PoolMutex *mutex)
+{
+#if defined(_WIN32)
+    LeaveCriticalSection(mutex);
+#else
+    pthread_mutex_unlock(mutex);
+#endif
+}
+#endif
+
+static void lock_descriptor_io(FileDescriptor *fileDesc)
+{
+#if defined(HAVE_POOL_MUTEX)
+    lock_pool_mutex(&fileDesc->ioLock);
+#else
+    (void)fileDesc;
+#endif
+}
+
+static void unlock_descriptor_io(FileDescriptor *fileDesc)
+{
+#if defined(HAVE_POOL_MUTEX)
+    unlock_pool_mutex(&fileDesc->ioLock);
+#else
+    (void)fileDesc;
+#endif
+}
+
 static void disk_file_close(FileDescriptor *fileDesc)
 {
-    if (fileDesc->file != NULL)
+    if (fileDesc->directFile != NULL)
+    {
+        mxf_file_close(&fileDesc->directFile);
+    }
+    if (fileDesc->fileId >= 0)
     {
-        fclose(fileDesc->file);
-        fileDesc->file = NULL;
+#if defined(_WIN32)
+        _close(fileDesc->fileId);
+#else
+        close(fileDesc->fileId);
+#endif
+        fileDesc->fileId = -1;
     }
 }
 
-static uint32_t disk_file_read(FileDescriptor *fileDesc, uint8_t *data, uint32_t count)
+static void free_descriptor(FileDescriptor *fileDesc)
 {
-    uint32_t result = (uint32_t)fread(data, 1, count, fileDesc->file);
-    if (result != count && ferror(fileDesc->file))
-        mxf_log_error("fread failed: %s\n", strerror(errno));
-    return result;
+    disk_file_close(fileDesc);
+#if defined(HAVE_POOL_MUTEX)
+    destroy_pool_mutex(&fileDesc->ioLock);
+#endif
+    free(fileDesc);
 }
 
-static uint32_t disk_file_write(FileDescriptor *fileDesc, const uint8_t *data, uint32_t count)
+static uint32_t disk_file_read(FileDescriptor *fileDesc, int64_t offset, uint8_t *data, uint32_t count)
 {
-    uint32_t result = (uint32_t)fwrite(data, 1, count, fileDesc->file);
-    if (result != count)
-        mxf_log_error("fwrite failed: %s\n", strerror(errno));
-    return result;
+    uint32_t totalRead = 0;
+#if defined(_WIN32)
+    int result;
+#else
+    ssize_t result;
+#endif
+
+    /* the direct I/O file and the Windows descriptor have a file position and so the seek and read must not be
+       interleaved with I/O from another thread */
+    if (fileDesc->directFile != NULL)
+    {
+        lock_descriptor_io(fileDesc);
+        if (mxf_file_seek(fileDesc->directFile, offset, SEEK_SET))
+        {
+            totalRead = mxf_file_read(fileDesc->directFile, data, count);
+        }
+        unlock_descriptor_io(fileDesc);
+        return totalRead;
+    }
+
+#if defined(_WIN32)
+    lock_descriptor_io(fileDesc);
+    if (_lseeki64(fileDesc->fileId, offset, SEEK_SET) < 0)
+    {
+        mxf_log_error("_lseeki64 failed: %s\n", strerror(errno));
+        unlock_descriptor_io(fileDesc);
+        return 0;
+    }
+#endif
+
+    while (totalRead < count)
+    {
+#if defined(_WIN32)
+        result = _read(fileDesc->fileId, &data[totalRead], count - totalRead);
+#else
+        result = pread(fileDesc->fileId, &data[totalRead], count - totalRead, (off_t)(offset + totalRead));
+#endif
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+#if defined(_WIN32)
+            mxf_log_error("_read failed: %s\n", strerror(errno));
+#else
+            mxf_log_error("pread failed: %s\n", strerror(errno));
+#endif
+            break;
+        }
+        if (result == 0)
+        {
+            break;
+        }
+        totalRead += (uint32_t)result;
+    }
+
+#if defined(_WIN32)
+    unlock_descriptor_io(fileDesc);
+#endif
+
+    return totalRead;
+}
+
+static uint32_t disk_file_write(FileDescriptor *fileDesc, int64_t offset, const uint8_t *data, uint32_t count)
+{
+    uint32_t totalWrite = 0;
+#if defined(_WIN32)
+    int result;
+#else
+    ssize_t result;
+#endif
+
+    if (fileDesc->directFile != NULL)
+    {
+        lock_descriptor_io(fileDesc);
+        if (mxf_file_seek(fileDesc->directFile, offset, SEEK_SET))
+        {
+            totalWrite = mxf_file_write(fileDesc->directFile, data, count);
+        }
+        unlock_descriptor_io(fileDesc);
+        return totalWrite;
+    }
+
+#if defined(_WIN32)
+    lock_descriptor_io(fileDesc);
+    if (_lseeki64(fileDesc->fileId, offset, SEEK_SET) < 0)
+    {
+        mxf_log_error("_lseeki64 failed: %s\n", strerror(errno));
+        unlock_descriptor_io(fileDesc);
+        return 0;
+    }
+#endif
+
+    while (totalWrite < count)
+    {
+#if defined(_WIN32)
+        result = _write(fileDesc->fileId, &data[totalWrite], count - totalWrite);
+#else
+        result = pwrite(fileDesc->fileId, &data[totalWrite], count - totalWrite, (off_t)(offset + totalWrite));
+#endif
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+#if defined(_WIN32)
+            mxf_log_error("_write failed: %s\n", strerror(errno));
+#else
+            mxf_log_error("pwrite failed: %s\n", strerror(errno));
+#endif
+            break;
+        }
+        totalWrite += (uint32_t)result;
+    }
+
+#if defined(_WIN32)
+    unlock_descriptor_io(fileDesc);
+#endif
+
+    return totalWrite;
 }
 
-static int disk_file_seek(FileDescriptor *fileDesc, int64_t offset, int whence)
+static int disk_file_advise(FileDescriptor *fileDesc, int64_t offset, int64_t len, MXFFileAdvice advice)
 {
 #if defined(_WIN32)
-    return _fseeki64(fileDesc->file, offset, whence) == 0;
+    (void)fileDesc;
+    (void)offset;
+    (void)len;
+    (void)advice;
+
+    return 1;
 #else
-    return fseeko(fileDesc->file, offset, whence) == 0;
+    if (fileDesc->directFile != NULL)
+    {
+        /* direct I/O bypasses the page cache */
+        return 1;
+    }
+
+    return mxf_fd_advise(fileDesc->fileId, offset, len, advice);
 #endif
 }
 
@@ -164,250 +459,980 @@ static int64_t disk_file_size(const char *filename)
         return -1;
     }
 
-    return statBuf.st_size;
+    return statBuf.st_size;
+}
+
+
+
+static void free_filename_templates(char ***filenameTemplates, int numFilenameTemplates)
+{
+    int i;
+
+    if (*filenameTemplates == NULL)
+    {
+        return;
+    }
+
+    for (i = 0; i < numFilenameTemplates; i++)
+    {
+        SAFE_FREE((*filenameTemplates)[i]);
+    }
+    SAFE_FREE(*filenameTemplates);
+}
+
+static int create_filename_templates(const char **directories, int numDirectories, const char *filenameTemplate,
+                                     char ***filenameTemplates, int *numFilenameTemplates)
+{
+    char **newTemplates = NULL;
+    int numNewTemplates = (numDirectories > 0 ? numDirectories : 1);
+    size_t dirLen;
+    size_t len;
+    size_t i;
+    int d;
+
+    if (strstr(filenameTemplate, "%d") == NULL)
+    {
+        mxf_log_error("Filename template '%s' doesn't contain %%d\n", filenameTemplate);
+        return 0;
+    }
+
+    CHK_MALLOC_ARRAY_ORET(newTemplates, char*, numNewTemplates);
+    memset(newTemplates, 0, numNewTemplates * sizeof(char*));
+
+    if (numDirectories == 0)
+    {
+        CHK_OFAIL((newTemplates[0] = strdup(filenameTemplate)) != NULL);
+    }
+    else
+    {
+        /* prefix the template with the directory, escaping any '%' in the directory name */
+        for (d = 0; d < numDirectories; d++)
+        {
+            dirLen = strlen(directories[d]);
+            CHK_MALLOC_ARRAY_OFAIL(newTemplates[d], char, dirLen * 2 + 1 + strlen(filenameTemplate) + 1);
+            len = 0;
+            for (i = 0; i < dirLen; i++)
+            {
+                if (directories[d][i] == '%')
+                {
+                    newTemplates[d][len++] = '%';
+                }
+                newTemplates[d][len++] = directories[d][i];
+            }
+#if defined(_WIN32)
+            if (dirLen > 0 && directories[d][dirLen - 1] != '/' && directories[d][dirLen - 1] != '\\')
+#else
+            if (dirLen > 0 && directories[d][dirLen - 1] != '/')
+#endif
+            {
+                newTemplates[d][len++] = '/';
+            }
+            strcpy(&newTemplates[d][len], filenameTemplate);
+        }
+    }
+
+    *filenameTemplates = newTemplates;
+    *numFilenameTemplates = numNewTemplates;
+    return 1;
+
+fail:
+    free_filename_templates(&newTemplates, numNewTemplates);
+    return 0;
+}
+
+static void get_page_filename(char **filenameTemplates, int numFilenameTemplates, int fileIndex,
+                              char *filename, size_t filenameSize)
+{
+    mxf_snprintf(filename, filenameSize, filenameTemplates[fileIndex % numFilenameTemplates], fileIndex);
+}
+
+
+
+static void lock_pool(DescriptorPool *pool)
+{
+#if defined(HAVE_POOL_MUTEX)
+    lock_pool_mutex(&pool->lock);
+#else
+    (void)pool;
+#endif
+}
+
+static void unlock_pool(DescriptorPool *pool)
+{
+#if defined(HAVE_POOL_MUTEX)
+    unlock_pool_mutex(&pool->lock);
+#else
+    (void)pool;
+#endif
+}
+
+static int create_pool(const char **directories, int numDirectories, const char *filenameTemplate, FileMode mode,
+                       int directIO, DescriptorPool **pool)
+{
+    DescriptorPool *newPool;
+
+    CHK_MALLOC_ORET(newPool, DescriptorPool);
+    memset(newPool, 0, sizeof(*newPool));
+    newPool->refCount = 1;
+    newPool->mode = mode;
+    newPool->directIO = directIO;
+    newPool->maxOpen = DEFAULT_MAX_OPEN_FILES;
+
+    if (!create_filename_templates(directories, numDirectories, filenameTemplate,
+                                   &newPool->filenameTemplates, &newPool->numFilenameTemplates))
+    {
+        free(newPool);
+        return 0;
+    }
+
+#if defined(HAVE_POOL_MUTEX)
+    if (!init_pool_mutex(&newPool->lock))
+    {
+        mxf_log_error("Failed to initialise page file descriptor pool mutex\n");
+        free_filename_templates(&newPool->filenameTemplates, newPool->numFilenameTemplates);
+        free(newPool);
+        return 0;
+    }
+#endif
+
+    *pool = newPool;
+    return 1;
+}
+
+static void release_pool(DescriptorPool **pool)
+{
+    FileDescriptor *fd;
+    FileDescriptor *nextFd;
+    int refCount;
+
+    if (*pool == NULL)
+    {
+        return;
+    }
+
+    lock_pool(*pool);
+    refCount = --(*pool)->refCount;
+    unlock_pool(*pool);
+    if (refCount > 0)
+    {
+        *pool = NULL;
+        return;
+    }
+
+    fd = (*pool)->head;
+    while (fd != NULL)
+    {
+        nextFd = fd->next;
+        free_descriptor(fd);
+        fd = nextFd;
+    }
+
+#if defined(HAVE_POOL_MUTEX)
+    destroy_pool_mutex(&(*pool)->lock);
+#endif
+    SAFE_FREE((*pool)->fileDescriptors);
+    SAFE_FREE((*pool)->ringReaderPositions);
+    free_filename_templates(&(*pool)->filenameTemplates, (*pool)->numFilenameTemplates);
+    SAFE_FREE(*pool);
+}
+
+static void unlink_descriptor(DescriptorPool *pool, FileDescriptor *fd)
+{
+    if (fd->next != NULL)
+    {
+        fd->next->prev = fd->prev;
+    }
+    else
+    {
+        pool->tail = fd->prev;
+    }
+    if (fd->prev != NULL)
+    {
+        fd->prev->next = fd->next;
+    }
+    else
+    {
+        pool->head = fd->next;
+    }
+    fd->prev = NULL;
+    fd->next = NULL;
+}
+
+static void append_descriptor(DescriptorPool *pool, FileDescriptor *fd)
+{
+    fd->prev = pool->tail;
+    fd->next = NULL;
+    if (pool->tail != NULL)
+    {
+        pool->tail->next = fd;
+    }
+    else
+    {
+        pool->head = fd;
+    }
+    pool->tail = fd;
+}
+
+static void close_unused_descriptors(DescriptorPool *pool, int maxOpen)
+{
+    FileDescriptor *fd;
+    FileDescriptor *nextFd;
+
+    /* close the least recently used descriptors that are not being read from or written to */
+    fd = pool->head;
+    while (fd != NULL && pool->numOpen > maxOpen)
+    {
+        nextFd = fd->next;
+        if (fd->useCount == 0)
+        {
+            unlink_descriptor(pool, fd);
+            pool->fileDescriptors[fd->fileIndex] = NULL;
+            pool->numOpen--;
+            free_descriptor(fd);
+        }
+        fd = nextFd;
+    }
+}
+
+static FileDescriptor* open_descriptor(DescriptorPool *pool, int fileIndex, int isNewPage)
+{
+    FileDescriptor *newFileDescriptor = NULL;
+    char filename[4096];
+    int flags = 0;
+
+    CHK_MALLOC_ORET(newFileDescriptor, FileDescriptor);
+    memset(newFileDescriptor, 0, sizeof(*newFileDescriptor));
+    newFileDescriptor->fileIndex = fileIndex;
+    newFileDescriptor->fileId = -1;
+#if defined(HAVE_POOL_MUTEX)
+    if (!init_pool_mutex(&newFileDescriptor->ioLock))
+    {
+        mxf_log_error("Failed to initialise page file descriptor mutex\n");
+        free(newFileDescriptor);
+        return NULL;
+    }
+#endif
+
+    get_page_filename(pool->filenameTemplates, pool->numFilenameTemplates, fileIndex, filename, sizeof(filename));
+    if (pool->directIO)
+    {
+        int result;
+        if (isNewPage)
+        {
+            result = mxf_disk_file_open_new_direct(filename, DIRECT_BUFFER_SIZE, &newFileDescriptor->directFile);
+        }
+        else
+        {
+            result = mxf_disk_file_open_modify_direct(filename, DIRECT_BUFFER_SIZE, &newFileDescriptor->directFile);
+        }
+        if (!result)
+        {
+            mxf_log_error("Failed to open paged mxf file '%s': %s\n", filename, strerror(errno));
+            goto fail;
+        }
+    }
+    else
+    {
+        switch (pool->mode)
+        {
+            case READ_MODE:
+                flags = O_RDONLY;
+                break;
+            case WRITE_MODE:
+                flags = O_RDWR;
+                if (isNewPage)
+                {
+                    flags |= O_CREAT | O_TRUNC;
+                }
+                break;
+            case MODIFY_MODE:
+                flags = O_RDWR | O_CREAT;
+                break;
+        }
+#if defined(_WIN32)
+        newFileDescriptor->fileId = _open(filename, flags | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        newFileDescriptor->fileId = open(filename, flags, 0666);
+#endif
+        if (newFileDescriptor->fileId < 0)
+        {
+            mxf_log_error("Failed to open paged mxf file '%s': %s\n", filename, strerror(errno));
+            goto fail;
+        }
+    }
+
+    if (pool->accessAdvice != MXF_ADVISE_NORMAL)
+    {
+        disk_file_advise(newFileDescriptor, 0, 0, pool->accessAdvice);
+    }
+
+    return newFileDescriptor;
+
+fail:
+    free_descriptor(newFileDescriptor);
+    return NULL;
+}
+
+/* returns the descriptor for the page file in use, opening the file if required. A page must be in the window in
+   ring mode. The window is checked whilst locked so that a page can't be dropped before the descriptor is in use */
+static FileDescriptor* acquire_file(DescriptorPool *pool, int fileIndex, int64_t ringPage, int isNewPage)
+{
+    FileDescriptor *fd = NULL;
+
+    lock_pool(pool);
+
+    if (pool->ringMaxPages > 0 && ringPage < pool->ringFirstPage)
+    {
+        mxf_log_warn("Page %"PRId64" was dropped from the mxf page file ring\n", ringPage);
+        goto fail;
+    }
+
+    if (fileIndex >= pool->numFileDescriptors)
+    {
+        FileDescriptor **newFileDescriptors;
+        int newNumFileDescriptors = (fileIndex / PAGE_ALLOC_INCR + 1) * PAGE_ALLOC_INCR;
+
+        CHK_MALLOC_ARRAY_OFAIL(newFileDescriptors, FileDescriptor*, newNumFileDescriptors);
+        memset(newFileDescriptors, 0, newNumFileDescriptors * sizeof(FileDescriptor*));
+        if (pool->fileDescriptors != NULL)
+        {
+            memcpy(newFileDescriptors, pool->fileDescriptors, pool->numFileDescriptors * sizeof(FileDescriptor*));
+        }
+        SAFE_FREE(pool->fileDescriptors);
+        pool->fileDescriptors = newFileDescriptors;
+        pool->numFileDescriptors = newNumFileDescriptors;
+    }
+
+    fd = pool->fileDescriptors[fileIndex];
+    if (fd != NULL)
+    {
+        /* move to the tail, the most recently used */
+        if (fd != pool->tail)
+        {
+            unlink_descriptor(pool, fd);
+            append_descriptor(pool, fd);
+        }
+    }
+    else
+    {
+        close_unused_descriptors(pool, pool->maxOpen - 1);
+
+        fd = open_descriptor(pool, fileIndex, isNewPage);
+        if (fd == NULL)
+        {
+            goto fail;
+        }
+
+        pool->fileDescriptors[fileIndex] = fd;
+        append_descriptor(pool, fd);
+        pool->numOpen++;
+    }
+    fd->useCount++;
+
+    unlock_pool(pool);
+    return fd;
+
+fail:
+    unlock_pool(pool);
+    return NULL;
+}
+
+static FileDescriptor* acquire_descriptor(MXFFileSysData *sysData, Page *page)
+{
+    FileDescriptor *fd;
+
+    if (page->wasRemoved)
+    {
+        mxf_log_warn("Failed to open mxf page file which was removed after truncation\n");
+        return NULL;
+    }
+
+    fd = acquire_file(sysData->pool, page->index, page->index, sysData->mode == WRITE_MODE && !page->wasOpenedBefore);
+    if (fd != NULL)
+    {
+        page->wasOpenedBefore = 1;
+    }
+
+    return fd;
+}
+
+static void release_descriptor(DescriptorPool *pool, FileDescriptor *fd)
+{
+    lock_pool(pool);
+    fd->useCount--;
+    if (fd->isDetached && fd->useCount == 0)
+    {
+        free_descriptor(fd);
+    }
+    unlock_pool(pool);
+}
+
+static void detach_file(DescriptorPool *pool, int fileIndex)
+{
+    FileDescriptor *fd;
+
+    if (fileIndex < pool->numFileDescriptors && (fd = pool->fileDescriptors[fileIndex]) != NULL)
+    {
+        unlink_descriptor(pool, fd);
+        pool->fileDescriptors[fileIndex] = NULL;
+        pool->numOpen--;
+        if (fd->useCount == 0)
+        {
+            free_descriptor(fd);
+        }
+        else
+        {
+            fd->isDetached = 1;
+        }
+    }
+}
+
+static void detach_descriptor(DescriptorPool *pool, int fileIndex)
+{
+    lock_pool(pool);
+    detach_file(pool, fileIndex);
+    unlock_pool(pool);
+}
+
+
+
+#if defined(HAVE_PTHREAD)
+
+static void* stripe_writer_thread(void *arg)
+{
+    StripeWriter *writer = (StripeWriter*)arg;
+    StripeBuffer *buffer;
+    int result;
+
+    pthread_mutex_lock(&writer->lock);
+    for (;;)
+    {
+        while (writer->head == NULL && !writer->stop)
+        {
+            pthread_cond_wait(&writer->cond, &writer->lock);
+        }
+        if (writer->head == NULL)
+        {
+            break;
+        }
+
+        buffer = writer->head;
+        writer->head = buffer->next;
+        if (writer->head == NULL)
+        {
+            writer->tail = NULL;
+        }
+        writer->isWriting = 1;
+        pthread_mutex_unlock(&writer->lock);
+
+        result = (disk_file_write(buffer->fileDesc, buffer->offset, buffer->data, buffer->size) == buffer->size);
+        release_descriptor(writer->pool, buffer->fileDesc);
+
+        pthread_mutex_lock(&writer->lock);
+        writer->queuedSize -= buffer->size;
+        writer->isWriting = 0;
+        if (!result)
+        {
+            writer->error = 1;
+        }
+        pthread_cond_broadcast(&writer->cond);
+
+        free(buffer->data);
+        free(buffer);
+    }
+    pthread_mutex_unlock(&writer->lock);
+
+    return NULL;
+}
+
+static int wait_stripe_writer(StripeWriter *writer)
+{
+    int result;
+
+    pthread_mutex_lock(&writer->lock);
+    while (writer->head != NULL || writer->isWriting)
+    {
+        pthread_cond_wait(&writer->cond, &writer->lock);
+    }
+    result = !writer->error;
+    pthread_mutex_unlock(&writer->lock);
+
+    return result;
+}
+
+static int wait_stripe_writers(MXFFileSysData *sysData)
+{
+    int result = 1;
+    int i;
+
+    for (i = 0; i < sysData->numStripeWriters; i++)
+    {
+        result = wait_stripe_writer(&sysData->stripeWriters[i]) && result;
+    }
+
+    return result;
+}
+
+static int stop_stripe_writers(MXFFileSysData *sysData)
+{
+    StripeWriter *writer;
+    int result = 1;
+    int i;
+
+    if (sysData->stripeWriters == NULL)
+    {
+        return 1;
+    }
+
+    for (i = 0; i < sysData->numStripeWriters; i++)
+    {
+        writer = &sysData->stripeWriters[i];
+        if (!writer->threadStarted)
+        {
+            continue;
+        }
+
+        pthread_mutex_lock(&writer->lock);
+        writer->stop = 1;
+        pthread_cond_broadcast(&writer->cond);
+        pthread_mutex_unlock(&writer->lock);
+        pthread_join(writer->thread, NULL);
+
+        result = !writer->error && result;
+
+        pthread_cond_destroy(&writer->cond);
+        pthread_mutex_destroy(&writer->lock);
+    }
+    SAFE_FREE(sysData->stripeWriters);
+    sysData->numStripeWriters = 0;
+
+    return result;
+}
+
+static int start_stripe_writers(MXFFileSysData *sysData, int numStripes)
+{
+    StripeWriter *writer;
+    int i;
+
+    CHK_MALLOC_ARRAY_ORET(sysData->stripeWriters, StripeWriter, numStripes);
+    memset(sysData->stripeWriters, 0, numStripes * sizeof(StripeWriter));
+    sysData->numStripeWriters = numStripes;
+
+    for (i = 0; i < numStripes; i++)
+    {
+        writer = &sysData->stripeWriters[i];
+        writer->pool = sysData->pool;
+
+        if (pthread_mutex_init(&writer->lock, NULL) != 0)
+        {
+            mxf_log_error("Failed to initialise stripe writer mutex\n");
+            return 0;
+        }
+        if (pthread_cond_init(&writer->cond, NULL) != 0)
+        {
+            mxf_log_error("Failed to initialise stripe writer condition variable\n");
+            pthread_mutex_destroy(&writer->lock);
+            return 0;
+        }
+        if (pthread_create(&writer->thread, NULL, stripe_writer_thread, writer) != 0)
+        {
+            mxf_log_error("Failed to create stripe writer thread\n");
+            pthread_cond_destroy(&writer->cond);
+            pthread_mutex_destroy(&writer->lock);
+            return 0;
+        }
+        writer->threadStarted = 1;
+    }
+
+    return 1;
+}
+
+static uint32_t queue_stripe_write(MXFFileSysData *sysData, FileDescriptor *fd, int64_t offset, const uint8_t *data,
+                                   uint32_t count)
+{
+    StripeWriter *writer = &sysData->stripeWriters[fd->fileIndex % sysData->numStripeWriters];
+    StripeBuffer *newBuffer = NULL;
+
+    pthread_mutex_lock(&writer->lock);
+    while (!writer->error && writer->queuedSize > 0 && writer->queuedSize + count > MAX_STRIPE_QUEUE_SIZE)
+    {
+        pthread_cond_wait(&writer->cond, &writer->lock);
+    }
+    if (writer->error)
+    {
+        pthread_mutex_unlock(&writer->lock);
+        release_descriptor(sysData->pool, fd);
+        return 0;
+    }
+
+    /* append to the last queued buffer if the data follows on from it */
+    if (writer->tail != NULL &&
+        writer->tail->fileDesc == fd &&
+        writer->tail->offset + writer->tail->size == offset &&
+        writer->tail->allocatedSize - writer->tail->size >= count)
+    {
+        memcpy(&writer->tail->data[writer->tail->size], data, count);
+        writer->tail->size += count;
+        writer->queuedSize += count;
+        pthread_mutex_unlock(&writer->lock);
+
+        /* the last buffer already holds the descriptor */
+        release_descriptor(sysData->pool, fd);
+        return count;
+    }
+    pthread_mutex_unlock(&writer->lock);
+
+    CHK_MALLOC_OFAIL(newBuffer, StripeBuffer);
+    memset(newBuffer, 0, sizeof(*newBuffer));
+    newBuffer->allocatedSize = (count > STRIPE_BUFFER_SIZE ? count : STRIPE_BUFFER_SIZE);
+    CHK_MALLOC_ARRAY_OFAIL(newBuffer->data, uint8_t, newBuffer->allocatedSize);
+    memcpy(newBuffer->data, data, count);
+    newBuffer->size = count;
+    newBuffer->offset = offset;
+    newBuffer->fileDesc = fd;
+
+    pthread_mutex_lock(&writer->lock);
+    if (writer->tail != NULL)
+    {
+        writer->tail->next = newBuffer;
+    }
+    else
+    {
+        writer->head = newBuffer;
+    }
+    writer->tail = newBuffer;
+    writer->queuedSize += count;
+    pthread_cond_broadcast(&writer->cond);
+    pthread_mutex_unlock(&writer->lock);
+
+    return count;
+
+fail:
+    if (newBuffer != NULL)
+    {
+        SAFE_FREE(newBuffer->data);
+        free(newBuffer);
+    }
+    release_descriptor(sysData->pool, fd);
+    return 0;
+}
+
+#else
+
+/* the pages of a striped page file are written synchronously without threads */
+
+static int wait_stripe_writer(StripeWriter *writer)
+{
+    (void)writer;
+    return 1;
+}
+
+static int wait_stripe_writers(MXFFileSysData *sysData)
+{
+    (void)sysData;
+    return 1;
+}
+
+static int stop_stripe_writers(MXFFileSysData *sysData)
+{
+    (void)sysData;
+    return 1;
+}
+
+static int start_stripe_writers(MXFFileSysData *sysData, int numStripes)
+{
+    (void)sysData;
+    (void)numStripes;
+    return 1;
+}
+
+static uint32_t queue_stripe_write(MXFFileSysData *sysData, FileDescriptor *fd, int64_t offset, const uint8_t *data,
+                                   uint32_t count)
+{
+    uint32_t numWrite;
+
+    numWrite = disk_file_write(fd, offset, data, count);
+    release_descriptor(sysData->pool, fd);
+
+    return numWrite;
+}
+
+#endif
+
+
+static Page* open_page(MXFFileSysData *sysData, int64_t position)
+{
+    int page;
+
+    page = (int)(position / sysData->pageSize);
+    if (page > sysData->numPages)
+    {
+        /* only allowed to open pages 0 .. last + 1 */
+        return 0;
+    }
+
+    if (page == sysData->numPages)
+    {
+        if (sysData->mode == READ_MODE)
+        {
+            /* no more pages to open */
+            return 0;
+        }
+
+        if (sysData->numPages == sysData->numPagesAllocated)
+        {
+            /* reallocate the pages */
+
+            Page *newPages;
+            CHK_MALLOC_ARRAY_ORET(newPages, Page, sysData->numPagesAllocated + PAGE_ALLOC_INCR);
+            if (sysData->pages != NULL)
+            {
+                memcpy(newPages, sysData->pages, sizeof(Page) * sysData->numPagesAllocated);
+            }
+            SAFE_FREE(sysData->pages);
+            sysData->pages = newPages;
+            sysData->numPagesAllocated += PAGE_ALLOC_INCR;
+        }
+
+        /* set new page data */
+        memset(&sysData->pages[sysData->numPages], 0, sizeof(Page));
+        sysData->pages[sysData->numPages].index = sysData->numPages;
+
+        sysData->numPages++;
+    }
+
+    return &sysData->pages[page];
 }
 
+static int64_t ring_size(DescriptorPool *pool)
+{
+    int64_t size;
+
+    lock_pool(pool);
+    size = pool->ringSize;
+    unlock_pool(pool);
 
+    return size;
+}
 
-static int open_file(MXFFileSysData *sysData, Page *page)
+static void drop_ring_page(DescriptorPool *pool)
 {
-    FILE *newFile = NULL;
     char filename[4096];
-    FileDescriptor *newFileDescriptor = NULL;
+    int fileIndex = (int)(pool->ringFirstPage % pool->ringMaxPages);
 
-    if (page->wasRemoved)
+    /* the file is removed rather than truncated so that readers still using the dropped page can complete their
+       reads. The page that replaces it is written to a new file */
+    detach_file(pool, fileIndex);
+    get_page_filename(pool->filenameTemplates, pool->numFilenameTemplates, fileIndex, filename, sizeof(filename));
+    if (remove(filename) != 0)
     {
-        mxf_log_warn("Failed to open mxf page file which was removed after truncation\n");
-        return 0;
+        mxf_log_warn("Failed to remove dropped mxf page file '%s': %s\n", filename, strerror(errno));
     }
 
-    /* move file descriptor to tail if already open, and return */
-    if (page->fileDescriptor != NULL)
-    {
-        if (page->fileDescriptor == sysData->fileDescriptorTail)
-        {
-            return 1;
-        }
+    pool->ringFirstPage++;
+}
 
-        /* extract file descriptor */
-        if (page->fileDescriptor->next != NULL)
-        {
-            page->fileDescriptor->next->prev = page->fileDescriptor->prev;
-        }
-        if (page->fileDescriptor->prev != NULL)
-        {
-            page->fileDescriptor->prev->next = page->fileDescriptor->next;
-        }
-        if (sysData->fileDescriptorHead == page->fileDescriptor)
-        {
-            sysData->fileDescriptorHead = page->fileDescriptor->next;
-        }
+static int register_ring_reader(MXFFileSysData *sysData)
+{
+    DescriptorPool *pool = sysData->pool;
+    int64_t *newPositions;
+    int i;
 
-        /* put file descriptor at tail */
-        page->fileDescriptor->next = NULL;
-        page->fileDescriptor->prev = sysData->fileDescriptorTail;
-        if (sysData->fileDescriptorTail != NULL)
+    lock_pool(pool);
+
+    for (i = 0; i < pool->numRingReaderPositions; i++)
+    {
+        if (pool->ringReaderPositions[i] < 0)
         {
-            sysData->fileDescriptorTail->next = page->fileDescriptor;
+            break;
         }
-        sysData->fileDescriptorTail = page->fileDescriptor;
-
-        return 1;
     }
-
-
-    /* close the least used file descriptor (the head) if too many file descriptors are open */
-    if (sysData->numFileDescriptors >= MAX_FILE_DESCRIPTORS)
+    if (i == pool->numRingReaderPositions)
     {
-        if (sysData->fileDescriptorTail == sysData->fileDescriptorHead)
+        newPositions = realloc(pool->ringReaderPositions, (pool->numRingReaderPositions + 8) * sizeof(int64_t));
+        if (newPositions == NULL)
         {
-            /* single file descriptor */
-
-            sysData->fileDescriptorHead->page->fileDescriptor = NULL;
-            disk_file_close(sysData->fileDescriptorHead);
-            SAFE_FREE(sysData->fileDescriptorHead);
-
-            sysData->fileDescriptorHead = NULL;
-            sysData->fileDescriptorTail = NULL;
-            sysData->numFileDescriptors--;
+            mxf_log_error("Failed to allocate ring reader positions\n");
+            unlock_pool(pool);
+            return 0;
         }
-        else
+        pool->ringReaderPositions = newPositions;
+        for (i = pool->numRingReaderPositions; i < pool->numRingReaderPositions + 8; i++)
         {
-            /* multiple file descriptors */
-
-            FileDescriptor *newHead = sysData->fileDescriptorHead->next;
-
-            sysData->fileDescriptorHead->page->fileDescriptor = NULL;
-            disk_file_close(sysData->fileDescriptorHead);
-            SAFE_FREE(sysData->fileDescriptorHead);
-
-            sysData->fileDescriptorHead = newHead;
-            newHead->prev = NULL;
-            sysData->numFileDescriptors--;
+            pool->ringReaderPositions[i] = -1;
         }
+        i = pool->numRingReaderPositions;
+        pool->numRingReaderPositions += 8;
     }
 
-    /* open the file */
-    mxf_snprintf(filename, sizeof(filename), sysData->filenameTemplate, page->index);
-    switch (sysData->mode)
+    pool->ringReaderPositions[i] = sysData->position;
+    sysData->isRingReader = 1;
+    sysData->ringReaderIndex = i;
+
+    unlock_pool(pool);
+    return 1;
+}
+
+static void update_ring_reader(MXFFileSysData *sysData)
+{
+    if (!sysData->isRingReader)
     {
-        case READ_MODE:
-            newFile = fopen(filename, "rb");
-            break;
-        case WRITE_MODE:
-            if (!page->wasOpenedBefore)
-            {
-                newFile = fopen(filename, "w+b");
-            }
-            else
-            {
-                newFile = fopen(filename, "r+b");
-            }
-            break;
-        case MODIFY_MODE:
-            newFile = fopen(filename, "r+b");
-            if (newFile == NULL)
-            {
-                newFile = fopen(filename, "w+b");
-            }
-            break;
+        return;
     }
-    if (newFile == NULL)
+
+    lock_pool(sysData->pool);
+    sysData->pool->ringReaderPositions[sysData->ringReaderIndex] = sysData->position;
+    unlock_pool(sysData->pool);
+}
+
+static uint32_t ring_read_from_page(MXFFileSysData *sysData, uint8_t *data, uint32_t count)
+{
+    DescriptorPool *pool = sysData->pool;
+    FileDescriptor *fd;
+    int64_t pageIndex;
+    int64_t offset;
+    int64_t size;
+    uint32_t numRead;
+
+    size = ring_size(pool);
+    if (sysData->position >= size)
     {
-        mxf_log_error("Failed to open paged mxf file '%s': %s\n", filename, strerror(errno));
         return 0;
     }
 
-    /* create the new file descriptor */
-    CHK_MALLOC_OFAIL(newFileDescriptor, FileDescriptor);
-    memset(newFileDescriptor, 0, sizeof(*newFileDescriptor));
-    newFileDescriptor->file = newFile;
-    newFile = NULL;
-    newFileDescriptor->page = page;
-
-    page->fileDescriptor = newFileDescriptor;
-    page->wasOpenedBefore = 1;
-    page->offset = 0;
+    pageIndex = sysData->position / sysData->pageSize;
+    offset = sysData->position - sysData->pageSize * pageIndex;
 
-    if (sysData->fileDescriptorTail != NULL)
+    fd = acquire_file(pool, (int)(pageIndex % pool->ringMaxPages), pageIndex, 0);
+    if (fd == NULL)
     {
-        sysData->fileDescriptorTail->next = newFileDescriptor;
+        return 0;
     }
-    newFileDescriptor->prev = sysData->fileDescriptorTail;
-    sysData->fileDescriptorTail = newFileDescriptor;
-    if (sysData->fileDescriptorHead == NULL)
+
+    /* read count bytes or 'till the end of the page or written data */
+    numRead = (count > (uint32_t)(sysData->pageSize - offset)) ? (uint32_t)(sysData->pageSize - offset) : count;
+    if (numRead > size - sysData->position)
     {
-        sysData->fileDescriptorHead = newFileDescriptor;
+        numRead = (uint32_t)(size - sysData->position);
     }
-    sysData->numFileDescriptors++;
+    numRead = disk_file_read(fd, offset, data, numRead);
 
+    release_descriptor(pool, fd);
 
-    return 1;
+    sysData->position += numRead;
+    update_ring_reader(sysData);
 
-fail:
-    if (newFile != NULL)
-    {
-        fclose(newFile);
-    }
-    return 0;
+    return numRead;
 }
 
-static Page* open_page(MXFFileSysData *sysData, int64_t position)
+static uint32_t ring_write_to_page(MXFFileSysData *sysData, const uint8_t *data, uint32_t count)
 {
-    int i;
-    int page;
+    DescriptorPool *pool = sysData->pool;
+    FileDescriptor *fd;
+    int64_t pageIndex;
+    int64_t offset;
+    int isNewPage = 0;
+    uint32_t numWrite;
 
-    page = (int)(position / sysData->pageSize);
-    if (page > sysData->numPages)
+    if (sysData->mode != WRITE_MODE)
     {
-        /* only allowed to open pages 0 .. last + 1 */
+        mxf_log_error("Cannot write to an mxf page file ring reader\n");
         return 0;
     }
 
-    if (page == sysData->numPages)
+    pageIndex = sysData->position / sysData->pageSize;
+    offset = sysData->position - sysData->pageSize * pageIndex;
+
+    lock_pool(pool);
+    if (sysData->position > pool->ringSize)
     {
-        if (sysData->mode == READ_MODE)
+        /* can't write from beyond the end of the data */
+        unlock_pool(pool);
+        return 0;
+    }
+    if (pageIndex == pool->ringNumPages)
+    {
+        /* drop the oldest page once the ring is full */
+        if (pool->ringNumPages - pool->ringFirstPage >= pool->ringMaxPages)
         {
-            /* no more pages to open */
-            return 0;
+            drop_ring_page(pool);
         }
+        pool->ringNumPages++;
+        isNewPage = 1;
+    }
+    unlock_pool(pool);
 
-        if (sysData->numPages == sysData->numPagesAllocated)
-        {
-            /* reallocate the pages */
-
-            Page *newPages;
-            CHK_MALLOC_ARRAY_ORET(newPages, Page, sysData->numPagesAllocated + PAGE_ALLOC_INCR);
-            memcpy(newPages, sysData->pages, sizeof(Page) * sysData->numPagesAllocated);
-            SAFE_FREE(sysData->pages);
-            sysData->pages = newPages;
-            sysData->numPagesAllocated += PAGE_ALLOC_INCR;
+    fd = acquire_file(pool, (int)(pageIndex % pool->ringMaxPages), pageIndex, isNewPage);
+    if (fd == NULL)
+    {
+        return 0;
+    }
 
-            /* reset the link back from file descriptors to the new pages */
-            for (i = 0; i < sysData->numPages; i++)
-            {
-                if (sysData->pages[i].fileDescriptor != NULL)
-                {
-                    sysData->pages[i].fileDescriptor->page = &sysData->pages[i];
-                }
-            }
-        }
+    /* write count bytes or 'till the end of the page */
+    numWrite = (count > (uint32_t)(sysData->pageSize - offset)) ? (uint32_t)(sysData->pageSize - offset) : count;
+    numWrite = disk_file_write(fd, offset, data, numWrite);
 
-        /* set new page data */
-        memset(&sysData->pages[sysData->numPages], 0, sizeof(Page));
-        sysData->pages[sysData->numPages].index = sysData->numPages;
+    release_descriptor(pool, fd);
 
-        sysData->numPages++;
-    }
+    sysData->position += numWrite;
 
-    /* open the file */
-    if (!open_file(sysData, &sysData->pages[page]))
+    /* make the data available to the readers */
+    lock_pool(pool);
+    if (sysData->position > pool->ringSize)
     {
-        return 0;
+        pool->ringSize = sysData->position;
     }
+    unlock_pool(pool);
 
-    return &sysData->pages[page];
+    return numWrite;
 }
 
 static uint32_t read_from_page(MXFFileSysData *sysData, uint8_t *data, uint32_t count)
 {
+    FileDescriptor *fd;
     uint32_t numRead;
+    int64_t offset;
     Page *page;
 
+    if (sysData->pool->ringMaxPages > 0)
+    {
+        return ring_read_from_page(sysData, data, count);
+    }
+
     page = open_page(sysData, sysData->position);
     if (page == 0)
     {
         return 0;
     }
 
-    if (sysData->position > sysData->pageSize * page->index + page->size)
+    offset = sysData->position - sysData->pageSize * page->index;
+    if (offset > page->size)
     {
         /* can't read beyond the end of the data in the page */
         /* TODO: assertion here? */
         return 0;
     }
 
-    /* set the file at the current position */
-    if (page->offset < 0 ||
-        sysData->position != sysData->pageSize * page->index + page->offset)
+    /* data queued for writing to the page must be written before it is read */
+    if (sysData->stripeWriters != NULL &&
+        !wait_stripe_writer(&sysData->stripeWriters[page->index % sysData->numStripeWriters]))
     {
-        int64_t offset = sysData->position - sysData->pageSize * page->index;
-        if (!disk_file_seek(page->fileDescriptor, offset, SEEK_SET))
-        {
-            page->offset = -1; /* invalidate the position within the page */
-            return 0;
-        }
-        page->offset = offset;
-        page->size = (page->offset > page->size) ? page->offset : page->size;
+        return 0;
+    }
+
+    fd = acquire_descriptor(sysData, page);
+    if (fd == NULL)
+    {
+        return 0;
     }
 
     /* read count bytes or 'till the end of the page */
-    numRead = (count > (uint32_t)(sysData->pageSize - page->offset)) ?
-        (uint32_t)(sysData->pageSize - page->offset) : count;
-    numRead = disk_file_read(page->fileDescriptor, data, numRead);
+    numRead = (count > (uint32_t)(sysData->pageSize - offset)) ? (uint32_t)(sysData->pageSize - offset) : count;
+    numRead = disk_file_read(fd, offset, data, numRead);
 
-    page->offset += numRead;
-    page->size = (page->offset > page->size) ? page->offset : page->size;
+    release_descriptor(sysData->pool, fd);
+
+    page->size = (offset + numRead > page->size) ? offset + numRead : page->size;
 
     sysData->position += numRead;
 
@@ -416,44 +1441,50 @@ static uint32_t read_from_page(MXFFileSysData *sysData, uint8_t *data, uint32_t
 
 static uint32_t write_to_page(MXFFileSysData *sysData, const uint8_t *data, uint32_t count)
 {
+    FileDescriptor *fd;
     uint32_t numWrite;
+    int64_t offset;
     Page *page;
 
+    if (sysData->pool->ringMaxPages > 0)
+    {
+        return ring_write_to_page(sysData, data, count);
+    }
+
     page = open_page(sysData, sysData->position);
     if (page == 0)
     {
         return 0;
     }
 
-    if (sysData->position > sysData->pageSize * page->index + page->size)
+    offset = sysData->position - sysData->pageSize * page->index;
+    if (offset > page->size)
     {
         /* can't write from beyond the end of the data in the page */
         /* TODO: assertion here? */
         return 0;
     }
 
-    /* set the file at the current position */
-    if (page->offset < 0 ||
-        sysData->position != sysData->pageSize * page->index + page->offset)
+    fd = acquire_descriptor(sysData, page);
+    if (fd == NULL)
     {
-        int64_t offset = sysData->position - sysData->pageSize * page->index;
-        if (!disk_file_seek(page->fileDescriptor, offset, SEEK_SET))
-        {
-            page->offset = -1; /* invalidate the position within the page */
-            return 0;
-        }
-        page->offset = offset;
-        page->size = (page->offset > page->size) ? page->offset : page->size;
+        return 0;
     }
 
     /* write count bytes or 'till the end of the page */
-    numWrite = (count > (uint32_t)(sysData->pageSize - page->offset)) ?
-        (uint32_t)(sysData->pageSize - page->offset) : count;
-    numWrite = disk_file_write(page->fileDescriptor, data, numWrite);
-
-    page->offset += numWrite;
-    page->size = (page->offset > page->size) ? page->offset : page->size;
+    numWrite = (count > (uint32_t)(sysData->pageSize - offset)) ? (uint32_t)(sysData->pageSize - offset) : count;
+    if (sysData->stripeWriters != NULL)
+    {
+        /* the descriptor is released once the queued data is written */
+        numWrite = queue_stripe_write(sysData, fd, offset, data, numWrite);
+    }
+    else
+    {
+        numWrite = disk_file_write(fd, offset, data, numWrite);
+        release_descriptor(sysData->pool, fd);
+    }
 
+    page->size = (offset + numWrite > page->size) ? offset + numWrite : page->size;
 
     sysData->position += numWrite;
 
@@ -471,32 +1502,35 @@ static void free_page_file(MXFFileSysData *sysData)
 
 static void page_file_close(MXFFileSysData *sysData)
 {
-    FileDescriptor *fd;
-    FileDescriptor *nextFd;
+    if (!stop_stripe_writers(sysData))
+    {
+        mxf_log_error("Failed to write striped mxf page file\n");
+    }
+
+    if (sysData->isRingReader)
+    {
+        lock_pool(sysData->pool);
+        sysData->pool->ringReaderPositions[sysData->ringReaderIndex] = -1;
+        unlock_pool(sysData->pool);
+        sysData->isRingReader = 0;
+    }
 
-    SAFE_FREE(sysData->filenameTemplate);
+    release_pool(&sysData->pool);
 
     SAFE_FREE(sysData->pages);
     sysData->numPages = 0;
     sysData->numPagesAllocated = 0;
 
-    fd = sysData->fileDescriptorHead;
-    while (fd != NULL)
-    {
-        disk_file_close(fd);
-        nextFd = fd->next;
-        SAFE_FREE(fd);
-        fd = nextFd;
-    }
-    sysData->fileDescriptorHead = NULL;
-    sysData->fileDescriptorTail = NULL;
-    sysData->numFileDescriptors = 0;
-
     sysData->position = 0;
 }
 
 static int64_t page_file_size(MXFFileSysData *sysData)
 {
+    if (sysData->pool->ringMaxPages > 0)
+    {
+        return ring_size(sysData->pool);
+    }
+
     if (sysData->numPages == 0)
     {
         return 0;
@@ -562,78 +1596,235 @@ static int page_file_putchar(MXFFileSysData *sysData, int c)
         return EOF;
     }
 
-    return data;
+    return data;
+}
+
+static int page_file_eof(MXFFileSysData *sysData)
+{
+    int64_t size = page_file_size(sysData);
+    if (size < 0)
+    {
+        return 1;
+    }
+
+    return sysData->position >= size;
+}
+
+static int page_file_seek(MXFFileSysData *sysData, int64_t offset, int whence)
+{
+    int64_t position;
+    int64_t size;
+
+    size = page_file_size(sysData);
+    if (size < 0)
+    {
+        return 0;
+    }
+
+    switch (whence)
+    {
+        case SEEK_SET:
+            position = offset;
+            break;
+        case SEEK_CUR:
+            position = sysData->position + offset;
+            break;
+        case SEEK_END:
+            position = size + offset;
+            break;
+        default:
+            position = sysData->position;
+            break;
+    }
+    if (position < 0 || position > size)
+    {
+        return 0;
+    }
+
+    sysData->position = position;
+    update_ring_reader(sysData);
+
+    return 1;
+}
+
+static int64_t page_file_tell(MXFFileSysData *sysData)
+{
+    return sysData->position;
+}
+
+static int page_file_is_seekable(MXFFileSysData *sysData)
+{
+    return sysData != NULL;
+}
+
+static int page_file_advise(MXFFileSysData *sysData, int64_t offset, int64_t len, MXFFileAdvice advice)
+{
+    DescriptorPool *pool = sysData->pool;
+    FileDescriptor *fd;
+    Page *page;
+    int64_t pageStart;
+    int64_t pageLen;
+    int numOpened = 0;
+    int first;
+    int last;
+    int result = 1;
+    int i;
+
+    if (advice != MXF_ADVISE_WILLNEED && advice != MXF_ADVISE_DONTNEED)
+    {
+        /* access patterns apply to all the page files, including those opened later */
+        lock_pool(pool);
+        pool->accessAdvice = advice;
+        for (fd = pool->head; fd != NULL; fd = fd->next)
+        {
+            result = disk_file_advise(fd, 0, 0, advice) && result;
+        }
+        unlock_pool(pool);
+        return result;
+    }
+
+    if (sysData->numPages == 0 || offset < 0)
+    {
+        return 1;
+    }
+
+    first = (int)(offset / sysData->pageSize);
+    if (len == 0 || (offset + len - 1) / sysData->pageSize >= sysData->numPages)
+    {
+        last = sysData->numPages - 1;
+    }
+    else
+    {
+        last = (int)((offset + len - 1) / sysData->pageSize);
+    }
+
+    for (i = first; i <= last; i++)
+    {
+        page = &sysData->pages[i];
+        if (page->wasRemoved)
+        {
+            continue;
+        }
+
+        pageStart = (i == first ? offset - sysData->pageSize * i : 0);
+        if (len == 0 || i < last)
+        {
+            pageLen = 0;
+        }
+        else
+        {
+            pageLen = offset + len - sysData->pageSize * i - pageStart;
+        }
+
+        /* a few page files are opened when reading to allow the read-ahead to start */
+        lock_pool(pool);
+        fd = (i < pool->numFileDescriptors ? pool->fileDescriptors[i] : NULL);
+        if (fd != NULL)
+        {
+            result = disk_file_advise(fd, pageStart, pageLen, advice) && result;
+        }
+        unlock_pool(pool);
+        if (fd == NULL && advice == MXF_ADVISE_WILLNEED && sysData->mode == READ_MODE &&
+            numOpened < MAX_WILLNEED_PAGES)
+        {
+            fd = acquire_descriptor(sysData, page);
+            if (fd == NULL)
+            {
+                return 0;
+            }
+            result = disk_file_advise(fd, pageStart, pageLen, advice) && result;
+            release_descriptor(pool, fd);
+            numOpened++;
+        }
+    }
+
+    return result;
 }
 
-static int page_file_eof(MXFFileSysData *sysData)
-{
-    int64_t size = page_file_size(sysData);
-    if (size < 0)
-    {
-        return 1;
-    }
 
-    return sysData->position >= size;
-}
 
-static int page_file_seek(MXFFileSysData *sysData, int64_t offset, int whence)
+static int page_file_dup(MXFFileSysData *sysData, MXFFile **dupFile)
 {
-    int64_t position;
-    int64_t size;
+    MXFFile *newMXFFile = NULL;
 
-    size = page_file_size(sysData);
-    if (size < 0)
+    if (sysData->pool->directIO)
     {
+        mxf_log_error("Cannot duplicate a direct I/O page file\n");
         return 0;
     }
 
-    switch (whence)
+    /* written data must be visible to the duplicate */
+    if (!wait_stripe_writers(sysData))
     {
-        case SEEK_SET:
-            position = offset;
-            break;
-        case SEEK_CUR:
-            position = sysData->position + offset;
-            break;
-        case SEEK_END:
-            position = size + offset;
-            break;
-        default:
-            position = sysData->position;
-            break;
+        return 0;
     }
-    if (position < 0 || position > size)
+
+    CHK_MALLOC_ORET(newMXFFile, MXFFile);
+    memset(newMXFFile, 0, sizeof(*newMXFFile));
+
+    newMXFFile->close           = page_file_close;
+    newMXFFile->read            = page_file_read;
+    newMXFFile->write           = page_file_write;
+    newMXFFile->get_char        = page_file_getchar;
+    newMXFFile->put_char        = page_file_putchar;
+    newMXFFile->eof             = page_file_eof;
+    newMXFFile->seek            = page_file_seek;
+    newMXFFile->tell            = page_file_tell;
+    newMXFFile->is_seekable     = page_file_is_seekable;
+    newMXFFile->size            = page_file_size;
+    newMXFFile->advise          = page_file_advise;
+    newMXFFile->dup             = page_file_dup;
+    newMXFFile->free_sys_data   = free_page_file;
+
+
+    CHK_MALLOC_OFAIL(newMXFFile->sysData, MXFFileSysData);
+    memset(newMXFFile->sysData, 0, sizeof(*newMXFFile->sysData));
+
+    /* the duplicate is a read-only view of the pages that exist now, sharing the open file descriptors. Written
+       data is visible to the duplicate because the descriptors are unbuffered */
+    lock_pool(sysData->pool);
+    sysData->pool->refCount++;
+    unlock_pool(sysData->pool);
+    newMXFFile->sysData->pool = sysData->pool;
+    newMXFFile->sysData->pageSize = sysData->pageSize;
+    newMXFFile->sysData->mode = READ_MODE;
+    newMXFFile->sysData->position = sysData->position;
+    newMXFFile->sysData->mxfPageFile.mxfFile = newMXFFile;
+
+    if (sysData->numPages > 0)
     {
-        return 0;
+        CHK_MALLOC_ARRAY_OFAIL(newMXFFile->sysData->pages, Page, sysData->numPagesAllocated);
+        memcpy(newMXFFile->sysData->pages, sysData->pages, sysData->numPages * sizeof(Page));
+        newMXFFile->sysData->numPages = sysData->numPages;
+        newMXFFile->sysData->numPagesAllocated = sysData->numPagesAllocated;
     }
 
-    sysData->position = position;
+    /* a duplicate of a ring follows the pages as they are written and dropped */
+    if (sysData->pool->ringMaxPages > 0)
+    {
+        CHK_OFAIL(register_ring_reader(newMXFFile->sysData));
+    }
 
+
+    *dupFile = newMXFFile;
     return 1;
-}
 
-static int64_t page_file_tell(MXFFileSysData *sysData)
-{
-    return sysData->position;
+fail:
+    if (newMXFFile != NULL)
+    {
+        mxf_file_close(&newMXFFile);
+    }
+    return 0;
 }
 
-static int page_file_is_seekable(MXFFileSysData *sysData)
-{
-    return sysData != NULL;
-}
 
 
 
-int mxf_page_file_open_new(const char *filenameTemplate, int64_t pageSize, MXFPageFile **mxfPageFile)
+static int page_file_open_new(const char **directories, int numDirectories, const char *filenameTemplate,
+                              int64_t pageSize, int directIO, MXFPageFile **mxfPageFile)
 {
     MXFFile *newMXFFile = NULL;
 
-    if (strstr(filenameTemplate, "%d") == NULL)
-    {
-        mxf_log_error("Filename template '%s' doesn't contain %%d\n", filenameTemplate);
-        return 0;
-    }
-
     CHK_MALLOC_ORET(newMXFFile, MXFFile);
     memset(newMXFFile, 0, sizeof(*newMXFFile));
 
@@ -647,17 +1838,25 @@ int mxf_page_file_open_new(const char *filenameTemplate, int64_t pageSize, MXFPa
     newMXFFile->tell            = page_file_tell;
     newMXFFile->is_seekable     = page_file_is_seekable;
     newMXFFile->size            = page_file_size;
+    newMXFFile->advise          = page_file_advise;
+    newMXFFile->dup             = page_file_dup;
     newMXFFile->free_sys_data   = free_page_file;
 
 
     CHK_MALLOC_OFAIL(newMXFFile->sysData, MXFFileSysData);
     memset(newMXFFile->sysData, 0, sizeof(*newMXFFile->sysData));
 
-    CHK_OFAIL((newMXFFile->sysData->filenameTemplate = strdup(filenameTemplate)) != NULL);
+    CHK_OFAIL(create_pool(directories, numDirectories, filenameTemplate, WRITE_MODE, directIO,
+                          &newMXFFile->sysData->pool));
     newMXFFile->sysData->pageSize = pageSize;
     newMXFFile->sysData->mode = WRITE_MODE;
     newMXFFile->sysData->mxfPageFile.mxfFile = newMXFFile;
 
+    if (numDirectories > 1)
+    {
+        CHK_OFAIL(start_stripe_writers(newMXFFile->sysData, numDirectories));
+    }
+
 
     *mxfPageFile = &newMXFFile->sysData->mxfPageFile;
     return 1;
@@ -670,9 +1869,11 @@ fail:
     return 0;
 }
 
-int mxf_page_file_open_read(const char *filenameTemplate, MXFPageFile **mxfPageFile)
+static int page_file_open_read(const char **directories, int numDirectories, const char *filenameTemplate,
+                               MXFPageFile **mxfPageFile)
 {
     MXFFile *newMXFFile = NULL;
+    DescriptorPool *pool;
     int pageCount;
     int allocatedPages;
     char filename[4096];
@@ -680,32 +1881,6 @@ int mxf_page_file_open_read(const char *filenameTemplate, MXFPageFile **mxfPageF
     struct stat st;
 
 
-    if (strstr(filenameTemplate, "%d") == NULL)
-    {
-        mxf_log_error("Filename template '%s' doesn't contain %%d\n", filenameTemplate);
-        return 0;
-    }
-
-    /* count number of page files */
-    pageCount = 0;
-    for(;;)
-    {
-        mxf_snprintf(filename, sizeof(filename), filenameTemplate, pageCount);
-        if ((file = fopen(filename, "rb")) == NULL)
-        {
-            break;
-        }
-        fclose(file);
-        pageCount++;
-    }
-
-    if (pageCount == 0)
-    {
-        /* file not found */
-        return 0;
-    }
-
-
     CHK_MALLOC_ORET(newMXFFile, MXFFile);
     memset(newMXFFile, 0, sizeof(*newMXFFile));
 
@@ -719,20 +1894,42 @@ int mxf_page_file_open_read(const char *filenameTemplate, MXFPageFile **mxfPageF
     newMXFFile->tell            = page_file_tell;
     newMXFFile->is_seekable     = page_file_is_seekable;
     newMXFFile->size            = page_file_size;
+    newMXFFile->advise          = page_file_advise;
+    newMXFFile->dup             = page_file_dup;
     newMXFFile->free_sys_data   = free_page_file;
 
 
     CHK_MALLOC_OFAIL(newMXFFile->sysData, MXFFileSysData);
     memset(newMXFFile->sysData, 0, sizeof(*newMXFFile->sysData));
 
-    CHK_OFAIL((newMXFFile->sysData->filenameTemplate = strdup(filenameTemplate)) != NULL);
+    CHK_OFAIL(create_pool(directories, numDirectories, filenameTemplate, READ_MODE, 0, &newMXFFile->sysData->pool));
     newMXFFile->sysData->mode = READ_MODE;
     newMXFFile->sysData->mxfPageFile.mxfFile = newMXFFile;
+    pool = newMXFFile->sysData->pool;
+
+
+    /* count number of page files */
+    pageCount = 0;
+    for(;;)
+    {
+        get_page_filename(pool->filenameTemplates, pool->numFilenameTemplates, pageCount, filename, sizeof(filename));
+        if ((file = fopen(filename, "rb")) == NULL)
+        {
+            break;
+        }
+        fclose(file);
+        pageCount++;
+    }
 
+    if (pageCount == 0)
+    {
+        /* file not found */
+        goto fail;
+    }
 
 
     /* get the page size from the first file */
-    mxf_snprintf(filename, sizeof(filename), filenameTemplate, 0);
+    get_page_filename(pool->filenameTemplates, pool->numFilenameTemplates, 0, filename, sizeof(filename));
     if (stat(filename, &st) != 0)
     {
         mxf_log_error("Failed to stat file '%s': %s\n", filename, strerror(errno));
@@ -742,7 +1939,7 @@ int mxf_page_file_open_read(const char *filenameTemplate, MXFPageFile **mxfPageF
 
     /* allocate pages */
     allocatedPages = (pageCount < PAGE_ALLOC_INCR) ? PAGE_ALLOC_INCR : pageCount;
-    CHK_MALLOC_ARRAY_ORET(newMXFFile->sysData->pages, Page, allocatedPages);
+    CHK_MALLOC_ARRAY_OFAIL(newMXFFile->sysData->pages, Page, allocatedPages);
     memset(newMXFFile->sysData->pages, 0, allocatedPages * sizeof(Page));
     newMXFFile->sysData->numPages = pageCount;
     newMXFFile->sysData->numPagesAllocated = allocatedPages;
@@ -753,7 +1950,8 @@ int mxf_page_file_open_read(const char *filenameTemplate, MXFPageFile **mxfPageF
     }
 
     /* set the file size of the last file, which could be less than newMXFFile->sysData->pageSize */
-    mxf_snprintf(filename, sizeof(filename), filenameTemplate, newMXFFile->sysData->numPages - 1);
+    get_page_filename(pool->filenameTemplates, pool->numFilenameTemplates, newMXFFile->sysData->numPages - 1,
+                      filename, sizeof(filename));
     if (stat(filename, &st) != 0)
     {
         mxf_log_error("Failed to stat file '%s': %s\n", filename, strerror(errno));
@@ -773,6 +1971,82 @@ fail:
     return 0;
 }
 
+int mxf_page_file_open_new(const char *filenameTemplate, int64_t pageSize, MXFPageFile **mxfPageFile)
+{
+    return page_file_open_new(NULL, 0, filenameTemplate, pageSize, 0, mxfPageFile);
+}
+
+int mxf_page_file_open_new_direct(const char *filenameTemplate, int64_t pageSize, MXFPageFile **mxfPageFile)
+{
+    return page_file_open_new(NULL, 0, filenameTemplate, pageSize, 1, mxfPageFile);
+}
+
+int mxf_page_file_open_new_striped(const char **directories, int numDirectories, const char *filenameTemplate,
+                                   int64_t pageSize, MXFPageFile **mxfPageFile)
+{
+    if (numDirectories < 1)
+    {
+        mxf_log_error("Striped page file requires at least 1 directory\n");
+        return 0;
+    }
+
+    return page_file_open_new(directories, numDirectories, filenameTemplate, pageSize, 0, mxfPageFile);
+}
+
+int mxf_page_file_open_new_ring(const char *filenameTemplate, int64_t pageSize, int maxPages,
+                                MXFPageFile **mxfPageFile)
+{
+    if (maxPages < 2)
+    {
+        mxf_log_error("Mxf page file ring requires at least 2 pages\n");
+        return 0;
+    }
+
+    if (!page_file_open_new(NULL, 0, filenameTemplate, pageSize, 0, mxfPageFile))
+    {
+        return 0;
+    }
+    (*mxfPageFile)->mxfFile->sysData->pool->ringMaxPages = maxPages;
+
+    return 1;
+}
+
+int mxf_page_file_open_ring_reader(MXFPageFile *ringFile, MXFPageFile **reader)
+{
+    MXFFile *dupFile;
+
+    if (ringFile->mxfFile->sysData->pool->ringMaxPages == 0)
+    {
+        mxf_log_error("Mxf page file is not a ring\n");
+        return 0;
+    }
+
+    if (!page_file_dup(ringFile->mxfFile->sysData, &dupFile))
+    {
+        return 0;
+    }
+
+    *reader = &dupFile->sysData->mxfPageFile;
+    return 1;
+}
+
+int mxf_page_file_open_read(const char *filenameTemplate, MXFPageFile **mxfPageFile)
+{
+    return page_file_open_read(NULL, 0, filenameTemplate, mxfPageFile);
+}
+
+int mxf_page_file_open_read_striped(const char **directories, int numDirectories, const char *filenameTemplate,
+                                    MXFPageFile **mxfPageFile)
+{
+    if (numDirectories < 1)
+    {
+        mxf_log_error("Striped page file requires at least 1 directory\n");
+        return 0;
+    }
+
+    return page_file_open_read(directories, numDirectories, filenameTemplate, mxfPageFile);
+}
+
 int mxf_page_file_open_modify(const char *filenameTemplate, int64_t pageSize, MXFPageFile **mxfPageFile)
 {
     MXFFile *newMXFFile = NULL;
@@ -839,13 +2113,15 @@ int mxf_page_file_open_modify(const char *filenameTemplate, int64_t pageSize, MX
     newMXFFile->tell            = page_file_tell;
     newMXFFile->is_seekable     = page_file_is_seekable;
     newMXFFile->size            = page_file_size;
+    newMXFFile->advise          = page_file_advise;
+    newMXFFile->dup             = page_file_dup;
     newMXFFile->free_sys_data   = free_page_file;
 
 
     CHK_MALLOC_OFAIL(newMXFFile->sysData, MXFFileSysData);
     memset(newMXFFile->sysData, 0, sizeof(*newMXFFile->sysData));
 
-    CHK_OFAIL((newMXFFile->sysData->filenameTemplate = strdup(filenameTemplate)) != NULL);
+    CHK_OFAIL(create_pool(NULL, 0, filenameTemplate, MODIFY_MODE, 0, &newMXFFile->sysData->pool));
     newMXFFile->sysData->pageSize = pageSize;
     newMXFFile->sysData->mode = MODIFY_MODE;
     newMXFFile->sysData->mxfPageFile.mxfFile = newMXFFile;
@@ -895,6 +2171,74 @@ int64_t mxf_page_file_get_page_size(MXFPageFile *mxfPageFile)
     return mxfPageFile->mxfFile->sysData->pageSize;
 }
 
+int mxf_page_file_set_max_open_files(MXFPageFile *mxfPageFile, int maxOpenFiles)
+{
+    DescriptorPool *pool = mxfPageFile->mxfFile->sysData->pool;
+
+    if (maxOpenFiles < 1)
+    {
+        mxf_log_error("Invalid maximum number of open page files %d\n", maxOpenFiles);
+        return 0;
+    }
+
+    lock_pool(pool);
+    pool->maxOpen = maxOpenFiles;
+    close_unused_descriptors(pool, maxOpenFiles);
+    unlock_pool(pool);
+
+    return 1;
+}
+
+int mxf_page_file_get_num_open_files(MXFPageFile *mxfPageFile)
+{
+    DescriptorPool *pool = mxfPageFile->mxfFile->sysData->pool;
+    int numOpen;
+
+    lock_pool(pool);
+    numOpen = pool->numOpen;
+    unlock_pool(pool);
+
+    return numOpen;
+}
+
+int mxf_page_file_get_ring_window(MXFPageFile *mxfPageFile, int64_t *start, int64_t *end)
+{
+    MXFFileSysData *sysData = mxfPageFile->mxfFile->sysData;
+    DescriptorPool *pool = sysData->pool;
+
+    if (pool->ringMaxPages == 0)
+    {
+        return 0;
+    }
+
+    lock_pool(pool);
+    *start = pool->ringFirstPage * sysData->pageSize;
+    *end = pool->ringSize;
+    unlock_pool(pool);
+
+    return 1;
+}
+
+int64_t mxf_page_file_get_ring_min_reader_position(MXFPageFile *mxfPageFile)
+{
+    DescriptorPool *pool = mxfPageFile->mxfFile->sysData->pool;
+    int64_t minPosition = -1;
+    int i;
+
+    lock_pool(pool);
+    for (i = 0; i < pool->numRingReaderPositions; i++)
+    {
+        if (pool->ringReaderPositions[i] >= 0 &&
+            (minPosition < 0 || pool->ringReaderPositions[i] < minPosition))
+        {
+            minPosition = pool->ringReaderPositions[i];
+        }
+    }
+    unlock_pool(pool);
+
+    return minPosition;
+}
+
 int mxf_page_file_is_page_filename(const char *filename)
 {
     return strstr(filename, "%d") != NULL;
@@ -915,6 +2259,16 @@ int mxf_page_file_forward_truncate(MXFPageFile *mxfPageFile)
         mxf_log_error("Cannot forward truncate read-only mxf page file\n");
         return 0;
     }
+    if (sysData->pool->ringMaxPages > 0)
+    {
+        mxf_log_error("Cannot forward truncate an mxf page file ring\n");
+        return 0;
+    }
+
+    if (!wait_stripe_writers(sysData))
+    {
+        return 0;
+    }
 
     /* close and truncate to zero length page files before the current one */
     for (i = 0; i < page; i++)
@@ -924,33 +2278,12 @@ int mxf_page_file_forward_truncate(MXFPageFile *mxfPageFile)
             continue;
         }
 
-        if (sysData->pages[i].fileDescriptor != NULL)
-        {
-            /* close the file */
-            disk_file_close(sysData->pages[i].fileDescriptor);
-
-            /* remove the file descriptor from the list */
-            if (sysData->fileDescriptorHead == sysData->pages[i].fileDescriptor)
-            {
-                sysData->fileDescriptorHead = sysData->fileDescriptorHead->next;
-            }
-            else
-            {
-                sysData->pages[i].fileDescriptor->prev->next = sysData->pages[i].fileDescriptor->next;
-            }
-            if (sysData->fileDescriptorTail == sysData->pages[i].fileDescriptor)
-            {
-                sysData->fileDescriptorTail = sysData->fileDescriptorTail->prev;
-            }
-            else
-            {
-                sysData->pages[i].fileDescriptor->next->prev = sysData->pages[i].fileDescriptor->prev;
-            }
-            SAFE_FREE(sysData->pages[i].fileDescriptor);
-        }
+        /* close the file. A duplicate reading the page keeps the file open until the read completes */
+        detach_descriptor(sysData->pool, i);
 
         /* truncate the file to zero length */
-        mxf_snprintf(filename, sizeof(filename), sysData->filenameTemplate, sysData->pages[i].index);
+        get_page_filename(sysData->pool->filenameTemplates, sysData->pool->numFilenameTemplates, sysData->pages[i].index,
+                          filename, sizeof(filename));
 
 #if defined(_WIN32)
         /* WIN32 does not have truncate() so open the file with _O_TRUNC then close it */
@@ -968,14 +2301,22 @@ int mxf_page_file_forward_truncate(MXFPageFile *mxfPageFile)
     return 1;
 }
 
-int mxf_page_file_remove(const char *filenameTemplate)
+static int page_file_remove(const char **directories, int numDirectories, const char *filenameTemplate)
 {
+    char **filenameTemplates;
+    int numFilenameTemplates;
     int index = 0;
     char filename[4096];
 
+    if (!create_filename_templates(directories, numDirectories, filenameTemplate,
+                                   &filenameTemplates, &numFilenameTemplates))
+    {
+        return 0;
+    }
+
     for(;;)
     {
-        mxf_snprintf(filename, sizeof(filename), filenameTemplate, index);
+        get_page_filename(filenameTemplates, numFilenameTemplates, index, filename, sizeof(filename));
         if (remove(filename) != 0)
         {
             break;
@@ -984,6 +2325,8 @@ int mxf_page_file_remove(const char *filenameTemplate)
         index++;
     }
 
+    free_filename_templates(&filenameTemplates, numFilenameTemplates);
+
     if (index == 0)
     {
         /* first file couldn't be removed or does not exist */
@@ -993,6 +2336,22 @@ int mxf_page_file_remove(const char *filenameTemplate)
     return 1;
 }
 
+int mxf_page_file_remove(const char *filenameTemplate)
+{
+    return page_file_remove(NULL, 0, filenameTemplate);
+}
+
+int mxf_page_file_remove_striped(const char **directories, int numDirectories, const char *filenameTemplate)
+{
+    if (numDirectories < 1)
+    {
+        mxf_log_error("Striped page file requires at least 1 directory\n");
+        return 0;
+    }
+
+    return page_file_remove(directories, numDirectories, filenameTemplate);
+}
+
 int64_t mxf_page_file_get_size(const char *filenameTemplate)
 {
     int index = 0;
@@ -48,16 +48,46 @@ int mxf_page_file_open_new(const char *filenameTemplate, int64_t pageSize, MXFPa
 int mxf_page_file_open_read(const char *filenameTemplate, MXFPageFile **mxfPageFile);
 int mxf_page_file_open_modify(const char *filenameTemplate, int64_t pageSize, MXFPageFile **mxfPageFile);
 
+/* write the page files using direct I/O, bypassing the page cache (see mxf_disk_file_open_new_direct) */
+int mxf_page_file_open_new_direct(const char *filenameTemplate, int64_t pageSize, MXFPageFile **mxfPageFile);
+
+/* place consecutive pages round-robin in the directories, e.g. page i is written to
+directories[i % numDirectories]/filenameTemplate. Each directory is written to concurrently from a separate thread */
+int mxf_page_file_open_new_striped(const char **directories, int numDirectories, const char *filenameTemplate,
+                                   int64_t pageSize, MXFPageFile **mxfPageFile);
+int mxf_page_file_open_read_striped(const char **directories, int numDirectories, const char *filenameTemplate,
+                                    MXFPageFile **mxfPageFile);
+
+/* time-shift ring mode: at most maxPages (>= 2) page files are kept on disk. Page i is written to file
+i % maxPages, replacing the oldest page once the ring is full. The data in the window [start, end) can be read
+using ring readers, which follow the writer as data is written. At least (maxPages - 1) * pageSize bytes before
+the end are always available, and a read that has started is completed even if the writer drops the page.
+Reads from a dropped page fail and the reader can seek forward to the window start */
+int mxf_page_file_open_new_ring(const char *filenameTemplate, int64_t pageSize, int maxPages,
+                                MXFPageFile **mxfPageFile);
+int mxf_page_file_open_ring_reader(MXFPageFile *ringFile, MXFPageFile **reader);
+int mxf_page_file_get_ring_window(MXFPageFile *mxfPageFile, int64_t *start, int64_t *end);
+/* returns the position of the ring reader furthest behind, or -1 if there are no readers */
+int64_t mxf_page_file_get_ring_min_reader_position(MXFPageFile *mxfPageFile);
+
 MXFFile* mxf_page_file_get_file(MXFPageFile *mxfPageFile);
 
 int64_t mxf_page_file_get_page_size(MXFPageFile *mxfPageFile);
 int mxf_page_file_is_page_filename(const char *filename);
 
+/* duplicates of the file (mxf_file_dup) share the open page files and can be used from different threads */
+
+/* set the maximum number of page files kept open (default 32), shared with duplicates of the file.
+The least recently used files are closed once the limit is reached, except those being read or written */
+int mxf_page_file_set_max_open_files(MXFPageFile *mxfPageFile, int maxOpenFiles);
+int mxf_page_file_get_num_open_files(MXFPageFile *mxfPageFile);
+
 /* truncate the file from the front, setting the file sizes to zero;
 the file can be continued to be read but cannot seek backwards or be reopened */
 int mxf_page_file_forward_truncate(MXFPageFile *mxfPageFile);
 
 int mxf_page_file_remove(const char *filenameTemplate);
+int mxf_page_file_remove_striped(const char **directories, int numDirectories, const char *filenameTemplate);
 
 int64_t mxf_page_file_get_size(const char *filenameTemplate);
 
@@ -0,0 +1,365 @@
+/*
+ * Copyright (C) 2012, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <mxf/mxf.h>
+#include <mxf/mxf_ring_file.h>
+#include <mxf/mxf_macros.h>
+
+
+#define DEFAULT_WINDOW_SIZE     (16 * 1024 * 1024)
+
+
+
+struct MXFRingFile
+{
+    MXFFile *mxfFile;
+};
+
+struct MXFFileSysData
+{
+    MXFRingFile ringFile;
+    MXFFile *target;
+    uint8_t *buffer;
+    uint32_t bufferSize;
+    uint32_t fillSize;
+    int64_t bufferStart;    /* position of the oldest byte in the buffer */
+    int64_t bufferEnd;      /* position after the last byte read from the target */
+    int64_t position;
+    int targetEOF;
+};
+
+
+
+static uint32_t buffer_index(MXFFileSysData *sysData, int64_t position)
+{
+    return (uint32_t)(position % sysData->bufferSize);
+}
+
+static void update_buffer_start(MXFFileSysData *sysData)
+{
+    if (sysData->bufferEnd - sysData->bufferStart > sysData->bufferSize)
+        sysData->bufferStart = sysData->bufferEnd - sysData->bufferSize;
+}
+
+static uint32_t copy_from_buffer(MXFFileSysData *sysData, uint8_t *data, uint32_t count)
+{
+    uint32_t index = buffer_index(sysData, sysData->position);
+
+    if (count > sysData->bufferEnd - sysData->position)
+        count = (uint32_t)(sysData->bufferEnd - sysData->position);
+    if (count > sysData->bufferSize - index)
+        count = sysData->bufferSize - index;
+
+    memcpy(data, &sysData->buffer[index], count);
+    sysData->position += count;
+
+    return count;
+}
+
+/* keep the last bufferSize bytes of data that was read directly from the target */
+static void append_to_buffer(MXFFileSysData *sysData, const uint8_t *data, uint32_t count)
+{
+    int64_t position = sysData->bufferEnd;
+    uint32_t index;
+    uint32_t numCopy;
+
+    if (count > sysData->bufferSize) {
+        position += count - sysData->bufferSize;
+        data     += count - sysData->bufferSize;
+        count     = sysData->bufferSize;
+    }
+
+    while (count > 0) {
+        index   = buffer_index(sysData, position);
+        numCopy = sysData->bufferSize - index;
+        if (numCopy > count)
+            numCopy = count;
+        memcpy(&sysData->buffer[index], data, numCopy);
+        position += numCopy;
+        data     += numCopy;
+        count    -= numCopy;
+    }
+}
+
+/* read more data from the target into the buffer. This must only be called when position equals bufferEnd so
+   that only data before the position is replaced */
+static uint32_t fill_buffer(MXFFileSysData *sysData, uint32_t minCount)
+{
+    uint32_t index = buffer_index(sysData, sysData->bufferEnd);
+    uint32_t count = sysData->fillSize;
+    uint32_t numRead;
+
+    if (sysData->targetEOF)
+        return 0;
+
+    if (count < minCount)
+        count = minCount;
+    if (count > sysData->bufferSize - index)
+        count = sysData->bufferSize - index;
+
+    numRead = mxf_file_read(sysData->target, &sysData->buffer[index], count);
+    if (numRead < count)
+        sysData->targetEOF = 1;
+
+    sysData->bufferEnd += numRead;
+    update_buffer_start(sysData);
+
+    return numRead;
+}
+
+
+static void ring_file_close(MXFFileSysData *sysData)
+{
+    mxf_file_close(&sysData->target);
+}
+
+static uint32_t ring_file_read(MXFFileSysData *sysData, uint8_t *data, uint32_t count)
+{
+    uint32_t totalRead = 0;
+    uint32_t numRead;
+
+    if (sysData->position < sysData->bufferStart)
+        return 0;
+
+    while (totalRead < count) {
+        if (sysData->position < sysData->bufferEnd) {
+            totalRead += copy_from_buffer(sysData, &data[totalRead], count - totalRead);
+        } else if (sysData->targetEOF) {
+            break;
+        } else if (count - totalRead >= sysData->bufferSize) {
+            /* large reads bypass the buffer and only the tail is kept for seeking back */
+            numRead = mxf_file_read(sysData->target, &data[totalRead], count - totalRead);
+            if (numRead < count - totalRead)
+                sysData->targetEOF = 1;
+            append_to_buffer(sysData, &data[totalRead], numRead);
+            sysData->bufferEnd += numRead;
+            update_buffer_start(sysData);
+            sysData->position = sysData->bufferEnd;
+            totalRead += numRead;
+        } else {
+            fill_buffer(sysData, count - totalRead);
+        }
+    }
+
+    return totalRead;
+}
+
+static uint32_t ring_file_write(MXFFileSysData *sysData, const uint8_t *data, uint32_t count)
+{
+    (void)sysData;
+    (void)data;
+    (void)count;
+
+    return 0;
+}
+
+static int ring_file_getchar(MXFFileSysData *sysData)
+{
+    int c;
+
+    if (sysData->position < sysData->bufferStart ||
+        (sysData->position >= sysData->bufferEnd && fill_buffer(sysData, 1) == 0))
+    {
+        return EOF;
+    }
+
+    c = sysData->buffer[buffer_index(sysData, sysData->position)];
+    sysData->position++;
+
+    return c;
+}
+
+static int ring_file_putchar(MXFFileSysData *sysData, int c)
+{
+    (void)sysData;
+    (void)c;
+
+    return EOF;
+}
+
+static int ring_file_eof(MXFFileSysData *sysData)
+{
+    return sysData->targetEOF && sysData->position >= sysData->bufferEnd;
+}
+
+static int ring_file_seek(MXFFileSysData *sysData, int64_t offset, int whence)
+{
+    int64_t origPosition = sysData->position;
+    int64_t position;
+    uint32_t minCount;
+
+    if (whence == SEEK_SET) {
+        position = offset;
+    } else if (whence == SEEK_CUR) {
+        position = sysData->position + offset;
+    } else {
+        mxf_log_error("Ring file does not support seeking relative to the end\n");
+        return 0;
+    }
+
+    if (position < sysData->bufferStart) {
+        mxf_log_error("Seek position %"PRId64" is before the start of the ring file window at %"PRId64"\n",
+                      position, sysData->bufferStart);
+        return 0;
+    }
+
+    /* seek forwards by reading and discarding */
+    while (position > sysData->bufferEnd) {
+        sysData->position = sysData->bufferEnd;
+        if (position - sysData->bufferEnd < sysData->bufferSize)
+            minCount = (uint32_t)(position - sysData->bufferEnd);
+        else
+            minCount = sysData->bufferSize;
+        if (fill_buffer(sysData, minCount) == 0) {
+            /* the original position may have left the window, in which case reads will fail */
+            sysData->position = origPosition;
+            return 0;
+        }
+    }
+
+    sysData->position = position;
+    return 1;
+}
+
+static int64_t ring_file_tell(MXFFileSysData *sysData)
+{
+    return sysData->position;
+}
+
+static int ring_file_is_seekable(MXFFileSysData *sysData)
+{
+    (void)sysData;
+
+    return 0;
+}
+
+static int64_t ring_file_size(MXFFileSysData *sysData)
+{
+    (void)sysData;
+
+    return -1;
+}
+
+static void free_ring_file(MXFFileSysData *sysData)
+{
+    if (!sysData)
+        return;
+
+    free(sysData->buffer);
+    free(sysData);
+}
+
+
+
+int mxf_ring_file_open(MXFFile *target, uint32_t windowSize, MXFRingFile **ringFile)
+{
+    MXFFile *newMXFFile = NULL;
+    MXFFileSysData *newRingFile = NULL;
+    int64_t position;
+
+    if (windowSize == 0)
+        windowSize = DEFAULT_WINDOW_SIZE;
+
+    CHK_MALLOC_ORET(newMXFFile, MXFFile);
+    memset(newMXFFile, 0, sizeof(MXFFile));
+    CHK_MALLOC_OFAIL(newRingFile, MXFFileSysData);
+    memset(newRingFile, 0, sizeof(MXFFileSysData));
+    CHK_MALLOC_ARRAY_OFAIL(newRingFile->buffer, uint8_t, windowSize);
+
+    position = mxf_file_tell(target);
+    if (position < 0)
+        position = 0;
+
+    newRingFile->target      = target;
+    newRingFile->bufferSize  = windowSize;
+    newRingFile->fillSize    = windowSize / 8;
+    newRingFile->bufferStart = position;
+    newRingFile->bufferEnd   = position;
+    newRingFile->position    = position;
+    newRingFile->ringFile.mxfFile = newMXFFile;
+
+    newMXFFile->close         = ring_file_close;
+    newMXFFile->read          = ring_file_read;
+    newMXFFile->write         = ring_file_write;
+    newMXFFile->get_char      = ring_file_getchar;
+    newMXFFile->put_char      = ring_file_putchar;
+    newMXFFile->eof           = ring_file_eof;
+    newMXFFile->seek          = ring_file_seek;
+    newMXFFile->tell          = ring_file_tell;
+    newMXFFile->is_seekable   = ring_file_is_seekable;
+    newMXFFile->size          = ring_file_size;
+    newMXFFile->free_sys_data = free_ring_file;
+    newMXFFile->sysData       = newRingFile;
+    newMXFFile->minLLen       = target->minLLen;
+    newMXFFile->runinLen      = target->runinLen;
+
+
+    *ringFile = &newRingFile->ringFile;
+    return 1;
+
+fail:
+    SAFE_FREE(newMXFFile);
+    free_ring_file(newRingFile);
+    return 0;
+}
+
+int mxf_ring_file_open_stdin(uint32_t windowSize, MXFFile **mxfFile)
+{
+    MXFFile *stdinFile = NULL;
+    MXFRingFile *ringFile;
+
+    CHK_ORET(mxf_stdin_wrap_read(&stdinFile));
+    CHK_OFAIL(mxf_ring_file_open(stdinFile, windowSize, &ringFile));
+
+    *mxfFile = mxf_ring_file_get_file(ringFile);
+    return 1;
+
+fail:
+    mxf_file_close(&stdinFile);
+    return 0;
+}
+
+MXFFile* mxf_ring_file_get_file(MXFRingFile *ringFile)
+{
+    return ringFile->mxfFile;
+}
+
+int64_t mxf_ring_file_get_window_start(MXFRingFile *ringFile)
+{
+    return ringFile->mxfFile->sysData->bufferStart;
+}
+
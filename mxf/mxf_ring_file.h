@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2012, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MXF_RING_FILE_H__
+#define __MXF_RING_FILE_H__
+
+
+#include <mxf/mxf_file.h>
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/*
+ * Read-only file that streams a (non-seekable) target through an in-memory ring buffer of windowSize bytes.
+ * Seeking backwards is possible within the last windowSize bytes that were read and seeking forwards reads and
+ * discards the data in between. Seeking relative to the end is not supported and the file reports itself as not
+ * seekable so that readers keep to their streaming code paths.
+ * A windowSize of 0 selects the default size. The target is closed when the ring file is closed.
+ */
+
+
+typedef struct MXFRingFile MXFRingFile;
+
+
+int mxf_ring_file_open(MXFFile *target, uint32_t windowSize, MXFRingFile **ringFile);
+
+/* wrap standard input in a ring file */
+int mxf_ring_file_open_stdin(uint32_t windowSize, MXFFile **mxfFile);
+
+MXFFile* mxf_ring_file_get_file(MXFRingFile *ringFile);
+
+/* returns the earliest position that can be seeked to */
+int64_t mxf_ring_file_get_window_start(MXFRingFile *ringFile);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
+
@@ -42,37 +42,79 @@
 #include <mxf/mxf_cache_file.h>
 #include <mxf/mxf_macros.h>
 
+#include "mxf_file_int.h"
 
 
+/* number of interleave blocks read between adaptive flush size updates */
+#define ADAPT_INTERVAL_BLOCKS   8
+
+
+typedef struct
+{
+    MXFCacheFile *cacheFile;    /* NULL once the writer has been closed */
+    MXFRWIntlWriterStats stats;
+} Writer;
+
 struct MXFRWInterleaver
 {
     uint32_t blockSize;
     uint32_t writerCacheSize;
 
-    int64_t readCount;
+    MXFRWIntlReaderStats *readers;
+    size_t numAllocReaders;
+    size_t numReaders;
 
-    MXFCacheFile **writers;
+    Writer *writers;
     size_t numAllocWriters;
     size_t numWriters;
     size_t lastWriterIndexFlush;
+
+    /* writer data flushed per block read, which is the blockSize unless in adaptive mode */
+    uint32_t flushSize;
+
+    /* adaptive mode, enabled if targetReadRate > 0 */
+    uint64_t targetReadRate;
+    uint32_t minFlushSize;
+    uint32_t maxFlushSize;
+    uint64_t readBytes;
+    uint64_t readNs;
+    uint64_t flushBytes;
+    uint64_t flushNs;
+    uint64_t numFlushes;
 };
 
 struct MXFFileSysData
 {
     MXFRWInterleaver *interleaver;
     MXFFile *target;
+    int isWriter;
+    size_t writerIndex;
+
+    /* a reader flushes writer data after every readBlockSize bytes read, which is the interleave block size
+       multiplied by its share */
+    size_t readerIndex;
+    uint32_t readBlockSize;
+    int64_t readCount;
 };
 
 
 
+static void update_backlog(Writer *writer)
+{
+    writer->stats.backlog = (uint64_t)mxf_cache_file_get_dirty_count(writer->cacheFile) *
+                                mxf_cache_file_get_page_size(writer->cacheFile);
+    if (writer->stats.backlog > writer->stats.maxBacklog)
+        writer->stats.maxBacklog = writer->stats.backlog;
+}
+
 static int add_cached_writer(MXFRWInterleaver *interleaver, MXFFile *writer, MXFFile **cachedWriter)
 {
-    MXFCacheFile **newWriters;
+    Writer *newWriters;
     MXFCacheFile *newCacheFile;
 
     if (interleaver->numWriters >= interleaver->numAllocWriters) {
-        newWriters = (MXFCacheFile**)realloc(interleaver->writers,
-                                             (interleaver->numAllocWriters + 32) * sizeof(*interleaver->writers));
+        newWriters = (Writer*)realloc(interleaver->writers,
+                                      (interleaver->numAllocWriters + 32) * sizeof(*interleaver->writers));
         if (!newWriters) {
             mxf_log_error("Failed to reallocate interleaver file writers array" LOG_LOC_FORMAT, LOG_LOC_PARAMS);
             return 0;
@@ -83,44 +125,78 @@ static int add_cached_writer(MXFRWInterleaver *interleaver, MXFFile *writer, MXF
 
     CHK_ORET(mxf_cache_file_open(writer, 0, interleaver->writerCacheSize, &newCacheFile));
 
-    interleaver->writers[interleaver->numWriters] = newCacheFile;
+    memset(&interleaver->writers[interleaver->numWriters], 0, sizeof(*interleaver->writers));
+    interleaver->writers[interleaver->numWriters].cacheFile    = newCacheFile;
+    interleaver->writers[interleaver->numWriters].stats.isOpen = 1;
     interleaver->numWriters++;
 
     *cachedWriter = mxf_cache_file_get_file(newCacheFile);
     return 1;
 }
 
+static int add_reader(MXFRWInterleaver *interleaver, uint32_t share, size_t *readerIndex)
+{
+    MXFRWIntlReaderStats *newReaders;
+
+    if (interleaver->numReaders >= interleaver->numAllocReaders) {
+        newReaders = (MXFRWIntlReaderStats*)realloc(interleaver->readers,
+                                                    (interleaver->numAllocReaders + 32) * sizeof(*interleaver->readers));
+        if (!newReaders) {
+            mxf_log_error("Failed to reallocate interleaver file readers array" LOG_LOC_FORMAT, LOG_LOC_PARAMS);
+            return 0;
+        }
+        interleaver->readers          = newReaders;
+        interleaver->numAllocReaders += 32;
+    }
+
+    memset(&interleaver->readers[interleaver->numReaders], 0, sizeof(*interleaver->readers));
+    interleaver->readers[interleaver->numReaders].share  = share;
+    interleaver->readers[interleaver->numReaders].isOpen = 1;
+    *readerIndex = interleaver->numReaders;
+    interleaver->numReaders++;
+
+    return 1;
+}
+
 static int have_writer_data(MXFRWInterleaver *interleaver)
 {
     size_t i;
     for (i = 0; i < interleaver->numWriters; i++) {
-        if (mxf_cache_file_get_dirty_count(interleaver->writers[i]) > 0)
+        if (interleaver->writers[i].cacheFile &&
+            mxf_cache_file_get_dirty_count(interleaver->writers[i].cacheFile) > 0)
+        {
             return 1;
+        }
     }
 
     return 0;
 }
 
-static int flush_writer_data(MXFRWInterleaver *interleaver)
+static int flush_writer_data(MXFRWInterleaver *interleaver, MXFRWIntlReaderStats *reader)
 {
-    uint32_t flushRem = interleaver->blockSize;
+    uint32_t flushRem = interleaver->flushSize;
     uint32_t numFlush;
+    Writer *writer;
     size_t writerIndex;
     size_t i;
 
     writerIndex = (interleaver->lastWriterIndexFlush + 1) % interleaver->numWriters;
     for (i = 0; i < interleaver->numWriters; i++) {
-        if (mxf_cache_file_get_dirty_count(interleaver->writers[writerIndex]) == 0)
-            break;
-
-        numFlush = mxf_cache_file_flush(interleaver->writers[writerIndex], flushRem);
-        if (numFlush == 0)
-            return 0;
-
-        interleaver->lastWriterIndexFlush = writerIndex;
-        if (flushRem <= numFlush) /* note that more than flushRem could have been flushed */
-            break;
-        flushRem -= numFlush;
+        writer = &interleaver->writers[writerIndex];
+        if (writer->cacheFile && mxf_cache_file_get_dirty_count(writer->cacheFile) > 0) {
+            numFlush = mxf_cache_file_flush(writer->cacheFile, flushRem);
+            if (numFlush == 0)
+                return 0;
+            writer->stats.flushedBytes += numFlush;
+            reader->flushedBytes += numFlush;
+            interleaver->flushBytes += numFlush;
+            update_backlog(writer);
+
+            interleaver->lastWriterIndexFlush = writerIndex;
+            if (flushRem <= numFlush) /* note that more than flushRem could have been flushed */
+                break;
+            flushRem -= numFlush;
+        }
 
         writerIndex = (writerIndex + 1) % interleaver->numWriters;
     }
@@ -128,26 +204,90 @@ static int flush_writer_data(MXFRWInterleaver *interleaver)
     return 1;
 }
 
+static void adapt_flush_size(MXFRWInterleaver *interleaver)
+{
+    double readRate, writeRate, targetRate;
+    double readSize;
+    double flushSize;
+
+    if (interleaver->flushBytes == 0 || interleaver->readBytes < ADAPT_INTERVAL_BLOCKS * (uint64_t)interleaver->blockSize)
+        return;
+
+    /* reading B bytes and flushing F bytes takes B / R + F / W seconds. The readers achieve the target rate T if
+       that is no more than B / T, i.e. F <= W * B * (1 / T - 1 / R). B is the average read between flushes, which
+       depends on the reader shares */
+    targetRate = (double)interleaver->targetReadRate;
+    readSize = (double)interleaver->readBytes / interleaver->numFlushes;
+    if (interleaver->flushNs == 0) {
+        flushSize = interleaver->maxFlushSize;
+    } else {
+        writeRate = interleaver->flushBytes * 1.0e9 / interleaver->flushNs;
+        if (interleaver->readNs == 0) {
+            flushSize = writeRate * readSize / targetRate;
+        } else {
+            readRate = interleaver->readBytes * 1.0e9 / interleaver->readNs;
+            if (readRate <= targetRate)
+                flushSize = 0;
+            else
+                flushSize = writeRate * readSize * (1.0 / targetRate - 1.0 / readRate);
+        }
+    }
+
+    /* move half way to the new size to smooth out measurement noise */
+    flushSize = (interleaver->flushSize + flushSize) / 2;
+    if (flushSize < interleaver->minFlushSize)
+        interleaver->flushSize = interleaver->minFlushSize;
+    else if (flushSize > interleaver->maxFlushSize)
+        interleaver->flushSize = interleaver->maxFlushSize;
+    else
+        interleaver->flushSize = (uint32_t)flushSize;
+
+    interleaver->readBytes  = 0;
+    interleaver->readNs     = 0;
+    interleaver->flushBytes = 0;
+    interleaver->flushNs    = 0;
+    interleaver->numFlushes = 0;
+}
+
 
 static void intl_file_close(MXFFileSysData *sysData)
 {
+    if (sysData->isWriter)
+        sysData->interleaver->writers[sysData->writerIndex].cacheFile = NULL;
+
     if (sysData->target)
         mxf_file_close(&sysData->target);
+
+    if (sysData->isWriter) {
+        sysData->interleaver->writers[sysData->writerIndex].stats.backlog = 0;
+        sysData->interleaver->writers[sysData->writerIndex].stats.isOpen  = 0;
+    } else {
+        sysData->interleaver->readers[sysData->readerIndex].isOpen = 0;
+    }
 }
 
 static uint32_t intl_file_read(MXFFileSysData *sysData, uint8_t *data, uint32_t count)
 {
+    MXFRWInterleaver *interleaver = sysData->interleaver;
+    MXFRWIntlReaderStats *reader;
     uint32_t remCount = count;
     uint32_t numRead, numActualRead;
     int flushWriter;
-    uint32_t flushCount = (uint32_t)(((sysData->interleaver->readCount % sysData->interleaver->blockSize) + count) /
-                                            sysData->interleaver->blockSize);
+    uint64_t startNs = 0;
+    uint32_t flushCount;
+
+    /* reads from a writer are served by its cache */
+    if (sysData->isWriter)
+        return mxf_file_read(sysData->target, data, count);
+
+    reader = &interleaver->readers[sysData->readerIndex];
+    flushCount = (uint32_t)(((sysData->readCount % sysData->readBlockSize) + count) / sysData->readBlockSize);
 
     while (remCount > 0) {
         if (flushCount > 0) {
-            if (have_writer_data(sysData->interleaver)) {
-                if (remCount >= sysData->interleaver->blockSize)
-                    numRead = sysData->interleaver->blockSize;
+            if (have_writer_data(interleaver)) {
+                if (remCount >= sysData->readBlockSize)
+                    numRead = sysData->readBlockSize;
                 else
                     numRead = remCount;
                 flushWriter = 1;
@@ -161,17 +301,33 @@ static uint32_t intl_file_read(MXFFileSysData *sysData, uint8_t *data, uint32_t
             flushWriter = 0;
         }
 
+        if (interleaver->targetReadRate > 0)
+            startNs = mxf_get_time_ns();
         numActualRead = mxf_file_read(sysData->target, &data[count - remCount], numRead);
         remCount -= numActualRead;
-        sysData->interleaver->readCount += numActualRead;
-        if (sysData->interleaver->readCount < 0)
-            sysData->interleaver->readCount = 0; /* reset after int64 overflow */
+        reader->readBytes += numActualRead;
+        sysData->readCount += numActualRead;
+        if (sysData->readCount < 0)
+            sysData->readCount = 0; /* reset after int64 overflow */
+
+        /* all reads count towards the read rate, including those that don't trigger a flush */
+        if (interleaver->targetReadRate > 0) {
+            interleaver->readNs    += mxf_get_time_ns() - startNs;
+            interleaver->readBytes += numActualRead;
+        }
 
         if (flushWriter) {
-            if (!flush_writer_data(sysData->interleaver)) {
+            if (interleaver->targetReadRate > 0)
+                startNs = mxf_get_time_ns();
+            if (!flush_writer_data(interleaver, reader)) {
                 mxf_log_warn("R/W interleaver read failed because writer cache data flush failed\n");
                 break;
             }
+            if (interleaver->targetReadRate > 0) {
+                interleaver->flushNs += mxf_get_time_ns() - startNs;
+                interleaver->numFlushes++;
+                adapt_flush_size(interleaver);
+            }
             flushCount--;
         }
 
@@ -184,7 +340,12 @@ static uint32_t intl_file_read(MXFFileSysData *sysData, uint8_t *data, uint32_t
 
 static uint32_t intl_file_write(MXFFileSysData *sysData, const uint8_t *data, uint32_t count)
 {
-    return mxf_file_write(sysData->target, data, count);
+    uint32_t numWrite = mxf_file_write(sysData->target, data, count);
+
+    if (sysData->isWriter)
+        update_backlog(&sysData->interleaver->writers[sysData->writerIndex]);
+
+    return numWrite;
 }
 
 static int intl_file_getchar(MXFFileSysData *sysData)
@@ -242,6 +403,7 @@ int mxf_create_rw_intl(uint32_t interleaveBlockSize, uint32_t writerCacheSize, M
 
     newInterleaver->blockSize       = interleaveBlockSize;
     newInterleaver->writerCacheSize = writerCacheSize;
+    newInterleaver->flushSize       = interleaveBlockSize;
 
     *interleaver = newInterleaver;
     return 1;
@@ -252,11 +414,13 @@ void mxf_free_rw_intl(MXFRWInterleaver **interleaver)
     if (!(*interleaver))
         return;
 
+    free((*interleaver)->readers);
     free((*interleaver)->writers);
     SAFE_FREE(*interleaver);
 }
 
-int mxf_rw_intl_open(MXFRWInterleaver *interleaver, MXFFile *target, int isWriter, MXFFile **mxfFile)
+static int open_intl_file(MXFRWInterleaver *interleaver, MXFFile *target, int isWriter, uint32_t share,
+                          MXFFile **mxfFile)
 {
     MXFFile *newMXFFile = NULL;
     MXFFileSysData *newIntlFile = NULL;
@@ -269,9 +433,14 @@ int mxf_rw_intl_open(MXFRWInterleaver *interleaver, MXFFile *target, int isWrite
 
     if (isWriter) {
         CHK_OFAIL(add_cached_writer(interleaver, target, &cachedTarget));
-        newIntlFile->target  = cachedTarget;
+        newIntlFile->target      = cachedTarget;
+        newIntlFile->isWriter    = 1;
+        newIntlFile->writerIndex = interleaver->numWriters - 1;
     } else {
-        newIntlFile->target  = target;
+        CHK_OFAIL(add_reader(interleaver, share, &newIntlFile->readerIndex));
+        newIntlFile->target        = target;
+        newIntlFile->readBlockSize = (interleaver->blockSize > UINT32_MAX / share ?
+                                        UINT32_MAX : interleaver->blockSize * share);
     }
     newIntlFile->interleaver = interleaver;
 
@@ -299,3 +468,77 @@ fail:
     return 0;
 }
 
+int mxf_rw_intl_open(MXFRWInterleaver *interleaver, MXFFile *target, int isWriter, MXFFile **mxfFile)
+{
+    return open_intl_file(interleaver, target, isWriter, 1, mxfFile);
+}
+
+int mxf_rw_intl_open_reader(MXFRWInterleaver *interleaver, MXFFile *target, uint32_t share, MXFFile **mxfFile)
+{
+    if (share == 0) {
+        mxf_log_error("Invalid interleaver reader share 0\n");
+        return 0;
+    }
+
+    return open_intl_file(interleaver, target, 0, share, mxfFile);
+}
+
+int mxf_rw_intl_set_adaptive(MXFRWInterleaver *interleaver, uint64_t targetReadRate, uint32_t minFlushSize,
+                             uint32_t maxFlushSize)
+{
+    if (targetReadRate > 0 && (minFlushSize == 0 || minFlushSize > maxFlushSize)) {
+        mxf_log_error("Invalid interleaver adaptive flush size range %u to %u\n", minFlushSize, maxFlushSize);
+        return 0;
+    }
+
+    interleaver->targetReadRate = targetReadRate;
+    interleaver->minFlushSize   = minFlushSize;
+    interleaver->maxFlushSize   = maxFlushSize;
+    interleaver->readBytes      = 0;
+    interleaver->readNs         = 0;
+    interleaver->flushBytes     = 0;
+    interleaver->flushNs        = 0;
+    interleaver->numFlushes     = 0;
+
+    if (targetReadRate == 0)
+        interleaver->flushSize = interleaver->blockSize;
+    else if (interleaver->flushSize < minFlushSize)
+        interleaver->flushSize = minFlushSize;
+    else if (interleaver->flushSize > maxFlushSize)
+        interleaver->flushSize = maxFlushSize;
+
+    return 1;
+}
+
+uint32_t mxf_rw_intl_get_flush_size(MXFRWInterleaver *interleaver)
+{
+    return interleaver->flushSize;
+}
+
+size_t mxf_rw_intl_get_num_writers(MXFRWInterleaver *interleaver)
+{
+    return interleaver->numWriters;
+}
+
+int mxf_rw_intl_get_writer_stats(MXFRWInterleaver *interleaver, size_t writerIndex, MXFRWIntlWriterStats *stats)
+{
+    if (writerIndex >= interleaver->numWriters)
+        return 0;
+
+    *stats = interleaver->writers[writerIndex].stats;
+    return 1;
+}
+
+size_t mxf_rw_intl_get_num_readers(MXFRWInterleaver *interleaver)
+{
+    return interleaver->numReaders;
+}
+
+int mxf_rw_intl_get_reader_stats(MXFRWInterleaver *interleaver, size_t readerIndex, MXFRWIntlReaderStats *stats)
+{
+    if (readerIndex >= interleaver->numReaders)
+        return 0;
+
+    *stats = interleaver->readers[readerIndex];
+    return 1;
+}
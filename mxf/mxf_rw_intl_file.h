@@ -44,6 +44,22 @@ extern "C"
 
 typedef struct MXFRWInterleaver MXFRWInterleaver;
 
+typedef struct
+{
+    uint32_t share;
+    uint64_t readBytes;
+    uint64_t flushedBytes;      /* writer data written to the targets when this reader crossed a block boundary */
+    int isOpen;
+} MXFRWIntlReaderStats;
+
+typedef struct
+{
+    uint64_t backlog;           /* writer data cached and not yet written to the target */
+    uint64_t maxBacklog;
+    uint64_t flushedBytes;      /* writer data written to the target by the interleaver */
+    int isOpen;
+} MXFRWIntlWriterStats;
+
 
 
 int mxf_create_rw_intl(uint32_t interleaveBlockSize, uint32_t writerCacheSize, MXFRWInterleaver **interleaver);
@@ -51,6 +67,29 @@ void mxf_free_rw_intl(MXFRWInterleaver **interleaver);
 
 int mxf_rw_intl_open(MXFRWInterleaver *interleaver, MXFFile *target, int isWriter, MXFFile **mxfFile);
 
+/* Open a reader with a bandwidth share. Each reader flushes writer data after every interleaveBlockSize * share
+   bytes it reads, and so a reader with share N gets N times the read bandwidth of a reader with share 1 when the
+   writers have a backlog. mxf_rw_intl_open opens readers with share 1. The files opened from an interleaver must
+   all be used from the same thread */
+int mxf_rw_intl_open_reader(MXFRWInterleaver *interleaver, MXFFile *target, uint32_t share, MXFFile **mxfFile);
+
+
+/* Adaptive mode. The interleaver measures the read and write throughput of the targets and, after each
+   interleave block that is read, flushes as much writer data as allows reads to achieve targetReadRate bytes
+   per second. The flush size is limited to the range minFlushSize to maxFlushSize. A targetReadRate of 0
+   reverts to flushing interleaveBlockSize bytes per block */
+int mxf_rw_intl_set_adaptive(MXFRWInterleaver *interleaver, uint64_t targetReadRate, uint32_t minFlushSize,
+                             uint32_t maxFlushSize);
+
+/* the writer data size flushed per interleave block that is read */
+uint32_t mxf_rw_intl_get_flush_size(MXFRWInterleaver *interleaver);
+
+/* readers and writers are numbered in the order they were opened, including those that have been closed */
+size_t mxf_rw_intl_get_num_readers(MXFRWInterleaver *interleaver);
+int mxf_rw_intl_get_reader_stats(MXFRWInterleaver *interleaver, size_t readerIndex, MXFRWIntlReaderStats *stats);
+size_t mxf_rw_intl_get_num_writers(MXFRWInterleaver *interleaver);
+int mxf_rw_intl_get_writer_stats(MXFRWInterleaver *interleaver, size_t writerIndex, MXFRWIntlWriterStats *stats);
+
 
 
 #ifdef __cplusplus
@@ -0,0 +1,318 @@
+/*
+ * Copyright (C) 2012, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <mxf/mxf.h>
+#include <mxf/mxf_stats_file.h>
+#include <mxf/mxf_macros.h>
+
+#include "mxf_file_int.h"
+
+
+
+struct MXFStatsFile
+{
+    MXFFile *mxfFile;
+};
+
+struct MXFFileSysData
+{
+    MXFStatsFile statsFile;
+    MXFFile *target;
+    MXFStatsCounters counters[MXF_STATS_NUM_OPS];
+};
+
+
+static const char * const OP_NAMES[MXF_STATS_NUM_OPS] =
+{
+    "read",
+    "write",
+    "get_char",
+    "put_char",
+    "seek",
+    "size",
+};
+
+
+
+static void record_op(MXFFileSysData *sysData, MXFStatsOp op, uint64_t startNs, uint64_t bytes)
+{
+    MXFStatsCounters *counters = &sysData->counters[op];
+    uint64_t durationNs = mxf_get_time_ns() - startNs;
+    uint64_t durationUs = durationNs / 1000;
+    int bucket = 0;
+
+    while (durationUs > 0 && bucket < MXF_STATS_NUM_BUCKETS - 1) {
+        durationUs >>= 1;
+        bucket++;
+    }
+
+    counters->count++;
+    counters->bytes   += bytes;
+    counters->totalNs += durationNs;
+    if (durationNs > counters->maxNs)
+        counters->maxNs = durationNs;
+    counters->histogram[bucket]++;
+}
+
+
+static void stats_file_close(MXFFileSysData *sysData)
+{
+    mxf_file_close(&sysData->target);
+}
+
+static uint32_t stats_file_read(MXFFileSysData *sysData, uint8_t *data, uint32_t count)
+{
+    uint64_t startNs = mxf_get_time_ns();
+    uint32_t result = mxf_file_read(sysData->target, data, count);
+    record_op(sysData, MXF_STATS_READ, startNs, result);
+    return result;
+}
+
+static uint32_t stats_file_write(MXFFileSysData *sysData, const uint8_t *data, uint32_t count)
+{
+    uint64_t startNs = mxf_get_time_ns();
+    uint32_t result = mxf_file_write(sysData->target, data, count);
+    record_op(sysData, MXF_STATS_WRITE, startNs, result);
+    return result;
+}
+
+static int stats_file_getchar(MXFFileSysData *sysData)
+{
+    uint64_t startNs = mxf_get_time_ns();
+    int result = mxf_file_getc(sysData->target);
+    record_op(sysData, MXF_STATS_GET_CHAR, startNs, result != EOF);
+    return result;
+}
+
+static int stats_file_putchar(MXFFileSysData *sysData, int c)
+{
+    uint64_t startNs = mxf_get_time_ns();
+    int result = mxf_file_putc(sysData->target, c);
+    record_op(sysData, MXF_STATS_PUT_CHAR, startNs, result != EOF);
+    return result;
+}
+
+static int stats_file_eof(MXFFileSysData *sysData)
+{
+    return mxf_file_eof(sysData->target);
+}
+
+static int stats_file_seek(MXFFileSysData *sysData, int64_t offset, int whence)
+{
+    uint64_t startNs = mxf_get_time_ns();
+    int result = mxf_file_seek(sysData->target, offset, whence);
+    record_op(sysData, MXF_STATS_SEEK, startNs, 0);
+    return result;
+}
+
+static int64_t stats_file_tell(MXFFileSysData *sysData)
+{
+    return mxf_file_tell(sysData->target);
+}
+
+static int stats_file_is_seekable(MXFFileSysData *sysData)
+{
+    return mxf_file_is_seekable(sysData->target);
+}
+
+static int64_t stats_file_size(MXFFileSysData *sysData)
+{
+    uint64_t startNs = mxf_get_time_ns();
+    int64_t result = mxf_file_size(sysData->target);
+    record_op(sysData, MXF_STATS_SIZE, startNs, 0);
+    return result;
+}
+
+static uint32_t stats_file_read_view(MXFFileSysData *sysData, const uint8_t **data, uint32_t count)
+{
+    uint64_t startNs = mxf_get_time_ns();
+    uint32_t result = mxf_file_read_view(sysData->target, data, count);
+    record_op(sysData, MXF_STATS_READ, startNs, result);
+    return result;
+}
+
+static uint64_t stats_file_writev(MXFFileSysData *sysData, const MXFIOVec *iov, int iovcnt)
+{
+    uint64_t startNs = mxf_get_time_ns();
+    uint64_t result = mxf_file_writev(sysData->target, iov, iovcnt);
+    record_op(sysData, MXF_STATS_WRITE, startNs, result);
+    return result;
+}
+
+static int stats_file_advise(MXFFileSysData *sysData, int64_t offset, int64_t len, MXFFileAdvice advice)
+{
+    return mxf_file_advise(sysData->target, offset, len, advice);
+}
+
+static int stats_file_preallocate(MXFFileSysData *sysData, int64_t offset, int64_t len)
+{
+    return mxf_file_preallocate(sysData->target, offset, len);
+}
+
+static uint64_t stats_file_read_64(MXFFileSysData *sysData, uint8_t *data, uint64_t count)
+{
+    uint64_t startNs = mxf_get_time_ns();
+    uint64_t result = mxf_file_read_64(sysData->target, data, count);
+    record_op(sysData, MXF_STATS_READ, startNs, result);
+    return result;
+}
+
+static uint64_t stats_file_write_64(MXFFileSysData *sysData, const uint8_t *data, uint64_t count)
+{
+    uint64_t startNs = mxf_get_time_ns();
+    uint64_t result = mxf_file_write_64(sysData->target, data, count);
+    record_op(sysData, MXF_STATS_WRITE, startNs, result);
+    return result;
+}
+
+static void free_stats_file(MXFFileSysData *sysData)
+{
+    free(sysData);
+}
+
+
+
+int mxf_stats_file_open(MXFFile *target, MXFStatsFile **statsFile)
+{
+    MXFFile *newMXFFile = NULL;
+    MXFFileSysData *newStatsFile = NULL;
+
+    CHK_MALLOC_ORET(newMXFFile, MXFFile);
+    memset(newMXFFile, 0, sizeof(MXFFile));
+    CHK_MALLOC_OFAIL(newStatsFile, MXFFileSysData);
+    memset(newStatsFile, 0, sizeof(MXFFileSysData));
+
+    newStatsFile->target = target;
+    newStatsFile->statsFile.mxfFile = newMXFFile;
+
+    newMXFFile->close         = stats_file_close;
+    newMXFFile->read          = stats_file_read;
+    newMXFFile->write         = stats_file_write;
+    newMXFFile->get_char      = stats_file_getchar;
+    newMXFFile->put_char      = stats_file_putchar;
+    newMXFFile->eof           = stats_file_eof;
+    newMXFFile->seek          = stats_file_seek;
+    newMXFFile->tell          = stats_file_tell;
+    newMXFFile->is_seekable   = stats_file_is_seekable;
+    newMXFFile->size          = stats_file_size;
+    /* the optional functions are only set if the target provides them so that the fallbacks are unchanged.
+       get_fd is not passed on because copies in the kernel would not be counted */
+    if (target->read_view)
+        newMXFFile->read_view = stats_file_read_view;
+    if (target->writev)
+        newMXFFile->writev    = stats_file_writev;
+    newMXFFile->advise        = stats_file_advise;
+    newMXFFile->preallocate   = stats_file_preallocate;
+    if (target->read_64)
+        newMXFFile->read_64   = stats_file_read_64;
+    if (target->write_64)
+        newMXFFile->write_64  = stats_file_write_64;
+    newMXFFile->free_sys_data = free_stats_file;
+    newMXFFile->sysData       = newStatsFile;
+    newMXFFile->minLLen       = target->minLLen;
+    newMXFFile->runinLen      = target->runinLen;
+
+
+    *statsFile = &newStatsFile->statsFile;
+    return 1;
+
+fail:
+    SAFE_FREE(newMXFFile);
+    SAFE_FREE(newStatsFile);
+    return 0;
+}
+
+MXFFile* mxf_stats_file_get_file(MXFStatsFile *statsFile)
+{
+    return statsFile->mxfFile;
+}
+
+void mxf_stats_file_get_counters(MXFStatsFile *statsFile, MXFStatsOp op, MXFStatsCounters *counters)
+{
+    if (op < 0 || op >= MXF_STATS_NUM_OPS) {
+        memset(counters, 0, sizeof(*counters));
+        return;
+    }
+
+    *counters = statsFile->mxfFile->sysData->counters[op];
+}
+
+void mxf_stats_file_reset(MXFStatsFile *statsFile)
+{
+    memset(statsFile->mxfFile->sysData->counters, 0, sizeof(statsFile->mxfFile->sysData->counters));
+}
+
+void mxf_stats_file_log(MXFStatsFile *statsFile, const char *label)
+{
+    const MXFStatsCounters *counters;
+    char histogram[MXF_STATS_NUM_BUCKETS * 24];
+    size_t len;
+    int haveCounts = 0;
+    int op;
+    int i;
+
+    for (op = 0; op < MXF_STATS_NUM_OPS; op++) {
+        counters = &statsFile->mxfFile->sysData->counters[op];
+        if (counters->count == 0)
+            continue;
+        haveCounts = 1;
+
+        /* list the non-empty buckets as <upper limit in us>:<count> */
+        histogram[0] = '\0';
+        len = 0;
+        for (i = 0; i < MXF_STATS_NUM_BUCKETS && len + 1 < sizeof(histogram); i++) {
+            if (counters->histogram[i] == 0)
+                continue;
+            if (i == MXF_STATS_NUM_BUCKETS - 1) {
+                mxf_snprintf(&histogram[len], sizeof(histogram) - len, " >%u:%"PRIu64,
+                             1U << (i - 1), counters->histogram[i]);
+            } else {
+                mxf_snprintf(&histogram[len], sizeof(histogram) - len, " <%u:%"PRIu64,
+                             1U << i, counters->histogram[i]);
+            }
+            len += strlen(&histogram[len]);
+        }
+
+        mxf_log_info("%s: %s count=%"PRIu64" bytes=%"PRIu64" total=%.3fms max=%.3fms us histogram:%s\n",
+                     label, OP_NAMES[op], counters->count, counters->bytes,
+                     counters->totalNs / 1000000.0, counters->maxNs / 1000000.0, histogram);
+    }
+
+    if (!haveCounts)
+        mxf_log_info("%s: no file operations\n", label);
+}
+
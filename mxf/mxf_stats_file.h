@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2012, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MXF_STATS_FILE_H__
+#define __MXF_STATS_FILE_H__
+
+
+#include <mxf/mxf_file.h>
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/*
+ * Statistics file that passes all calls on to the target file and counts the calls, the bytes transferred and
+ * the latency of each operation. The latency histogram bucket 0 counts calls that took less than 1 microsecond and
+ * bucket i counts calls that took 2^(i-1) up to 2^i microseconds; the last bucket includes all longer calls.
+ * The target is closed when the statistics file is closed.
+ */
+
+
+#define MXF_STATS_NUM_BUCKETS   32
+
+typedef enum
+{
+    MXF_STATS_READ = 0,
+    MXF_STATS_WRITE,
+    MXF_STATS_GET_CHAR,
+    MXF_STATS_PUT_CHAR,
+    MXF_STATS_SEEK,
+    MXF_STATS_SIZE,
+    MXF_STATS_NUM_OPS
+} MXFStatsOp;
+
+typedef struct
+{
+    uint64_t count;
+    uint64_t bytes;
+    uint64_t totalNs;
+    uint64_t maxNs;
+    uint64_t histogram[MXF_STATS_NUM_BUCKETS];
+} MXFStatsCounters;
+
+typedef struct MXFStatsFile MXFStatsFile;
+
+
+int mxf_stats_file_open(MXFFile *target, MXFStatsFile **statsFile);
+
+MXFFile* mxf_stats_file_get_file(MXFStatsFile *statsFile);
+
+
+void mxf_stats_file_get_counters(MXFStatsFile *statsFile, MXFStatsOp op, MXFStatsCounters *counters);
+void mxf_stats_file_reset(MXFStatsFile *statsFile);
+
+/* log a summary of the counters using mxf_log_info, prefixed with label */
+void mxf_stats_file_log(MXFStatsFile *statsFile, const char *label);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
+
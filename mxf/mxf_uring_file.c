@@ -0,0 +1,996 @@
+/*
+ * Copyright (C) 2012, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include <mxf/mxf.h>
+#include <mxf/mxf_uring_file.h>
+#include <mxf/mxf_macros.h>
+
+
+
+#define DEFAULT_QUEUE_DEPTH     8
+#define DEFAULT_BLOCK_SIZE      (2 * 1024 * 1024)
+
+/* distinguishes the file's block requests from submit/complete requests */
+#define BLOCK_USER_DATA_FLAG    (1ULL << 63)
+
+
+typedef enum
+{
+    NEW_MODE,
+    READ_MODE,
+    MODIFY_MODE,
+} OpenMode;
+
+typedef enum
+{
+    IDLE_IO,
+    READ_IO,
+    WRITE_IO,
+} IOMode;
+
+typedef enum
+{
+    BLOCK_FREE,
+    BLOCK_FILLING,
+    BLOCK_WRITE_PENDING,
+    BLOCK_READ_PENDING,
+    BLOCK_READ_DONE,
+} BlockState;
+
+typedef struct
+{
+    uint8_t *data;
+    int64_t offset;
+    uint32_t size;
+    BlockState state;
+    uint64_t lastUse;
+} Block;
+
+typedef struct
+{
+    uint64_t userData;
+    int32_t result;
+} Completion;
+
+typedef struct
+{
+    int fd;
+    uint32_t numEntries;
+    uint32_t inFlight;
+    int failed;         /* submission failed and no further requests are submitted */
+
+    void *sqRing;
+    size_t sqRingSize;
+    void *cqRing;
+    size_t cqRingSize;
+    struct io_uring_sqe *sqes;
+    size_t sqesSize;
+
+    unsigned *sqHead;
+    unsigned *sqTail;
+    unsigned *sqMask;
+    unsigned *sqArray;
+    unsigned *cqHead;
+    unsigned *cqTail;
+    unsigned *cqMask;
+    struct io_uring_cqe *cqes;
+} Ring;
+
+struct MXFURingFile
+{
+    MXFFile *mxfFile;
+};
+
+struct MXFFileSysData
+{
+    MXFURingFile uringFile;
+    int fd;
+    OpenMode mode;
+    Ring ring;
+
+    unsigned char *allocBlockData;
+    Block *blocks;
+    uint32_t numBlocks;
+    uint32_t blockSize;
+    Block *fillBlock;
+    IOMode ioMode;
+    uint64_t useCount;
+
+    Completion *userCompletions;
+    uint32_t numUserCompletions;
+    uint32_t userInFlight;
+
+    int64_t position;
+    int64_t lastReadEnd;
+    int64_t fileSize;
+    int eof;
+    int ioError;
+};
+
+
+
+static int ring_enter(Ring *ring, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+    int result;
+
+    do {
+        result = (int)syscall(__NR_io_uring_enter, ring->fd, toSubmit, minComplete, flags, NULL, 0);
+    } while (result < 0 && errno == EINTR);
+
+    return result;
+}
+
+static void ring_close(Ring *ring)
+{
+    if (ring->sqes)
+        munmap(ring->sqes, ring->sqesSize);
+    if (ring->cqRing && ring->cqRing != ring->sqRing)
+        munmap(ring->cqRing, ring->cqRingSize);
+    if (ring->sqRing)
+        munmap(ring->sqRing, ring->sqRingSize);
+    if (ring->fd >= 0)
+        close(ring->fd);
+
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+}
+
+static int ring_open(Ring *ring, uint32_t entries)
+{
+    struct io_uring_params params;
+    void *ptr;
+
+    memset(ring, 0, sizeof(*ring));
+    memset(&params, 0, sizeof(params));
+
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0) {
+        mxf_log_error("Failed to setup io_uring: %s\n", strerror(errno));
+        return 0;
+    }
+
+    ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if ((params.features & IORING_FEAT_SINGLE_MMAP)) {
+        if (ring->cqRingSize > ring->sqRingSize)
+            ring->sqRingSize = ring->cqRingSize;
+        ring->cqRingSize = ring->sqRingSize;
+    }
+
+    ptr = mmap(NULL, ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+               IORING_OFF_SQ_RING);
+    CHK_OFAIL(ptr != MAP_FAILED);
+    ring->sqRing = ptr;
+
+    if ((params.features & IORING_FEAT_SINGLE_MMAP)) {
+        ring->cqRing = ring->sqRing;
+    } else {
+        ptr = mmap(NULL, ring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                   IORING_OFF_CQ_RING);
+        CHK_OFAIL(ptr != MAP_FAILED);
+        ring->cqRing = ptr;
+    }
+
+    ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    ptr = mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+               IORING_OFF_SQES);
+    CHK_OFAIL(ptr != MAP_FAILED);
+    ring->sqes = (struct io_uring_sqe*)ptr;
+
+    ring->sqHead  = (unsigned*)((char*)ring->sqRing + params.sq_off.head);
+    ring->sqTail  = (unsigned*)((char*)ring->sqRing + params.sq_off.tail);
+    ring->sqMask  = (unsigned*)((char*)ring->sqRing + params.sq_off.ring_mask);
+    ring->sqArray = (unsigned*)((char*)ring->sqRing + params.sq_off.array);
+    ring->cqHead  = (unsigned*)((char*)ring->cqRing + params.cq_off.head);
+    ring->cqTail  = (unsigned*)((char*)ring->cqRing + params.cq_off.tail);
+    ring->cqMask  = (unsigned*)((char*)ring->cqRing + params.cq_off.ring_mask);
+    ring->cqes    = (struct io_uring_cqe*)((char*)ring->cqRing + params.cq_off.cqes);
+
+    /* the completion queue is at least as large as the submission queue and so limiting the number
+       of requests in flight to the submission queue size prevents completion queue overflows */
+    ring->numEntries = params.sq_entries;
+
+    return 1;
+
+fail:
+    mxf_log_error("Failed to map io_uring queues: %s\n", strerror(errno));
+    ring_close(ring);
+    return 0;
+}
+
+static int ring_submit(Ring *ring, uint8_t opcode, int fd, const void *data, uint32_t count, int64_t offset,
+                       uint64_t userData)
+{
+    struct io_uring_sqe *sqe;
+    unsigned tail;
+    unsigned index;
+    int result;
+
+    assert(ring->inFlight < ring->numEntries);
+
+    if (ring->failed)
+        return 0;
+
+    tail  = *ring->sqTail;
+    index = tail & *ring->sqMask;
+    sqe   = &ring->sqes[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode    = opcode;
+    sqe->fd        = fd;
+    sqe->addr      = (uint64_t)(uintptr_t)data;
+    sqe->len       = count;
+    sqe->off       = (uint64_t)offset;
+    sqe->user_data = userData;
+
+    ring->sqArray[index] = index;
+    __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+
+    do {
+        result = ring_enter(ring, 1, 0, 0);
+    } while (result < 0 && errno == EAGAIN);
+
+    if (result != 1) {
+        mxf_log_error("Failed to submit io_uring request: %s\n", result < 0 ? strerror(errno) : "not consumed");
+        ring->failed = 1;
+
+        /* the request is still queued if the kernel has not consumed it. The tail is reset so that it is never
+           submitted, which is safe because the kernel only consumes requests from within io_uring_enter */
+        if (__atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE) == tail) {
+            __atomic_store_n(ring->sqTail, tail, __ATOMIC_RELEASE);
+            return 0;
+        }
+        /* the request was consumed and its completion will be posted */
+    }
+
+    ring->inFlight++;
+    return 1;
+}
+
+static int ring_reap(Ring *ring, int wait, uint64_t *userData, int32_t *result)
+{
+    struct io_uring_cqe *cqe;
+    unsigned head;
+    unsigned tail;
+
+    while (1) {
+        head = *ring->cqHead;
+        tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+        if (head != tail) {
+            cqe = &ring->cqes[head & *ring->cqMask];
+            *userData = cqe->user_data;
+            *result   = cqe->res;
+            __atomic_store_n(ring->cqHead, head + 1, __ATOMIC_RELEASE);
+            ring->inFlight--;
+            return 1;
+        }
+
+        if (!wait || ring->inFlight == 0)
+            return 0;
+
+        if (ring_enter(ring, 0, 1, IORING_ENTER_GETEVENTS) < 0) {
+            mxf_log_error("Failed to wait for io_uring completion: %s\n", strerror(errno));
+            return 0;
+        }
+    }
+}
+
+
+static int write_remainder(MXFFileSysData *sysData, const uint8_t *data, uint32_t count, int64_t offset)
+{
+    ssize_t result;
+
+    /* complete a short write synchronously */
+    while (count > 0) {
+        result = pwrite(sysData->fd, data, count, offset);
+        if (result < 0) {
+            if (errno == EINTR)
+                continue;
+            mxf_log_error("pwrite failed: %s\n", strerror(errno));
+            return 0;
+        }
+        data   += result;
+        offset += result;
+        count  -= (uint32_t)result;
+    }
+
+    return 1;
+}
+
+static int64_t update_file_size(MXFFileSysData *sysData)
+{
+    struct stat statBuf;
+
+    /* the file size could be larger if another process is writing to it */
+    if (fstat(sysData->fd, &statBuf) == 0 && statBuf.st_size > sysData->fileSize)
+        sysData->fileSize = statBuf.st_size;
+
+    return sysData->fileSize;
+}
+
+static void process_completion(MXFFileSysData *sysData, uint64_t userData, int32_t result)
+{
+    Block *block;
+
+    if (!(userData & BLOCK_USER_DATA_FLAG)) {
+        sysData->userCompletions[sysData->numUserCompletions].userData = userData;
+        sysData->userCompletions[sysData->numUserCompletions].result   = result;
+        sysData->numUserCompletions++;
+        sysData->userInFlight--;
+        return;
+    }
+
+    block = &sysData->blocks[userData & ~BLOCK_USER_DATA_FLAG];
+    if (block->state == BLOCK_WRITE_PENDING) {
+        if (result < 0) {
+            mxf_log_error("io_uring write failed: %s\n", strerror(-result));
+            sysData->ioError = 1;
+        } else if ((uint32_t)result < block->size) {
+            if (!write_remainder(sysData, &block->data[result], block->size - (uint32_t)result,
+                                 block->offset + result))
+            {
+                sysData->ioError = 1;
+            }
+        }
+        block->state = BLOCK_FREE;
+        block->size  = 0;
+    } else {
+        assert(block->state == BLOCK_READ_PENDING);
+        if (result < 0) {
+            mxf_log_error("io_uring read failed: %s\n", strerror(-result));
+            block->state = BLOCK_FREE;
+            block->size  = 0;
+            return;
+        }
+
+        block->size += (uint32_t)result;
+
+        /* a short read before the end of the file is continued, e.g. after a signal. The size is refreshed in
+           case the file is still growing */
+        if (result > 0 && block->size < sysData->blockSize &&
+            (block->offset + block->size < sysData->fileSize ||
+                block->offset + block->size < update_file_size(sysData)) &&
+            ring_submit(&sysData->ring, IORING_OP_READ, sysData->fd, &block->data[block->size],
+                        sysData->blockSize - block->size, block->offset + block->size, userData))
+        {
+            return;
+        }
+        block->state = BLOCK_READ_DONE;
+    }
+}
+
+static int process_next_completion(MXFFileSysData *sysData, int wait)
+{
+    uint64_t userData;
+    int32_t result;
+
+    if (!ring_reap(&sysData->ring, wait, &userData, &result))
+        return 0;
+
+    process_completion(sysData, userData, result);
+    return 1;
+}
+
+static int make_ring_space(MXFFileSysData *sysData)
+{
+    while (sysData->ring.inFlight >= sysData->ring.numEntries)
+        CHK_ORET(process_next_completion(sysData, 1));
+
+    return 1;
+}
+
+static int wait_for_block(MXFFileSysData *sysData, Block *block)
+{
+    while (block->state == BLOCK_WRITE_PENDING || block->state == BLOCK_READ_PENDING)
+        CHK_ORET(process_next_completion(sysData, 1));
+
+    return 1;
+}
+
+static int submit_block_write(MXFFileSysData *sysData, Block *block)
+{
+    CHK_ORET(make_ring_space(sysData));
+
+    block->state = BLOCK_WRITE_PENDING;
+    if (!ring_submit(&sysData->ring, IORING_OP_WRITE, sysData->fd, block->data, block->size, block->offset,
+                     BLOCK_USER_DATA_FLAG | (uint64_t)(block - sysData->blocks)))
+    {
+        block->state = BLOCK_FREE;
+        sysData->ioError = 1;
+        return 0;
+    }
+
+    return 1;
+}
+
+static int submit_block_read(MXFFileSysData *sysData, Block *block, int64_t offset)
+{
+    CHK_ORET(make_ring_space(sysData));
+
+    block->state  = BLOCK_READ_PENDING;
+    block->offset = offset;
+    block->size   = 0;
+    if (!ring_submit(&sysData->ring, IORING_OP_READ, sysData->fd, block->data, sysData->blockSize, offset,
+                     BLOCK_USER_DATA_FLAG | (uint64_t)(block - sysData->blocks)))
+    {
+        block->state = BLOCK_FREE;
+        if (sysData->ring.failed)
+            sysData->ioError = 1;
+        return 0;
+    }
+
+    return 1;
+}
+
+static int submit_fill_block(MXFFileSysData *sysData)
+{
+    Block *block = sysData->fillBlock;
+
+    if (!block)
+        return 1;
+
+    sysData->fillBlock = NULL;
+    if (block->size == 0) {
+        block->state = BLOCK_FREE;
+        return 1;
+    }
+
+    return submit_block_write(sysData, block);
+}
+
+static int flush_writes(MXFFileSysData *sysData)
+{
+    uint32_t i;
+
+    CHK_ORET(submit_fill_block(sysData));
+    for (i = 0; i < sysData->numBlocks; i++)
+        CHK_ORET(wait_for_block(sysData, &sysData->blocks[i]));
+
+    return !sysData->ioError;
+}
+
+static int drop_reads(MXFFileSysData *sysData)
+{
+    uint32_t i;
+
+    for (i = 0; i < sysData->numBlocks; i++) {
+        CHK_ORET(wait_for_block(sysData, &sysData->blocks[i]));
+        if (sysData->blocks[i].state == BLOCK_READ_DONE) {
+            sysData->blocks[i].state = BLOCK_FREE;
+            sysData->blocks[i].size  = 0;
+        }
+    }
+
+    return 1;
+}
+
+static Block* find_read_block(MXFFileSysData *sysData, int64_t offset)
+{
+    uint32_t i;
+
+    for (i = 0; i < sysData->numBlocks; i++) {
+        if ((sysData->blocks[i].state == BLOCK_READ_PENDING || sysData->blocks[i].state == BLOCK_READ_DONE) &&
+            sysData->blocks[i].offset == offset)
+        {
+            return &sysData->blocks[i];
+        }
+    }
+
+    return NULL;
+}
+
+static Block* get_unused_block(MXFFileSysData *sysData, int64_t minReuseOffset)
+{
+    Block *lruBlock = NULL;
+    uint32_t i;
+
+    /* prefer free blocks, otherwise the least recently used block that has been read, excluding blocks at
+       or beyond minReuseOffset */
+    for (i = 0; i < sysData->numBlocks; i++) {
+        if (sysData->blocks[i].state == BLOCK_FREE)
+            return &sysData->blocks[i];
+
+        if (sysData->blocks[i].state == BLOCK_READ_DONE && sysData->blocks[i].offset < minReuseOffset &&
+            (!lruBlock || sysData->blocks[i].lastUse < lruBlock->lastUse))
+        {
+            lruBlock = &sysData->blocks[i];
+        }
+    }
+
+    return lruBlock;
+}
+
+static int prefetch_blocks(MXFFileSysData *sysData, int64_t blockOffset)
+{
+    int64_t offset;
+    Block *block;
+    uint32_t i;
+
+    for (i = 1; i < sysData->numBlocks; i++) {
+        offset = blockOffset + (int64_t)i * sysData->blockSize;
+        if (offset >= sysData->fileSize && offset >= update_file_size(sysData))
+            break;
+        if (find_read_block(sysData, offset))
+            continue;
+
+        /* only reuse blocks that are behind the current read position */
+        block = get_unused_block(sysData, blockOffset);
+        if (!block)
+            break;
+        CHK_ORET(submit_block_read(sysData, block, offset));
+    }
+
+    return 1;
+}
+
+static int wait_for_write_overlap(MXFFileSysData *sysData, int64_t offset, int64_t size)
+{
+    uint32_t i;
+
+    /* requests in flight can complete in any order and so overlapping writes must be serialised */
+    for (i = 0; i < sysData->numBlocks; i++) {
+        if (sysData->blocks[i].state == BLOCK_WRITE_PENDING &&
+            sysData->blocks[i].offset < offset + size &&
+            sysData->blocks[i].offset + sysData->blocks[i].size > offset)
+        {
+            CHK_ORET(wait_for_block(sysData, &sysData->blocks[i]));
+        }
+    }
+
+    return 1;
+}
+
+
+
+static void uring_file_close(MXFFileSysData *sysData)
+{
+    uint64_t userData;
+    int32_t result;
+
+    if (sysData->ring.fd >= 0) {
+        if (!flush_writes(sysData))
+            mxf_log_error("Failed to complete io_uring file writes\n");
+
+        /* discard outstanding submit/complete requests */
+        while (ring_reap(&sysData->ring, 1, &userData, &result))
+        {}
+    }
+    ring_close(&sysData->ring);
+
+    if (sysData->fd >= 0) {
+        close(sysData->fd);
+        sysData->fd = -1;
+    }
+
+    SAFE_FREE(sysData->blocks);
+    SAFE_FREE(sysData->allocBlockData);
+    SAFE_FREE(sysData->userCompletions);
+}
+
+static uint32_t uring_file_read(MXFFileSysData *sysData, uint8_t *data, uint32_t count)
+{
+    uint32_t remCount = count;
+    int64_t blockOffset;
+    uint32_t blockPos;
+    uint32_t numRead;
+    Block *block;
+    int sequential;
+
+    if (sysData->ioMode == WRITE_IO) {
+        CHK_ORET(flush_writes(sysData));
+        sysData->ioMode = IDLE_IO;
+    }
+    sysData->ioMode = READ_IO;
+
+    sequential = (sysData->position == sysData->lastReadEnd);
+
+    while (remCount > 0) {
+        blockOffset = sysData->position - sysData->position % sysData->blockSize;
+
+        block = find_read_block(sysData, blockOffset);
+        if (!block) {
+            while (!(block = get_unused_block(sysData, INT64_MAX))) {
+                if (!process_next_completion(sysData, 1))
+                    break;
+            }
+            if (!block || !submit_block_read(sysData, block, blockOffset))
+                break;
+        }
+        /* prefetching is best-effort and the read continues if it fails */
+        if (sequential)
+            prefetch_blocks(sysData, blockOffset);
+        if (!wait_for_block(sysData, block) || block->state != BLOCK_READ_DONE)
+            break;
+        block->lastUse = ++sysData->useCount;
+
+        blockPos = (uint32_t)(sysData->position - blockOffset);
+        if (blockPos >= block->size) {
+            /* a block read at the end of the file is read again if the file has grown since */
+            if (block->size < sysData->blockSize && block->offset + block->size < update_file_size(sysData) &&
+                submit_block_read(sysData, block, blockOffset))
+            {
+                continue;
+            }
+            break;
+        }
+
+        numRead = block->size - blockPos;
+        if (numRead > remCount)
+            numRead = remCount;
+        memcpy(&data[count - remCount], &block->data[blockPos], numRead);
+        remCount -= numRead;
+        sysData->position += numRead;
+    }
+
+    sysData->lastReadEnd = sysData->position;
+    sysData->eof = (count > 0 && remCount > 0);
+
+    return count - remCount;
+}
+
+static uint32_t uring_file_write(MXFFileSysData *sysData, const uint8_t *data, uint32_t count)
+{
+    uint32_t remCount = count;
+    uint32_t numWrite;
+    Block *block;
+
+    if (sysData->mode == READ_MODE || sysData->ioError)
+        return 0;
+
+    if (sysData->ioMode == READ_IO)
+        CHK_ORET(drop_reads(sysData));
+    sysData->ioMode = WRITE_IO;
+
+    while (remCount > 0) {
+        if (sysData->fillBlock &&
+            sysData->fillBlock->offset + sysData->fillBlock->size != sysData->position)
+        {
+            if (!submit_fill_block(sysData))
+                break;
+        }
+
+        if (!sysData->fillBlock) {
+            while (!(block = get_unused_block(sysData, INT64_MAX))) {
+                if (!process_next_completion(sysData, 1))
+                    break;
+            }
+            if (!block || !wait_for_write_overlap(sysData, sysData->position, sysData->blockSize))
+                break;
+
+            block->state  = BLOCK_FILLING;
+            block->offset = sysData->position;
+            block->size   = 0;
+            sysData->fillBlock = block;
+        }
+        block = sysData->fillBlock;
+
+        numWrite = sysData->blockSize - block->size;
+        if (numWrite > remCount)
+            numWrite = remCount;
+        memcpy(&block->data[block->size], &data[count - remCount], numWrite);
+        block->size += numWrite;
+        remCount -= numWrite;
+        sysData->position += numWrite;
+
+        if (block->size == sysData->blockSize && !submit_fill_block(sysData))
+            break;
+    }
+
+    if (sysData->position > sysData->fileSize)
+        sysData->fileSize = sysData->position;
+
+    return count - remCount;
+}
+
+static int uring_file_getchar(MXFFileSysData *sysData)
+{
+    uint8_t data;
+    if (uring_file_read(sysData, &data, 1) != 1)
+        return EOF;
+
+    return data;
+}
+
+static int uring_file_putchar(MXFFileSysData *sysData, int c)
+{
+    uint8_t data = (uint8_t)c;
+    if (uring_file_write(sysData, &data, 1) != 1)
+        return EOF;
+
+    return data;
+}
+
+static int uring_file_eof(MXFFileSysData *sysData)
+{
+    return sysData->eof;
+}
+
+static int64_t uring_file_size(MXFFileSysData *sysData)
+{
+    return update_file_size(sysData);
+}
+
+static int uring_file_seek(MXFFileSysData *sysData, int64_t offset, int whence)
+{
+    int64_t position;
+
+    switch (whence)
+    {
+        case SEEK_SET:
+            position = offset;
+            break;
+        case SEEK_CUR:
+            position = sysData->position + offset;
+            break;
+        case SEEK_END:
+            position = uring_file_size(sysData) + offset;
+            break;
+        default:
+            return 0;
+    }
+    if (position < 0)
+        return 0;
+
+    sysData->position = position;
+    sysData->eof      = 0;
+
+    return 1;
+}
+
+static int64_t uring_file_tell(MXFFileSysData *sysData)
+{
+    return sysData->position;
+}
+
+static int uring_file_is_seekable(MXFFileSysData *sysData)
+{
+    (void)sysData;
+
+    return 1;
+}
+
+static void free_uring_file(MXFFileSysData *sysData)
+{
+    free(sysData);
+}
+
+
+static int uring_file_open(const char *filename, OpenMode mode, uint32_t queueDepth, uint32_t in_blockSize,
+                           MXFURingFile **uringFile)
+{
+    MXFFile *newMXFFile = NULL;
+    MXFFileSysData *newURingFile = NULL;
+    struct stat statBuf;
+    uint32_t sysPageSize;
+    uint32_t blockSize = in_blockSize;
+    uint32_t i;
+    int flags = 0;
+
+    sysPageSize = mxf_get_system_page_size();
+    CHK_ORET(sysPageSize > 0);
+
+    if (queueDepth == 0)
+        queueDepth = DEFAULT_QUEUE_DEPTH;
+    if (blockSize == 0)
+        blockSize = DEFAULT_BLOCK_SIZE;
+    else if (blockSize % sysPageSize != 0)
+        blockSize = (blockSize + sysPageSize - 1) & ~(sysPageSize - 1);
+
+    CHK_MALLOC_ORET(newMXFFile, MXFFile);
+    memset(newMXFFile, 0, sizeof(MXFFile));
+    CHK_MALLOC_OFAIL(newURingFile, MXFFileSysData);
+    memset(newURingFile, 0, sizeof(MXFFileSysData));
+    newURingFile->fd      = -1;
+    newURingFile->ring.fd = -1;
+
+    switch (mode)
+    {
+        case NEW_MODE:
+            flags = O_RDWR | O_CREAT | O_TRUNC;
+            break;
+        case READ_MODE:
+            flags = O_RDONLY;
+            break;
+        case MODIFY_MODE:
+            flags = O_RDWR;
+            break;
+    }
+    newURingFile->fd = open(filename, flags, 0666);
+    if (newURingFile->fd < 0)
+        goto fail;
+    if (fstat(newURingFile->fd, &statBuf) != 0) {
+        mxf_log_error("Failed to stat file '%s': %s\n", filename, strerror(errno));
+        goto fail;
+    }
+    newURingFile->fileSize = statBuf.st_size;
+
+    /* the ring is shared between the blocks and the submit/complete requests */
+    CHK_OFAIL(ring_open(&newURingFile->ring, queueDepth * 2));
+
+    CHK_MALLOC_ARRAY_OFAIL(newURingFile->allocBlockData, unsigned char,
+                           (size_t)queueDepth * blockSize + sysPageSize);
+    CHK_MALLOC_ARRAY_OFAIL(newURingFile->blocks, Block, queueDepth);
+    memset(newURingFile->blocks, 0, queueDepth * sizeof(Block));
+    for (i = 0; i < queueDepth; i++) {
+        newURingFile->blocks[i].data = (uint8_t*)(((uintptr_t)newURingFile->allocBlockData + sysPageSize - 1) &
+                                                  ~(uintptr_t)(sysPageSize - 1)) + (size_t)i * blockSize;
+    }
+    CHK_MALLOC_ARRAY_OFAIL(newURingFile->userCompletions, Completion, newURingFile->ring.numEntries);
+
+    newURingFile->mode       = mode;
+    newURingFile->numBlocks  = queueDepth;
+    newURingFile->blockSize  = blockSize;
+    newURingFile->uringFile.mxfFile = newMXFFile;
+
+    newMXFFile->close         = uring_file_close;
+    newMXFFile->read          = uring_file_read;
+    newMXFFile->write         = uring_file_write;
+    newMXFFile->get_char      = uring_file_getchar;
+    newMXFFile->put_char      = uring_file_putchar;
+    newMXFFile->eof           = uring_file_eof;
+    newMXFFile->seek          = uring_file_seek;
+    newMXFFile->tell          = uring_file_tell;
+    newMXFFile->is_seekable   = uring_file_is_seekable;
+    newMXFFile->size          = uring_file_size;
+    newMXFFile->free_sys_data = free_uring_file;
+    newMXFFile->sysData       = newURingFile;
+
+    *uringFile = &newURingFile->uringFile;
+    return 1;
+
+fail:
+    if (newURingFile) {
+        ring_close(&newURingFile->ring);
+        if (newURingFile->fd >= 0)
+            close(newURingFile->fd);
+        SAFE_FREE(newURingFile->blocks);
+        SAFE_FREE(newURingFile->allocBlockData);
+        SAFE_FREE(newURingFile->userCompletions);
+    }
+    SAFE_FREE(newMXFFile);
+    SAFE_FREE(newURingFile);
+    return 0;
+}
+
+
+
+int mxf_uring_file_is_supported(void)
+{
+    struct io_uring_params params;
+    int fd;
+
+    memset(&params, 0, sizeof(params));
+    fd = (int)syscall(__NR_io_uring_setup, 1, &params);
+    if (fd < 0)
+        return 0;
+
+    close(fd);
+    return 1;
+}
+
+int mxf_uring_file_open_new(const char *filename, uint32_t queueDepth, uint32_t blockSize, MXFURingFile **uringFile)
+{
+    return uring_file_open(filename, NEW_MODE, queueDepth, blockSize, uringFile);
+}
+
+int mxf_uring_file_open_read(const char *filename, uint32_t queueDepth, uint32_t blockSize, MXFURingFile **uringFile)
+{
+    return uring_file_open(filename, READ_MODE, queueDepth, blockSize, uringFile);
+}
+
+int mxf_uring_file_open_modify(const char *filename, uint32_t queueDepth, uint32_t blockSize,
+                               MXFURingFile **uringFile)
+{
+    return uring_file_open(filename, MODIFY_MODE, queueDepth, blockSize, uringFile);
+}
+
+MXFFile* mxf_uring_file_get_file(MXFURingFile *uringFile)
+{
+    return uringFile->mxfFile;
+}
+
+int mxf_uring_file_flush(MXFURingFile *uringFile)
+{
+    return flush_writes(uringFile->mxfFile->sysData);
+}
+
+int mxf_uring_file_submit_read(MXFURingFile *uringFile, int64_t offset, uint8_t *data, uint32_t count,
+                               uint64_t userData)
+{
+    MXFFileSysData *sysData = uringFile->mxfFile->sysData;
+
+    CHK_ORET(!(userData & BLOCK_USER_DATA_FLAG));
+    CHK_ORET(sysData->userInFlight + sysData->numUserCompletions < sysData->ring.numEntries);
+    CHK_ORET(make_ring_space(sysData));
+    CHK_ORET(ring_submit(&sysData->ring, IORING_OP_READ, sysData->fd, data, count, offset, userData));
+    sysData->userInFlight++;
+
+    return 1;
+}
+
+int mxf_uring_file_submit_write(MXFURingFile *uringFile, int64_t offset, const uint8_t *data, uint32_t count,
+                                uint64_t userData)
+{
+    MXFFileSysData *sysData = uringFile->mxfFile->sysData;
+
+    CHK_ORET(sysData->mode != READ_MODE);
+    CHK_ORET(!(userData & BLOCK_USER_DATA_FLAG));
+    CHK_ORET(sysData->userInFlight + sysData->numUserCompletions < sysData->ring.numEntries);
+    CHK_ORET(make_ring_space(sysData));
+    CHK_ORET(ring_submit(&sysData->ring, IORING_OP_WRITE, sysData->fd, data, count, offset, userData));
+    sysData->userInFlight++;
+
+    if (offset + count > sysData->fileSize)
+        sysData->fileSize = offset + count;
+
+    return 1;
+}
+
+int mxf_uring_file_complete(MXFURingFile *uringFile, int wait, uint64_t *userData, int32_t *result)
+{
+    MXFFileSysData *sysData = uringFile->mxfFile->sysData;
+
+    while (sysData->numUserCompletions == 0) {
+        if (sysData->userInFlight == 0 || !process_next_completion(sysData, wait))
+            return 0;
+    }
+
+    *userData = sysData->userCompletions[0].userData;
+    *result   = sysData->userCompletions[0].result;
+    sysData->numUserCompletions--;
+    memmove(&sysData->userCompletions[0], &sysData->userCompletions[1],
+            sysData->numUserCompletions * sizeof(Completion));
+
+    return 1;
+}
+
+uint32_t mxf_uring_file_get_in_flight(MXFURingFile *uringFile)
+{
+    MXFFileSysData *sysData = uringFile->mxfFile->sysData;
+
+    return sysData->userInFlight + sysData->numUserCompletions;
+}
+
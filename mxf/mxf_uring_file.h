@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2012, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MXF_URING_FILE_H__
+#define __MXF_URING_FILE_H__
+
+
+#include <mxf/mxf_file.h>
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/*
+ * Linux io_uring disk file. Writes are copied into a set of blocks that are written asynchronously once full
+ * (write-behind) and sequential reads keep the following blocks in flight (read-ahead), so that up to queueDepth
+ * blocks of blockSize bytes are being transferred at once. A queueDepth or blockSize of 0 selects the default.
+ *
+ * The submit/complete functions provide direct access to the queue for layers that manage their own buffers.
+ * These requests bypass the MXFFile position and its blocks, and so must not overlap with data that is buffered
+ * in the blocks; call mxf_uring_file_flush first. userData values must be less than 2^63.
+ */
+
+
+typedef struct MXFURingFile MXFURingFile;
+
+
+int mxf_uring_file_is_supported(void);
+
+int mxf_uring_file_open_new(const char *filename, uint32_t queueDepth, uint32_t blockSize, MXFURingFile **uringFile);
+int mxf_uring_file_open_read(const char *filename, uint32_t queueDepth, uint32_t blockSize, MXFURingFile **uringFile);
+int mxf_uring_file_open_modify(const char *filename, uint32_t queueDepth, uint32_t blockSize,
+                               MXFURingFile **uringFile);
+
+MXFFile* mxf_uring_file_get_file(MXFURingFile *uringFile);
+
+/* submit the partially filled block and wait for all block writes to complete */
+int mxf_uring_file_flush(MXFURingFile *uringFile);
+
+int mxf_uring_file_submit_read(MXFURingFile *uringFile, int64_t offset, uint8_t *data, uint32_t count,
+                               uint64_t userData);
+int mxf_uring_file_submit_write(MXFURingFile *uringFile, int64_t offset, const uint8_t *data, uint32_t count,
+                                uint64_t userData);
+/* returns 1 and the userData and result (byte count or -errno) of a completed request, or 0 if no request
+   has completed (wait is false) or no request is in flight */
+int mxf_uring_file_complete(MXFURingFile *uringFile, int wait, uint64_t *userData, int32_t *result);
+uint32_t mxf_uring_file_get_in_flight(MXFURingFile *uringFile);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
+
@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2012, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include <mxf/mxf.h>
+#include <mxf/mxf_macros.h>
+
+#include "mxf_shaped_file.h"
+
+
+
+struct MXFShapedFile
+{
+    MXFFile *mxfFile;
+};
+
+struct MXFFileSysData
+{
+    MXFShapedFile shapedFile;
+    MXFFile *target;
+    MXFShapedFileParams params;
+    uint32_t ioCount;
+};
+
+
+
+static void sleep_us(uint64_t us)
+{
+#if defined(_WIN32)
+    Sleep((DWORD)((us + 999) / 1000));
+#else
+    struct timespec ts;
+
+    ts.tv_sec  = us / 1000000;
+    ts.tv_nsec = (long)(us % 1000000) * 1000;
+    while (nanosleep(&ts, &ts) != 0)
+        ;
+#endif
+}
+
+static void delay_call(MXFFileSysData *sysData)
+{
+    if (sysData->params.latencyUs > 0)
+        sleep_us(sysData->params.latencyUs);
+}
+
+static uint32_t shape_io(MXFFileSysData *sysData, uint32_t count)
+{
+    uint32_t shapedCount = count;
+
+    sysData->ioCount++;
+    if (sysData->params.shortIOInterval > 0 && count > 1 &&
+        sysData->ioCount % sysData->params.shortIOInterval == 0)
+    {
+        shapedCount = count / 2;
+    }
+
+    delay_call(sysData);
+    if (sysData->params.bytesPerSec > 0)
+        sleep_us((uint64_t)shapedCount * 1000000 / sysData->params.bytesPerSec);
+
+    return shapedCount;
+}
+
+
+static void shaped_file_close(MXFFileSysData *sysData)
+{
+    mxf_file_close(&sysData->target);
+}
+
+static uint32_t shaped_file_read(MXFFileSysData *sysData, uint8_t *data, uint32_t count)
+{
+    return mxf_file_read(sysData->target, data, shape_io(sysData, count));
+}
+
+static uint32_t shaped_file_write(MXFFileSysData *sysData, const uint8_t *data, uint32_t count)
+{
+    return mxf_file_write(sysData->target, data, shape_io(sysData, count));
+}
+
+static int shaped_file_getchar(MXFFileSysData *sysData)
+{
+    return mxf_file_getc(sysData->target);
+}
+
+static int shaped_file_putchar(MXFFileSysData *sysData, int c)
+{
+    return mxf_file_putc(sysData->target, c);
+}
+
+static int shaped_file_eof(MXFFileSysData *sysData)
+{
+    return mxf_file_eof(sysData->target);
+}
+
+static int shaped_file_seek(MXFFileSysData *sysData, int64_t offset, int whence)
+{
+    delay_call(sysData);
+    return mxf_file_seek(sysData->target, offset, whence);
+}
+
+static int64_t shaped_file_tell(MXFFileSysData *sysData)
+{
+    return mxf_file_tell(sysData->target);
+}
+
+static int shaped_file_is_seekable(MXFFileSysData *sysData)
+{
+    return mxf_file_is_seekable(sysData->target);
+}
+
+static int64_t shaped_file_size(MXFFileSysData *sysData)
+{
+    delay_call(sysData);
+    return mxf_file_size(sysData->target);
+}
+
+static void free_shaped_file(MXFFileSysData *sysData)
+{
+    free(sysData);
+}
+
+
+
+int mxf_shaped_file_open(MXFFile *target, const MXFShapedFileParams *params, MXFShapedFile **shapedFile)
+{
+    MXFFile *newMXFFile = NULL;
+    MXFFileSysData *newShapedFile = NULL;
+
+    CHK_MALLOC_ORET(newMXFFile, MXFFile);
+    memset(newMXFFile, 0, sizeof(MXFFile));
+    CHK_MALLOC_OFAIL(newShapedFile, MXFFileSysData);
+    memset(newShapedFile, 0, sizeof(MXFFileSysData));
+
+    newShapedFile->target = target;
+    newShapedFile->params = *params;
+    newShapedFile->shapedFile.mxfFile = newMXFFile;
+
+    /* the optional functions are not set so that all I/O goes through the shaped read and write */
+    newMXFFile->close         = shaped_file_close;
+    newMXFFile->read          = shaped_file_read;
+    newMXFFile->write         = shaped_file_write;
+    newMXFFile->get_char      = shaped_file_getchar;
+    newMXFFile->put_char      = shaped_file_putchar;
+    newMXFFile->eof           = shaped_file_eof;
+    newMXFFile->seek          = shaped_file_seek;
+    newMXFFile->tell          = shaped_file_tell;
+    newMXFFile->is_seekable   = shaped_file_is_seekable;
+    newMXFFile->size          = shaped_file_size;
+    newMXFFile->free_sys_data = free_shaped_file;
+    newMXFFile->sysData       = newShapedFile;
+    newMXFFile->minLLen       = target->minLLen;
+    newMXFFile->runinLen      = target->runinLen;
+
+
+    *shapedFile = &newShapedFile->shapedFile;
+    return 1;
+
+fail:
+    SAFE_FREE(newMXFFile);
+    SAFE_FREE(newShapedFile);
+    return 0;
+}
+
+MXFFile* mxf_shaped_file_get_file(MXFShapedFile *shapedFile)
+{
+    return shapedFile->mxfFile;
+}
+
+void mxf_shaped_file_set_params(MXFShapedFile *shapedFile, const MXFShapedFileParams *params)
+{
+    shapedFile->mxfFile->sysData->params = *params;
+    shapedFile->mxfFile->sysData->ioCount = 0;
+}
+
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2012, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MXF_SHAPED_FILE_H__
+#define __MXF_SHAPED_FILE_H__
+
+
+#include <mxf/mxf_file.h>
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/*
+ * Test file that passes calls on to the target file and shapes them to simulate slow storage.
+ * Each read, write, seek and size call is delayed by latencyUs, and reads and writes are further
+ * delayed to limit the throughput to bytesPerSec. If shortIOInterval is > 0 then every
+ * shortIOInterval'th read or write call transfers only half of the requested bytes.
+ * A value of 0 disables each of the shaping features.
+ * The target is closed when the shaped file is closed.
+ */
+
+
+typedef struct
+{
+    uint32_t latencyUs;
+    uint64_t bytesPerSec;
+    uint32_t shortIOInterval;
+} MXFShapedFileParams;
+
+typedef struct MXFShapedFile MXFShapedFile;
+
+
+int mxf_shaped_file_open(MXFFile *target, const MXFShapedFileParams *params, MXFShapedFile **shapedFile);
+
+MXFFile* mxf_shaped_file_get_file(MXFShapedFile *shapedFile);
+
+void mxf_shaped_file_set_params(MXFShapedFile *shapedFile, const MXFShapedFileParams *params);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
+
@@ -40,6 +40,7 @@
 
 #include <mxf/mxf.h>
 #include <mxf/mxf_macros.h>
+#include <mxf/mxf_memory_file.h>
 
 static const mxfKey someKey =
     {0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02};
@@ -57,9 +58,8 @@ static uint8_t data[256];
 
 
 
-int test_read(const char *filename)
+int do_read(MXFFile *mxfFile)
 {
-    MXFFile *mxfFile = NULL;
     mxfKey key;
     uint8_t llen;
     uint64_t len;
@@ -79,6 +79,77 @@ int test_read(const char *filename)
     uint32_t ablen;
     uint32_t abelen;
 
+    CHK_ORET(mxf_file_read(mxfFile, indata, 100) == 100);
+    CHK_ORET(memcmp(data, indata, 100) == 0);
+    CHK_ORET(mxf_file_getc(mxfFile) == 0xff);
+    CHK_ORET(mxf_file_getc(mxfFile) == 0xff);
+    CHK_ORET(mxf_read_uint8(mxfFile, &valueu8));
+    CHK_ORET(valueu8 == 0x0f);
+    CHK_ORET(mxf_read_uint16(mxfFile, &valueu16));
+    CHK_ORET(valueu16 == 0x0f00);
+    CHK_ORET(mxf_read_uint32(mxfFile, &valueu32));
+    CHK_ORET(valueu32 == 0x0f000000);
+    CHK_ORET(mxf_read_uint64(mxfFile, &valueu64));
+    CHK_ORET(valueu64 == 0x0f00000000000000LL);
+    CHK_ORET(mxf_read_int8(mxfFile, &value8));
+    CHK_ORET(value8 == -0x0f);
+    CHK_ORET(mxf_read_int16(mxfFile, &value16));
+    CHK_ORET(value16 == -0x0f00);
+    CHK_ORET(mxf_read_int32(mxfFile, &value32));
+    CHK_ORET(value32 == -0x0f000000);
+    CHK_ORET(mxf_read_int64(mxfFile, &value64));
+    CHK_ORET(value64 == -0x0f00000000000000LL);
+    CHK_ORET(mxf_read_local_tag(mxfFile, &tag));
+    CHK_ORET(tag == 0xffaa);
+    CHK_ORET(mxf_read_k(mxfFile, &key));
+    CHK_ORET(mxf_equals_key(&key, &someKey));
+    CHK_ORET(mxf_read_l(mxfFile, &llen, &len));
+    CHK_ORET(llen == 1 && len == 0x01);
+    CHK_ORET(mxf_read_l(mxfFile, &llen, &len));
+    CHK_ORET(llen == 2 && len == 0x80);
+    CHK_ORET(mxf_read_l(mxfFile, &llen, &len));
+    CHK_ORET(llen == 3 && len == 0x8000);
+    CHK_ORET(mxf_read_l(mxfFile, &llen, &len));
+    CHK_ORET(llen == 4 && len == 0x800000);
+    CHK_ORET(mxf_read_l(mxfFile, &llen, &len));
+    CHK_ORET(llen == 5 && len == 0x80000000);
+    CHK_ORET(mxf_read_l(mxfFile, &llen, &len));
+    CHK_ORET(llen == 6 && len == 0x8000000000LL);
+    CHK_ORET(mxf_read_l(mxfFile, &llen, &len));
+    CHK_ORET(llen == 7 && len == 0x800000000000LL);
+    CHK_ORET(mxf_read_l(mxfFile, &llen, &len));
+    CHK_ORET(llen == 8 && len == 0x80000000000000LL);
+    CHK_ORET(mxf_read_l(mxfFile, &llen, &len));
+    CHK_ORET(llen == 9 && len == 0x8000000000000000LL);
+    CHK_ORET(mxf_read_kl(mxfFile, &key, &llen, &len));
+    CHK_ORET(mxf_equals_key(&key, &someKey));
+    CHK_ORET(llen == 3 && len == 0xf100);
+    CHK_ORET(mxf_read_l(mxfFile, &llen, &len));
+    CHK_ORET(llen == 8 && len == 0x10);
+    CHK_ORET(mxf_read_l(mxfFile, &llen, &len));
+    CHK_ORET(llen == 4 && len == 0x10);
+    CHK_ORET(mxf_read_kl(mxfFile, &key, &llen, &len));
+    CHK_ORET(mxf_equals_key(&key, &someKey));
+    CHK_ORET(llen == 8 && len == 0x1000);
+    CHK_ORET(mxf_read_ul(mxfFile, &ul));
+    CHK_ORET(mxf_equals_ul(&ul, &someUL));
+    CHK_ORET(mxf_read_uid(mxfFile, &uid));
+    CHK_ORET(mxf_equals_uid(&uid, &someUID));
+    CHK_ORET(mxf_read_uuid(mxfFile, &uuid));
+    CHK_ORET(mxf_equals_uuid(&uuid, &someUUID));
+    CHK_ORET(mxf_read_batch_header(mxfFile, &ablen, &abelen));
+    CHK_ORET(ablen == 2 && abelen == 16);
+    CHK_ORET(mxf_read_array_header(mxfFile, &ablen, &abelen));
+    CHK_ORET(ablen == 4 && abelen == 32);
+
+
+    return 1;
+}
+
+int test_read(const char *filename)
+{
+    MXFFile *mxfFile = NULL;
+
     if (!mxf_disk_file_open_read(filename, &mxfFile))
     {
         mxf_log_error("Failed to open '%s'" LOG_LOC_FORMAT, filename, LOG_LOC_PARAMS);
@@ -86,78 +157,98 @@ int test_read(const char *filename)
     }
 
     /* TEST */
-    CHK_OFAIL(mxf_file_read(mxfFile, indata, 100) == 100);
-    CHK_OFAIL(memcmp(data, indata, 100) == 0);
+    CHK_OFAIL(do_read(mxfFile));
+
+    mxf_file_close(&mxfFile);
+    return 1;
+
+fail:
+    mxf_file_close(&mxfFile);
+    return 0;
+}
+
+int test_read_ahead(const char *filename, uint32_t bufferSize)
+{
+    MXFFile *mxfFile = NULL;
+    const uint8_t *peekData;
+    int64_t size;
+
+    if (!mxf_disk_file_open_read(filename, &mxfFile))
+    {
+        mxf_log_error("Failed to open '%s'" LOG_LOC_FORMAT, filename, LOG_LOC_PARAMS);
+        return 0;
+    }
+
+    /* TEST */
+    CHK_OFAIL(mxf_file_set_read_ahead(mxfFile, bufferSize));
+    CHK_OFAIL(do_read(mxfFile));
+
+    size = mxf_file_size(mxfFile);
+    CHK_OFAIL(mxf_file_tell(mxfFile) == size);
+    CHK_OFAIL(!mxf_file_eof(mxfFile));
+    CHK_OFAIL(mxf_file_getc(mxfFile) == EOF);
+    CHK_OFAIL(mxf_file_eof(mxfFile));
+    CHK_OFAIL(mxf_file_seek(mxfFile, 10, SEEK_SET));
+    CHK_OFAIL(mxf_file_peek(mxfFile, &peekData, 4) == 4);
+    CHK_OFAIL(peekData[0] == 0xaa);
+    CHK_OFAIL(mxf_file_tell(mxfFile) == 10);
+    mxf_file_consume(mxfFile, 2);
+    CHK_OFAIL(mxf_file_tell(mxfFile) == 12);
+    CHK_OFAIL(mxf_file_seek(mxfFile, 100 - 12, SEEK_CUR));
     CHK_OFAIL(mxf_file_getc(mxfFile) == 0xff);
+    CHK_OFAIL(mxf_file_seek(mxfFile, -1, SEEK_CUR));
     CHK_OFAIL(mxf_file_getc(mxfFile) == 0xff);
-    CHK_OFAIL(mxf_read_uint8(mxfFile, &valueu8));
-    CHK_OFAIL(valueu8 == 0x0f);
-    CHK_OFAIL(mxf_read_uint16(mxfFile, &valueu16));
-    CHK_OFAIL(valueu16 == 0x0f00);
-    CHK_OFAIL(mxf_read_uint32(mxfFile, &valueu32));
-    CHK_OFAIL(valueu32 == 0x0f000000);
-    CHK_OFAIL(mxf_read_uint64(mxfFile, &valueu64));
-    CHK_OFAIL(valueu64 == 0x0f00000000000000LL);
-    CHK_OFAIL(mxf_read_int8(mxfFile, &value8));
-    CHK_OFAIL(value8 == -0x0f);
-    CHK_OFAIL(mxf_read_int16(mxfFile, &value16));
-    CHK_OFAIL(value16 == -0x0f00);
-    CHK_OFAIL(mxf_read_int32(mxfFile, &value32));
-    CHK_OFAIL(value32 == -0x0f000000);
-    CHK_OFAIL(mxf_read_int64(mxfFile, &value64));
-    CHK_OFAIL(value64 == -0x0f00000000000000LL);
-    CHK_OFAIL(mxf_read_local_tag(mxfFile, &tag));
-    CHK_OFAIL(tag == 0xffaa);
-    CHK_OFAIL(mxf_read_k(mxfFile, &key));
-    CHK_OFAIL(mxf_equals_key(&key, &someKey));
-    CHK_OFAIL(mxf_read_l(mxfFile, &llen, &len));
-    CHK_OFAIL(llen == 1 && len == 0x01);
-    CHK_OFAIL(mxf_read_l(mxfFile, &llen, &len));
-    CHK_OFAIL(llen == 2 && len == 0x80);
-    CHK_OFAIL(mxf_read_l(mxfFile, &llen, &len));
-    CHK_OFAIL(llen == 3 && len == 0x8000);
-    CHK_OFAIL(mxf_read_l(mxfFile, &llen, &len));
-    CHK_OFAIL(llen == 4 && len == 0x800000);
-    CHK_OFAIL(mxf_read_l(mxfFile, &llen, &len));
-    CHK_OFAIL(llen == 5 && len == 0x80000000);
-    CHK_OFAIL(mxf_read_l(mxfFile, &llen, &len));
-    CHK_OFAIL(llen == 6 && len == 0x8000000000LL);
-    CHK_OFAIL(mxf_read_l(mxfFile, &llen, &len));
-    CHK_OFAIL(llen == 7 && len == 0x800000000000LL);
-    CHK_OFAIL(mxf_read_l(mxfFile, &llen, &len));
-    CHK_OFAIL(llen == 8 && len == 0x80000000000000LL);
-    CHK_OFAIL(mxf_read_l(mxfFile, &llen, &len));
-    CHK_OFAIL(llen == 9 && len == 0x8000000000000000LL);
-    CHK_OFAIL(mxf_read_kl(mxfFile, &key, &llen, &len));
-    CHK_OFAIL(mxf_equals_key(&key, &someKey));
-    CHK_OFAIL(llen == 3 && len == 0xf100);
-    CHK_OFAIL(mxf_read_l(mxfFile, &llen, &len));
-    CHK_OFAIL(llen == 8 && len == 0x10);
-    CHK_OFAIL(mxf_read_l(mxfFile, &llen, &len));
-    CHK_OFAIL(llen == 4 && len == 0x10);
-    CHK_OFAIL(mxf_read_kl(mxfFile, &key, &llen, &len));
-    CHK_OFAIL(mxf_equals_key(&key, &someKey));
-    CHK_OFAIL(llen == 8 && len == 0x1000);
-    CHK_OFAIL(mxf_read_ul(mxfFile, &ul));
-    CHK_OFAIL(mxf_equals_ul(&ul, &someUL));
-    CHK_OFAIL(mxf_read_uid(mxfFile, &uid));
-    CHK_OFAIL(mxf_equals_uid(&uid, &someUID));
-    CHK_OFAIL(mxf_read_uuid(mxfFile, &uuid));
-    CHK_OFAIL(mxf_equals_uuid(&uuid, &someUUID));
-    CHK_OFAIL(mxf_read_batch_header(mxfFile, &ablen, &abelen));
-    CHK_OFAIL(ablen == 2 && abelen == 16);
-    CHK_OFAIL(mxf_read_array_header(mxfFile, &ablen, &abelen));
-    CHK_OFAIL(ablen == 4 && abelen == 32);
+    CHK_OFAIL(mxf_file_seek(mxfFile, 0, SEEK_SET));
+    CHK_OFAIL(mxf_file_set_read_ahead(mxfFile, 0));
+    CHK_OFAIL(do_read(mxfFile));
 
+    mxf_file_close(&mxfFile);
+    return 1;
 
+fail:
     mxf_file_close(&mxfFile);
+    return 0;
+}
+
+int test_mmap_read(const char *filename)
+{
+#if defined(_WIN32)
+    (void)filename;
+    return 1;
+#else
+    MXFFile *mxfFile = NULL;
+    const uint8_t *view;
+    int64_t size;
+
+    if (!mxf_mmap_file_open_read(filename, &mxfFile))
+    {
+        mxf_log_error("Failed to memory map '%s'" LOG_LOC_FORMAT, filename, LOG_LOC_PARAMS);
+        return 0;
+    }
 
+    /* TEST */
+    CHK_OFAIL(do_read(mxfFile));
+
+    size = mxf_file_size(mxfFile);
+    CHK_OFAIL(mxf_file_can_read_view(mxfFile));
+    CHK_OFAIL(mxf_file_seek(mxfFile, 0, SEEK_SET));
+    CHK_OFAIL(mxf_file_read_view(mxfFile, &view, 100) == 100);
+    CHK_OFAIL(memcmp(data, view, 100) == 0);
+    CHK_OFAIL(mxf_file_tell(mxfFile) == 100);
+    CHK_OFAIL(mxf_file_getc(mxfFile) == 0xff);
+    CHK_OFAIL(mxf_file_seek(mxfFile, -1, SEEK_END));
+    CHK_OFAIL(mxf_file_read_view(mxfFile, &view, 100) == 1);
+    CHK_OFAIL(mxf_file_eof(mxfFile));
+    CHK_OFAIL(mxf_file_tell(mxfFile) == size);
+    CHK_OFAIL(mxf_file_write(mxfFile, data, 1) == 0);
 
+    mxf_file_close(&mxfFile);
     return 1;
 
 fail:
     mxf_file_close(&mxfFile);
     return 0;
+#endif
 }
 
 int do_write(MXFFile *mxfFile)
@@ -250,6 +341,421 @@ fail:
 }
 
 
+int test_writev(const char *filename)
+{
+    MXFFile *mxfFile = NULL;
+    MXFIOVec iov[3];
+    uint8_t kl[mxfKey_extlen + 4];
+    uint8_t indata[256];
+    uint8_t payload[200];
+    uint32_t i;
+
+    for (i = 0; i < sizeof(payload); i++)
+        payload[i] = (uint8_t)i;
+
+    if (!mxf_disk_file_open_new(filename, &mxfFile))
+    {
+        mxf_log_error("Failed to create '%s'" LOG_LOC_FORMAT, filename, LOG_LOC_PARAMS);
+        return 0;
+    }
+
+    /* TEST */
+    CHK_OFAIL(mxf_encode_fixed_kl(&someKey, 4, sizeof(payload), kl));
+    CHK_OFAIL(!mxf_encode_fixed_l(1, 0x80, kl));
+    iov[0].data = kl;
+    iov[0].size = sizeof(kl);
+    iov[1].data = payload;
+    iov[1].size = 100;
+    iov[2].data = &payload[100];
+    iov[2].size = 100;
+
+    /* the byte buffered by stdio must be written before the gathered buffers */
+    CHK_OFAIL(mxf_file_putc(mxfFile, 0x55) == 0x55);
+    CHK_OFAIL(mxf_file_writev(mxfFile, iov, 3) == sizeof(kl) + sizeof(payload));
+    CHK_OFAIL(mxf_file_tell(mxfFile) == 1 + sizeof(kl) + sizeof(payload));
+    CHK_OFAIL(mxf_file_putc(mxfFile, 0x66) == 0x66);
+    CHK_OFAIL(mxf_file_size(mxfFile) == 2 + sizeof(kl) + sizeof(payload));
+
+    CHK_OFAIL(mxf_file_seek(mxfFile, 0, SEEK_SET));
+    CHK_OFAIL(mxf_file_getc(mxfFile) == 0x55);
+    CHK_OFAIL(mxf_file_read(mxfFile, indata, sizeof(kl)) == sizeof(kl));
+    CHK_OFAIL(memcmp(indata, &someKey, mxfKey_extlen) == 0);
+    CHK_OFAIL(indata[mxfKey_extlen] == 0x83 && indata[mxfKey_extlen + 3] == sizeof(payload));
+    CHK_OFAIL(mxf_file_read(mxfFile, indata, sizeof(payload)) == sizeof(payload));
+    CHK_OFAIL(memcmp(indata, payload, sizeof(payload)) == 0);
+    CHK_OFAIL(mxf_file_getc(mxfFile) == 0x66);
+
+    mxf_file_close(&mxfFile);
+    return 1;
+
+fail:
+    mxf_file_close(&mxfFile);
+    return 0;
+}
+
+int test_advise(const char *filename)
+{
+    MXFFile *mxfFile = NULL;
+
+    if (!mxf_disk_file_open_read(filename, &mxfFile))
+    {
+        mxf_log_error("Failed to open '%s'" LOG_LOC_FORMAT, filename, LOG_LOC_PARAMS);
+        return 0;
+    }
+
+    /* TEST */
+    CHK_OFAIL(mxf_file_advise(mxfFile, 0, 0, MXF_ADVISE_SEQUENTIAL));
+    CHK_OFAIL(mxf_file_advise(mxfFile, 0, 0, MXF_ADVISE_RANDOM));
+    CHK_OFAIL(mxf_file_advise(mxfFile, 10, 100, MXF_ADVISE_WILLNEED));
+    CHK_OFAIL(mxf_file_tell(mxfFile) == 0);
+    CHK_OFAIL(do_read(mxfFile));
+    CHK_OFAIL(mxf_file_advise(mxfFile, 0, 0, MXF_ADVISE_DONTNEED));
+    mxf_file_close(&mxfFile);
+
+#if !defined(_WIN32)
+    CHK_OFAIL(mxf_mmap_file_open_read(filename, &mxfFile));
+    CHK_OFAIL(mxf_file_advise(mxfFile, 0, 0, MXF_ADVISE_SEQUENTIAL));
+    CHK_OFAIL(mxf_file_advise(mxfFile, 10, 100, MXF_ADVISE_WILLNEED));
+    CHK_OFAIL(do_read(mxfFile));
+    CHK_OFAIL(mxf_file_advise(mxfFile, 0, 0, MXF_ADVISE_NORMAL));
+    mxf_file_close(&mxfFile);
+#endif
+
+    return 1;
+
+fail:
+    mxf_file_close(&mxfFile);
+    return 0;
+}
+
+int test_read_write_64(const char *filename)
+{
+    MXFFile *mxfFile = NULL;
+    uint8_t data[1000];
+    uint8_t indata[1000];
+    uint32_t i;
+
+    for (i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)(i % 249);
+
+    if (!mxf_disk_file_open_new(filename, &mxfFile))
+    {
+        mxf_log_error("Failed to create '%s'" LOG_LOC_FORMAT, filename, LOG_LOC_PARAMS);
+        return 0;
+    }
+
+    /* TEST */
+    CHK_OFAIL(mxf_file_write_64(mxfFile, data, sizeof(data)) == sizeof(data));
+    CHK_OFAIL(mxf_file_seek(mxfFile, 0, SEEK_SET));
+    CHK_OFAIL(mxf_file_set_read_ahead(mxfFile, 256));
+    CHK_OFAIL(mxf_file_getc(mxfFile) == data[0]);
+    CHK_OFAIL(mxf_file_read_64(mxfFile, indata, sizeof(indata)) == sizeof(data) - 1);
+    CHK_OFAIL(memcmp(indata, &data[1], sizeof(data) - 1) == 0);
+    CHK_OFAIL(mxf_file_eof(mxfFile));
+
+    mxf_file_close(&mxfFile);
+    return 1;
+
+fail:
+    mxf_file_close(&mxfFile);
+    return 0;
+}
+
+int test_arrays(const char *filename)
+{
+    MXFFile *mxfFile = NULL;
+    uint16_t values16[37];
+    uint32_t values32[1100];
+    uint64_t values64[23];
+    uint16_t invalues16[37];
+    uint32_t invalues32[1100];
+    uint64_t invalues64[23];
+    uint32_t valueu32;
+    uint8_t bytes[8];
+    uint32_t i;
+
+    for (i = 0; i < 37; i++)
+        values16[i] = (uint16_t)(0x0102 * (i + 1));
+    for (i = 0; i < 1100; i++)
+        values32[i] = 0x01020304 * (i + 1);
+    for (i = 0; i < 23; i++)
+        values64[i] = 0x0102030405060708LL * (i + 1);
+
+    if (!mxf_disk_file_open_new(filename, &mxfFile))
+    {
+        mxf_log_error("Failed to create '%s'" LOG_LOC_FORMAT, filename, LOG_LOC_PARAMS);
+        return 0;
+    }
+
+    /* TEST */
+    CHK_OFAIL(mxf_write_uint16_array(mxfFile, values16, 37));
+    CHK_OFAIL(mxf_write_uint32_array(mxfFile, values32, 1100)); /* exceeds the write buffer */
+    CHK_OFAIL(mxf_write_uint64_array(mxfFile, values64, 23));
+    CHK_OFAIL(mxf_write_uint32_array(mxfFile, NULL, 0));
+    CHK_OFAIL(mxf_file_tell(mxfFile) == 37 * 2 + 1100 * 4 + 23 * 8);
+
+    CHK_OFAIL(mxf_file_seek(mxfFile, 0, SEEK_SET));
+    CHK_OFAIL(mxf_read_uint16_array(mxfFile, invalues16, 37));
+    CHK_OFAIL(memcmp(values16, invalues16, sizeof(values16)) == 0);
+    CHK_OFAIL(mxf_read_uint32_array(mxfFile, invalues32, 1100));
+    CHK_OFAIL(memcmp(values32, invalues32, sizeof(values32)) == 0);
+    CHK_OFAIL(mxf_read_uint64_array(mxfFile, invalues64, 23));
+    CHK_OFAIL(memcmp(values64, invalues64, sizeof(values64)) == 0);
+    CHK_OFAIL(!mxf_read_uint64_array(mxfFile, invalues64, 1));
+
+    /* check the byte order matches the single value functions */
+    CHK_OFAIL(mxf_file_seek(mxfFile, 37 * 2 + 5 * 4, SEEK_SET));
+    CHK_OFAIL(mxf_read_uint32(mxfFile, &valueu32));
+    CHK_OFAIL(valueu32 == values32[5]);
+    CHK_OFAIL(mxf_file_seek(mxfFile, 37 * 2 + 1100 * 4, SEEK_SET));
+    CHK_OFAIL(mxf_file_read(mxfFile, bytes, 8) == 8);
+    for (i = 0; i < 8; i++)
+        CHK_OFAIL(bytes[i] == i + 1);
+
+    mxf_file_close(&mxfFile);
+    return 1;
+
+fail:
+    mxf_file_close(&mxfFile);
+    return 0;
+}
+
+int test_dup(const char *filename)
+{
+#if defined(_WIN32)
+    (void)filename;
+    return 1;
+#else
+    MXFFile *mxfFile = NULL;
+    MXFFile *dupFile = NULL;
+    MXFFile *dupFile2 = NULL;
+    uint8_t data[1000];
+    uint8_t indata[1000];
+    uint32_t i;
+
+    for (i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)(i % 251);
+
+    if (!mxf_disk_file_open_new(filename, &mxfFile))
+    {
+        mxf_log_error("Failed to create '%s'" LOG_LOC_FORMAT, filename, LOG_LOC_PARAMS);
+        return 0;
+    }
+
+    /* TEST */
+    CHK_OFAIL(mxf_file_write(mxfFile, data, sizeof(data)) == sizeof(data));
+    CHK_OFAIL(mxf_file_seek(mxfFile, 100, SEEK_SET));
+    CHK_OFAIL(mxf_file_set_read_ahead(mxfFile, 256));
+    CHK_OFAIL(mxf_file_getc(mxfFile) == data[100]);
+
+    /* the duplicate starts at the logical position and sees the unflushed written data */
+    CHK_OFAIL(mxf_file_dup(mxfFile, &dupFile));
+    CHK_OFAIL(mxf_file_tell(dupFile) == 101);
+    CHK_OFAIL(mxf_file_size(dupFile) == sizeof(data));
+    CHK_OFAIL(mxf_file_read(dupFile, indata, 200) == 200);
+    CHK_OFAIL(memcmp(indata, &data[101], 200) == 0);
+    CHK_OFAIL(mxf_file_tell(mxfFile) == 101);
+    CHK_OFAIL(mxf_file_getc(mxfFile) == data[101]);
+
+    /* positional writes and reads are independent of the original's position */
+    CHK_OFAIL(mxf_file_dup(dupFile, &dupFile2));
+    CHK_OFAIL(mxf_file_tell(dupFile2) == 301);
+    CHK_OFAIL(mxf_file_seek(dupFile2, 0, SEEK_END));
+    CHK_OFAIL(mxf_file_write(dupFile2, data, 10) == 10);
+    CHK_OFAIL(mxf_file_seek(dupFile, -10, SEEK_END));
+    CHK_OFAIL(mxf_file_read(dupFile, indata, 20) == 10);
+    CHK_OFAIL(memcmp(indata, data, 10) == 0);
+    CHK_OFAIL(mxf_file_eof(dupFile));
+    CHK_OFAIL(mxf_file_getc(dupFile) == EOF);
+    CHK_OFAIL(mxf_file_tell(mxfFile) == 102);
+    CHK_OFAIL(mxf_file_size(mxfFile) == sizeof(data) + 10);
+
+    mxf_file_close(&dupFile2);
+    mxf_file_close(&dupFile);
+    mxf_file_close(&mxfFile);
+    return 1;
+
+fail:
+    mxf_file_close(&dupFile2);
+    mxf_file_close(&dupFile);
+    mxf_file_close(&mxfFile);
+    return 0;
+#endif
+}
+
+int test_preallocate(const char *filename)
+{
+    MXFFile *mxfFile = NULL;
+
+    if (!mxf_disk_file_open_new(filename, &mxfFile))
+    {
+        mxf_log_error("Failed to create '%s'" LOG_LOC_FORMAT, filename, LOG_LOC_PARAMS);
+        return 0;
+    }
+
+    /* TEST */
+    CHK_OFAIL(mxf_file_preallocate(mxfFile, 0, 1024 * 1024));
+    CHK_OFAIL(mxf_file_size(mxfFile) == 0);
+    CHK_OFAIL(do_write(mxfFile));
+    CHK_OFAIL(mxf_file_seek(mxfFile, 0, SEEK_END));
+    CHK_OFAIL(mxf_file_tell(mxfFile) < 1024 * 1024);
+    mxf_file_close(&mxfFile);
+
+    CHK_OFAIL(test_read(filename));
+
+    return 1;
+
+fail:
+    mxf_file_close(&mxfFile);
+    return 0;
+}
+
+int test_copy_range(const char *filename)
+{
+    MXFFile *srcFile = NULL;
+    MXFFile *dstFile = NULL;
+    MXFMemoryFile *memFile = NULL;
+    char copyFilename[1024];
+    uint8_t data[1000];
+    uint8_t indata[1000];
+    uint32_t i;
+
+    for (i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)(i % 251);
+    mxf_snprintf(copyFilename, sizeof(copyFilename), "%s.copy", filename);
+
+    if (!mxf_disk_file_open_new(filename, &srcFile))
+    {
+        mxf_log_error("Failed to create '%s'" LOG_LOC_FORMAT, filename, LOG_LOC_PARAMS);
+        return 0;
+    }
+    if (!mxf_disk_file_open_new(copyFilename, &dstFile))
+    {
+        mxf_log_error("Failed to create '%s'" LOG_LOC_FORMAT, copyFilename, LOG_LOC_PARAMS);
+        goto fail;
+    }
+
+    /* TEST */
+
+    /* disk to disk, with data still buffered by stdio at both ends */
+    CHK_OFAIL(mxf_file_write(srcFile, data, sizeof(data)) == sizeof(data));
+    CHK_OFAIL(mxf_file_seek(srcFile, 100, SEEK_SET));
+    CHK_OFAIL(mxf_file_putc(dstFile, 0x55) == 0x55);
+    CHK_OFAIL(mxf_file_copy_range(srcFile, dstFile, 500) == 500);
+    CHK_OFAIL(mxf_file_tell(srcFile) == 600);
+    CHK_OFAIL(mxf_file_tell(dstFile) == 501);
+    CHK_OFAIL(mxf_file_putc(dstFile, 0x66) == 0x66);
+
+    /* copy stops at the end of the source */
+    CHK_OFAIL(mxf_file_copy_range(srcFile, dstFile, 1000) == 400);
+    CHK_OFAIL(mxf_file_tell(dstFile) == 902);
+    mxf_file_close(&srcFile);
+
+    /* memory file to disk */
+    CHK_OFAIL(mxf_mem_file_open_read(data, sizeof(data), 0, &memFile));
+    srcFile = mxf_mem_file_get_file(memFile);
+    CHK_OFAIL(mxf_file_seek(srcFile, 10, SEEK_SET));
+    CHK_OFAIL(mxf_file_copy_range(srcFile, dstFile, 90) == 90);
+    mxf_file_close(&srcFile);
+    mxf_file_close(&dstFile);
+
+    CHK_OFAIL(mxf_disk_file_open_read(copyFilename, &dstFile));
+    CHK_OFAIL(mxf_file_size(dstFile) == 992);
+    CHK_OFAIL(mxf_file_getc(dstFile) == 0x55);
+    CHK_OFAIL(mxf_file_read(dstFile, indata, 500) == 500);
+    CHK_OFAIL(memcmp(indata, &data[100], 500) == 0);
+    CHK_OFAIL(mxf_file_getc(dstFile) == 0x66);
+    CHK_OFAIL(mxf_file_read(dstFile, indata, 400) == 400);
+    CHK_OFAIL(memcmp(indata, &data[600], 400) == 0);
+    CHK_OFAIL(mxf_file_read(dstFile, indata, 90) == 90);
+    CHK_OFAIL(memcmp(indata, &data[10], 90) == 0);
+    mxf_file_close(&dstFile);
+
+    remove(copyFilename);
+    return 1;
+
+fail:
+    mxf_file_close(&srcFile);
+    mxf_file_close(&dstFile);
+    remove(copyFilename);
+    return 0;
+}
+
+int test_direct(const char *filename)
+{
+#if defined(_WIN32)
+    (void)filename;
+    return 1;
+#else
+    MXFFile *mxfFile = NULL;
+    uint8_t *bigData = NULL;
+    uint8_t *bigInData = NULL;
+    uint32_t bigSize;
+    int64_t startPos;
+    uint32_t i;
+
+    /* the buffer size is rounded up to the system page size */
+    if (!mxf_disk_file_open_new_direct(filename, 1, &mxfFile))
+    {
+        mxf_log_error("Failed to create direct '%s'" LOG_LOC_FORMAT, filename, LOG_LOC_PARAMS);
+        return 0;
+    }
+
+    /* TEST */
+    CHK_OFAIL(do_write(mxfFile));
+    startPos = mxf_file_tell(mxfFile);
+    CHK_OFAIL(mxf_file_size(mxfFile) == startPos);
+
+    bigSize = mxf_get_system_page_size() * 3 + 5;
+    CHK_MALLOC_ARRAY_OFAIL(bigData, uint8_t, bigSize);
+    CHK_MALLOC_ARRAY_OFAIL(bigInData, uint8_t, bigSize);
+    for (i = 0; i < bigSize; i++)
+        bigData[i] = (uint8_t)(i % 253);
+    CHK_OFAIL(mxf_file_write(mxfFile, bigData, bigSize) == bigSize);
+    CHK_OFAIL(mxf_file_seek(mxfFile, startPos + 1000, SEEK_SET));
+    CHK_OFAIL(mxf_file_write(mxfFile, &bigData[1000], 200) == 200);
+    CHK_OFAIL(mxf_file_size(mxfFile) == startPos + bigSize);
+
+    CHK_OFAIL(mxf_file_seek(mxfFile, startPos, SEEK_SET));
+    CHK_OFAIL(mxf_file_read(mxfFile, bigInData, bigSize) == bigSize);
+    CHK_OFAIL(memcmp(bigData, bigInData, bigSize) == 0);
+    CHK_OFAIL(mxf_file_getc(mxfFile) == EOF);
+    CHK_OFAIL(mxf_file_eof(mxfFile));
+    CHK_OFAIL(mxf_file_seek(mxfFile, 0, SEEK_SET));
+    CHK_OFAIL(do_read(mxfFile));
+    mxf_file_close(&mxfFile);
+
+    /* the end of file padding is removed on close */
+    CHK_OFAIL(mxf_disk_file_open_read(filename, &mxfFile));
+    CHK_OFAIL(mxf_file_size(mxfFile) == startPos + bigSize);
+    CHK_OFAIL(mxf_file_seek(mxfFile, startPos, SEEK_SET));
+    CHK_OFAIL(mxf_file_read(mxfFile, bigInData, bigSize) == bigSize);
+    CHK_OFAIL(memcmp(bigData, bigInData, bigSize) == 0);
+    mxf_file_close(&mxfFile);
+
+    CHK_OFAIL(mxf_disk_file_open_modify_direct(filename, 0, &mxfFile));
+    CHK_OFAIL(mxf_file_size(mxfFile) == startPos + bigSize);
+    CHK_OFAIL(do_write(mxfFile));
+    mxf_file_close(&mxfFile);
+
+    CHK_OFAIL(mxf_disk_file_open_read(filename, &mxfFile));
+    CHK_OFAIL(do_read(mxfFile));
+    CHK_OFAIL(mxf_file_size(mxfFile) == startPos + bigSize);
+    mxf_file_close(&mxfFile);
+
+    free(bigData);
+    free(bigInData);
+    return 1;
+
+fail:
+    mxf_file_close(&mxfFile);
+    free(bigData);
+    free(bigInData);
+    return 0;
+#endif
+}
+
+
 void usage(const char *cmd)
 {
     fprintf(stderr, "Usage: %s filename\n", cmd);
@@ -273,11 +779,62 @@ int main(int argc, const char *argv[])
         return 1;
     }
 
+    if (!test_read_ahead(argv[1], 32) ||
+        !test_read_ahead(argv[1], 4096))
+    {
+        return 1;
+    }
+
+    if (!test_mmap_read(argv[1]))
+    {
+        return 1;
+    }
+
     if (!test_modify(argv[1]))
     {
         return 1;
     }
 
+    if (!test_advise(argv[1]))
+    {
+        return 1;
+    }
+
+    if (!test_writev(argv[1]))
+    {
+        return 1;
+    }
+
+    if (!test_read_write_64(argv[1]))
+    {
+        return 1;
+    }
+
+    if (!test_arrays(argv[1]))
+    {
+        return 1;
+    }
+
+    if (!test_dup(argv[1]))
+    {
+        return 1;
+    }
+
+    if (!test_preallocate(argv[1]))
+    {
+        return 1;
+    }
+
+    if (!test_copy_range(argv[1]))
+    {
+        return 1;
+    }
+
+    if (!test_direct(argv[1]))
+    {
+        return 1;
+    }
+
     return 0;
 }
 
@@ -39,6 +39,7 @@
 
 #include <mxf/mxf.h>
 #include <mxf/mxf_cache_file.h>
+#include <mxf/mxf_stats_file.h>
 
 
 #define DATA_SIZE   65536
@@ -60,32 +61,20 @@ static void usage(const char *cmd)
     fprintf(stderr, "Usage: %s filename\n", cmd);
 }
 
-int main(int argc, const char *argv[])
+static void test_cache_file(const char *filename, uint32_t numWays, unsigned char *writeData,
+                            unsigned char *readData)
 {
     MXFFile *target;
     MXFCacheFile *cacheFile;
     MXFFile *mxfFile;
-    unsigned char *writeData;
-    unsigned char *readData;
-
-    if (argc != 2)
-    {
-        usage(argv[0]);
-        return 1;
-    }
-
-    writeData = malloc(DATA_SIZE);
-    memset(writeData, 122, DATA_SIZE);
-    writeData[0] = 0x01;
-    writeData[DATA_SIZE / 2] = 0x02;
-    readData = malloc(DATA_SIZE);
-
 
-    CHECK(mxf_disk_file_open_new(argv[1], &target));
-    CHECK(mxf_cache_file_open(target, PAGE_SIZE, 4 * DATA_SIZE, &cacheFile));
+    CHECK(mxf_disk_file_open_new(filename, &target));
+    CHECK(mxf_cache_file_open_2(target, PAGE_SIZE, 4 * DATA_SIZE, numWays, &cacheFile));
     mxfFile = mxf_cache_file_get_file(cacheFile);
 
     CHECK(mxf_file_write(mxfFile, writeData, DATA_SIZE) == DATA_SIZE);
+    CHECK(mxf_file_seek(mxfFile, 0, SEEK_END));
+    CHECK(mxf_file_tell(mxfFile) == DATA_SIZE);
 
     CHECK(mxf_file_seek(mxfFile, 0, SEEK_SET));
     CHECK(mxf_file_size(mxfFile) == DATA_SIZE);
@@ -128,8 +117,180 @@ int main(int argc, const char *argv[])
     CHECK(mxf_file_write(mxfFile, &writeData[DATA_SIZE / 2], DATA_SIZE / 2) == DATA_SIZE / 2);
     CHECK(mxf_file_seek(mxfFile, 0, SEEK_SET));
     CHECK(mxf_file_getc(mxfFile) == 0x01);
+    CHECK(mxf_file_advise(mxfFile, 4 * DATA_SIZE, DATA_SIZE, MXF_ADVISE_WILLNEED));
+    CHECK(mxf_file_tell(mxfFile) == 1);
+    CHECK(mxf_file_getc(mxfFile) == 122);
+    CHECK(mxf_file_seek(mxfFile, 4 * DATA_SIZE, SEEK_SET));
+    CHECK(mxf_file_getc(mxfFile) == 0x02);
+    CHECK(mxf_file_advise(mxfFile, 0, 0, MXF_ADVISE_RANDOM));
+
+    mxf_file_close(&mxfFile);
+}
+
+static void test_alternating_reads(const char *filename, uint32_t numWays, uint64_t maxTargetReads)
+{
+    MXFFile *target;
+    MXFStatsFile *statsFile;
+    MXFCacheFile *cacheFile;
+    MXFFile *mxfFile;
+    MXFStatsCounters counters;
+    unsigned char data[16];
+    int i;
+
+    /* pages 0 and 8 map to the same slot in a direct-mapped cache with 8 pages */
+    CHECK(mxf_disk_file_open_read(filename, &target));
+    CHECK(mxf_stats_file_open(target, &statsFile));
+    CHECK(mxf_cache_file_open_2(mxf_stats_file_get_file(statsFile), PAGE_SIZE, 8 * PAGE_SIZE, numWays, &cacheFile));
+    mxfFile = mxf_cache_file_get_file(cacheFile);
+
+    for (i = 0; i < 10; i++) {
+        CHECK(mxf_file_seek(mxfFile, 100, SEEK_SET));
+        CHECK(mxf_file_read(mxfFile, data, sizeof(data)) == sizeof(data));
+        CHECK(mxf_file_seek(mxfFile, 8 * PAGE_SIZE + 100, SEEK_SET));
+        CHECK(mxf_file_read(mxfFile, data, sizeof(data)) == sizeof(data));
+    }
+
+    mxf_stats_file_get_counters(statsFile, MXF_STATS_READ, &counters);
+    CHECK(counters.count <= maxTargetReads);
 
     mxf_file_close(&mxfFile);
+}
+
+#if defined(HAVE_PTHREAD)
+static void test_flusher(const char *filename, uint32_t numWays, unsigned char *readData)
+{
+    MXFFile *target;
+    MXFCacheFile *cacheFile;
+    MXFFile *mxfFile;
+    unsigned char frameData[PAGE_SIZE + 1000];
+    int64_t position;
+    uint32_t i;
+
+    CHECK(mxf_disk_file_open_new(filename, &target));
+    CHECK(mxf_cache_file_open_2(target, PAGE_SIZE, 4 * DATA_SIZE, numWays, &cacheFile));
+    CHECK(mxf_cache_file_start_flusher(cacheFile, DATA_SIZE, DATA_SIZE / 4));
+    mxfFile = mxf_cache_file_get_file(cacheFile);
+
+    /* write frames that straddle pages and overwrite the start of the file at the end, similar to a header update */
+    for (i = 0; i < 200; i++) {
+        memset(frameData, (int)(i & 0xff), sizeof(frameData));
+        CHECK(mxf_file_write(mxfFile, frameData, sizeof(frameData)) == sizeof(frameData));
+    }
+    CHECK(mxf_file_seek(mxfFile, 0, SEEK_SET));
+    memset(frameData, 0xff, 100);
+    CHECK(mxf_file_write(mxfFile, frameData, 100) == 100);
+    CHECK(mxf_cache_file_stop_flusher(cacheFile));
+    mxf_file_close(&mxfFile);
+
+    CHECK(mxf_disk_file_open_read(filename, &mxfFile));
+    CHECK(mxf_file_size(mxfFile) == 200 * (int64_t)sizeof(frameData));
+    CHECK(mxf_file_read(mxfFile, readData, 100) == 100);
+    for (i = 0; i < 100; i++)
+        CHECK(readData[i] == 0xff);
+    for (i = 0; i < 200; i++) {
+        position = i * (int64_t)sizeof(frameData);
+        CHECK(mxf_file_seek(mxfFile, position + (i == 0 ? 100 : 0), SEEK_SET));
+        CHECK(mxf_file_read(mxfFile, readData, sizeof(frameData) - (i == 0 ? 100 : 0)) ==
+                  sizeof(frameData) - (i == 0 ? 100 : 0));
+        CHECK(readData[0] == (i & 0xff) && readData[sizeof(frameData) - 101] == (i & 0xff));
+    }
+    mxf_file_close(&mxfFile);
+}
+
+static void test_prefetcher(const char *filename, uint32_t numWays, unsigned char *readData)
+{
+    MXFFile *mxfFile;
+    MXFFile *target;
+    MXFCacheFile *cacheFile;
+    unsigned char data[1000];
+    int64_t fileSize;
+    int64_t position;
+    uint32_t numRead;
+    uint32_t i;
+
+    /* each byte value is derived from its position */
+    CHECK(mxf_disk_file_open_new(filename, &mxfFile));
+    for (i = 0; i < DATA_SIZE; i++)
+        readData[i] = (unsigned char)((i * 7) >> 3);
+    for (i = 0; i < 10; i++)
+        CHECK(mxf_file_write(mxfFile, readData, DATA_SIZE) == DATA_SIZE);
+    CHECK(mxf_file_write(mxfFile, readData, 100) == 100);
+    fileSize = mxf_file_tell(mxfFile);
+    mxf_file_close(&mxfFile);
+
+    CHECK(mxf_disk_file_open_modify(filename, &target));
+    CHECK(mxf_cache_file_open_2(target, PAGE_SIZE, 16 * PAGE_SIZE, numWays, &cacheFile));
+    CHECK(mxf_cache_file_start_prefetcher(cacheFile, 4 * PAGE_SIZE));
+    mxfFile = mxf_cache_file_get_file(cacheFile);
+
+    /* sequential reads with small skips, a jump back and an overwrite */
+    position = 0;
+    while (1) {
+        numRead = mxf_file_read(mxfFile, data, sizeof(data));
+        for (i = 0; i < numRead; i++)
+            CHECK(data[i] == (unsigned char)((((position + i) % DATA_SIZE) * 7) >> 3));
+        position += numRead;
+        if (numRead < sizeof(data))
+            break;
+        if (position % 7 == 0) {
+            CHECK(mxf_file_seek(mxfFile, 10, SEEK_CUR));
+            position += 10;
+        }
+        if (position > 3 * DATA_SIZE && position < 3 * DATA_SIZE + sizeof(data)) {
+            CHECK(mxf_file_seek(mxfFile, 100, SEEK_SET));
+            position = 100;
+            memset(data, 0, sizeof(data));
+            CHECK(mxf_file_write(mxfFile, data, sizeof(data)) == sizeof(data));
+            CHECK(mxf_file_read(mxfFile, data, sizeof(data)) == sizeof(data));
+            CHECK(mxf_file_seek(mxfFile, 4 * DATA_SIZE, SEEK_SET));
+            position = 4 * DATA_SIZE;
+        }
+    }
+    CHECK(position == fileSize);
+    CHECK(mxf_file_eof(mxfFile));
+
+    CHECK(mxf_file_seek(mxfFile, 100, SEEK_SET));
+    CHECK(mxf_file_read(mxfFile, data, sizeof(data)) == sizeof(data));
+    for (i = 0; i < sizeof(data); i++)
+        CHECK(data[i] == 0);
+
+    mxf_cache_file_stop_prefetcher(cacheFile);
+    mxf_file_close(&mxfFile);
+}
+#endif
+
+int main(int argc, const char *argv[])
+{
+    unsigned char *writeData;
+    unsigned char *readData;
+
+    if (argc != 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    writeData = malloc(DATA_SIZE);
+    memset(writeData, 122, DATA_SIZE);
+    writeData[0] = 0x01;
+    writeData[DATA_SIZE / 2] = 0x02;
+    readData = malloc(DATA_SIZE);
+
+
+    test_cache_file(argv[1], 1, writeData, readData);
+    test_cache_file(argv[1], 4, writeData, readData);
+    test_cache_file(argv[1], 0, writeData, readData);
+
+    test_alternating_reads(argv[1], 1, 20);
+    test_alternating_reads(argv[1], 2, 2);
+    test_alternating_reads(argv[1], 0, 2);
+
+#if defined(HAVE_PTHREAD)
+    test_flusher(argv[1], 1, readData);
+    test_flusher(argv[1], 0, readData);
+    test_prefetcher(argv[1], 1, readData);
+    test_prefetcher(argv[1], 0, readData);
+#endif
 
 
     free(writeData);
@@ -137,4 +298,3 @@ int main(int argc, const char *argv[])
 
     return 0;
 }
-
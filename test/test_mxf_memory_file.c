@@ -36,14 +36,25 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#if !defined(_WIN32) && defined(HAVE_SHM_OPEN)
+#include <unistd.h>
+#endif
 
 #include <mxf/mxf.h>
 #include <mxf/mxf_memory_file.h>
 
+#if !defined(_WIN32) && (defined(HAVE_MEMFD_CREATE) || defined(HAVE_SHM_OPEN))
+#define HAVE_SHARED_MEM_FILE    1
+#endif
+
 
 #define CHUNK_SIZE  1024
 #define DATA_SIZE   (CHUNK_SIZE * 5 / 2)
 
+#define GROWTH_DATA_SIZE    (CHUNK_SIZE * 20)
+
+static const char *g_flushFilename = "memfiletest_flush.mxf";
+
 
 
 #define CHECK(cmd) \
@@ -55,12 +66,47 @@
 
 
 
+static int check_pattern(MXFFile *mxfFile, int64_t start, int64_t size, int offset)
+{
+    unsigned char buffer[1500];
+    int64_t position;
+    uint32_t count;
+    uint32_t i;
+
+    if (!mxf_file_seek(mxfFile, start, SEEK_SET))
+        return 0;
+
+    for (position = start; position < start + size; position += count) {
+        count = (start + size - position > (int64_t)sizeof(buffer) ? sizeof(buffer) : (uint32_t)(start + size - position));
+        if (mxf_file_read(mxfFile, buffer, count) != count)
+            return 0;
+        for (i = 0; i < count; i++) {
+            if (buffer[i] != (unsigned char)(position + i + offset))
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
 int main()
 {
     MXFMemoryFile *mxfMemFile;
+#if defined(HAVE_SHARED_MEM_FILE)
+    MXFMemoryFile *readMemFile;
+    MXFFile *readFile;
+#endif
     MXFFile *mxfFile;
+    MXFFile *flushFile;
     unsigned char *data;
+    unsigned char *adoptData;
+    unsigned char stackData[100];
+#if defined(HAVE_SHARED_MEM_FILE) && defined(HAVE_SHM_OPEN)
+    char sharedName[64];
+#endif
+    const uint8_t *view;
     int64_t numChunks;
+    int64_t i;
 
     data = malloc(DATA_SIZE);
     memset(data, 122, DATA_SIZE);
@@ -110,6 +156,12 @@ int main()
     CHECK(mxf_file_size(mxfFile) == DATA_SIZE * 5 + DATA_SIZE / 3);
     CHECK(mxf_file_write(mxfFile, data, DATA_SIZE) == DATA_SIZE);
     CHECK(mxf_file_size(mxfFile) == DATA_SIZE * 6 + DATA_SIZE / 3);
+    CHECK(mxf_file_seek(mxfFile, CHUNK_SIZE - 1, SEEK_SET));
+    CHECK(mxf_file_read_view(mxfFile, &view, 2) == 1);
+    CHECK(view == &mxf_mem_file_get_chunk_data(mxfMemFile, 0)[CHUNK_SIZE - 1]);
+    CHECK(mxf_file_read_view(mxfFile, &view, 1) == 1);
+    CHECK(view == mxf_mem_file_get_chunk_data(mxfMemFile, 1));
+    CHECK(mxf_file_tell(mxfFile) == CHUNK_SIZE + 1);
 
     mxf_file_close(&mxfFile);
 
@@ -132,7 +184,121 @@ int main()
     CHECK(mxf_file_eof(mxfFile));
     CHECK(mxf_file_tell(mxfFile) == DATA_SIZE);
 
+    CHECK(mxf_file_can_read_view(mxfFile));
+    CHECK(mxf_file_seek(mxfFile, 1, SEEK_SET));
+    CHECK(mxf_file_read_view(mxfFile, &view, DATA_SIZE) == DATA_SIZE - 1);
+    CHECK(view == &data[1]);
+    CHECK(mxf_file_read_view(mxfFile, &view, DATA_SIZE) == 0);
+    CHECK(mxf_file_eof(mxfFile));
+
+    mxf_file_close(&mxfFile);
+
+
+    /* chunk growth */
+
+    CHECK(mxf_mem_file_open_new(CHUNK_SIZE, 0, &mxfMemFile));
+    mxfFile = mxf_mem_file_get_file(mxfMemFile);
+    CHECK(!mxf_mem_file_set_chunk_growth(mxfMemFile, CHUNK_SIZE / 2));
+    CHECK(mxf_mem_file_set_chunk_growth(mxfMemFile, CHUNK_SIZE * 8));
+
+    for (i = 0; i < GROWTH_DATA_SIZE; i++)
+        CHECK(mxf_file_putc(mxfFile, (int)(i & 0xff)) == (int)(i & 0xff));
+    CHECK(mxf_file_size(mxfFile) == GROWTH_DATA_SIZE);
+    CHECK(mxf_mem_file_get_num_chunks(mxfMemFile) == 5);
+    CHECK(mxf_mem_file_get_chunk_size(mxfMemFile, 0) == CHUNK_SIZE);
+    CHECK(mxf_mem_file_get_chunk_size(mxfMemFile, 1) == CHUNK_SIZE * 2);
+    CHECK(mxf_mem_file_get_chunk_size(mxfMemFile, 3) == CHUNK_SIZE * 8);
+    CHECK(mxf_mem_file_get_chunk_size(mxfMemFile, 4) == CHUNK_SIZE * 5);
+    CHECK(check_pattern(mxfFile, 0, GROWTH_DATA_SIZE, 0));
+    CHECK(check_pattern(mxfFile, CHUNK_SIZE * 3 - 10, CHUNK_SIZE * 5, 0));
+    CHECK(mxf_file_seek(mxfFile, CHUNK_SIZE * 7 - 1, SEEK_SET));
+    CHECK(mxf_file_read_view(mxfFile, &view, 2) == 1);
+    CHECK(view == &mxf_mem_file_get_chunk_data(mxfMemFile, 2)[CHUNK_SIZE * 4 - 1]);
+
+    /* adopted chunks */
+
+    CHECK(!mxf_mem_file_adopt_chunk(mxfMemFile, stackData, 0, 0));
+    adoptData = malloc(DATA_SIZE);
+    for (i = 0; i < DATA_SIZE; i++)
+        adoptData[i] = (unsigned char)(GROWTH_DATA_SIZE + i);
+    CHECK(mxf_mem_file_adopt_chunk(mxfMemFile, adoptData, DATA_SIZE, 1));
+    for (i = 0; i < (int64_t)sizeof(stackData); i++)
+        stackData[i] = (unsigned char)(GROWTH_DATA_SIZE + DATA_SIZE + i);
+    CHECK(mxf_mem_file_adopt_chunk(mxfMemFile, stackData, sizeof(stackData), 0));
+    CHECK(mxf_mem_file_get_num_chunks(mxfMemFile) == 7);
+    CHECK(mxf_mem_file_get_chunk_data(mxfMemFile, 5) == adoptData);
+    CHECK(mxf_file_size(mxfFile) == GROWTH_DATA_SIZE + DATA_SIZE + sizeof(stackData));
+    CHECK(mxf_file_seek(mxfFile, 0, SEEK_END));
+    for (i = GROWTH_DATA_SIZE + DATA_SIZE + sizeof(stackData); i < GROWTH_DATA_SIZE * 2; i++)
+        CHECK(mxf_file_putc(mxfFile, (int)(i & 0xff)) == (int)(i & 0xff));
+    CHECK(check_pattern(mxfFile, 0, GROWTH_DATA_SIZE * 2, 0));
+
+    /* data can be overwritten in adopted chunks */
+    memset(data, 0, DATA_SIZE);
+    CHECK(mxf_file_seek(mxfFile, GROWTH_DATA_SIZE + 10, SEEK_SET));
+    CHECK(mxf_file_write(mxfFile, data, DATA_SIZE) == DATA_SIZE);
+    CHECK(adoptData[DATA_SIZE - 1] == 0);
+    CHECK(stackData[9] == 0);
+    for (i = 0; i < DATA_SIZE; i++)
+        data[i] = (unsigned char)(GROWTH_DATA_SIZE + 10 + i);
+    CHECK(mxf_file_seek(mxfFile, GROWTH_DATA_SIZE + 10, SEEK_SET));
+    CHECK(mxf_file_write(mxfFile, data, DATA_SIZE) == DATA_SIZE);
+
+    /* vectored flush */
+    CHECK(mxf_disk_file_open_new(g_flushFilename, &flushFile));
+    CHECK(mxf_mem_file_flush_to_file(mxfMemFile, flushFile));
+    mxf_file_close(&flushFile);
+    mxf_file_close(&mxfFile);
+
+    CHECK(mxf_disk_file_open_read(g_flushFilename, &flushFile));
+    CHECK(mxf_file_size(flushFile) == GROWTH_DATA_SIZE * 2);
+    CHECK(check_pattern(flushFile, 0, GROWTH_DATA_SIZE * 2, 0));
+    mxf_file_close(&flushFile);
+    remove(g_flushFilename);
+
+
+#if defined(HAVE_SHARED_MEM_FILE)
+    /* shared memory file handed over using the memfd descriptor */
+    CHECK(mxf_mem_file_open_new_shared(NULL, CHUNK_SIZE, 0, &mxfMemFile));
+    mxfFile = mxf_mem_file_get_file(mxfMemFile);
+    CHECK(mxf_mem_file_get_shared_fd(mxfMemFile) >= 0);
+    CHECK(!mxf_mem_file_adopt_chunk(mxfMemFile, stackData, sizeof(stackData), 0));
+    for (i = 0; i < GROWTH_DATA_SIZE; i++)
+        CHECK(mxf_file_putc(mxfFile, (int)(i & 0xff)) == (int)(i & 0xff));
+    CHECK(mxf_mem_file_get_num_chunks(mxfMemFile) == 1);
+    CHECK(mxf_mem_file_get_size(mxfMemFile) == GROWTH_DATA_SIZE);
+    CHECK(check_pattern(mxfFile, 0, GROWTH_DATA_SIZE, 0));
+    CHECK(mxf_mem_file_seal_shared(mxfMemFile));
+    CHECK(mxf_file_write(mxfFile, data, 1) == 0);
+    CHECK(check_pattern(mxfFile, 0, GROWTH_DATA_SIZE, 0));
+
+    CHECK(mxf_mem_file_open_read_shared_fd(mxf_mem_file_get_shared_fd(mxfMemFile), 100, &readMemFile));
+    readFile = mxf_mem_file_get_file(readMemFile);
     mxf_file_close(&mxfFile);
+    CHECK(mxf_file_size(readFile) == GROWTH_DATA_SIZE + 100);
+    CHECK(check_pattern(readFile, 100, GROWTH_DATA_SIZE, -100));
+    mxf_file_close(&readFile);
+
+#if defined(HAVE_SHM_OPEN)
+    /* named shared memory file */
+    snprintf(sharedName, sizeof(sharedName), "/mxf_memfiletest_%ld", (long)getpid());
+    CHECK(mxf_mem_file_open_new_shared(sharedName, 0, 0, &mxfMemFile));
+    mxfFile = mxf_mem_file_get_file(mxfMemFile);
+    CHECK(mxf_file_seek(mxfFile, DATA_SIZE, SEEK_SET));
+    CHECK(mxf_file_write(mxfFile, data, DATA_SIZE) == DATA_SIZE);
+    CHECK(mxf_mem_file_seal_shared(mxfMemFile));
+    mxf_file_close(&mxfFile);
+
+    CHECK(mxf_mem_file_open_read_shared(sharedName, 0, &readMemFile));
+    readFile = mxf_mem_file_get_file(readMemFile);
+    CHECK(mxf_file_size(readFile) == DATA_SIZE * 2);
+    CHECK(mxf_file_read_view(readFile, &view, DATA_SIZE * 2) == DATA_SIZE * 2);
+    CHECK(view[0] == 0 && view[DATA_SIZE * 2 - 1] == data[DATA_SIZE - 1]);
+    mxf_file_close(&readFile);
+    CHECK(mxf_mem_file_unlink_shared(sharedName));
+    CHECK(!mxf_mem_file_open_read_shared(sharedName, 0, &readMemFile));
+#endif
+#endif
 
 
     free(data);
@@ -37,6 +37,16 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <sys/stat.h>
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(HAVE_PTHREAD)
+#include <pthread.h>
+#endif
 
 #include <mxf/mxf.h>
 #include <mxf/mxf_page_file.h>
@@ -46,7 +56,19 @@
 #define PAGE_SIZE   (10 * 1024 * 1024)
 #define DATA_SIZE   (PAGE_SIZE * 3 / 2)
 
+#define POOL_PAGE_SIZE      4096
+#define POOL_NUM_PAGES      40
+#define POOL_DATA_SIZE      (POOL_PAGE_SIZE * POOL_NUM_PAGES)
+#define POOL_NUM_READS      2000
+#define POOL_NUM_THREADS    4
+
+#define NUM_STRIPES         3
+
+#define RING_MAX_PAGES      4
+#define RING_DATA_SIZE      (POOL_PAGE_SIZE * 200 + 123)
+
 static const char *g_testFile = "pagetest___%d.mxf";
+static const char *g_stripeDirs[NUM_STRIPES] = {"pagetest_stripe0", "pagetest_stripe1/", "pagetest_stripe2"};
 
 
 
@@ -74,10 +96,401 @@ static void remove_test_files()
     }
 }
 
+static uint8_t pool_byte(int64_t position)
+{
+    return (uint8_t)((position * 7) ^ (position >> 12));
+}
+
+static int check_random_reads(MXFFile *mxfFile, unsigned int seed)
+{
+    uint8_t buffer[POOL_PAGE_SIZE * 2];
+    int64_t position;
+    uint32_t count;
+    uint32_t i;
+    int r;
+
+    for (r = 0; r < POOL_NUM_READS; r++)
+    {
+        seed = seed * 1103515245 + 12345;
+        position = (seed >> 8) % POOL_DATA_SIZE;
+        count = (seed >> 4) % sizeof(buffer) + 1;
+        if (position + count > POOL_DATA_SIZE)
+        {
+            count = (uint32_t)(POOL_DATA_SIZE - position);
+        }
+
+        if (!mxf_file_seek(mxfFile, position, SEEK_SET) ||
+            mxf_file_read(mxfFile, buffer, count) != count)
+        {
+            return 0;
+        }
+        for (i = 0; i < count; i++)
+        {
+            if (buffer[i] != pool_byte(position + i))
+            {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+#if defined(HAVE_PTHREAD)
+typedef struct
+{
+    MXFFile *mxfFile;
+    unsigned int seed;
+    int result;
+} ReaderThread;
+
+static void* reader_thread(void *arg)
+{
+    ReaderThread *reader = (ReaderThread*)arg;
+
+    reader->result = check_random_reads(reader->mxfFile, reader->seed);
+
+    return NULL;
+}
+#endif
+
+static void test_descriptor_pool()
+{
+    MXFPageFile *mxfPageFile;
+    MXFFile *mxfFile;
+    uint8_t *data;
+    int64_t i;
+
+    data = malloc(POOL_DATA_SIZE);
+    for (i = 0; i < POOL_DATA_SIZE; i++)
+    {
+        data[i] = pool_byte(i);
+    }
+
+    /* written pages are closed and re-opened without being truncated */
+    CHECK(mxf_page_file_open_new(g_testFile, POOL_PAGE_SIZE, &mxfPageFile));
+    mxfFile = mxf_page_file_get_file(mxfPageFile);
+    CHECK(!mxf_page_file_set_max_open_files(mxfPageFile, 0));
+    CHECK(mxf_page_file_set_max_open_files(mxfPageFile, 3));
+    CHECK(mxf_file_write(mxfFile, data, POOL_DATA_SIZE) == POOL_DATA_SIZE);
+    CHECK(mxf_page_file_get_num_open_files(mxfPageFile) == 3);
+    CHECK(mxf_file_seek(mxfFile, POOL_PAGE_SIZE / 2, SEEK_SET));
+    CHECK(mxf_file_write(mxfFile, &data[POOL_PAGE_SIZE / 2], POOL_PAGE_SIZE) == POOL_PAGE_SIZE);
+    CHECK(check_random_reads(mxfFile, 1));
+    CHECK(mxf_page_file_get_num_open_files(mxfPageFile) <= 3);
+    mxf_file_close(&mxfFile);
+
+    CHECK(mxf_page_file_open_read(g_testFile, &mxfPageFile));
+    mxfFile = mxf_page_file_get_file(mxfPageFile);
+    CHECK(mxf_file_size(mxfFile) == POOL_DATA_SIZE);
+    CHECK(mxf_page_file_set_max_open_files(mxfPageFile, 2));
+    CHECK(check_random_reads(mxfFile, 2));
+    CHECK(mxf_page_file_get_num_open_files(mxfPageFile) <= 2);
+    CHECK(mxf_page_file_set_max_open_files(mxfPageFile, 1));
+    CHECK(mxf_page_file_get_num_open_files(mxfPageFile) <= 1);
+
+#if defined(HAVE_PTHREAD)
+    {
+        /* duplicates share the pool and read concurrently */
+        ReaderThread readers[POOL_NUM_THREADS];
+        pthread_t threads[POOL_NUM_THREADS];
+        int t;
+
+        CHECK(mxf_page_file_set_max_open_files(mxfPageFile, POOL_NUM_THREADS));
+        for (t = 0; t < POOL_NUM_THREADS; t++)
+        {
+            CHECK(mxf_file_dup(mxfFile, &readers[t].mxfFile));
+            readers[t].seed = 100 + t;
+            readers[t].result = 0;
+            CHECK(pthread_create(&threads[t], NULL, reader_thread, &readers[t]) == 0);
+        }
+        for (t = 0; t < POOL_NUM_THREADS; t++)
+        {
+            CHECK(pthread_join(threads[t], NULL) == 0);
+            CHECK(readers[t].result);
+            mxf_file_close(&readers[t].mxfFile);
+        }
+    }
+#endif
+
+    mxf_file_close(&mxfFile);
+
+    CHECK(mxf_page_file_remove(g_testFile));
+
+    free(data);
+}
+
+static void test_striped()
+{
+    MXFPageFile *mxfPageFile;
+    MXFFile *mxfFile;
+    MXFFile *dupFile;
+    const char *wrongDirs[NUM_STRIPES];
+    char filename[4096];
+    struct stat st;
+    uint8_t *data;
+    uint32_t count;
+    int64_t i;
+
+    data = malloc(POOL_DATA_SIZE);
+    for (i = 0; i < POOL_DATA_SIZE; i++)
+    {
+        data[i] = pool_byte(i);
+    }
+
+    for (i = 0; i < NUM_STRIPES; i++)
+    {
+#if defined(_WIN32)
+        _mkdir(g_stripeDirs[i]);
+#else
+        mkdir(g_stripeDirs[i], 0777);
+#endif
+    }
+
+    /* write in small pieces and update the start, as done when writing a header */
+    CHECK(mxf_page_file_open_new_striped(g_stripeDirs, NUM_STRIPES, "page_%d.mxf", POOL_PAGE_SIZE, &mxfPageFile));
+    mxfFile = mxf_page_file_get_file(mxfPageFile);
+    memset(data, 0, 100);
+    CHECK(mxf_file_write(mxfFile, data, 100) == 100);
+    for (i = 100; i < POOL_DATA_SIZE; i += count)
+    {
+        count = (uint32_t)(i % 1000 + 1);
+        if (i + count > POOL_DATA_SIZE)
+        {
+            count = (uint32_t)(POOL_DATA_SIZE - i);
+        }
+        CHECK(mxf_file_write(mxfFile, &data[i], count) == count);
+    }
+    for (i = 0; i < 100; i++)
+    {
+        data[i] = pool_byte(i);
+    }
+    CHECK(mxf_file_seek(mxfFile, 0, SEEK_SET));
+    CHECK(mxf_file_write(mxfFile, data, 100) == 100);
+    CHECK(mxf_file_size(mxfFile) == POOL_DATA_SIZE);
+
+    /* queued data is written before it is read back */
+    CHECK(check_random_reads(mxfFile, 3));
+    CHECK(mxf_file_seek(mxfFile, POOL_DATA_SIZE, SEEK_SET));
+    CHECK(mxf_file_write(mxfFile, data, 10) == 10);
+    CHECK(mxf_file_dup(mxfFile, &dupFile));
+    CHECK(mxf_file_seek(dupFile, POOL_DATA_SIZE, SEEK_SET));
+    CHECK(mxf_file_read(dupFile, &data[POOL_DATA_SIZE - 10], 10) == 10);
+    CHECK(memcmp(data, &data[POOL_DATA_SIZE - 10], 10) == 0);
+    mxf_file_close(&dupFile);
+    mxf_file_close(&mxfFile);
+
+    /* pages are placed round-robin in the directories */
+    for (i = 0; i <= POOL_NUM_PAGES; i++)
+    {
+        mxf_snprintf(filename, sizeof(filename), "pagetest_stripe%d/page_%d.mxf", (int)(i % NUM_STRIPES), (int)i);
+        CHECK(stat(filename, &st) == 0);
+        CHECK(st.st_size == (i < POOL_NUM_PAGES ? POOL_PAGE_SIZE : 10));
+    }
+
+    CHECK(mxf_page_file_open_read_striped(g_stripeDirs, NUM_STRIPES, "page_%d.mxf", &mxfPageFile));
+    mxfFile = mxf_page_file_get_file(mxfPageFile);
+    CHECK(mxf_file_size(mxfFile) == POOL_DATA_SIZE + 10);
+    CHECK(check_random_reads(mxfFile, 4));
+    mxf_file_close(&mxfFile);
+
+    /* the first page is not found if the directories are in the wrong order */
+    wrongDirs[0] = g_stripeDirs[1];
+    wrongDirs[1] = g_stripeDirs[0];
+    wrongDirs[2] = g_stripeDirs[2];
+    CHECK(!mxf_page_file_open_read_striped(wrongDirs, NUM_STRIPES, "page_%d.mxf", &mxfPageFile));
+
+    CHECK(mxf_page_file_remove_striped(g_stripeDirs, NUM_STRIPES, "page_%d.mxf"));
+    for (i = 0; i < NUM_STRIPES; i++)
+    {
+#if defined(_WIN32)
+        CHECK(_rmdir(g_stripeDirs[i]) == 0);
+#else
+        CHECK(rmdir(g_stripeDirs[i]) == 0);
+#endif
+    }
+
+    free(data);
+}
+
+static int write_ring_data(MXFFile *mxfFile, int64_t size)
+{
+    uint8_t buffer[1000];
+    int64_t position = mxf_file_tell(mxfFile);
+    uint32_t count;
+    uint32_t i;
+
+    while (position < size)
+    {
+        count = (uint32_t)(position % sizeof(buffer) + 1);
+        if (position + count > size)
+        {
+            count = (uint32_t)(size - position);
+        }
+        for (i = 0; i < count; i++)
+        {
+            buffer[i] = pool_byte(position + i);
+        }
+        if (mxf_file_write(mxfFile, buffer, count) != count)
+        {
+            return 0;
+        }
+        position += count;
+    }
+
+    return 1;
+}
+
+/* reads until the end of the data, skipping forward to the window start if the reader falls behind */
+static int follow_ring(MXFPageFile *reader, int64_t endPosition)
+{
+    MXFFile *mxfFile = mxf_page_file_get_file(reader);
+    uint8_t buffer[3000];
+    int64_t position;
+    int64_t start;
+    int64_t end;
+    uint32_t numRead;
+    uint32_t i;
+
+    position = mxf_file_tell(mxfFile);
+    while (position < endPosition)
+    {
+        numRead = (endPosition - position < (int64_t)sizeof(buffer) ? (uint32_t)(endPosition - position) :
+                        (uint32_t)sizeof(buffer));
+        numRead = mxf_file_read(mxfFile, buffer, numRead);
+        if (numRead == 0)
+        {
+            if (!mxf_page_file_get_ring_window(reader, &start, &end))
+            {
+                return 0;
+            }
+            if (position < start && !mxf_file_seek(mxfFile, start, SEEK_SET))
+            {
+                return 0;
+            }
+            position = mxf_file_tell(mxfFile);
+            continue;
+        }
+
+        for (i = 0; i < numRead; i++)
+        {
+            if (buffer[i] != pool_byte(position + i))
+            {
+                return 0;
+            }
+        }
+        position += numRead;
+    }
+
+    return mxf_file_tell(mxfFile) == endPosition;
+}
+
+#if defined(HAVE_PTHREAD)
+typedef struct
+{
+    MXFPageFile *reader;
+    int result;
+} RingReaderThread;
+
+static void* ring_reader_thread(void *arg)
+{
+    RingReaderThread *reader = (RingReaderThread*)arg;
+
+    reader->result = follow_ring(reader->reader, RING_DATA_SIZE);
+
+    return NULL;
+}
+#endif
+
+static void test_ring()
+{
+    MXFPageFile *mxfPageFile;
+    MXFPageFile *reader;
+    MXFFile *mxfFile;
+    MXFFile *readerFile;
+    char filename[4096];
+    struct stat st;
+    uint8_t buffer[16];
+    int64_t start;
+    int64_t end;
+    int i;
+
+    CHECK(!mxf_page_file_open_new_ring(g_testFile, POOL_PAGE_SIZE, 1, &mxfPageFile));
+    CHECK(mxf_page_file_open_new_ring(g_testFile, POOL_PAGE_SIZE, RING_MAX_PAGES, &mxfPageFile));
+    mxfFile = mxf_page_file_get_file(mxfPageFile);
+    CHECK(mxf_page_file_get_ring_min_reader_position(mxfPageFile) == -1);
+    CHECK(!mxf_page_file_forward_truncate(mxfPageFile));
+
+    CHECK(mxf_page_file_open_ring_reader(mxfPageFile, &reader));
+    readerFile = mxf_page_file_get_file(reader);
+    CHECK(mxf_file_read(readerFile, buffer, 1) == 0);
+    CHECK(mxf_file_write(readerFile, buffer, 1) == 0);
+
+    /* the reader follows the writer */
+    CHECK(write_ring_data(mxfFile, POOL_PAGE_SIZE * 5 / 2));
+    CHECK(mxf_file_size(readerFile) == POOL_PAGE_SIZE * 5 / 2);
+    CHECK(follow_ring(reader, POOL_PAGE_SIZE));
+    CHECK(mxf_page_file_get_ring_min_reader_position(mxfPageFile) == POOL_PAGE_SIZE);
+
+    /* the oldest pages are dropped and the files are reused */
+    CHECK(write_ring_data(mxfFile, POOL_PAGE_SIZE * 10 + 5));
+    CHECK(mxf_page_file_get_ring_window(reader, &start, &end));
+    CHECK(start == POOL_PAGE_SIZE * 7);
+    CHECK(end == POOL_PAGE_SIZE * 10 + 5);
+    for (i = 0; i < RING_MAX_PAGES + 2; i++)
+    {
+        mxf_snprintf(filename, sizeof(filename), g_testFile, i);
+        CHECK((stat(filename, &st) == 0) == (i < RING_MAX_PAGES));
+    }
+    CHECK(mxf_page_file_get_size(g_testFile) == POOL_PAGE_SIZE * 3 + 5);
+    CHECK(mxf_file_read(readerFile, buffer, sizeof(buffer)) == 0);
+    CHECK(follow_ring(reader, POOL_PAGE_SIZE * 10 + 5));
+
+    /* the writer can update data in the window */
+    CHECK(!mxf_file_seek(mxfFile, POOL_PAGE_SIZE * 10 + 6, SEEK_SET));
+    CHECK(mxf_file_seek(mxfFile, POOL_PAGE_SIZE * 8, SEEK_SET));
+    CHECK(write_ring_data(mxfFile, POOL_PAGE_SIZE * 9));
+    CHECK(mxf_file_seek(mxfFile, POOL_PAGE_SIZE * 2, SEEK_SET));
+    CHECK(mxf_file_write(mxfFile, buffer, 1) == 0);
+    CHECK(mxf_file_seek(mxfFile, 0, SEEK_END));
+
+#if defined(HAVE_PTHREAD)
+    {
+        /* readers follow the writer concurrently */
+        RingReaderThread readers[2];
+        pthread_t threads[2];
+        int t;
+
+        for (t = 0; t < 2; t++)
+        {
+            CHECK(mxf_page_file_open_ring_reader(mxfPageFile, &readers[t].reader));
+            readers[t].result = 0;
+            CHECK(pthread_create(&threads[t], NULL, ring_reader_thread, &readers[t]) == 0);
+        }
+        CHECK(write_ring_data(mxfFile, RING_DATA_SIZE));
+        for (t = 0; t < 2; t++)
+        {
+            CHECK(pthread_join(threads[t], NULL) == 0);
+            CHECK(readers[t].result);
+            readerFile = mxf_page_file_get_file(readers[t].reader);
+            mxf_file_close(&readerFile);
+        }
+    }
+#endif
+
+    readerFile = mxf_page_file_get_file(reader);
+    mxf_file_close(&readerFile);
+    CHECK(mxf_page_file_get_ring_min_reader_position(mxfPageFile) == -1);
+    mxf_file_close(&mxfFile);
+
+    CHECK(mxf_page_file_remove(g_testFile));
+}
+
 int main()
 {
     MXFPageFile *mxfPageFile;
     MXFFile *mxfFile;
+    MXFFile *dupFile;
     uint8_t *data;
     int i;
 
@@ -149,6 +562,25 @@ int main()
     CHECK(mxf_file_seek(mxfFile, DATA_SIZE - 5, SEEK_CUR));
     CHECK(mxf_file_tell(mxfFile) == DATA_SIZE - 5);
     CHECK(mxf_file_read(mxfFile, data, DATA_SIZE) == DATA_SIZE);
+    CHECK(mxf_file_advise(mxfFile, 0, 0, MXF_ADVISE_RANDOM));
+    CHECK(mxf_file_advise(mxfFile, PAGE_SIZE / 2, PAGE_SIZE * 2, MXF_ADVISE_WILLNEED));
+    CHECK(mxf_file_tell(mxfFile) == DATA_SIZE * 2 - 5);
+    CHECK(mxf_file_seek(mxfFile, 0, SEEK_SET));
+    CHECK(mxf_file_read(mxfFile, data, DATA_SIZE) == DATA_SIZE);
+
+    /* test a duplicate has an independent position */
+    CHECK(mxf_file_seek(mxfFile, PAGE_SIZE - 5, SEEK_SET));
+    CHECK(mxf_file_dup(mxfFile, &dupFile));
+    CHECK(mxf_file_tell(dupFile) == PAGE_SIZE - 5);
+    CHECK(mxf_file_size(dupFile) == DATA_SIZE * 2);
+    CHECK(mxf_file_read(dupFile, data, 10) == 10);
+    CHECK(mxf_file_tell(dupFile) == PAGE_SIZE + 5);
+    CHECK(mxf_file_tell(mxfFile) == PAGE_SIZE - 5);
+    CHECK(mxf_file_read(mxfFile, data, DATA_SIZE) == DATA_SIZE);
+    CHECK(mxf_file_seek(dupFile, 0, SEEK_END));
+    CHECK(mxf_file_read(dupFile, data, 1) == 0);
+    CHECK(mxf_file_eof(dupFile));
+    mxf_file_close(&dupFile);
 
     mxf_file_close(&mxfFile);
 
@@ -206,6 +638,13 @@ int main()
     CHECK(mxf_page_file_remove(g_testFile));
 
 
+    test_descriptor_pool();
+
+    test_striped();
+
+    test_ring();
+
+
     free(data);
 
     return 0;
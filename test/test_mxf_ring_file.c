@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2012, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <mxf/mxf.h>
+#include <mxf/mxf_memory_file.h>
+#include <mxf/mxf_ring_file.h>
+
+
+#define DATA_SIZE       100000
+#define WINDOW_SIZE     4096
+
+
+
+#define CHECK(cmd) \
+    if (!(cmd)) \
+    { \
+        fprintf(stderr, "'%s' failed in %s:%d\n", #cmd, __FILE__, __LINE__); \
+        exit(1); \
+    }
+
+
+
+int main(void)
+{
+    MXFMemoryFile *memFile;
+    MXFRingFile *ringFile;
+    MXFFile *target;
+    MXFFile *mxfFile;
+    unsigned char *data;
+    unsigned char *readData;
+    int i;
+
+    data = malloc(DATA_SIZE);
+    readData = malloc(DATA_SIZE);
+    for (i = 0; i < DATA_SIZE; i++)
+        data[i] = (unsigned char)(i * 13 + (i >> 8));
+
+    CHECK(mxf_mem_file_open_read(data, DATA_SIZE, 0, &memFile));
+    target = mxf_mem_file_get_file(memFile);
+    CHECK(mxf_ring_file_open(target, WINDOW_SIZE, &ringFile));
+    mxfFile = mxf_ring_file_get_file(ringFile);
+
+    CHECK(!mxf_file_is_seekable(mxfFile));
+    CHECK(mxf_file_write(mxfFile, data, 1) == 0);
+
+    /* small reads and seeking back within the window */
+    CHECK(mxf_file_read(mxfFile, readData, 100) == 100);
+    CHECK(memcmp(readData, data, 100) == 0);
+    CHECK(mxf_file_getc(mxfFile) == data[100]);
+    CHECK(mxf_file_seek(mxfFile, 10, SEEK_SET));
+    CHECK(mxf_file_getc(mxfFile) == data[10]);
+    CHECK(mxf_file_tell(mxfFile) == 11);
+    CHECK(mxf_file_read(mxfFile, readData, 3000) == 3000);
+    CHECK(memcmp(readData, &data[11], 3000) == 0);
+
+    /* seeking forwards discards data and moves the window */
+    CHECK(mxf_file_seek(mxfFile, 20000, SEEK_CUR));
+    CHECK(mxf_file_tell(mxfFile) == 23011);
+    CHECK(mxf_ring_file_get_window_start(ringFile) > 0);
+    CHECK(!mxf_file_seek(mxfFile, 0, SEEK_SET));
+    CHECK(!mxf_file_seek(mxfFile, 0, SEEK_END));
+    CHECK(mxf_file_tell(mxfFile) == 23011);
+    CHECK(mxf_file_read(mxfFile, readData, 1000) == 1000);
+    CHECK(memcmp(readData, &data[23011], 1000) == 0);
+    CHECK(mxf_file_seek(mxfFile, -(WINDOW_SIZE / 2), SEEK_CUR));
+    CHECK(mxf_file_read(mxfFile, readData, WINDOW_SIZE / 2) == WINDOW_SIZE / 2);
+    CHECK(memcmp(readData, &data[24011 - WINDOW_SIZE / 2], WINDOW_SIZE / 2) == 0);
+
+    /* large reads bypass the buffer and keep the tail for seeking back */
+    CHECK(mxf_file_read(mxfFile, readData, 3 * WINDOW_SIZE) == 3 * WINDOW_SIZE);
+    CHECK(memcmp(readData, &data[24011], 3 * WINDOW_SIZE) == 0);
+    CHECK(mxf_ring_file_get_window_start(ringFile) == 24011 + 2 * WINDOW_SIZE);
+    CHECK(mxf_file_seek(mxfFile, 24011 + 2 * WINDOW_SIZE, SEEK_SET));
+    CHECK(mxf_file_read(mxfFile, readData, WINDOW_SIZE + 10) == WINDOW_SIZE + 10);
+    CHECK(memcmp(readData, &data[24011 + 2 * WINDOW_SIZE], WINDOW_SIZE + 10) == 0);
+
+    /* end of file */
+    CHECK(mxf_file_seek(mxfFile, DATA_SIZE - 10, SEEK_SET));
+    CHECK(!mxf_file_eof(mxfFile));
+    CHECK(mxf_file_read(mxfFile, readData, 100) == 10);
+    CHECK(memcmp(readData, &data[DATA_SIZE - 10], 10) == 0);
+    CHECK(mxf_file_eof(mxfFile));
+    CHECK(mxf_file_getc(mxfFile) == EOF);
+    CHECK(mxf_file_seek(mxfFile, -5, SEEK_CUR));
+    CHECK(!mxf_file_eof(mxfFile));
+    CHECK(mxf_file_getc(mxfFile) == data[DATA_SIZE - 5]);
+    CHECK(!mxf_file_seek(mxfFile, DATA_SIZE + 1, SEEK_SET));
+    CHECK(mxf_file_tell(mxfFile) == DATA_SIZE - 4);
+    CHECK(mxf_file_getc(mxfFile) == data[DATA_SIZE - 4]);
+
+    mxf_file_close(&mxfFile);
+
+    /* a failed forward seek keeps the position, which is no longer readable once it has left the window */
+    CHECK(mxf_mem_file_open_read(data, DATA_SIZE, 0, &memFile));
+    target = mxf_mem_file_get_file(memFile);
+    CHECK(mxf_ring_file_open(target, WINDOW_SIZE, &ringFile));
+    mxfFile = mxf_ring_file_get_file(ringFile);
+    CHECK(mxf_file_read(mxfFile, readData, 10) == 10);
+    CHECK(!mxf_file_seek(mxfFile, 2 * DATA_SIZE, SEEK_SET));
+    CHECK(mxf_file_tell(mxfFile) == 10);
+    CHECK(mxf_ring_file_get_window_start(ringFile) > 10);
+    CHECK(mxf_file_read(mxfFile, readData, 10) == 0);
+    CHECK(mxf_file_getc(mxfFile) == EOF);
+
+    mxf_file_close(&mxfFile);
+
+    free(data);
+    free(readData);
+
+    return 0;
+}
+
@@ -41,11 +41,14 @@
 #include <mxf/mxf_rw_intl_file.h>
 #include <mxf/mxf_memory_file.h>
 
+#include "mxf_shaped_file.h"
+
 
 #define BLOCK_SIZE          (64 * 1024)
 #define DATA_SIZE           (2 * BLOCK_SIZE)
 #define MEM_CHUNK_SIZE      (10 * BLOCK_SIZE)
 #define MEM_READER_SIZE     (10 * BLOCK_SIZE)
+#define ADAPT_DATA_SIZE     (64 * BLOCK_SIZE)
 
 
 
@@ -58,6 +61,156 @@
 
 
 
+static void test_adaptive()
+{
+    MXFRWInterleaver *interleaver;
+    MXFMemoryFile *memoryFile;
+    MXFShapedFile *shapedFile;
+    MXFShapedFileParams params;
+    MXFRWIntlWriterStats stats;
+    MXFFile *reader;
+    MXFFile *writer;
+    unsigned char *data;
+    int i;
+
+    data = malloc(ADAPT_DATA_SIZE);
+    memset(data, 122, ADAPT_DATA_SIZE);
+    memset(&params, 0, sizeof(params));
+
+    CHECK(mxf_create_rw_intl(BLOCK_SIZE, 2 * ADAPT_DATA_SIZE, &interleaver));
+    CHECK(mxf_rw_intl_set_adaptive(interleaver, 100 * 1000 * 1000, 4096, 4 * BLOCK_SIZE));
+
+    /* reads at 200MB/s and writes at 50MB/s leaves time for a quarter of a block to be flushed per block read
+       to achieve 100MB/s reads */
+    CHECK(mxf_mem_file_open_read(data, ADAPT_DATA_SIZE, 0, &memoryFile));
+    params.bytesPerSec = 200 * 1000 * 1000;
+    CHECK(mxf_shaped_file_open(mxf_mem_file_get_file(memoryFile), &params, &shapedFile));
+    CHECK(mxf_rw_intl_open(interleaver, mxf_shaped_file_get_file(shapedFile), 0, &reader));
+
+    CHECK(mxf_mem_file_open_new(MEM_CHUNK_SIZE, 0, &memoryFile));
+    params.bytesPerSec = 50 * 1000 * 1000;
+    CHECK(mxf_shaped_file_open(mxf_mem_file_get_file(memoryFile), &params, &shapedFile));
+    CHECK(mxf_rw_intl_open(interleaver, mxf_shaped_file_get_file(shapedFile), 1, &writer));
+
+    CHECK(mxf_file_write(writer, data, ADAPT_DATA_SIZE) == ADAPT_DATA_SIZE);
+    CHECK(mxf_rw_intl_get_num_writers(interleaver) == 1);
+    CHECK(mxf_rw_intl_get_writer_stats(interleaver, 0, &stats));
+    CHECK(stats.isOpen && stats.backlog == ADAPT_DATA_SIZE && stats.maxBacklog == ADAPT_DATA_SIZE);
+    CHECK(stats.flushedBytes == 0);
+
+    for (i = 0; i < ADAPT_DATA_SIZE / BLOCK_SIZE; i++)
+        CHECK(mxf_file_read(reader, data, BLOCK_SIZE) == BLOCK_SIZE);
+    CHECK(mxf_rw_intl_get_flush_size(interleaver) < BLOCK_SIZE / 2);
+
+    CHECK(mxf_rw_intl_get_writer_stats(interleaver, 0, &stats));
+    CHECK(stats.flushedBytes > 0 && stats.backlog == ADAPT_DATA_SIZE - stats.flushedBytes);
+    CHECK(!mxf_rw_intl_get_writer_stats(interleaver, 1, &stats));
+
+    /* reads continue without flushing once the writer is closed */
+    mxf_file_close(&writer);
+    CHECK(mxf_rw_intl_get_writer_stats(interleaver, 0, &stats));
+    CHECK(!stats.isOpen && stats.backlog == 0);
+    CHECK(mxf_file_seek(reader, 0, SEEK_SET));
+    CHECK(mxf_file_read(reader, data, 2 * BLOCK_SIZE) == 2 * BLOCK_SIZE);
+
+    mxf_file_close(&reader);
+    mxf_free_rw_intl(&interleaver);
+
+    free(data);
+}
+
+static void test_adaptive_small_reads()
+{
+    MXFRWInterleaver *interleaver;
+    MXFMemoryFile *memoryFile;
+    MXFShapedFile *shapedFile;
+    MXFShapedFileParams params;
+    MXFFile *reader;
+    MXFFile *writer;
+    unsigned char *data;
+    int i;
+
+    data = malloc(ADAPT_DATA_SIZE);
+    memset(data, 122, ADAPT_DATA_SIZE);
+    memset(&params, 0, sizeof(params));
+
+    CHECK(mxf_create_rw_intl(BLOCK_SIZE, 2 * ADAPT_DATA_SIZE, &interleaver));
+    CHECK(mxf_rw_intl_set_adaptive(interleaver, 100 * 1000 * 1000, 4096, 4 * BLOCK_SIZE));
+
+    /* reads that are much faster than the target rate leave time to flush half a block per block read at
+       50MB/s writes, whichever size the reads are. All reads must count, not just those that trigger a flush */
+    CHECK(mxf_mem_file_open_read(data, ADAPT_DATA_SIZE, 0, &memoryFile));
+    CHECK(mxf_rw_intl_open(interleaver, mxf_mem_file_get_file(memoryFile), 0, &reader));
+
+    CHECK(mxf_mem_file_open_new(MEM_CHUNK_SIZE, 0, &memoryFile));
+    params.bytesPerSec = 50 * 1000 * 1000;
+    CHECK(mxf_shaped_file_open(mxf_mem_file_get_file(memoryFile), &params, &shapedFile));
+    CHECK(mxf_rw_intl_open(interleaver, mxf_shaped_file_get_file(shapedFile), 1, &writer));
+    CHECK(mxf_file_write(writer, data, ADAPT_DATA_SIZE) == ADAPT_DATA_SIZE);
+
+    for (i = 0; i < ADAPT_DATA_SIZE / (BLOCK_SIZE / 16); i++)
+        CHECK(mxf_file_read(reader, data, BLOCK_SIZE / 16) == BLOCK_SIZE / 16);
+    CHECK(mxf_rw_intl_get_flush_size(interleaver) > BLOCK_SIZE / 4);
+    CHECK(mxf_rw_intl_get_flush_size(interleaver) < BLOCK_SIZE);
+
+    mxf_file_close(&writer);
+    mxf_file_close(&reader);
+    mxf_free_rw_intl(&interleaver);
+
+    free(data);
+}
+
+static void test_reader_shares()
+{
+    MXFRWInterleaver *interleaver;
+    MXFMemoryFile *memoryFile;
+    MXFRWIntlReaderStats stats;
+    MXFRWIntlWriterStats writerStats;
+    MXFFile *reader1;
+    MXFFile *reader3;
+    MXFFile *writer;
+    unsigned char *data;
+    int i;
+
+    data = malloc(ADAPT_DATA_SIZE);
+    memset(data, 122, ADAPT_DATA_SIZE);
+
+    CHECK(mxf_create_rw_intl(BLOCK_SIZE, 2 * ADAPT_DATA_SIZE, &interleaver));
+
+    CHECK(mxf_mem_file_open_read(data, ADAPT_DATA_SIZE, 0, &memoryFile));
+    CHECK(mxf_rw_intl_open(interleaver, mxf_mem_file_get_file(memoryFile), 0, &reader1));
+    CHECK(mxf_mem_file_open_read(data, ADAPT_DATA_SIZE, 0, &memoryFile));
+    CHECK(mxf_rw_intl_open_reader(interleaver, mxf_mem_file_get_file(memoryFile), 3, &reader3));
+    CHECK(!mxf_rw_intl_open_reader(interleaver, mxf_mem_file_get_file(memoryFile), 0, &writer));
+
+    CHECK(mxf_mem_file_open_new(MEM_CHUNK_SIZE, 0, &memoryFile));
+    CHECK(mxf_rw_intl_open(interleaver, mxf_mem_file_get_file(memoryFile), 1, &writer));
+    CHECK(mxf_file_write(writer, data, ADAPT_DATA_SIZE) == ADAPT_DATA_SIZE);
+
+    /* the reader with 3 times the share flushes a third of the writer data for the same amount read */
+    for (i = 0; i < 12; i++) {
+        CHECK(mxf_file_read(reader1, data, BLOCK_SIZE) == BLOCK_SIZE);
+        CHECK(mxf_file_read(reader3, data, BLOCK_SIZE) == BLOCK_SIZE);
+    }
+
+    CHECK(mxf_rw_intl_get_num_readers(interleaver) == 2);
+    CHECK(mxf_rw_intl_get_reader_stats(interleaver, 0, &stats));
+    CHECK(stats.share == 1 && stats.readBytes == 12 * BLOCK_SIZE && stats.flushedBytes == 12 * BLOCK_SIZE);
+    CHECK(mxf_rw_intl_get_reader_stats(interleaver, 1, &stats));
+    CHECK(stats.share == 3 && stats.readBytes == 12 * BLOCK_SIZE && stats.flushedBytes == 4 * BLOCK_SIZE);
+    CHECK(mxf_rw_intl_get_writer_stats(interleaver, 0, &writerStats));
+    CHECK(writerStats.flushedBytes == 16 * BLOCK_SIZE);
+
+    mxf_file_close(&reader1);
+    CHECK(mxf_rw_intl_get_reader_stats(interleaver, 0, &stats));
+    CHECK(!stats.isOpen);
+    mxf_file_close(&reader3);
+    mxf_file_close(&writer);
+    mxf_free_rw_intl(&interleaver);
+
+    free(data);
+}
+
 int main()
 {
     MXFRWInterleaver *interleaver;
@@ -96,6 +249,10 @@ int main()
 
     free(data);
 
+    test_adaptive();
+    test_adaptive_small_reads();
+    test_reader_shares();
+
     return 0;
 }
 
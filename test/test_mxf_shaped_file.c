@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2012, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <mxf/mxf.h>
+#include <mxf/mxf_memory_file.h>
+#include <mxf/mxf_cache_file.h>
+#include <mxf/mxf_stats_file.h>
+
+#include "mxf_shaped_file.h"
+
+
+#define DATA_SIZE       65536
+#define LATENCY_US      200
+#define KL_READ_SIZE    16
+#define KL_READ_STEP    256
+#define CACHE_PAGE_SIZE 8192
+
+
+
+#define CHECK(cmd) \
+    if (!(cmd)) \
+    { \
+        fprintf(stderr, "'%s' failed in %s:%d\n", #cmd, __FILE__, __LINE__); \
+        exit(1); \
+    }
+
+
+
+static unsigned char g_data[DATA_SIZE];
+
+
+/* open a memory file containing g_data, wrapped in a shaped file and then a statistics file */
+static void open_shaped_file(const MXFShapedFileParams *params, MXFShapedFile **shapedFile, MXFStatsFile **statsFile)
+{
+    MXFMemoryFile *memFile;
+    MXFFile *mxfFile;
+
+    CHECK(mxf_mem_file_open_new(DATA_SIZE, 0, &memFile));
+    mxfFile = mxf_mem_file_get_file(memFile);
+    CHECK(mxf_file_write(mxfFile, g_data, DATA_SIZE) == DATA_SIZE);
+    CHECK(mxf_file_seek(mxfFile, 0, SEEK_SET));
+
+    CHECK(mxf_shaped_file_open(mxfFile, params, shapedFile));
+    CHECK(mxf_stats_file_open(mxf_shaped_file_get_file(*shapedFile), statsFile));
+}
+
+/* read small chunks spread through the file, similar to a reader stepping through KLs */
+static void read_kls(MXFFile *mxfFile)
+{
+    unsigned char buffer[KL_READ_SIZE];
+    int64_t pos;
+
+    for (pos = 0; pos + KL_READ_SIZE <= DATA_SIZE; pos += KL_READ_STEP) {
+        CHECK(mxf_file_seek(mxfFile, pos, SEEK_SET));
+        CHECK(mxf_file_read(mxfFile, buffer, KL_READ_SIZE) == KL_READ_SIZE);
+        CHECK(memcmp(buffer, &g_data[pos], KL_READ_SIZE) == 0);
+    }
+}
+
+
+static void test_short_io(void)
+{
+    MXFShapedFileParams params;
+    MXFShapedFile *shapedFile;
+    MXFStatsFile *statsFile;
+    MXFFile *mxfFile;
+    unsigned char buffer[1000];
+
+    memset(&params, 0, sizeof(params));
+    params.shortIOInterval = 2;
+    open_shaped_file(&params, &shapedFile, &statsFile);
+    mxfFile = mxf_stats_file_get_file(statsFile);
+
+    CHECK(mxf_file_read(mxfFile, buffer, sizeof(buffer)) == sizeof(buffer));
+    CHECK(mxf_file_read(mxfFile, buffer, sizeof(buffer)) == sizeof(buffer) / 2);
+    CHECK(memcmp(buffer, &g_data[sizeof(buffer)], sizeof(buffer) / 2) == 0);
+    CHECK(mxf_file_tell(mxfFile) == sizeof(buffer) + sizeof(buffer) / 2);
+    CHECK(mxf_file_write(mxfFile, buffer, sizeof(buffer)) == sizeof(buffer));
+    CHECK(mxf_file_write(mxfFile, buffer, sizeof(buffer)) == sizeof(buffer) / 2);
+
+    params.shortIOInterval = 0;
+    mxf_shaped_file_set_params(shapedFile, &params);
+    CHECK(mxf_file_read(mxfFile, buffer, sizeof(buffer)) == sizeof(buffer));
+    CHECK(mxf_file_read(mxfFile, buffer, sizeof(buffer)) == sizeof(buffer));
+
+    mxf_file_close(&mxfFile);
+}
+
+static void test_latency_and_bandwidth(void)
+{
+    MXFShapedFileParams params;
+    MXFShapedFile *shapedFile;
+    MXFStatsFile *statsFile;
+    MXFStatsCounters counters;
+    MXFFile *mxfFile;
+    unsigned char buffer[10000];
+    int i;
+
+    memset(&params, 0, sizeof(params));
+    params.latencyUs = LATENCY_US;
+    open_shaped_file(&params, &shapedFile, &statsFile);
+    mxfFile = mxf_stats_file_get_file(statsFile);
+
+    for (i = 0; i < 10; i++)
+        CHECK(mxf_file_read(mxfFile, buffer, 100) == 100);
+    CHECK(mxf_file_seek(mxfFile, 0, SEEK_SET));
+
+    mxf_stats_file_get_counters(statsFile, MXF_STATS_READ, &counters);
+    CHECK(counters.count == 10);
+    CHECK(counters.totalNs >= 10 * LATENCY_US * 1000);
+    mxf_stats_file_get_counters(statsFile, MXF_STATS_SEEK, &counters);
+    CHECK(counters.count == 1 && counters.totalNs >= LATENCY_US * 1000);
+
+    /* 10000 bytes at 1 MB/s takes at least 10 ms */
+    params.latencyUs = 0;
+    params.bytesPerSec = 1000000;
+    mxf_shaped_file_set_params(shapedFile, &params);
+    mxf_stats_file_reset(statsFile);
+    CHECK(mxf_file_read(mxfFile, buffer, sizeof(buffer)) == sizeof(buffer));
+    mxf_stats_file_get_counters(statsFile, MXF_STATS_READ, &counters);
+    CHECK(counters.totalNs >= 10000000);
+
+    mxf_file_close(&mxfFile);
+}
+
+/* compares small reads from a high latency file with and without the cache file */
+static void test_cache_under_latency(void)
+{
+    MXFShapedFileParams params;
+    MXFShapedFile *shapedFile;
+    MXFStatsFile *statsFile;
+    MXFCacheFile *cacheFile;
+    MXFStatsCounters direct;
+    MXFStatsCounters cached;
+    MXFFile *mxfFile;
+
+    memset(&params, 0, sizeof(params));
+    params.latencyUs = LATENCY_US;
+
+    open_shaped_file(&params, &shapedFile, &statsFile);
+    mxfFile = mxf_stats_file_get_file(statsFile);
+    read_kls(mxfFile);
+    mxf_stats_file_log(statsFile, "direct");
+    mxf_stats_file_get_counters(statsFile, MXF_STATS_READ, &direct);
+    mxf_file_close(&mxfFile);
+
+    open_shaped_file(&params, &shapedFile, &statsFile);
+    CHECK(mxf_cache_file_open(mxf_stats_file_get_file(statsFile), CACHE_PAGE_SIZE, 4 * CACHE_PAGE_SIZE, &cacheFile));
+    mxfFile = mxf_cache_file_get_file(cacheFile);
+    read_kls(mxfFile);
+    mxf_stats_file_log(statsFile, "cached");
+    mxf_stats_file_get_counters(statsFile, MXF_STATS_READ, &cached);
+    mxf_file_close(&mxfFile);
+
+    CHECK(cached.count < direct.count);
+    CHECK(cached.totalNs < direct.totalNs);
+}
+
+
+int main(void)
+{
+    int i;
+
+    for (i = 0; i < DATA_SIZE; i++)
+        g_data[i] = (unsigned char)(i * 7);
+
+    test_short_io();
+    test_latency_and_bandwidth();
+    test_cache_under_latency();
+
+    return 0;
+}
+
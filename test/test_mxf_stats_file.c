@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2012, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <mxf/mxf.h>
+#include <mxf/mxf_memory_file.h>
+#include <mxf/mxf_stats_file.h>
+
+
+#define DATA_SIZE   8192
+
+
+
+#define CHECK(cmd) \
+    if (!(cmd)) \
+    { \
+        fprintf(stderr, "'%s' failed in %s:%d\n", #cmd, __FILE__, __LINE__); \
+        exit(1); \
+    }
+
+
+
+static uint64_t histogram_total(const MXFStatsCounters *counters)
+{
+    uint64_t total = 0;
+    int i;
+
+    for (i = 0; i < MXF_STATS_NUM_BUCKETS; i++)
+        total += counters->histogram[i];
+
+    return total;
+}
+
+int main(void)
+{
+    MXFMemoryFile *memFile;
+    MXFStatsFile *statsFile;
+    MXFFile *mxfFile;
+    MXFStatsCounters counters;
+    unsigned char writeData[DATA_SIZE];
+    unsigned char readData[DATA_SIZE];
+
+    memset(writeData, 0x55, DATA_SIZE);
+
+    CHECK(mxf_mem_file_open_new(1024, 0, &memFile));
+    CHECK(mxf_stats_file_open(mxf_mem_file_get_file(memFile), &statsFile));
+    mxfFile = mxf_stats_file_get_file(statsFile);
+
+    CHECK(mxf_file_write(mxfFile, writeData, DATA_SIZE) == DATA_SIZE);
+    CHECK(mxf_file_write(mxfFile, writeData, DATA_SIZE / 2) == DATA_SIZE / 2);
+    CHECK(mxf_file_putc(mxfFile, 0x02) == 0x02);
+    CHECK(mxf_file_size(mxfFile) == DATA_SIZE + DATA_SIZE / 2 + 1);
+    CHECK(mxf_file_seek(mxfFile, 0, SEEK_SET));
+    CHECK(mxf_file_read(mxfFile, readData, DATA_SIZE) == DATA_SIZE);
+    CHECK(memcmp(readData, writeData, DATA_SIZE) == 0);
+    CHECK(mxf_file_seek(mxfFile, -1, SEEK_END));
+    CHECK(mxf_file_getc(mxfFile) == 0x02);
+    CHECK(mxf_file_getc(mxfFile) == EOF);
+    CHECK(mxf_file_eof(mxfFile));
+    CHECK(mxf_file_tell(mxfFile) == DATA_SIZE + DATA_SIZE / 2 + 1);
+
+    mxf_stats_file_get_counters(statsFile, MXF_STATS_WRITE, &counters);
+    CHECK(counters.count == 2);
+    CHECK(counters.bytes == DATA_SIZE + DATA_SIZE / 2);
+    CHECK(histogram_total(&counters) == 2);
+    CHECK(counters.maxNs <= counters.totalNs);
+
+    mxf_stats_file_get_counters(statsFile, MXF_STATS_PUT_CHAR, &counters);
+    CHECK(counters.count == 1 && counters.bytes == 1);
+
+    mxf_stats_file_get_counters(statsFile, MXF_STATS_READ, &counters);
+    CHECK(counters.count == 1);
+    CHECK(counters.bytes == DATA_SIZE);
+
+    mxf_stats_file_get_counters(statsFile, MXF_STATS_GET_CHAR, &counters);
+    CHECK(counters.count == 2);
+    CHECK(counters.bytes == 1);
+
+    mxf_stats_file_get_counters(statsFile, MXF_STATS_SEEK, &counters);
+    CHECK(counters.count == 2 && counters.bytes == 0);
+
+    mxf_stats_file_get_counters(statsFile, MXF_STATS_SIZE, &counters);
+    CHECK(counters.count == 1);
+
+    mxf_stats_file_log(statsFile, "test");
+
+    mxf_stats_file_reset(statsFile);
+    mxf_stats_file_get_counters(statsFile, MXF_STATS_READ, &counters);
+    CHECK(counters.count == 0 && counters.bytes == 0 && histogram_total(&counters) == 0);
+    mxf_stats_file_get_counters(statsFile, MXF_STATS_NUM_OPS, &counters);
+    CHECK(counters.count == 0);
+
+    mxf_file_close(&mxfFile);
+
+    return 0;
+}
+
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2012, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <mxf/mxf.h>
+#include <mxf/mxf_uring_file.h>
+
+
+#define QUEUE_DEPTH     4
+#define BLOCK_SIZE      4096
+#define DATA_SIZE       (BLOCK_SIZE * 10 + 123)
+
+
+
+#define CHECK(cmd) \
+    if (!(cmd)) \
+    { \
+        fprintf(stderr, "'%s' failed in %s:%d\n", #cmd, __FILE__, __LINE__); \
+        exit(1); \
+    }
+
+
+
+int main(int argc, const char **argv)
+{
+    const char *filename;
+    MXFURingFile *uringFile;
+    MXFFile *mxfFile;
+    unsigned char *data;
+    unsigned char *readData;
+    uint64_t userData;
+    int32_t result;
+    uint32_t i;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <filename>\n", argv[0]);
+        return 1;
+    }
+    filename = argv[1];
+
+    if (!mxf_uring_file_is_supported()) {
+        fprintf(stderr, "io_uring is not supported\n");
+        return 77;
+    }
+
+    data = malloc(DATA_SIZE);
+    readData = malloc(DATA_SIZE);
+    for (i = 0; i < DATA_SIZE; i++)
+        data[i] = (unsigned char)(i % 251);
+
+
+    /* new: odd sized writes, a rewrite and put char */
+
+    CHECK(mxf_uring_file_open_new(filename, QUEUE_DEPTH, BLOCK_SIZE, &uringFile));
+    mxfFile = mxf_uring_file_get_file(uringFile);
+
+    CHECK(mxf_file_write(mxfFile, data, 1000) == 1000);
+    CHECK(mxf_file_write(mxfFile, &data[1000], DATA_SIZE - 2000) == DATA_SIZE - 2000);
+    CHECK(mxf_file_tell(mxfFile) == DATA_SIZE - 1000);
+    CHECK(mxf_file_seek(mxfFile, 10, SEEK_SET));
+    CHECK(mxf_file_write(mxfFile, &data[10], 100) == 100);
+    CHECK(mxf_file_seek(mxfFile, DATA_SIZE - 1000, SEEK_SET));
+    CHECK(mxf_file_write(mxfFile, &data[DATA_SIZE - 1000], 999) == 999);
+    CHECK(mxf_file_putc(mxfFile, data[DATA_SIZE - 1]) == data[DATA_SIZE - 1]);
+    CHECK(mxf_file_size(mxfFile) == DATA_SIZE);
+
+    /* read back what was written */
+    CHECK(mxf_file_seek(mxfFile, 0, SEEK_SET));
+    CHECK(mxf_file_read(mxfFile, readData, DATA_SIZE) == DATA_SIZE);
+    CHECK(memcmp(data, readData, DATA_SIZE) == 0);
+    CHECK(mxf_file_getc(mxfFile) == EOF);
+    CHECK(mxf_file_eof(mxfFile));
+
+    mxf_file_close(&mxfFile);
+
+
+    /* read using the disk file */
+
+    CHECK(mxf_disk_file_open_read(filename, &mxfFile));
+    CHECK(mxf_file_size(mxfFile) == DATA_SIZE);
+    CHECK(mxf_file_read(mxfFile, readData, DATA_SIZE) == DATA_SIZE);
+    CHECK(memcmp(data, readData, DATA_SIZE) == 0);
+    mxf_file_close(&mxfFile);
+
+
+    /* read: small sequential reads with read-ahead and a backwards seek */
+
+    CHECK(mxf_uring_file_open_read(filename, QUEUE_DEPTH, BLOCK_SIZE, &uringFile));
+    mxfFile = mxf_uring_file_get_file(uringFile);
+
+    memset(readData, 0, DATA_SIZE);
+    for (i = 0; i < DATA_SIZE; i += 77) {
+        uint32_t count = (DATA_SIZE - i < 77 ? DATA_SIZE - i : 77);
+        CHECK(mxf_file_read(mxfFile, &readData[i], count) == count);
+    }
+    CHECK(memcmp(data, readData, DATA_SIZE) == 0);
+    CHECK(mxf_file_seek(mxfFile, BLOCK_SIZE + 5, SEEK_SET));
+    CHECK(mxf_file_getc(mxfFile) == data[BLOCK_SIZE + 5]);
+    CHECK(mxf_file_write(mxfFile, data, 1) == 0);
+
+    mxf_file_close(&mxfFile);
+
+
+    /* modify: submit and complete */
+
+    CHECK(mxf_uring_file_open_modify(filename, QUEUE_DEPTH, BLOCK_SIZE, &uringFile));
+    mxfFile = mxf_uring_file_get_file(uringFile);
+
+    memset(readData, 0, DATA_SIZE);
+    CHECK(mxf_uring_file_submit_write(uringFile, DATA_SIZE, data, 100, 1));
+    CHECK(mxf_uring_file_submit_read(uringFile, 0, readData, BLOCK_SIZE, 2));
+    CHECK(mxf_uring_file_get_in_flight(uringFile) == 2);
+    for (i = 0; i < 2; i++) {
+        CHECK(mxf_uring_file_complete(uringFile, 1, &userData, &result));
+        CHECK((userData == 1 && result == 100) || (userData == 2 && result == BLOCK_SIZE));
+    }
+    CHECK(mxf_uring_file_get_in_flight(uringFile) == 0);
+    CHECK(!mxf_uring_file_complete(uringFile, 1, &userData, &result));
+    CHECK(memcmp(data, readData, BLOCK_SIZE) == 0);
+    CHECK(mxf_file_size(mxfFile) == DATA_SIZE + 100);
+
+    mxf_file_close(&mxfFile);
+
+
+    /* read a file that is still growing */
+
+    CHECK(mxf_uring_file_open_read(filename, QUEUE_DEPTH, BLOCK_SIZE, &uringFile));
+    mxfFile = mxf_uring_file_get_file(uringFile);
+
+    CHECK(mxf_file_read(mxfFile, readData, DATA_SIZE) == DATA_SIZE);
+    CHECK(mxf_file_read(mxfFile, readData, DATA_SIZE) == 100);
+    CHECK(mxf_file_eof(mxfFile));
+    {
+        MXFFile *appendFile;
+        CHECK(mxf_disk_file_open_modify(filename, &appendFile));
+        CHECK(mxf_file_seek(appendFile, 0, SEEK_END));
+        CHECK(mxf_file_write(appendFile, data, 2 * BLOCK_SIZE) == 2 * BLOCK_SIZE);
+        mxf_file_close(&appendFile);
+    }
+    memset(readData, 0, DATA_SIZE);
+    CHECK(mxf_file_read(mxfFile, readData, DATA_SIZE) == 2 * BLOCK_SIZE);
+    CHECK(memcmp(data, readData, 2 * BLOCK_SIZE) == 0);
+
+    mxf_file_close(&mxfFile);
+
+
+    free(data);
+    free(readData);
+
+    return 0;
+}
+